@@ -3402,6 +3402,12 @@ typedef struct AVCodecContext {
 #define FF_SUB_TEXT_FMT_ASS_WITH_TIMINGS 1
 #endif
 
+    /**
+     * If nonzero, collect performance statistics, see avcodec_get_stats().
+     * - encoding: unused
+     * - decoding: set by user before avcodec_open2()
+     */
+    int perf_stats;
 } AVCodecContext;
 
 AVRational av_codec_get_pkt_timebase         (const AVCodecContext *avctx);
@@ -4152,6 +4158,62 @@ int avcodec_open2(AVCodecContext *avctx, const AVCodec *codec, AVDictionary **op
  */
 int avcodec_close(AVCodecContext *avctx);
 
+/**
+ * Decoding stages timed in AVCodecStats.stage_time.
+ */
+enum AVCodecStage {
+    AV_CODEC_STAGE_ENTROPY,     ///< bitstream parsing and entropy decoding
+    AV_CODEC_STAGE_RECON,       ///< prediction and residual reconstruction
+    AV_CODEC_STAGE_LOOP_FILTER, ///< in-loop filtering
+    AV_CODEC_STAGE_NB           ///< Not part of ABI
+};
+
+/**
+ * Performance statistics of a codec context, collected when
+ * AVCodecContext.perf_stats is set. sizeof(AVCodecStats) is not a part of
+ * the public ABI, new fields may be added to the end with a minor version
+ * bump.
+ */
+typedef struct AVCodecStats {
+    /**
+     * Time spent in each stage, summed over all threads, in units of the
+     * platform high resolution timer (CPU cycles on x86). Only the h264,
+     * hevc and vp9 decoders report it. Decoders which interleave entropy
+     * decoding and reconstruction too finely to time them separately
+     * account both as AV_CODEC_STAGE_RECON. Stays 0 for stages a codec does
+     * not report or if no such timer is available. With frame threading,
+     * the frames still being decoded are not counted yet.
+     */
+    uint64_t stage_time[AV_CODEC_STAGE_NB];
+
+    /**
+     * Time threads spent blocked on other threads, i.e. waiting for the
+     * progress of reference frames or rows, and the caller waiting for
+     * frame threads to output a frame, in microseconds.
+     */
+    int64_t wait_time;
+
+    /**
+     * Time worker threads spent waiting for new work, in microseconds.
+     */
+    int64_t idle_time;
+
+    /**
+     * Number of frames currently being decoded by frame threads.
+     */
+    int frames_in_flight;
+} AVCodecStats;
+
+/**
+ * Get the performance statistics of a codec context. They may be read
+ * after each decoded frame.
+ *
+ * @return the statistics, valid until the next call to this function or
+ *         until the context is closed, or NULL if AVCodecContext.perf_stats
+ *         is not set or the context is not open
+ */
+const AVCodecStats *avcodec_get_stats(AVCodecContext *avctx);
+
 /**
  * Free all allocated data in the given subtitle struct.
  *
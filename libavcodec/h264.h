@@ -514,6 +514,10 @@ typedef struct H264SliceContext {
     // rbsp buffer used for this slice
     uint8_t *rbsp_buffer;
     unsigned int rbsp_buffer_size;
+
+    /* AVCodecStats stage times of this slice context */
+    uint64_t stage_time[AV_CODEC_STAGE_NB];
+    uint64_t stage_timer;
 } H264SliceContext;
 
 /**
@@ -2196,6 +2196,13 @@ static int fill_filter_caches(const H264Context *h, H264SliceContext *sl, int mb
     return 0;
 }
 
+static av_always_inline void stats_lap(const H264Context *h, H264SliceContext *sl,
+                                       enum AVCodecStage stage)
+{
+    if (h->avctx->perf_stats)
+        ff_stats_lap(sl->stage_time, stage, &sl->stage_timer);
+}
+
 static void loop_filter(const H264Context *h, H264SliceContext *sl, int start_x, int end_x)
 {
     uint8_t *dest_y, *dest_cb, *dest_cr;
@@ -2205,6 +2212,9 @@ static void loop_filter(const H264Context *h, H264SliceContext *sl, int start_x,
     const int pixel_shift    = h->pixel_shift;
     const int block_h        = 16 >> h->chroma_y_shift;
 
+    if (h->avctx->perf_stats)
+        sl->stage_timer = ff_stats_timer();
+
     if (sl->deblocking_filter) {
         for (mb_x = start_x; mb_x < end_x; mb_x++)
             for (mb_y = end_mb_y - FRAME_MBAFF(h); mb_y <= end_mb_y; mb_y++) {
@@ -2263,6 +2273,8 @@ static void loop_filter(const H264Context *h, H264SliceContext *sl, int start_x,
     sl->mb_y         = end_mb_y - FRAME_MBAFF(h);
     sl->chroma_qp[0] = get_chroma_qp(h, 0, sl->qscale);
     sl->chroma_qp[1] = get_chroma_qp(h, 1, sl->qscale);
+
+    stats_lap(h, sl, AV_CODEC_STAGE_LOOP_FILTER);
 }
 
 static void predict_field_decoding_flag(const H264Context *h, H264SliceContext *sl)
@@ -2339,6 +2351,9 @@ static int decode_slice(struct AVCodecContext *avctx, void *arg)
 
     sl->mb_skip_run = -1;
 
+    if (h->avctx->perf_stats)
+        sl->stage_timer = ff_stats_timer();
+
     av_assert0(h->block_offset[15] == (4 * ((scan8[15] - scan8[0]) & 7) << h->pixel_shift) + 4 * sl->linesize * ((scan8[15] - scan8[0]) >> 3));
 
     sl->is_complex = FRAME_MBAFF(h) || h->picture_structure != PICT_FRAME ||
@@ -2381,18 +2396,24 @@ static int decode_slice(struct AVCodecContext *avctx, void *arg)
 
             ret = ff_h264_decode_mb_cabac(h, sl);
             // STOP_TIMER("decode_mb_cabac")
+            stats_lap(h, sl, AV_CODEC_STAGE_ENTROPY);
 
-            if (ret >= 0)
+            if (ret >= 0) {
                 ff_h264_hl_decode_mb(h, sl);
+                stats_lap(h, sl, AV_CODEC_STAGE_RECON);
+            }
 
             // FIXME optimal? or let mb_decode decode 16x32 ?
             if (ret >= 0 && FRAME_MBAFF(h)) {
                 sl->mb_y++;
 
                 ret = ff_h264_decode_mb_cabac(h, sl);
+                stats_lap(h, sl, AV_CODEC_STAGE_ENTROPY);
 
-                if (ret >= 0)
+                if (ret >= 0) {
                     ff_h264_hl_decode_mb(h, sl);
+                    stats_lap(h, sl, AV_CODEC_STAGE_RECON);
+                }
                 sl->mb_y--;
             }
             eos = get_cabac_terminate(&sl->cabac);
@@ -2452,17 +2473,23 @@ static int decode_slice(struct AVCodecContext *avctx, void *arg)
             }
 
             ret = ff_h264_decode_mb_cavlc(h, sl);
+            stats_lap(h, sl, AV_CODEC_STAGE_ENTROPY);
 
-            if (ret >= 0)
+            if (ret >= 0) {
                 ff_h264_hl_decode_mb(h, sl);
+                stats_lap(h, sl, AV_CODEC_STAGE_RECON);
+            }
 
             // FIXME optimal? or let mb_decode decode 16x32 ?
             if (ret >= 0 && FRAME_MBAFF(h)) {
                 sl->mb_y++;
                 ret = ff_h264_decode_mb_cavlc(h, sl);
+                stats_lap(h, sl, AV_CODEC_STAGE_ENTROPY);
 
-                if (ret >= 0)
+                if (ret >= 0) {
                     ff_h264_hl_decode_mb(h, sl);
+                    stats_lap(h, sl, AV_CODEC_STAGE_RECON);
+                }
                 sl->mb_y--;
             }
 
@@ -2525,6 +2552,22 @@ static int decode_slice(struct AVCodecContext *avctx, void *arg)
     }
 }
 
+/* Add the stage times of the slice contexts to the codec statistics. */
+static void merge_slice_stats(H264Context *h, unsigned context_count)
+{
+    AVCodecStats *stats = &h->avctx->internal->stats;
+    int i, j;
+
+    for (i = 0; i < context_count; i++) {
+        H264SliceContext *sl = &h->slice_ctx[i];
+
+        for (j = 0; j < AV_CODEC_STAGE_NB; j++) {
+            stats->stage_time[j] += sl->stage_time[j];
+            sl->stage_time[j]     = 0;
+        }
+    }
+}
+
 /**
  * Call decode_slice() for each context.
  *
@@ -2554,6 +2597,8 @@ int ff_h264_execute_decode_slices(H264Context *h, unsigned context_count)
 
         ret = decode_slice(avctx, &h->slice_ctx[0]);
         h->mb_y = h->slice_ctx[0].mb_y;
+        if (avctx->perf_stats)
+            merge_slice_stats(h, 1);
         return ret;
     } else {
         av_assert0(context_count > 0);
@@ -2581,6 +2626,8 @@ int ff_h264_execute_decode_slices(H264Context *h, unsigned context_count)
 
         avctx->execute(avctx, decode_slice, h->slice_ctx,
                        NULL, context_count, sizeof(h->slice_ctx[0]));
+        if (avctx->perf_stats)
+            merge_slice_stats(h, context_count);
 
         /* pull back stuff from slices to master context */
         sl                   = &h->slice_ctx[context_count - 1];
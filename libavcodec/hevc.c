@@ -2304,6 +2304,38 @@ static void hls_decode_neighbour(HEVCContext *s, int x_ctb, int y_ctb,
     lc->ctb_up_left_flag = ((x_ctb > 0) && (y_ctb > 0)  && (ctb_addr_in_slice-1 >= s->ps.sps->ctb_width) && (s->ps.pps->tile_id[ctb_addr_ts] == s->ps.pps->tile_id[s->ps.pps->ctb_addr_rs_to_ts[ctb_addr_rs-1 - s->ps.sps->ctb_width]]));
 }
 
+static av_always_inline void stats_start(HEVCContext *s)
+{
+    if (s->avctx->perf_stats)
+        s->HEVClc->stage_timer = ff_stats_timer();
+}
+
+static av_always_inline void stats_lap(HEVCContext *s, enum AVCodecStage stage)
+{
+    if (s->avctx->perf_stats)
+        ff_stats_lap(s->HEVClc->stage_time, stage, &s->HEVClc->stage_timer);
+}
+
+/* Add the stage times of the local contexts to the codec statistics. The
+ * entropy decoding of the coding quadtree is interleaved with the
+ * reconstruction and accounted as such. */
+static void merge_stats(HEVCContext *s)
+{
+    AVCodecStats *stats = &s->avctx->internal->stats;
+    int i, j;
+
+    for (i = 0; i < FFMAX(s->threads_number, 1); i++) {
+        HEVCLocalContext *lc = i ? s->HEVClcList[i] : s->HEVClc;
+
+        if (!lc)
+            continue;
+        for (j = 0; j < AV_CODEC_STAGE_NB; j++) {
+            stats->stage_time[j] += lc->stage_time[j];
+            lc->stage_time[j]     = 0;
+        }
+    }
+}
+
 static int hls_decode_entry(AVCodecContext *avctxt, void *isFilterThread)
 {
     HEVCContext *s  = avctxt->priv_data;
@@ -2333,15 +2365,18 @@ static int hls_decode_entry(AVCodecContext *avctxt, void *isFilterThread)
         y_ctb = (ctb_addr_rs / ((s->ps.sps->width + ctb_size - 1) >> s->ps.sps->log2_ctb_size)) << s->ps.sps->log2_ctb_size;
         hls_decode_neighbour(s, x_ctb, y_ctb, ctb_addr_ts);
 
+        stats_start(s);
         ff_hevc_cabac_init(s, ctb_addr_ts);
 
         hls_sao_param(s, x_ctb >> s->ps.sps->log2_ctb_size, y_ctb >> s->ps.sps->log2_ctb_size);
+        stats_lap(s, AV_CODEC_STAGE_ENTROPY);
 
         s->deblock[ctb_addr_rs].beta_offset = s->sh.beta_offset;
         s->deblock[ctb_addr_rs].tc_offset   = s->sh.tc_offset;
         s->filter_slice_edges[ctb_addr_rs]  = s->sh.slice_loop_filter_across_slices_enabled_flag;
 
         more_data = hls_coding_quadtree(s, x_ctb, y_ctb, s->ps.sps->log2_ctb_size, 0);
+        stats_lap(s, AV_CODEC_STAGE_RECON);
         if (more_data < 0) {
             s->tab_slice_address[ctb_addr_rs] = -1;
             return more_data;
@@ -2351,11 +2386,15 @@ static int hls_decode_entry(AVCodecContext *avctxt, void *isFilterThread)
         ctb_addr_ts++;
         ff_hevc_save_states(s, ctb_addr_ts);
         ff_hevc_hls_filters(s, x_ctb, y_ctb, ctb_size);
+        stats_lap(s, AV_CODEC_STAGE_LOOP_FILTER);
     }
 
     if (x_ctb + ctb_size >= s->ps.sps->width &&
-        y_ctb + ctb_size >= s->ps.sps->height)
+        y_ctb + ctb_size >= s->ps.sps->height) {
+        stats_start(s);
         ff_hevc_hls_filter(s, x_ctb, y_ctb, ctb_size);
+        stats_lap(s, AV_CODEC_STAGE_LOOP_FILTER);
+    }
 
     return ctb_addr_ts;
 }
@@ -2408,9 +2447,12 @@ static int hls_decode_entry_wpp(AVCodecContext *avctxt, void *input_ctb_row, int
             return 0;
         }
 
+        stats_start(s);
         ff_hevc_cabac_init(s, ctb_addr_ts);
         hls_sao_param(s, x_ctb >> s->ps.sps->log2_ctb_size, y_ctb >> s->ps.sps->log2_ctb_size);
+        stats_lap(s, AV_CODEC_STAGE_ENTROPY);
         more_data = hls_coding_quadtree(s, x_ctb, y_ctb, s->ps.sps->log2_ctb_size, 0);
+        stats_lap(s, AV_CODEC_STAGE_RECON);
 
         if (more_data < 0) {
             s->tab_slice_address[ctb_addr_rs] = -1;
@@ -2423,7 +2465,9 @@ static int hls_decode_entry_wpp(AVCodecContext *avctxt, void *input_ctb_row, int
 
         ff_hevc_save_states(s, ctb_addr_ts);
         ff_thread_report_progress2(s->avctx, ctb_row, thread, 1);
+        stats_start(s);
         ff_hevc_hls_filters(s, x_ctb, y_ctb, ctb_size);
+        stats_lap(s, AV_CODEC_STAGE_LOOP_FILTER);
 
         if (!more_data && (x_ctb+ctb_size) < s->ps.sps->width && ctb_row != s->sh.num_entry_point_offsets) {
             avpriv_atomic_int_set(&s1->wpp_err,  1);
@@ -2432,7 +2476,9 @@ static int hls_decode_entry_wpp(AVCodecContext *avctxt, void *input_ctb_row, int
         }
 
         if ((x_ctb+ctb_size) >= s->ps.sps->width && (y_ctb+ctb_size) >= s->ps.sps->height ) {
+            stats_start(s);
             ff_hevc_hls_filter(s, x_ctb, y_ctb, ctb_size);
+            stats_lap(s, AV_CODEC_STAGE_LOOP_FILTER);
             ff_thread_report_progress2(s->avctx, ctb_row , thread, SHIFT_CTB_WPP);
             return ctb_addr_ts;
         }
@@ -2826,6 +2872,8 @@ static int decode_nal_unit(HEVCContext *s, const HEVCNAL *nal)
                 ctb_addr_ts = hls_slice_data_wpp(s, nal);
             else
                 ctb_addr_ts = hls_slice_data(s);
+            if (s->avctx->perf_stats)
+                merge_stats(s);
             if (ctb_addr_ts >= (s->ps.sps->ctb_width * s->ps.sps->ctb_height)) {
                 s->is_decoded = 1;
             }
@@ -814,6 +814,10 @@ typedef struct HEVCLocalContext {
     /* properties of the boundary of the current CTB for the purposes
      * of the deblocking filter */
     int boundary_flags;
+
+    /* AVCodecStats stage times of this local context */
+    uint64_t stage_time[AV_CODEC_STAGE_NB];
+    uint64_t stage_timer;
 } HEVCLocalContext;
 
 typedef struct HEVCContext {
@@ -30,6 +30,7 @@
 #include "libavutil/channel_layout.h"
 #include "libavutil/mathematics.h"
 #include "libavutil/pixfmt.h"
+#include "libavutil/timer.h"
 #include "avcodec.h"
 #include "config.h"
 
@@ -96,6 +97,7 @@ typedef struct FramePool {
     int width, height;
     int stride_align[AV_NUM_DATA_POINTERS];
     int linesize[4];
+    int pool_size[4];   ///< size of the buffers in each of pools
     int planes;
     int channels;
     int samples;
@@ -160,6 +162,13 @@ typedef struct AVCodecInternal {
      * hwaccel-specific private data
      */
     void *hwaccel_priv_data;
+
+    /**
+     * Performance statistics collected by this context, and the sum over
+     * all threads returned by avcodec_get_stats().
+     */
+    AVCodecStats stats;
+    AVCodecStats stats_sum;
 } AVCodecInternal;
 
 struct AVCodecDefault {
@@ -305,6 +314,30 @@ int ff_set_dimensions(AVCodecContext *s, int width, int height);
  */
 int ff_set_sar(AVCodecContext *avctx, AVRational sar);
 
+/**
+ * Read the timer used for AVCodecStats.stage_time.
+ */
+static av_always_inline uint64_t ff_stats_timer(void)
+{
+#ifdef AV_READ_TIME
+    return AV_READ_TIME();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * Add the time elapsed since *t to stage_time[stage] and restart *t,
+ * to time consecutive stages with a single timer read each.
+ */
+static av_always_inline void ff_stats_lap(uint64_t *stage_time,
+                                          enum AVCodecStage stage, uint64_t *t)
+{
+    uint64_t now = ff_stats_timer();
+    stage_time[stage] += now - *t;
+    *t = now;
+}
+
 /**
  * Add or update AV_FRAME_DATA_MATRIXENCODING side data.
  */
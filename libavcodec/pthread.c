@@ -86,3 +86,11 @@ void ff_thread_free(AVCodecContext *avctx)
     else
         ff_slice_thread_free(avctx);
 }
+
+void ff_thread_get_stats(AVCodecContext *avctx, AVCodecStats *stats)
+{
+    if (avctx->active_thread_type&FF_THREAD_FRAME)
+        ff_frame_thread_get_stats(avctx, stats);
+    else if (avctx->active_thread_type&FF_THREAD_SLICE)
+        ff_slice_thread_get_stats(avctx, stats);
+}
@@ -42,6 +42,7 @@
 #include "libavutil/mem.h"
 #include "libavutil/opt.h"
 #include "libavutil/thread.h"
+#include "libavutil/time.h"
 
 /**
  * Context used by codec threads and stored in their AVCodecInternal thread_ctx.
@@ -95,6 +96,19 @@ typedef struct PerThreadContext {
     enum AVPixelFormat result_format;            ///< get_format() result
 
     int die;                        ///< Set when the thread should exit.
+
+    /**
+     * Time spent waiting on this thread by other threads, and by this thread
+     * for new packets, for AVCodecStats. Protected by progress_mutex.
+     */
+    int64_t wait_time;
+    int64_t idle_time;
+
+    /**
+     * Stage times of avctx, copied when a frame is done so that they can be
+     * read while the thread decodes the next one. Protected by progress_mutex.
+     */
+    uint64_t stage_time[AV_CODEC_STAGE_NB];
 } PerThreadContext;
 
 /**
@@ -133,11 +147,19 @@ static attribute_align_arg void *frame_worker_thread(void *arg)
 
     pthread_mutex_lock(&p->mutex);
     while (1) {
+        int64_t idle_start = avctx->perf_stats ? av_gettime_relative() : 0;
+
             while (p->state == STATE_INPUT_READY && !p->die)
                 pthread_cond_wait(&p->input_cond, &p->mutex);
 
         if (p->die) break;
 
+        if (idle_start) {
+            pthread_mutex_lock(&p->progress_mutex);
+            p->idle_time += av_gettime_relative() - idle_start;
+            pthread_mutex_unlock(&p->progress_mutex);
+        }
+
         if (!codec->update_thread_context && THREAD_SAFE_CALLBACKS(avctx))
             ff_thread_finish_setup(avctx);
 
@@ -162,6 +184,7 @@ static attribute_align_arg void *frame_worker_thread(void *arg)
                 p->progress[i][1] = INT_MAX;
             }
 #endif
+        memcpy(p->stage_time, avctx->internal->stats.stage_time, sizeof(p->stage_time));
         p->state = STATE_INPUT_READY;
 
         pthread_cond_broadcast(&p->progress_cond);
@@ -323,9 +346,13 @@ static int submit_packet(PerThreadContext *p, AVPacket *avpkt)
     if (prev_thread) {
         int err;
         if (prev_thread->state == STATE_SETTING_UP) {
+            int64_t start = p->avctx->perf_stats ? av_gettime_relative() : 0;
+
             pthread_mutex_lock(&prev_thread->progress_mutex);
             while (prev_thread->state == STATE_SETTING_UP)
                 pthread_cond_wait(&prev_thread->progress_cond, &prev_thread->progress_mutex);
+            if (start)
+                prev_thread->wait_time += av_gettime_relative() - start;
             pthread_mutex_unlock(&prev_thread->progress_mutex);
         }
 
@@ -426,9 +453,13 @@ int ff_thread_decode_frame(AVCodecContext *avctx,
         p = &fctx->threads[finished++];
 
         if (p->state != STATE_INPUT_READY) {
+            int64_t start = avctx->perf_stats ? av_gettime_relative() : 0;
+
             pthread_mutex_lock(&p->progress_mutex);
             while (p->state != STATE_INPUT_READY)
                 pthread_cond_wait(&p->output_cond, &p->progress_mutex);
+            if (start)
+                p->wait_time += av_gettime_relative() - start;
             pthread_mutex_unlock(&p->progress_mutex);
         }
 
@@ -490,6 +521,7 @@ void ff_thread_await_progress(ThreadFrame *f, int n, int field)
 {
     PerThreadContext *p;
     volatile int *progress = f->progress ? (int*)f->progress->data : NULL;
+    int64_t start;
 
     if (!progress || progress[field] >= n) return;
 
@@ -498,9 +530,13 @@ void ff_thread_await_progress(ThreadFrame *f, int n, int field)
     if (f->owner->debug&FF_DEBUG_THREADS)
         av_log(f->owner, AV_LOG_DEBUG, "thread awaiting %d field %d from %p\n", n, field, progress);
 
+    start = f->owner->perf_stats ? av_gettime_relative() : 0;
+
     pthread_mutex_lock(&p->progress_mutex);
     while (progress[field] < n)
         pthread_cond_wait(&p->progress_cond, &p->progress_mutex);
+    if (start)
+        p->wait_time += av_gettime_relative() - start;
     pthread_mutex_unlock(&p->progress_mutex);
 }
 
@@ -601,6 +637,24 @@ void ff_frame_thread_free(AVCodecContext *avctx, int thread_count)
     avctx->codec = NULL;
 }
 
+void ff_frame_thread_get_stats(AVCodecContext *avctx, AVCodecStats *stats)
+{
+    FrameThreadContext *fctx = avctx->internal->thread_ctx;
+    int i, j;
+
+    for (i = 0; i < avctx->thread_count; i++) {
+        PerThreadContext *p = &fctx->threads[i];
+
+        pthread_mutex_lock(&p->progress_mutex);
+        for (j = 0; j < AV_CODEC_STAGE_NB; j++)
+            stats->stage_time[j] += p->stage_time[j];
+        stats->wait_time        += p->wait_time;
+        stats->idle_time        += p->idle_time;
+        stats->frames_in_flight += p->state != STATE_INPUT_READY;
+        pthread_mutex_unlock(&p->progress_mutex);
+    }
+}
+
 int ff_frame_thread_init(AVCodecContext *avctx)
 {
     int thread_count = avctx->thread_count;
@@ -27,8 +27,10 @@
 
 int ff_slice_thread_init(AVCodecContext *avctx);
 void ff_slice_thread_free(AVCodecContext *avctx);
+void ff_slice_thread_get_stats(AVCodecContext *avctx, AVCodecStats *stats);
 
 int ff_frame_thread_init(AVCodecContext *avctx);
 void ff_frame_thread_free(AVCodecContext *avctx, int thread_count);
+void ff_frame_thread_get_stats(AVCodecContext *avctx, AVCodecStats *stats);
 
 #endif // AVCODEC_PTHREAD_INTERNAL_H
@@ -34,6 +34,7 @@
 #include "libavutil/cpu.h"
 #include "libavutil/mem.h"
 #include "libavutil/thread.h"
+#include "libavutil/time.h"
 
 typedef int (action_func)(AVCodecContext *c, void *arg);
 typedef int (action_func2)(AVCodecContext *c, void *arg, int jobnr, int threadnr);
@@ -59,6 +60,14 @@ typedef struct SliceThreadContext {
     int thread_count;
     pthread_cond_t *progress_cond;
     pthread_mutex_t *progress_mutex;
+
+    /**
+     * Time spent by the workers waiting for jobs, protected by
+     * current_job_lock, and waiting for the rows of other threads,
+     * protected by the corresponding progress_mutex, for AVCodecStats.
+     */
+    int64_t idle_time;
+    int64_t *wait_time;
 } SliceThreadContext;
 
 static void* attribute_align_arg worker(void *v)
@@ -78,8 +87,15 @@ static void* attribute_align_arg worker(void *v)
             if (c->current_job == thread_count + c->job_count)
                 pthread_cond_signal(&c->last_job_cond);
 
-            while (last_execute == c->current_execute && !c->done)
-                pthread_cond_wait(&c->current_job_cond, &c->current_job_lock);
+            if (avctx->perf_stats) {
+                int64_t start = av_gettime_relative();
+                while (last_execute == c->current_execute && !c->done)
+                    pthread_cond_wait(&c->current_job_cond, &c->current_job_lock);
+                c->idle_time += av_gettime_relative() - start;
+            } else {
+                while (last_execute == c->current_execute && !c->done)
+                    pthread_cond_wait(&c->current_job_cond, &c->current_job_lock);
+            }
             last_execute = c->current_execute;
             our_job = self_id;
 
@@ -127,6 +143,7 @@ void ff_slice_thread_free(AVCodecContext *avctx)
     av_freep(&c->entries);
     av_freep(&c->progress_mutex);
     av_freep(&c->progress_cond);
+    av_freep(&c->wait_time);
 
     av_freep(&c->workers);
     av_freep(&avctx->internal->thread_ctx);
@@ -243,6 +260,24 @@ int ff_slice_thread_init(AVCodecContext *avctx)
     return 0;
 }
 
+void ff_slice_thread_get_stats(AVCodecContext *avctx, AVCodecStats *stats)
+{
+    SliceThreadContext *c = avctx->internal->thread_ctx;
+    int i;
+
+    pthread_mutex_lock(&c->current_job_lock);
+    stats->idle_time += c->idle_time;
+    pthread_mutex_unlock(&c->current_job_lock);
+
+    if (!c->entries)
+        return;
+    for (i = 0; i < c->thread_count; i++) {
+        pthread_mutex_lock(&c->progress_mutex[i]);
+        stats->wait_time += c->wait_time[i];
+        pthread_mutex_unlock(&c->progress_mutex[i]);
+    }
+}
+
 void ff_thread_report_progress2(AVCodecContext *avctx, int field, int thread, int n)
 {
     SliceThreadContext *p = avctx->internal->thread_ctx;
@@ -258,15 +293,20 @@ void ff_thread_await_progress2(AVCodecContext *avctx, int field, int thread, int
 {
     SliceThreadContext *p  = avctx->internal->thread_ctx;
     int *entries      = p->entries;
+    int64_t start;
 
     if (!entries || !field) return;
 
     thread = thread ? thread - 1 : p->thread_count - 1;
 
+    start = avctx->perf_stats ? av_gettime_relative() : 0;
+
     pthread_mutex_lock(&p->progress_mutex[thread]);
     while ((entries[field - 1] - entries[field]) < shift){
         pthread_cond_wait(&p->progress_cond[thread], &p->progress_mutex[thread]);
     }
+    if (start)
+        p->wait_time[thread] += av_gettime_relative() - start;
     pthread_mutex_unlock(&p->progress_mutex[thread]);
 }
 
@@ -288,12 +328,14 @@ int ff_alloc_entries(AVCodecContext *avctx, int count)
         if (!p->progress_mutex) {
             p->progress_mutex = av_malloc_array(p->thread_count, sizeof(pthread_mutex_t));
             p->progress_cond  = av_malloc_array(p->thread_count, sizeof(pthread_cond_t));
+            p->wait_time      = av_mallocz_array(p->thread_count, sizeof(*p->wait_time));
         }
 
-        if (!p->entries || !p->progress_mutex || !p->progress_cond) {
+        if (!p->entries || !p->progress_mutex || !p->progress_cond || !p->wait_time) {
             av_freep(&p->entries);
             av_freep(&p->progress_mutex);
             av_freep(&p->progress_cond);
+            av_freep(&p->wait_time);
             return AVERROR(ENOMEM);
         }
         p->entries_count  = count;
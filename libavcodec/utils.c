@@ -503,6 +503,15 @@ int avcodec_fill_audio_frame(AVFrame *frame, int nb_channels,
     return ret;
 }
 
+/* Whether the buffers of pool i can be kept for a new buffer size. Pools of
+ * larger buffers are reused unless more than half of each buffer would be
+ * wasted, to avoid reallocating everything on every size change. */
+static int frame_pool_fits(FramePool *pool, int i, int size)
+{
+    return pool->pools[i] && size <= pool->pool_size[i] &&
+           size > pool->pool_size[i] / 2;
+}
+
 static int update_frame_pool(AVCodecContext *avctx, AVFrame *frame)
 {
     FramePool *pool = avctx->internal->pool;
@@ -547,10 +556,16 @@ static int update_frame_pool(AVCodecContext *avctx, AVFrame *frame)
         size[i] = tmpsize - (data[i] - data[0]);
 
         for (i = 0; i < 4; i++) {
-            av_buffer_pool_uninit(&pool->pools[i]);
+            int pool_size = size[i] + 16 + STRIDE_ALIGN - 1;
+
             pool->linesize[i] = linesize[i];
+            if (size[i] && frame_pool_fits(pool, i, pool_size))
+                continue;
+
+            av_buffer_pool_uninit(&pool->pools[i]);
+            pool->pool_size[i] = 0;
             if (size[i]) {
-                pool->pools[i] = av_buffer_pool_init(size[i] + 16 + STRIDE_ALIGN - 1,
+                pool->pools[i] = av_buffer_pool_init(pool_size,
                                                      CONFIG_MEMORY_POISONING ?
                                                         NULL :
                                                         av_buffer_allocz);
@@ -558,6 +573,7 @@ static int update_frame_pool(AVCodecContext *avctx, AVFrame *frame)
                     ret = AVERROR(ENOMEM);
                     goto fail;
                 }
+                pool->pool_size[i] = pool_size;
             }
         }
         pool->format = frame->format;
@@ -575,16 +591,20 @@ static int update_frame_pool(AVCodecContext *avctx, AVFrame *frame)
             pool->channels == ch && frame->nb_samples == pool->samples)
             return 0;
 
-        av_buffer_pool_uninit(&pool->pools[0]);
         ret = av_samples_get_buffer_size(&pool->linesize[0], ch,
                                          frame->nb_samples, frame->format, 0);
         if (ret < 0)
             goto fail;
 
-        pool->pools[0] = av_buffer_pool_init(pool->linesize[0], NULL);
-        if (!pool->pools[0]) {
-            ret = AVERROR(ENOMEM);
-            goto fail;
+        if (!frame_pool_fits(pool, 0, pool->linesize[0])) {
+            av_buffer_pool_uninit(&pool->pools[0]);
+            pool->pool_size[0] = 0;
+            pool->pools[0] = av_buffer_pool_init(pool->linesize[0], NULL);
+            if (!pool->pools[0]) {
+                ret = AVERROR(ENOMEM);
+                goto fail;
+            }
+            pool->pool_size[0] = pool->linesize[0];
         }
 
         pool->format     = frame->format;
@@ -597,8 +617,10 @@ static int update_frame_pool(AVCodecContext *avctx, AVFrame *frame)
     }
     return 0;
 fail:
-    for (i = 0; i < 4; i++)
+    for (i = 0; i < 4; i++) {
         av_buffer_pool_uninit(&pool->pools[i]);
+        pool->pool_size[i] = 0;
+    }
     pool->format = -1;
     pool->planes = pool->channels = pool->samples = 0;
     pool->width  = pool->height = 0;
@@ -2655,6 +2677,21 @@ void avsubtitle_free(AVSubtitle *sub)
     memset(sub, 0, sizeof(AVSubtitle));
 }
 
+const AVCodecStats *avcodec_get_stats(AVCodecContext *avctx)
+{
+    AVCodecStats *stats;
+
+    if (!avctx->perf_stats || !avcodec_is_open(avctx))
+        return NULL;
+
+    stats  = &avctx->internal->stats_sum;
+    *stats = avctx->internal->stats;
+    if (HAVE_THREADS && avctx->active_thread_type && avctx->internal->thread_ctx)
+        ff_thread_get_stats(avctx, stats);
+
+    return stats;
+}
+
 av_cold int avcodec_close(AVCodecContext *avctx)
 {
     int i;
@@ -162,6 +162,9 @@ typedef struct VP9Context {
     DECLARE_ALIGNED(32, uint8_t, tmp_uv)[2][64 * 64 * 2];
     uint16_t mvscale[3][2];
     uint8_t mvstep[3][2];
+
+    // performance statistics
+    uint64_t stage_timer;
 } VP9Context;
 
 static const uint8_t bwh_tab[2][N_BS_SIZES][2] = {
@@ -1421,6 +1424,22 @@ static av_always_inline void setctx_2d(uint8_t *ptr, int w, int h,
     }
 }
 
+static av_always_inline void stats_start(AVCodecContext *ctx)
+{
+    VP9Context *s = ctx->priv_data;
+
+    if (ctx->perf_stats)
+        s->stage_timer = ff_stats_timer();
+}
+
+static av_always_inline void stats_lap(AVCodecContext *ctx, enum AVCodecStage stage)
+{
+    VP9Context *s = ctx->priv_data;
+
+    if (ctx->perf_stats)
+        ff_stats_lap(ctx->internal->stats.stage_time, stage, &s->stage_timer);
+}
+
 static void decode_mode(AVCodecContext *ctx)
 {
     static const uint8_t left_ctx[N_BS_SIZES] = {
@@ -3201,6 +3220,7 @@ static void decode_b(AVCodecContext *ctx, int row, int col,
     s->min_mv.y = -(128 + row * 64);
     s->max_mv.x = 128 + (s->cols - col - w4) * 64;
     s->max_mv.y = 128 + (s->rows - row - h4) * 64;
+    stats_start(ctx);
     if (s->pass < 2) {
         b->bs = bs;
         b->bl = bl;
@@ -3259,6 +3279,8 @@ static void decode_b(AVCodecContext *ctx, int row, int col,
             }
         }
 
+        stats_lap(ctx, AV_CODEC_STAGE_ENTROPY);
+
         if (s->pass == 1) {
             s->b++;
             s->block += w4 * h4 * 64 * bytesperpixel;
@@ -3308,6 +3330,7 @@ static void decode_b(AVCodecContext *ctx, int row, int col,
             inter_recon_8bpp(ctx);
         }
     }
+    stats_lap(ctx, AV_CODEC_STAGE_RECON);
     if (emu[0]) {
         int w = FFMIN(s->cols - col, w4) * 8, h = FFMIN(s->rows - row, h4) * 8, n, o = 0;
 
@@ -4204,6 +4227,7 @@ static int vp9_decode_frame(AVCodecContext *ctx, void *frame,
 
                 // loopfilter one row
                 if (s->s.h.filter.level) {
+                    stats_start(ctx);
                     yoff2 = yoff;
                     uvoff2 = uvoff;
                     lflvl_ptr = s->lflvl;
@@ -4212,6 +4236,7 @@ static int vp9_decode_frame(AVCodecContext *ctx, void *frame,
                          uvoff2 += 64 * bytesperpixel >> s->ss_h, lflvl_ptr++) {
                         loopfilter_sb(ctx, lflvl_ptr, row, col, yoff2, uvoff2);
                     }
+                    stats_lap(ctx, AV_CODEC_STAGE_LOOP_FILTER);
                 }
 
                 // FIXME maybe we can make this more finegrained by running the
@@ -25,6 +25,7 @@
 #include "libavutil/opt.h"
 #include "libavutil/parseutils.h"
 #include "avfilter.h"
+#include "biquaddsp.h"
 #include "internal.h"
 #include "audio.h"
 
@@ -40,9 +41,6 @@ enum FilterType {
 typedef struct FoSection {
     double a0, a1, a2, a3, a4;
     double b0, b1, b2, b3, b4;
-
-    double num[4];
-    double denum[4];
 } FoSection;
 
 typedef struct EqualizatorFilter {
@@ -55,6 +53,7 @@ typedef struct EqualizatorFilter {
     double width;
 
     FoSection section[2];
+    int cascade_pos;        ///< index of the first section in the cascade of the channel
 } EqualizatorFilter;
 
 typedef struct AudioNEqualizerContext {
@@ -70,6 +69,13 @@ typedef struct AudioNEqualizerContext {
     int nb_allocated;
     EqualizatorFilter *filters;
     AVFrame *video;
+
+    BiquadDSPContext dsp;
+    int nb_groups;          ///< groups of BIQUAD_LANES_DBL channels filtered together
+    int *group_offset;      ///< first section of each group, nb_groups + 1 entries
+    double *coeffs;         ///< coefficients of the cascades, see BiquadDSPContext
+    double *state;          ///< history of the cascades
+    double *block;          ///< interleaved samples of the group being filtered
 } AudioNEqualizerContext;
 
 #define OFFSET(x) offsetof(AudioNEqualizerContext, x)
@@ -213,6 +219,8 @@ static av_cold int init(AVFilterContext *ctx)
     if (s->draw_curves)
         ff_insert_outpad(ctx, 1, &vpad);
 
+    ff_biquaddsp_init(&s->dsp);
+
     return 0;
 }
 
@@ -266,6 +274,10 @@ static av_cold void uninit(AVFilterContext *ctx)
     av_freep(&s->filters);
     s->nb_filters = 0;
     s->nb_allocated = 0;
+    av_freep(&s->group_offset);
+    av_freep(&s->coeffs);
+    av_freep(&s->state);
+    av_freep(&s->block);
 }
 
 static void butterworth_fo_section(FoSection *S, double beta,
@@ -571,6 +583,93 @@ static int add_filter(AudioNEqualizerContext *s, AVFilterLink *inlink)
     return 0;
 }
 
+static void set_filter_coeffs(AudioNEqualizerContext *s, EqualizatorFilter *f)
+{
+    const int lanes = BIQUAD_LANES_DBL;
+    const int group = f->channel / lanes;
+    double *c = s->coeffs + (s->group_offset[group] + f->cascade_pos) * 9 * lanes +
+                f->channel % lanes;
+    int i;
+
+    for (i = 0; i < FILTER_ORDER / 2; i++, c += 9 * lanes) {
+        FoSection *S = &f->section[i];
+
+        if (f->gain == 0.) {
+            c[0 * lanes] = 1;
+            c[1 * lanes] = c[2 * lanes] = c[3 * lanes] = c[4 * lanes] = 0;
+            c[5 * lanes] = c[6 * lanes] = c[7 * lanes] = c[8 * lanes] = 0;
+            continue;
+        }
+        c[0 * lanes] = S->b0;
+        c[1 * lanes] = S->b1;
+        c[2 * lanes] = S->a1;
+        c[3 * lanes] = S->b2;
+        c[4 * lanes] = S->a2;
+        c[5 * lanes] = S->b3;
+        c[6 * lanes] = S->a3;
+        c[7 * lanes] = S->b4;
+        c[8 * lanes] = S->a4;
+    }
+}
+
+/* The filters of each channel are chained into a cascade of sections,
+ * the channels being processed by groups, one per lane. Channels with
+ * fewer filters than others in their group, and disabled filters, are
+ * padded with pass-through sections. */
+static int init_cascades(AudioNEqualizerContext *s, int channels)
+{
+    const int lanes = BIQUAD_LANES_DBL;
+    int *nb_filters;
+    int ch, g, i, l, nb_sections;
+
+    av_freep(&s->group_offset);
+    av_freep(&s->coeffs);
+    av_freep(&s->state);
+    av_freep(&s->block);
+
+    nb_filters = av_calloc(channels, sizeof(*nb_filters));
+    if (!nb_filters)
+        return AVERROR(ENOMEM);
+    for (i = 0; i < s->nb_filters; i++) {
+        EqualizatorFilter *f = &s->filters[i];
+
+        if (f->ignore)
+            continue;
+        f->cascade_pos = nb_filters[f->channel]++ * FILTER_ORDER / 2;
+    }
+
+    s->nb_groups = (channels + lanes - 1) / lanes;
+    s->group_offset = av_calloc(s->nb_groups + 1, sizeof(*s->group_offset));
+    if (!s->group_offset) {
+        av_free(nb_filters);
+        return AVERROR(ENOMEM);
+    }
+    for (g = 0; g < s->nb_groups; g++) {
+        int max_filters = 0;
+
+        for (ch = g * lanes; ch < FFMIN(channels, (g + 1) * lanes); ch++)
+            max_filters = FFMAX(max_filters, nb_filters[ch]);
+        s->group_offset[g + 1] = s->group_offset[g] + max_filters * FILTER_ORDER / 2;
+    }
+    av_free(nb_filters);
+
+    nb_sections = s->group_offset[s->nb_groups];
+    s->coeffs = av_mallocz_array(nb_sections * 9 * lanes, sizeof(*s->coeffs));
+    s->state  = av_mallocz_array(nb_sections * 8 * lanes, sizeof(*s->state));
+    s->block  = av_mallocz_array(BIQUAD_BLOCK_SIZE * lanes, sizeof(*s->block));
+    if (!s->coeffs || !s->state || !s->block)
+        return AVERROR(ENOMEM);
+
+    for (i = 0; i < nb_sections; i++)
+        for (l = 0; l < lanes; l++)
+            s->coeffs[i * 9 * lanes + l] = 1;
+    for (i = 0; i < s->nb_filters; i++)
+        if (!s->filters[i].ignore)
+            set_filter_coeffs(s, &s->filters[i]);
+
+    return 0;
+}
+
 static int config_input(AVFilterLink *inlink)
 {
     AVFilterContext *ctx = inlink->dst;
@@ -626,7 +725,10 @@ static int config_input(AVFilterLink *inlink)
 
     av_free(args);
 
-    return ret;
+    if (ret < 0)
+        return ret;
+
+    return init_cascades(s, inlink->channels);
 }
 
 static int process_command(AVFilterContext *ctx, const char *cmd, const char *args,
@@ -653,6 +755,8 @@ static int process_command(AVFilterContext *ctx, const char *cmd, const char *ar
         s->filters[filter].width = width;
         s->filters[filter].gain  = gain;
         equalizer(&s->filters[filter], inlink->sample_rate);
+        if (!s->filters[filter].ignore)
+            set_filter_coeffs(s, &s->filters[filter]);
         if (s->draw_curves)
             draw_curves(ctx, inlink, s->video);
 
@@ -662,62 +766,49 @@ static int process_command(AVFilterContext *ctx, const char *cmd, const char *ar
     return ret;
 }
 
-static inline double section_process(FoSection *S, double in)
-{
-    double out;
-
-    out = S->b0 * in;
-    out+= S->b1 * S->num[0] - S->denum[0] * S->a1;
-    out+= S->b2 * S->num[1] - S->denum[1] * S->a2;
-    out+= S->b3 * S->num[2] - S->denum[2] * S->a3;
-    out+= S->b4 * S->num[3] - S->denum[3] * S->a4;
-
-    S->num[3] = S->num[2];
-    S->num[2] = S->num[1];
-    S->num[1] = S->num[0];
-    S->num[0] = in;
-
-    S->denum[3] = S->denum[2];
-    S->denum[2] = S->denum[1];
-    S->denum[1] = S->denum[0];
-    S->denum[0] = out;
-
-    return out;
-}
-
-static double process_sample(FoSection *s1, double in)
-{
-    double p0 = in, p1;
-    int i;
-
-    for (i = 0; i < FILTER_ORDER / 2; i++) {
-        p1 = section_process(&s1[i], p0);
-        p0 = p1;
-    }
-
-    return p1;
-}
-
 static int filter_frame(AVFilterLink *inlink, AVFrame *buf)
 {
     AVFilterContext *ctx = inlink->dst;
     AudioNEqualizerContext *s = ctx->priv;
     AVFilterLink *outlink = ctx->outputs[0];
-    double *bptr;
-    int i, n;
+    const int lanes = BIQUAD_LANES_DBL;
+    const int channels = inlink->channels;
+    int g, c, i, n, len;
+
+    for (g = 0; g < s->nb_groups; g++) {
+        const int nb_sections = s->group_offset[g + 1] - s->group_offset[g];
+        const int nb_lanes = FFMIN(lanes, channels - g * lanes);
+        const double *coeffs = s->coeffs + s->group_offset[g] * 9 * lanes;
+        double *state = s->state + s->group_offset[g] * 8 * lanes;
+        double *block = s->block;
+
+        if (!nb_sections)
+            continue;
 
-    for (i = 0; i < s->nb_filters; i++) {
-        EqualizatorFilter *f = &s->filters[i];
+        for (n = 0; n < buf->nb_samples; n += len) {
+            len = FFMIN(BIQUAD_BLOCK_SIZE, buf->nb_samples - n);
 
-        if (f->gain == 0. || f->ignore)
-            continue;
+            for (c = 0; c < lanes; c++) {
+                const double *src;
 
-        bptr = (double *)buf->extended_data[f->channel];
-        for (n = 0; n < buf->nb_samples; n++) {
-            double sample = bptr[n];
+                if (c >= nb_lanes) {
+                    for (i = 0; i < len; i++)
+                        block[i * lanes + c] = 0;
+                    continue;
+                }
+                src = (const double *)buf->extended_data[g * lanes + c] + n;
+                for (i = 0; i < len; i++)
+                    block[i * lanes + c] = src[i];
+            }
 
-            sample  = process_sample(f->section, sample);
-            bptr[n] = sample;
+            s->dsp.fourth_order_dbl(block, state, coeffs, nb_sections, len);
+
+            for (c = 0; c < nb_lanes; c++) {
+                double *dst = (double *)buf->extended_data[g * lanes + c] + n;
+
+                for (i = 0; i < len; i++)
+                    dst[i] = block[i * lanes + c];
+            }
         }
     }
 
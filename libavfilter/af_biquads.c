@@ -63,9 +63,12 @@
  */
 
 #include "libavutil/avassert.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
 #include "libavutil/opt.h"
 #include "audio.h"
 #include "avfilter.h"
+#include "biquaddsp.h"
 #include "internal.h"
 
 enum FilterType {
@@ -89,10 +92,10 @@ enum WidthType {
     SLOPE,
 };
 
-typedef struct ChanCache {
-    double i1, i2;
-    double o1, o2;
-} ChanCache;
+enum PrecisionType {
+    PRECISION_F64,
+    PRECISION_F32,
+};
 
 typedef struct BiquadsContext {
     const AVClass *class;
@@ -101,6 +104,7 @@ typedef struct BiquadsContext {
     int width_type;
     int poles;
     int csg;
+    int precision;
 
     double gain;
     double frequency;
@@ -109,12 +113,15 @@ typedef struct BiquadsContext {
     double a0, a1, a2;
     double b0, b1, b2;
 
-    ChanCache *cache;
+    BiquadDSPContext dsp;
+    DECLARE_ALIGNED(32, float,  coeffs_flt)[5 * BIQUAD_LANES_FLT];
+    DECLARE_ALIGNED(32, double, coeffs_dbl)[5 * BIQUAD_LANES_DBL];
+    void *state;        ///< filter history, see BiquadDSPContext
+    void *block;        ///< interleaved samples of the channels being filtered
     int clippings;
 
-    void (*filter)(struct BiquadsContext *s, const void *ibuf, void *obuf, int len,
-                   double *i1, double *i2, double *o1, double *o2,
-                   double b0, double b1, double b2, double a1, double a2);
+    void (*filter)(struct BiquadsContext *s, AVFrame *in, AVFrame *out,
+                   int nb_channels, int nb_samples);
 } BiquadsContext;
 
 static av_cold int init(AVFilterContext *ctx)
@@ -129,6 +136,8 @@ static av_cold int init(AVFilterContext *ctx)
         }
     }
 
+    ff_biquaddsp_init(&s->dsp);
+
     return 0;
 }
 
@@ -165,75 +174,67 @@ static int query_formats(AVFilterContext *ctx)
     return ff_set_common_samplerates(ctx, formats);
 }
 
-#define BIQUAD_FILTER(name, type, min, max, need_clipping)                    \
-static void biquad_## name (BiquadsContext *s,                                \
-                            const void *input, void *output, int len,         \
-                            double *in1, double *in2,                         \
-                            double *out1, double *out2,                       \
-                            double b0, double b1, double b2,                  \
-                            double a1, double a2)                             \
+/* The channels are filtered by groups of lanes, the samples of each group
+ * being interleaved into blocks for the DSP function. */
+#define BIQUAD_FILTER(name, type, ftype, fn, lanes, min, max, need_clipping)  \
+static void biquad_## name (BiquadsContext *s, AVFrame *in, AVFrame *out,     \
+                            int nb_channels, int nb_samples)                  \
 {                                                                             \
-    const type *ibuf = input;                                                 \
-    type *obuf = output;                                                      \
-    double i1 = *in1;                                                         \
-    double i2 = *in2;                                                         \
-    double o1 = *out1;                                                        \
-    double o2 = *out2;                                                        \
-    int i;                                                                    \
-    a1 = -a1;                                                                 \
-    a2 = -a2;                                                                 \
+    ftype *block = s->block;                                                  \
+    ftype *state = s->state;                                                  \
+    int ch, c, i, n, len;                                                     \
                                                                               \
-    for (i = 0; i+1 < len; i++) {                                             \
-        o2 = i2 * b2 + i1 * b1 + ibuf[i] * b0 + o2 * a2 + o1 * a1;            \
-        i2 = ibuf[i];                                                         \
-        if (need_clipping && o2 < min) {                                      \
-            s->clippings++;                                                   \
-            obuf[i] = min;                                                    \
-        } else if (need_clipping && o2 > max) {                               \
-            s->clippings++;                                                   \
-            obuf[i] = max;                                                    \
-        } else {                                                              \
-            obuf[i] = o2;                                                     \
-        }                                                                     \
-        i++;                                                                  \
-        o1 = i1 * b2 + i2 * b1 + ibuf[i] * b0 + o1 * a2 + o2 * a1;            \
-        i1 = ibuf[i];                                                         \
-        if (need_clipping && o1 < min) {                                      \
-            s->clippings++;                                                   \
-            obuf[i] = min;                                                    \
-        } else if (need_clipping && o1 > max) {                               \
-            s->clippings++;                                                   \
-            obuf[i] = max;                                                    \
-        } else {                                                              \
-            obuf[i] = o1;                                                     \
-        }                                                                     \
-    }                                                                         \
-    if (i < len) {                                                            \
-        double o0 = ibuf[i] * b0 + i1 * b1 + i2 * b2 + o1 * a1 + o2 * a2;     \
-        i2 = i1;                                                              \
-        i1 = ibuf[i];                                                         \
-        o2 = o1;                                                              \
-        o1 = o0;                                                              \
-        if (need_clipping && o0 < min) {                                      \
-            s->clippings++;                                                   \
-            obuf[i] = min;                                                    \
-        } else if (need_clipping && o0 > max) {                               \
-            s->clippings++;                                                   \
-            obuf[i] = max;                                                    \
-        } else {                                                              \
-            obuf[i] = o0;                                                     \
+    for (ch = 0; ch < nb_channels; ch += lanes) {                             \
+        const int nb_lanes = FFMIN(lanes, nb_channels - ch);                  \
+                                                                              \
+        for (n = 0; n < nb_samples; n += len) {                               \
+            len = FFMIN(BIQUAD_BLOCK_SIZE, nb_samples - n);                   \
+                                                                              \
+            for (c = 0; c < lanes; c++) {                                     \
+                const type *ibuf;                                             \
+                                                                              \
+                if (c >= nb_lanes) {                                          \
+                    for (i = 0; i < len; i++)                                 \
+                        block[i * lanes + c] = 0;                             \
+                    continue;                                                 \
+                }                                                             \
+                ibuf = (const type *)in->extended_data[ch + c] + n;           \
+                for (i = 0; i < len; i++)                                     \
+                    block[i * lanes + c] = ibuf[i];                           \
+            }                                                                 \
+                                                                              \
+            s->dsp.biquad_## fn(block, state, s->coeffs_## fn, 1, len);       \
+                                                                              \
+            for (c = 0; c < nb_lanes; c++) {                                  \
+                type *obuf = (type *)out->extended_data[ch + c] + n;          \
+                                                                              \
+                for (i = 0; i < len; i++) {                                   \
+                    const double o = block[i * lanes + c];                    \
+                                                                              \
+                    if (need_clipping && o < min) {                           \
+                        s->clippings++;                                       \
+                        obuf[i] = min;                                        \
+                    } else if (need_clipping && o > max) {                    \
+                        s->clippings++;                                       \
+                        obuf[i] = max;                                        \
+                    } else {                                                  \
+                        obuf[i] = o;                                          \
+                    }                                                         \
+                }                                                             \
+            }                                                                 \
         }                                                                     \
+        state += 4 * lanes;                                                   \
     }                                                                         \
-    *in1  = i1;                                                               \
-    *in2  = i2;                                                               \
-    *out1 = o1;                                                               \
-    *out2 = o2;                                                               \
 }
 
-BIQUAD_FILTER(s16, int16_t, INT16_MIN, INT16_MAX, 1)
-BIQUAD_FILTER(s32, int32_t, INT32_MIN, INT32_MAX, 1)
-BIQUAD_FILTER(flt, float,   -1., 1., 0)
-BIQUAD_FILTER(dbl, double,  -1., 1., 0)
+BIQUAD_FILTER(s16_dbl, int16_t, double, dbl, BIQUAD_LANES_DBL, INT16_MIN, INT16_MAX, 1)
+BIQUAD_FILTER(s32_dbl, int32_t, double, dbl, BIQUAD_LANES_DBL, INT32_MIN, INT32_MAX, 1)
+BIQUAD_FILTER(flt_dbl, float,   double, dbl, BIQUAD_LANES_DBL, -1., 1., 0)
+BIQUAD_FILTER(dbl_dbl, double,  double, dbl, BIQUAD_LANES_DBL, -1., 1., 0)
+BIQUAD_FILTER(s16_flt, int16_t, float,  flt, BIQUAD_LANES_FLT, INT16_MIN, INT16_MAX, 1)
+BIQUAD_FILTER(s32_flt, int32_t, float,  flt, BIQUAD_LANES_FLT, INT32_MIN, INT32_MAX, 1)
+BIQUAD_FILTER(flt_flt, float,   float,  flt, BIQUAD_LANES_FLT, -1., 1., 0)
+BIQUAD_FILTER(dbl_flt, double,  float,  flt, BIQUAD_LANES_FLT, -1., 1., 0)
 
 static int config_output(AVFilterLink *outlink)
 {
@@ -243,6 +244,7 @@ static int config_output(AVFilterLink *outlink)
     double A = exp(s->gain / 40 * log(10.));
     double w0 = 2 * M_PI * s->frequency / inlink->sample_rate;
     double alpha;
+    int i, lanes, size;
 
     if (w0 > M_PI) {
         av_log(ctx, AV_LOG_ERROR,
@@ -375,16 +377,48 @@ static int config_output(AVFilterLink *outlink)
     s->b1 /= s->a0;
     s->b2 /= s->a0;
 
-    s->cache = av_realloc_f(s->cache, sizeof(ChanCache), inlink->channels);
-    if (!s->cache)
+    for (i = 0; i < BIQUAD_LANES_FLT; i++) {
+        s->coeffs_flt[0 * BIQUAD_LANES_FLT + i] =  s->b0;
+        s->coeffs_flt[1 * BIQUAD_LANES_FLT + i] =  s->b1;
+        s->coeffs_flt[2 * BIQUAD_LANES_FLT + i] =  s->b2;
+        s->coeffs_flt[3 * BIQUAD_LANES_FLT + i] = -s->a1;
+        s->coeffs_flt[4 * BIQUAD_LANES_FLT + i] = -s->a2;
+    }
+    for (i = 0; i < BIQUAD_LANES_DBL; i++) {
+        s->coeffs_dbl[0 * BIQUAD_LANES_DBL + i] =  s->b0;
+        s->coeffs_dbl[1 * BIQUAD_LANES_DBL + i] =  s->b1;
+        s->coeffs_dbl[2 * BIQUAD_LANES_DBL + i] =  s->b2;
+        s->coeffs_dbl[3 * BIQUAD_LANES_DBL + i] = -s->a1;
+        s->coeffs_dbl[4 * BIQUAD_LANES_DBL + i] = -s->a2;
+    }
+
+    if (s->precision == PRECISION_F32) {
+        lanes = BIQUAD_LANES_FLT;
+        size  = sizeof(float);
+    } else {
+        lanes = BIQUAD_LANES_DBL;
+        size  = sizeof(double);
+    }
+    av_freep(&s->state);
+    av_freep(&s->block);
+    s->state = av_mallocz_array(FFALIGN(inlink->channels, lanes), 4 * size);
+    s->block = av_mallocz_array(BIQUAD_BLOCK_SIZE * lanes, size);
+    if (!s->state || !s->block)
         return AVERROR(ENOMEM);
-    memset(s->cache, 0, sizeof(ChanCache) * inlink->channels);
 
     switch (inlink->format) {
-    case AV_SAMPLE_FMT_S16P: s->filter = biquad_s16; break;
-    case AV_SAMPLE_FMT_S32P: s->filter = biquad_s32; break;
-    case AV_SAMPLE_FMT_FLTP: s->filter = biquad_flt; break;
-    case AV_SAMPLE_FMT_DBLP: s->filter = biquad_dbl; break;
+    case AV_SAMPLE_FMT_S16P:
+        s->filter = s->precision == PRECISION_F32 ? biquad_s16_flt : biquad_s16_dbl;
+        break;
+    case AV_SAMPLE_FMT_S32P:
+        s->filter = s->precision == PRECISION_F32 ? biquad_s32_flt : biquad_s32_dbl;
+        break;
+    case AV_SAMPLE_FMT_FLTP:
+        s->filter = s->precision == PRECISION_F32 ? biquad_flt_flt : biquad_flt_dbl;
+        break;
+    case AV_SAMPLE_FMT_DBLP:
+        s->filter = s->precision == PRECISION_F32 ? biquad_dbl_flt : biquad_dbl_dbl;
+        break;
     default: av_assert0(0);
     }
 
@@ -398,7 +432,6 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *buf)
     AVFilterLink *outlink = ctx->outputs[0];
     AVFrame *out_buf;
     int nb_samples = buf->nb_samples;
-    int ch;
 
     if (av_frame_is_writable(buf)) {
         out_buf = buf;
@@ -411,12 +444,7 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *buf)
         av_frame_copy_props(out_buf, buf);
     }
 
-    for (ch = 0; ch < av_frame_get_channels(buf); ch++)
-        s->filter(s, buf->extended_data[ch],
-                  out_buf->extended_data[ch], nb_samples,
-                  &s->cache[ch].i1, &s->cache[ch].i2,
-                  &s->cache[ch].o1, &s->cache[ch].o2,
-                  s->b0, s->b1, s->b2, s->a1, s->a2);
+    s->filter(s, buf, out_buf, av_frame_get_channels(buf), nb_samples);
 
     if (s->clippings > 0)
         av_log(ctx, AV_LOG_WARNING, "clipping %d times. Please reduce gain.\n", s->clippings);
@@ -431,7 +459,8 @@ static av_cold void uninit(AVFilterContext *ctx)
 {
     BiquadsContext *s = ctx->priv;
 
-    av_freep(&s->cache);
+    av_freep(&s->state);
+    av_freep(&s->block);
 }
 
 static const AVFilterPad inputs[] = {
@@ -455,6 +484,11 @@ static const AVFilterPad outputs[] = {
 #define OFFSET(x) offsetof(BiquadsContext, x)
 #define FLAGS AV_OPT_FLAG_AUDIO_PARAM|AV_OPT_FLAG_FILTERING_PARAM
 
+#define PRECISION_OPTIONS \
+    {"precision", "set filtering precision", OFFSET(precision), AV_OPT_TYPE_INT, {.i64=PRECISION_F64}, PRECISION_F64, PRECISION_F32, FLAGS, "precision"}, \
+    {"f64", "double-precision floating-point", 0, AV_OPT_TYPE_CONST, {.i64=PRECISION_F64}, 0, 0, FLAGS, "precision"}, \
+    {"f32", "single-precision floating-point", 0, AV_OPT_TYPE_CONST, {.i64=PRECISION_F32}, 0, 0, FLAGS, "precision"},
+
 #define DEFINE_BIQUAD_FILTER(name_, description_)                       \
 AVFILTER_DEFINE_CLASS(name_);                                           \
 static av_cold int name_##_init(AVFilterContext *ctx) \
@@ -490,6 +524,7 @@ static const AVOption equalizer_options[] = {
     {"w",     "set band-width", OFFSET(width), AV_OPT_TYPE_DOUBLE, {.dbl=1}, 0, 999, FLAGS},
     {"gain", "set gain", OFFSET(gain), AV_OPT_TYPE_DOUBLE, {.dbl=0}, -900, 900, FLAGS},
     {"g",    "set gain", OFFSET(gain), AV_OPT_TYPE_DOUBLE, {.dbl=0}, -900, 900, FLAGS},
+    PRECISION_OPTIONS
     {NULL}
 };
 
@@ -508,6 +543,7 @@ static const AVOption bass_options[] = {
     {"w",     "set shelf transition steep", OFFSET(width), AV_OPT_TYPE_DOUBLE, {.dbl=0.5}, 0, 99999, FLAGS},
     {"gain", "set gain", OFFSET(gain), AV_OPT_TYPE_DOUBLE, {.dbl=0}, -900, 900, FLAGS},
     {"g",    "set gain", OFFSET(gain), AV_OPT_TYPE_DOUBLE, {.dbl=0}, -900, 900, FLAGS},
+    PRECISION_OPTIONS
     {NULL}
 };
 
@@ -526,6 +562,7 @@ static const AVOption treble_options[] = {
     {"w",     "set shelf transition steep", OFFSET(width), AV_OPT_TYPE_DOUBLE, {.dbl=0.5}, 0, 99999, FLAGS},
     {"gain", "set gain", OFFSET(gain), AV_OPT_TYPE_DOUBLE, {.dbl=0}, -900, 900, FLAGS},
     {"g",    "set gain", OFFSET(gain), AV_OPT_TYPE_DOUBLE, {.dbl=0}, -900, 900, FLAGS},
+    PRECISION_OPTIONS
     {NULL}
 };
 
@@ -543,6 +580,7 @@ static const AVOption bandpass_options[] = {
     {"width", "set band-width", OFFSET(width), AV_OPT_TYPE_DOUBLE, {.dbl=0.5}, 0, 999, FLAGS},
     {"w",     "set band-width", OFFSET(width), AV_OPT_TYPE_DOUBLE, {.dbl=0.5}, 0, 999, FLAGS},
     {"csg",   "use constant skirt gain", OFFSET(csg), AV_OPT_TYPE_BOOL, {.i64=0}, 0, 1, FLAGS},
+    PRECISION_OPTIONS
     {NULL}
 };
 
@@ -559,6 +597,7 @@ static const AVOption bandreject_options[] = {
     {"s", "slope", 0, AV_OPT_TYPE_CONST, {.i64=SLOPE}, 0, 0, FLAGS, "width_type"},
     {"width", "set band-width", OFFSET(width), AV_OPT_TYPE_DOUBLE, {.dbl=0.5}, 0, 999, FLAGS},
     {"w",     "set band-width", OFFSET(width), AV_OPT_TYPE_DOUBLE, {.dbl=0.5}, 0, 999, FLAGS},
+    PRECISION_OPTIONS
     {NULL}
 };
 
@@ -577,6 +616,7 @@ static const AVOption lowpass_options[] = {
     {"w",     "set width", OFFSET(width), AV_OPT_TYPE_DOUBLE, {.dbl=0.707}, 0, 99999, FLAGS},
     {"poles", "set number of poles", OFFSET(poles), AV_OPT_TYPE_INT, {.i64=2}, 1, 2, FLAGS},
     {"p",     "set number of poles", OFFSET(poles), AV_OPT_TYPE_INT, {.i64=2}, 1, 2, FLAGS},
+    PRECISION_OPTIONS
     {NULL}
 };
 
@@ -595,6 +635,7 @@ static const AVOption highpass_options[] = {
     {"w",     "set width", OFFSET(width), AV_OPT_TYPE_DOUBLE, {.dbl=0.707}, 0, 99999, FLAGS},
     {"poles", "set number of poles", OFFSET(poles), AV_OPT_TYPE_INT, {.i64=2}, 1, 2, FLAGS},
     {"p",     "set number of poles", OFFSET(poles), AV_OPT_TYPE_INT, {.i64=2}, 1, 2, FLAGS},
+    PRECISION_OPTIONS
     {NULL}
 };
 
@@ -611,6 +652,7 @@ static const AVOption allpass_options[] = {
     {"s", "slope", 0, AV_OPT_TYPE_CONST, {.i64=SLOPE}, 0, 0, FLAGS, "width_type"},
     {"width", "set filter-width", OFFSET(width), AV_OPT_TYPE_DOUBLE, {.dbl=707.1}, 0, 99999, FLAGS},
     {"w",     "set filter-width", OFFSET(width), AV_OPT_TYPE_DOUBLE, {.dbl=707.1}, 0, 99999, FLAGS},
+    PRECISION_OPTIONS
     {NULL}
 };
 
@@ -624,6 +666,7 @@ static const AVOption biquad_options[] = {
     {"b0", NULL, OFFSET(b0), AV_OPT_TYPE_DOUBLE, {.dbl=1}, INT16_MIN, INT16_MAX, FLAGS},
     {"b1", NULL, OFFSET(b1), AV_OPT_TYPE_DOUBLE, {.dbl=1}, INT16_MIN, INT16_MAX, FLAGS},
     {"b2", NULL, OFFSET(b2), AV_OPT_TYPE_DOUBLE, {.dbl=1}, INT16_MIN, INT16_MAX, FLAGS},
+    PRECISION_OPTIONS
     {NULL}
 };
 
@@ -58,6 +58,7 @@ AVFrame *ff_default_get_audio_buffer(AVFilterLink *link, int nb_samples)
     av_samples_set_silence(frame->extended_data, 0, nb_samples, channels,
                            link->format);
 
+    ff_filter_profile_buffer(link);
 
     return frame;
 }
@@ -134,8 +134,10 @@ static void common_uninit(ShowCQTContext *s)
             av_freep(&s->coeffs[k].val);
     av_freep(&s->coeffs);
     av_freep(&s->fft_data);
-    av_freep(&s->fft_result);
+    av_freep(&s->fft_buf);
+    s->fft_result = NULL;
     av_freep(&s->cqt_result);
+    av_freep(&s->cqt_slices);
     av_freep(&s->c_buf);
     av_freep(&s->h_buf);
     av_freep(&s->rcp_h_buf);
@@ -282,6 +284,7 @@ static int init_cqt(ShowCQTContext *s)
     AVExpr *expr = NULL;
     int rate = s->ctx->inputs[0]->sample_rate;
     int nb_cqt_coeffs = 0;
+    int64_t sum;
     int k, x, ret;
 
     if ((ret = av_expr_parse(&expr, s->tlength, var_names, NULL, NULL, NULL, NULL, 0, s->ctx)) < 0)
@@ -322,6 +325,17 @@ static int init_cqt(ShowCQTContext *s)
         }
     }
 
+    /* split the bins between the jobs so that they get about the same
+     * number of coefficients, the kernels of the high bins are the longest */
+    s->cqt_slices[0] = 0;
+    for (k = 0, x = 1, sum = 0; k < s->cqt_len; k++) {
+        sum += s->coeffs[k].len;
+        while (x < s->nb_threads && sum * s->nb_threads >= (int64_t)nb_cqt_coeffs * x)
+            s->cqt_slices[x++] = k + 1;
+    }
+    while (x <= s->nb_threads)
+        s->cqt_slices[x++] = s->cqt_len;
+
     av_expr_free(expr);
     av_log(s->ctx, AV_LOG_INFO, "nb_cqt_coeffs = %d.\n", nb_cqt_coeffs);
     return 0;
@@ -663,14 +677,14 @@ static void yuv_from_cqt(ColorFloat *c, const FFTComplex *v, float gamma, int le
 }
 
 static void draw_bar_rgb(AVFrame *out, const float *h, const float *rcp_h,
-                         const ColorFloat *c, int bar_h)
+                         const ColorFloat *c, int bar_h, int y_start, int y_end)
 {
     int x, y, w = out->width;
     float mul, ht, rcp_bar_h = 1.0f / bar_h;
     uint8_t *v = out->data[0], *lp;
     int ls = out->linesize[0];
 
-    for (y = 0; y < bar_h; y++) {
+    for (y = y_start; y < y_end; y++) {
         ht = (bar_h - y) * rcp_bar_h;
         lp = v + y * ls;
         for (x = 0; x < w; x++) {
@@ -713,7 +727,7 @@ do { \
 } while (0)
 
 static void draw_bar_yuv(AVFrame *out, const float *h, const float *rcp_h,
-                         const ColorFloat *c, int bar_h)
+                         const ColorFloat *c, int bar_h, int y_start, int y_end)
 {
     int x, y, yh, w = out->width;
     float mul, ht, rcp_bar_h = 1.0f / bar_h;
@@ -722,7 +736,7 @@ static void draw_bar_yuv(AVFrame *out, const float *h, const float *rcp_h,
     int lsy = out->linesize[0], lsu = out->linesize[1], lsv = out->linesize[2];
     int fmt = out->format;
 
-    for (y = 0; y < bar_h; y += 2) {
+    for (y = y_start; y < y_end; y += 2) {
         yh = (fmt == AV_PIX_FMT_YUV420P) ? y / 2 : y;
         ht = (bar_h - y) * rcp_bar_h;
         lpy = vy + y * lsy;
@@ -763,13 +777,14 @@ static void draw_bar_yuv(AVFrame *out, const float *h, const float *rcp_h,
     }
 }
 
-static void draw_axis_rgb(AVFrame *out, AVFrame *axis, const ColorFloat *c, int off)
+static void draw_axis_rgb(AVFrame *out, AVFrame *axis, const ColorFloat *c, int off,
+                          int y_start, int y_end)
 {
-    int x, y, w = axis->width, h = axis->height;
+    int x, y, w = axis->width;
     float a, rcp_255 = 1.0f / 255.0f;
     uint8_t *lp, *lpa;
 
-    for (y = 0; y < h; y++) {
+    for (y = y_start; y < y_end; y++) {
         lp = out->data[0] + (off + y) * out->linesize[0];
         lpa = axis->data[0] + y * axis->linesize[0];
         for (x = 0; x < w; x++) {
@@ -826,9 +841,10 @@ do { \
     lpay++; lpaa++; \
 } while (0)
 
-static void draw_axis_yuv(AVFrame *out, AVFrame *axis, const ColorFloat *c, int off)
+static void draw_axis_yuv(AVFrame *out, AVFrame *axis, const ColorFloat *c, int off,
+                          int y_start, int y_end)
 {
-    int fmt = out->format, x, y, yh, w = axis->width, h = axis->height;
+    int fmt = out->format, x, y, yh, w = axis->width;
     int offh = (fmt == AV_PIX_FMT_YUV420P) ? off / 2 : off;
     uint8_t *vy = out->data[0], *vu = out->data[1], *vv = out->data[2];
     uint8_t *vay = axis->data[0], *vau = axis->data[1], *vav = axis->data[2], *vaa = axis->data[3];
@@ -836,7 +852,7 @@ static void draw_axis_yuv(AVFrame *out, AVFrame *axis, const ColorFloat *c, int
     int lsay = axis->linesize[0], lsau = axis->linesize[1], lsav = axis->linesize[2], lsaa = axis->linesize[3];
     uint8_t *lpy, *lpu, *lpv, *lpay, *lpau, *lpav, *lpaa;
 
-    for (y = 0; y < h; y += 2) {
+    for (y = y_start; y < y_end; y += 2) {
         yh = (fmt == AV_PIX_FMT_YUV420P) ? y / 2 : y;
         lpy = vy + (off + y) * lsy;
         lpu = vu + (offh + yh) * lsu;
@@ -883,7 +899,8 @@ static void draw_axis_yuv(AVFrame *out, AVFrame *axis, const ColorFloat *c, int
     }
 }
 
-static void draw_sono(AVFrame *out, AVFrame *sono, int off, int idx)
+static void draw_sono(AVFrame *out, AVFrame *sono, int off, int idx,
+                      int y_start, int y_end)
 {
     int fmt = out->format, h = sono->height;
     int nb_planes = (fmt == AV_PIX_FMT_RGB24) ? 1 : 3;
@@ -892,14 +909,14 @@ static void draw_sono(AVFrame *out, AVFrame *sono, int off, int idx)
     int ls, i, y, yh;
 
     ls = FFMIN(out->linesize[0], sono->linesize[0]);
-    for (y = 0; y < h; y++) {
+    for (y = y_start; y < y_end; y++) {
         memcpy(out->data[0] + (off + y) * out->linesize[0],
                sono->data[0] + (idx + y) % h * sono->linesize[0], ls);
     }
 
     for (i = 1; i < nb_planes; i++) {
         ls = FFMIN(out->linesize[i], sono->linesize[i]);
-        for (y = 0; y < h; y += inc) {
+        for (y = y_start; y < y_end; y += inc) {
             yh = (fmt == AV_PIX_FMT_YUV420P) ? y / 2 : y;
             memcpy(out->data[i] + (offh + yh) * out->linesize[i],
                    sono->data[i] + (idx + y) % h * sono->linesize[i], ls);
@@ -984,6 +1001,49 @@ static void process_cqt(ShowCQTContext *s)
         yuv_from_cqt(s->c_buf, s->cqt_result, s->sono_g, s->width);
 }
 
+static int cqt_calc_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    ShowCQTContext *s = ctx->priv;
+    const int start = s->cqt_slices[jobnr];
+    const int end   = s->cqt_slices[jobnr + 1];
+
+    s->cqt_calc(s->cqt_result + start, s->fft_result, s->coeffs + start,
+                end - start, s->fft_len);
+    return 0;
+}
+
+/* the areas are sliced by pairs of rows, for the subsampled chroma */
+#define SLICE_ROWS(h)                                       \
+    const int y_start = (h) / 2 *  jobnr      / nb_jobs * 2; \
+    const int y_end   = (h) / 2 * (jobnr + 1) / nb_jobs * 2
+
+static int draw_bar_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    ShowCQTContext *s = ctx->priv;
+    SLICE_ROWS(s->bar_h);
+
+    s->draw_bar(arg, s->h_buf, s->rcp_h_buf, s->c_buf, s->bar_h, y_start, y_end);
+    return 0;
+}
+
+static int draw_axis_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    ShowCQTContext *s = ctx->priv;
+    SLICE_ROWS(s->axis_h);
+
+    s->draw_axis(arg, s->axis_frame, s->c_buf, s->bar_h, y_start, y_end);
+    return 0;
+}
+
+static int draw_sono_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    ShowCQTContext *s = ctx->priv;
+    SLICE_ROWS(s->sono_h);
+
+    s->draw_sono(arg, s->sono_frame, s->bar_h + s->axis_h, s->sono_idx, y_start, y_end);
+    return 0;
+}
+
 static int plot_cqt(AVFilterContext *ctx, AVFrame **frameout)
 {
     AVFilterLink *outlink = ctx->outputs[0];
@@ -1003,7 +1063,7 @@ static int plot_cqt(AVFilterContext *ctx, AVFrame **frameout)
     s->fft_result[s->fft_len] = s->fft_result[0];
     UPDATE_TIME(s->fft_time);
 
-    s->cqt_calc(s->cqt_result, s->fft_result, s->coeffs, s->cqt_len, s->fft_len);
+    ctx->internal->execute(ctx, cqt_calc_slice, NULL, NULL, s->nb_threads);
     UPDATE_TIME(s->cqt_time);
 
     process_cqt(s);
@@ -1021,17 +1081,20 @@ static int plot_cqt(AVFilterContext *ctx, AVFrame **frameout)
         UPDATE_TIME(s->alloc_time);
 
         if (s->bar_h) {
-            s->draw_bar(out, s->h_buf, s->rcp_h_buf, s->c_buf, s->bar_h);
+            ctx->internal->execute(ctx, draw_bar_slice, out, NULL,
+                                   FFMIN(s->bar_h / 2, s->nb_threads));
             UPDATE_TIME(s->bar_time);
         }
 
         if (s->axis_h) {
-            s->draw_axis(out, s->axis_frame, s->c_buf, s->bar_h);
+            ctx->internal->execute(ctx, draw_axis_slice, out, NULL,
+                                   FFMIN(s->axis_h / 2, s->nb_threads));
             UPDATE_TIME(s->axis_time);
         }
 
         if (s->sono_h) {
-            s->draw_sono(out, s->sono_frame, s->bar_h + s->axis_h, s->sono_idx);
+            ctx->internal->execute(ctx, draw_sono_slice, out, NULL,
+                                   FFMIN(s->sono_h / 2, s->nb_threads));
             UPDATE_TIME(s->sono_time);
         }
         out->pts = s->next_pts;
@@ -1043,6 +1106,15 @@ static int plot_cqt(AVFilterContext *ctx, AVFrame **frameout)
     return 0;
 }
 
+av_cold void ff_showcqt_init_cqt_calc(ShowCQTContext *s)
+{
+    s->cqt_align = 1;
+    s->cqt_calc = cqt_calc;
+
+    if (ARCH_X86)
+        ff_showcqt_init_x86(s);
+}
+
 /* main filter control */
 static av_cold int init(AVFilterContext *ctx)
 {
@@ -1169,15 +1241,19 @@ static int config_output(AVFilterLink *outlink)
     s->fft_len = 1 << s->fft_bits;
     av_log(ctx, AV_LOG_INFO, "fft_len = %d, cqt_len = %d.\n", s->fft_len, s->cqt_len);
 
+    /* cqt_calc may read up to cqt_align - 1 entries on both sides of the
+     * fft result, they are kept zeroed */
     s->fft_ctx = av_fft_init(s->fft_bits, 0);
     s->fft_data = av_calloc(s->fft_len, sizeof(*s->fft_data));
-    s->fft_result = av_calloc(s->fft_len + 64, sizeof(*s->fft_result));
+    s->fft_buf = av_calloc(s->fft_len + 128, sizeof(*s->fft_buf));
     s->cqt_result = av_malloc_array(s->cqt_len, sizeof(*s->cqt_result));
-    if (!s->fft_ctx || !s->fft_data || !s->fft_result || !s->cqt_result)
+    s->nb_threads = FFMAX(1, ctx->graph->nb_threads);
+    s->cqt_slices = av_malloc_array(s->nb_threads + 1, sizeof(*s->cqt_slices));
+    if (!s->fft_ctx || !s->fft_data || !s->fft_buf || !s->cqt_result || !s->cqt_slices)
         return AVERROR(ENOMEM);
+    s->fft_result = s->fft_buf + 64;
 
-    s->cqt_align = 1;
-    s->cqt_calc = cqt_calc;
+    ff_showcqt_init_cqt_calc(s);
     s->draw_sono = draw_sono;
     if (s->format == AV_PIX_FMT_RGB24) {
         s->draw_bar = draw_bar_rgb;
@@ -1369,4 +1445,5 @@ AVFilter ff_avf_showcqt = {
     .inputs        = showcqt_inputs,
     .outputs       = showcqt_outputs,
     .priv_class    = &showcqt_class,
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
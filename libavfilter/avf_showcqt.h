@@ -60,6 +60,7 @@ typedef struct {
     FFTContext          *fft_ctx;
     Coeffs              *coeffs;
     FFTComplex          *fft_data;
+    FFTComplex          *fft_buf;
     FFTComplex          *fft_result;
     FFTComplex          *cqt_result;
     int                 fft_bits;
@@ -71,13 +72,19 @@ typedef struct {
     float               *rcp_h_buf;
     float               *sono_v_buf;
     float               *bar_v_buf;
+    int                 nb_threads;
+    int                 *cqt_slices;    /* first bin of each cqt_calc job, nb_threads + 1 entries */
     /* callback */
+    /* src[i] is read for i in [-cqt_align + 1, fft_len + cqt_align - 1] */
     void                (*cqt_calc)(FFTComplex *dst, const FFTComplex *src, const Coeffs *coeffs,
                                     int len, int fft_len);
+    /* the draw callbacks fill the rows [y_start, y_end) of their area, both even */
     void                (*draw_bar)(AVFrame *out, const float *h, const float *rcp_h,
-                                    const ColorFloat *c, int bar_h);
-    void                (*draw_axis)(AVFrame *out, AVFrame *axis, const ColorFloat *c, int off);
-    void                (*draw_sono)(AVFrame *out, AVFrame *sono, int off, int idx);
+                                    const ColorFloat *c, int bar_h, int y_start, int y_end);
+    void                (*draw_axis)(AVFrame *out, AVFrame *axis, const ColorFloat *c, int off,
+                                     int y_start, int y_end);
+    void                (*draw_sono)(AVFrame *out, AVFrame *sono, int off, int idx,
+                                     int y_start, int y_end);
     void                (*update_sono)(AVFrame *sono, const ColorFloat *c, int idx);
     /* performance debugging */
     int64_t             fft_time;
@@ -112,4 +119,11 @@ typedef struct {
     int                 axis;
 } ShowCQTContext;
 
+/**
+ * Set cqt_calc and cqt_align, the start of every Coeffs must be a multiple
+ * of cqt_align and its len a multiple of cqt_align too.
+ */
+void ff_showcqt_init_cqt_calc(ShowCQTContext *s);
+void ff_showcqt_init_x86(ShowCQTContext *s);
+
 #endif
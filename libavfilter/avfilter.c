@@ -19,6 +19,14 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include "config.h"
+
+#include <string.h>
+#if HAVE_SYS_RESOURCE_H
+#include <sys/time.h>
+#include <sys/resource.h>
+#endif
+
 #include "libavutil/atomic.h"
 #include "libavutil/avassert.h"
 #include "libavutil/avstring.h"
@@ -33,6 +41,7 @@
 #include "libavutil/pixdesc.h"
 #include "libavutil/rational.h"
 #include "libavutil/samplefmt.h"
+#include "libavutil/time.h"
 
 #include "audio.h"
 #include "avfilter.h"
@@ -366,6 +375,82 @@ void ff_tlog_link(void *ctx, AVFilterLink *link, int end)
     }
 }
 
+typedef struct ProfileStart {
+    int64_t time, cpu_time;
+    int64_t nested_time, nested_cpu_time;
+} ProfileStart;
+
+static int64_t get_cpu_time(void)
+{
+#if HAVE_GETRUSAGE
+    struct rusage rusage;
+
+    getrusage(RUSAGE_SELF, &rusage);
+    return rusage.ru_utime.tv_sec  * 1000000LL + rusage.ru_utime.tv_usec +
+           rusage.ru_stime.tv_sec  * 1000000LL + rusage.ru_stime.tv_usec;
+#else
+    return -1;
+#endif
+}
+
+static int profiling(AVFilterContext *filter)
+{
+    return filter->graph && filter->graph->profile;
+}
+
+static void profile_start(AVFilterContext *filter, ProfileStart *start)
+{
+    AVFilterGraphInternal *gi = filter->graph->internal;
+
+    start->nested_time     = gi->profile_time;
+    start->nested_cpu_time = gi->profile_cpu_time;
+    start->cpu_time        = get_cpu_time();
+    start->time            = av_gettime_relative();
+}
+
+/* Charge the time elapsed since profile_start() to filter, minus the time
+ * of the nested callbacks of other filters which returned meanwhile. */
+static void profile_end(AVFilterContext *filter, ProfileStart *start)
+{
+    AVFilterGraphInternal *gi = filter->graph->internal;
+    AVFilterStats *stats = &filter->internal->stats;
+    int64_t time     = av_gettime_relative() - start->time;
+    int64_t cpu_time = get_cpu_time()        - start->cpu_time;
+
+    stats->time     += time     - (gi->profile_time     - start->nested_time);
+    stats->cpu_time += cpu_time - (gi->profile_cpu_time - start->nested_cpu_time);
+    stats->nb_calls++;
+    gi->profile_time     = start->nested_time     + time;
+    gi->profile_cpu_time = start->nested_cpu_time + cpu_time;
+}
+
+void ff_filter_profile_buffer(AVFilterLink *link)
+{
+    if (link->src && profiling(link->src))
+        link->src->internal->stats.nb_buffers++;
+}
+
+const AVFilterStats *avfilter_get_stats(AVFilterContext *filter)
+{
+    AVFilterStats *stats = &filter->internal->stats;
+    unsigned i;
+
+    if (!profiling(filter))
+        return NULL;
+
+    stats->nb_frames_in = stats->nb_frames_out = 0;
+    for (i = 0; i < filter->nb_inputs; i++)
+        if (filter->inputs[i])
+            stats->nb_frames_in  += filter->inputs[i]->frame_count;
+    for (i = 0; i < filter->nb_outputs; i++)
+        if (filter->outputs[i])
+            stats->nb_frames_out += filter->outputs[i]->frame_count;
+    if (get_cpu_time() < 0)
+        stats->cpu_time = -1;
+
+    return stats;
+}
+
 int ff_request_frame(AVFilterLink *link)
 {
     FF_TPRINTF_START(NULL, request_frame); ff_tlog_link(NULL, link, 1);
@@ -383,9 +468,17 @@ int ff_request_frame_to_filter(AVFilterLink *link)
 
     FF_TPRINTF_START(NULL, request_frame_to_filter); ff_tlog_link(NULL, link, 1);
     link->frame_wanted_in = 0;
-    if (link->srcpad->request_frame)
-        ret = link->srcpad->request_frame(link);
-    else if (link->src->inputs[0])
+    if (link->srcpad->request_frame) {
+        if (profiling(link->src)) {
+            ProfileStart start;
+
+            profile_start(link->src, &start);
+            ret = link->srcpad->request_frame(link);
+            profile_end(link->src, &start);
+        } else {
+            ret = link->srcpad->request_frame(link);
+        }
+    } else if (link->src->inputs[0])
         ret = ff_request_frame(link->src->inputs[0]);
     if (ret == AVERROR_EOF && link->partial_buf) {
         AVFrame *pbuf = link->partial_buf;
@@ -1122,7 +1215,15 @@ static int ff_filter_frame_framed(AVFilterLink *link, AVFrame *frame)
             (dstctx->filter->flags & AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC))
             filter_frame = default_filter_frame;
     }
-    ret = filter_frame(link, out);
+    if (profiling(dstctx)) {
+        ProfileStart start;
+
+        profile_start(dstctx, &start);
+        ret = filter_frame(link, out);
+        profile_end(dstctx, &start);
+    } else {
+        ret = filter_frame(link, out);
+    }
     link->frame_count++;
     ff_update_link_current_pts(link, pts);
     return ret;
@@ -361,6 +361,49 @@ struct AVFilterContext {
     int is_disabled;                ///< the enabled state from the last expression evaluation
 };
 
+/**
+ * Profiling statistics of a filter, collected when AVFilterGraph.profile is
+ * set. sizeof(AVFilterStats) is not a part of the public ABI, new fields may
+ * be added to the end with a minor version bump.
+ */
+typedef struct AVFilterStats {
+    /**
+     * Wall clock time spent in the filter callbacks, excluding the time
+     * spent in the filters it called, in microseconds.
+     */
+    int64_t time;
+
+    /**
+     * CPU time (user and system) of the whole process during the same
+     * intervals, in microseconds; this includes slice threading worker
+     * threads. -1 if not available on this platform.
+     */
+    int64_t cpu_time;
+
+    /**
+     * Number of filter_frame() and request_frame() callbacks invoked.
+     */
+    int64_t nb_calls;
+
+    int64_t nb_frames_in;   ///< number of frames received on all inputs
+    int64_t nb_frames_out;  ///< number of frames sent on all outputs
+
+    /**
+     * Number of frames allocated with the default allocators for the outputs
+     * of this filter. This includes the copies made by libavfilter when the
+     * destination requires writable frames.
+     */
+    int64_t nb_buffers;
+} AVFilterStats;
+
+/**
+ * Get the profiling statistics of a filter.
+ *
+ * @return the statistics, valid until the filter is freed, or NULL if the
+ *         filter is not part of a graph with profiling enabled
+ */
+const AVFilterStats *avfilter_get_stats(AVFilterContext *filter);
+
 /**
  * A link between two filters. This contains pointers to the source and
  * destination filters between which this link exists, and the indexes of
@@ -831,6 +874,12 @@ typedef struct AVFilterGraph {
 
     char *aresample_swr_opts; ///< swr options to use for the auto-inserted aresample filters, Access ONLY through AVOptions
 
+    /**
+     * If nonzero, collect per-filter profiling statistics while the graph
+     * runs, see avfilter_get_stats(). Must be set before filtering starts.
+     */
+    int profile;
+
     /**
      * Private fields
      *
@@ -1083,6 +1132,9 @@ int avfilter_graph_queue_command(AVFilterGraph *graph, const char *target, const
 /**
  * Dump a graph into a human-readable string representation.
  *
+ * If profiling is enabled on the graph, the statistics of each filter are
+ * printed below the graph, the filters taking the most time first.
+ *
  * @param graph    the graph to dump
  * @param options  formatting options; currently ignored
  * @return  a string, or NULL in case of memory allocation failure;
@@ -49,6 +49,8 @@ static const AVOption filtergraph_options[] = {
         AV_OPT_TYPE_STRING, {.str = NULL}, 0, 0, FLAGS },
     {"aresample_swr_opts"   , "default aresample filter options"    , OFFSET(aresample_swr_opts)    ,
         AV_OPT_TYPE_STRING, {.str = NULL}, 0, 0, FLAGS },
+    { "profile",     "Collect per-filter profiling statistics", OFFSET(profile),
+        AV_OPT_TYPE_BOOL,  { .i64 = 0 }, 0, 1, FLAGS },
     { NULL },
 };
 
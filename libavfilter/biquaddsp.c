@@ -0,0 +1,129 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "config.h"
+#include "libavutil/attributes.h"
+#include "biquaddsp.h"
+
+#define BIQUAD_CASCADE(name, type, lanes)                                     \
+static void biquad_## name ##_c(type *buf, type *state, const type *coeffs,   \
+                                int nb_sections, int len)                     \
+{                                                                             \
+    int s, l, n;                                                              \
+                                                                              \
+    for (s = 0; s < nb_sections; s++) {                                       \
+        for (l = 0; l < lanes; l++) {                                         \
+            const type b0 = coeffs[0 * lanes + l];                            \
+            const type b1 = coeffs[1 * lanes + l];                            \
+            const type b2 = coeffs[2 * lanes + l];                            \
+            const type a1 = coeffs[3 * lanes + l];                            \
+            const type a2 = coeffs[4 * lanes + l];                            \
+            type i1 = state[0 * lanes + l];                                   \
+            type i2 = state[1 * lanes + l];                                   \
+            type o1 = state[2 * lanes + l];                                   \
+            type o2 = state[3 * lanes + l];                                   \
+            type *dst = buf + l;                                              \
+                                                                              \
+            for (n = 0; n < len; n++) {                                       \
+                const type in  = dst[n * lanes];                              \
+                const type out = i2 * b2 + i1 * b1 + in * b0 +                \
+                                 o2 * a2 + o1 * a1;                           \
+                                                                              \
+                i2 = i1;                                                      \
+                i1 = in;                                                      \
+                o2 = o1;                                                      \
+                o1 = out;                                                     \
+                dst[n * lanes] = out;                                         \
+            }                                                                 \
+                                                                              \
+            state[0 * lanes + l] = i1;                                        \
+            state[1 * lanes + l] = i2;                                        \
+            state[2 * lanes + l] = o1;                                        \
+            state[3 * lanes + l] = o2;                                        \
+        }                                                                     \
+        coeffs += 5 * lanes;                                                  \
+        state  += 4 * lanes;                                                  \
+    }                                                                         \
+}
+
+BIQUAD_CASCADE(flt, float,  BIQUAD_LANES_FLT)
+BIQUAD_CASCADE(dbl, double, BIQUAD_LANES_DBL)
+
+static void fourth_order_dbl_c(double *buf, double *state, const double *coeffs,
+                               int nb_sections, int len)
+{
+    const int lanes = BIQUAD_LANES_DBL;
+    int s, l, n, k;
+
+    for (s = 0; s < nb_sections; s++) {
+        for (l = 0; l < lanes; l++) {
+            double *dst = buf + l;
+            double b[5], a[5], x[4], y[4];
+
+            b[0] = coeffs[l];
+            for (k = 1; k < 5; k++) {
+                b[k] = coeffs[(2 * k - 1) * lanes + l];
+                a[k] = coeffs[(2 * k    ) * lanes + l];
+            }
+            for (k = 0; k < 4; k++) {
+                x[k] = state[(k    ) * lanes + l];
+                y[k] = state[(k + 4) * lanes + l];
+            }
+
+            for (n = 0; n < len; n++) {
+                const double in = dst[n * lanes];
+                double out;
+
+                out  = b[0] * in;
+                out += b[1] * x[0] - y[0] * a[1];
+                out += b[2] * x[1] - y[1] * a[2];
+                out += b[3] * x[2] - y[2] * a[3];
+                out += b[4] * x[3] - y[3] * a[4];
+
+                x[3] = x[2];
+                x[2] = x[1];
+                x[1] = x[0];
+                x[0] = in;
+
+                y[3] = y[2];
+                y[2] = y[1];
+                y[1] = y[0];
+                y[0] = out;
+
+                dst[n * lanes] = out;
+            }
+
+            for (k = 0; k < 4; k++) {
+                state[(k    ) * lanes + l] = x[k];
+                state[(k + 4) * lanes + l] = y[k];
+            }
+        }
+        coeffs += 9 * lanes;
+        state  += 8 * lanes;
+    }
+}
+
+av_cold void ff_biquaddsp_init(BiquadDSPContext *dsp)
+{
+    dsp->biquad_flt       = biquad_flt_c;
+    dsp->biquad_dbl       = biquad_dbl_c;
+    dsp->fourth_order_dbl = fourth_order_dbl_c;
+
+    if (ARCH_X86)
+        ff_biquaddsp_init_x86(dsp);
+}
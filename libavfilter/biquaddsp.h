@@ -0,0 +1,61 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_BIQUADDSP_H
+#define AVFILTER_BIQUADDSP_H
+
+#define BIQUAD_LANES_FLT    8   ///< channels filtered together by the float functions
+#define BIQUAD_LANES_DBL    4   ///< channels filtered together by the double functions
+#define BIQUAD_BLOCK_SIZE 256   ///< maximum number of frames passed to the functions at once
+
+/**
+ * Cascades of IIR sections in direct form I, applied to BIQUAD_LANES_FLT
+ * (resp. BIQUAD_LANES_DBL) independent channels at once.
+ *
+ * buf holds len frames of interleaved samples, one per lane, and is filtered
+ * in place by nb_sections sections in a row. Each lane has its own
+ * coefficients and history: coeffs and state hold, for each section, rows of
+ * one value per lane, i.e. coefficient k of section s for lane l is at
+ * coeffs[(s * nb_coeffs + k) * lanes + l]. All the buffers must be aligned
+ * on 32 bytes.
+ */
+typedef struct BiquadDSPContext {
+    /**
+     * Second order sections.
+     * The 5 coefficients rows are b0, b1, b2, -a1 and -a2, a0 being 1.
+     * The 4 state rows are x[n-1], x[n-2], y[n-1] and y[n-2].
+     */
+    void (*biquad_flt)(float *buf, float *state, const float *coeffs,
+                       int nb_sections, int len);
+    void (*biquad_dbl)(double *buf, double *state, const double *coeffs,
+                       int nb_sections, int len);
+
+    /**
+     * Fourth order sections.
+     * The 9 coefficients rows are b0, b1, a1, b2, a2, b3, a3, b4 and a4,
+     * a0 being 1.
+     * The 8 state rows are x[n-1] to x[n-4], then y[n-1] to y[n-4].
+     */
+    void (*fourth_order_dbl)(double *buf, double *state, const double *coeffs,
+                             int nb_sections, int len);
+} BiquadDSPContext;
+
+void ff_biquaddsp_init(BiquadDSPContext *dsp);
+void ff_biquaddsp_init_x86(BiquadDSPContext *dsp);
+
+#endif /* AVFILTER_BIQUADDSP_H */
@@ -0,0 +1,43 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef AVFILTER_BOXBLUR_H
+#define AVFILTER_BOXBLUR_H
+
+#include <stdint.h>
+
+typedef struct BoxBlurDSPContext {
+    /**
+     * Move the blurring box of w columns down by one row: add the row add
+     * to the running sums and remove the row sub, then store the blurred
+     * pixels.
+     * sum[x] += (add[x] - sub[x]) * inv; dst[x] = sum[x] >> 16
+     *
+     * inv is less than 32768.
+     *
+     * @return the number of pixels processed, the caller is responsible
+     *         for the remaining w - ret pixels
+     */
+    int (*vblur_row)(uint8_t *dst, int32_t *sum, const uint8_t *add,
+                     const uint8_t *sub, int w, int inv);
+} BoxBlurDSPContext;
+
+void ff_boxblur_init_dsp(BoxBlurDSPContext *dsp);
+void ff_boxblur_init_dsp_x86(BoxBlurDSPContext *dsp);
+
+#endif /* AVFILTER_BOXBLUR_H */
@@ -0,0 +1,50 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_CONVOLUTION_H
+#define AVFILTER_CONVOLUTION_H
+
+#include <stdint.h>
+
+typedef struct ConvolutionDSPContext {
+    /**
+     * Filter w pixels of a row with a 3x3 matrix:
+     * dst[x] = av_clip_uint8((int)(sum * rdiv + bias + 0.5f)),
+     * sum being the sum of c[i][x] * matrix[i] for the 9 taps.
+     *
+     * c points to the source pixels of the taps for x = 0, in the order
+     * of the matrix. All the pixels read are within the picture, the
+     * borders are mirrored by the caller.
+     *
+     * @return the number of pixels filtered, the caller is responsible
+     *         for filtering the remaining w - ret pixels
+     */
+    int (*filter_3x3)(uint8_t *dst, int w, const int *matrix,
+                      const uint8_t *const *c, float rdiv, float bias);
+
+    /**
+     * Same as filter_3x3, with a 5x5 matrix and 25 taps.
+     */
+    int (*filter_5x5)(uint8_t *dst, int w, const int *matrix,
+                      const uint8_t *const *c, float rdiv, float bias);
+} ConvolutionDSPContext;
+
+void ff_convolution_init_dsp(ConvolutionDSPContext *dsp);
+void ff_convolution_init_dsp_x86(ConvolutionDSPContext *dsp);
+
+#endif /* AVFILTER_CONVOLUTION_H */
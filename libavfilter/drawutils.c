@@ -21,6 +21,7 @@
 
 #include <string.h>
 
+#include "config.h"
 #include "libavutil/avassert.h"
 #include "libavutil/avutil.h"
 #include "libavutil/colorspace.h"
@@ -173,6 +174,33 @@ void ff_copy_rectangle(uint8_t *dst[4], int dst_linesize[4],
     }
 }
 
+static int blend_row8_c(uint8_t *dst, const uint8_t *mask, int w,
+                        unsigned src, unsigned alpha)
+{
+    int x;
+
+    for (x = 0; x < w; x++) {
+        unsigned a = mask[x] * alpha;
+        dst[x] = ((0x1010101 - a) * dst[x] + a * src) >> 24;
+    }
+    return w;
+}
+
+static int blend_row8_2x2_c(uint8_t *dst, const uint8_t *mask,
+                            ptrdiff_t mask_linesize, int w,
+                            unsigned src, unsigned alpha)
+{
+    const uint8_t *mask2 = mask + mask_linesize;
+    int x;
+
+    for (x = 0; x < w; x++) {
+        unsigned a = ((mask[2 * x] + mask[2 * x + 1] +
+                       mask2[2 * x] + mask2[2 * x + 1]) >> 2) * alpha;
+        dst[x] = ((0x1010101 - a) * dst[x] + a * src) >> 24;
+    }
+    return w;
+}
+
 int ff_draw_init(FFDrawContext *draw, enum AVPixelFormat format, unsigned flags)
 {
     const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(format);
@@ -217,6 +245,10 @@ int ff_draw_init(FFDrawContext *draw, enum AVPixelFormat format, unsigned flags)
     for (i = 0; i < ((desc->nb_components - 1) | 1); i++)
         draw->comp_mask[desc->comp[i].plane] |=
             1 << desc->comp[i].offset;
+    draw->blend_row8     = blend_row8_c;
+    draw->blend_row8_2x2 = blend_row8_2x2_c;
+    if (ARCH_X86)
+        ff_draw_init_x86(draw);
     return 0;
 }
 
@@ -605,6 +637,32 @@ static void blend_line_hv(uint8_t *dst, int dst_delta,
                     right, hband, hsub + vsub, xm);
 }
 
+/**
+ * Same as blend_line_hv() for an 8 bits mask and a planar 8 bits component,
+ * either not subsampled or subsampled by 2 in both directions.
+ */
+static void blend_line_hv_row8(FFDrawContext *draw, uint8_t *dst,
+                               unsigned src, unsigned alpha,
+                               const uint8_t *mask, int mask_linesize, int w,
+                               unsigned hsub, unsigned vsub,
+                               int xm, int left, int right)
+{
+    int x;
+
+    if (left) {
+        blend_pixel(dst, src, alpha, mask, mask_linesize, 3,
+                    left, 1 << vsub, hsub + vsub, xm);
+        dst++;
+        xm += left;
+    }
+    if (hsub)
+        x = draw->blend_row8_2x2(dst, mask + xm, mask_linesize, w, src, alpha);
+    else
+        x = draw->blend_row8(dst, mask + xm, w, src, alpha);
+    blend_line_hv(dst + x, 1, src, alpha, mask, mask_linesize, 3, w - x,
+                  hsub, vsub, xm + (x << hsub), 0, right, 1 << vsub);
+}
+
 void ff_blend_mask(FFDrawContext *draw, FFDrawColor *color,
                    uint8_t *dst[], int dst_linesize[], int dst_w, int dst_h,
                    const uint8_t *mask,  int mask_linesize, int mask_w, int mask_h,
@@ -661,7 +719,17 @@ void ff_blend_mask(FFDrawContext *draw, FFDrawColor *color,
                 p += dst_linesize[plane];
                 m += top * mask_linesize;
             }
-            if (depth <= 8) {
+            if (depth <= 8 && l2depth == 3 && draw->pixelstep[plane] == 1 &&
+                draw->hsub[plane] == draw->vsub[plane] && draw->hsub[plane] <= 1) {
+                for (y = 0; y < h_sub; y++) {
+                    blend_line_hv_row8(draw, p, color->comp[plane].u8[comp], alpha,
+                                       m, mask_linesize, w_sub,
+                                       draw->hsub[plane], draw->vsub[plane],
+                                       xm0, left, right);
+                    p += dst_linesize[plane];
+                    m += mask_linesize << draw->vsub[plane];
+                }
+            } else if (depth <= 8) {
                 for (y = 0; y < h_sub; y++) {
                     blend_line_hv(p, draw->pixelstep[plane],
                                   color->comp[plane].u8[comp], alpha,
@@ -55,6 +55,27 @@ typedef struct FFDrawContext {
     uint8_t vsub[MAX_PLANES];  /*< vertical subsampling */
     uint8_t hsub_max;
     uint8_t vsub_max;
+
+    /**
+     * Blend w pixels of an 8 bits component with an 8 bits mask of the
+     * same resolution:
+     * a = mask[x] * alpha, dst[x] = ((0x1010101 - a) * dst[x] + a * src) >> 24
+     *
+     * @return the number of pixels blended, the caller is responsible for
+     *         blending the remaining w - ret pixels
+     */
+    int (*blend_row8)(uint8_t *dst, const uint8_t *mask, int w,
+                      unsigned src, unsigned alpha);
+
+    /**
+     * Same as blend_row8, for a component subsampled by 2 in both
+     * directions, each pixel covering 2x2 samples of the mask:
+     * a = ((mask[2x] + mask[2x + 1] + mask[2x + mask_linesize] +
+     *       mask[2x + 1 + mask_linesize]) >> 2) * alpha
+     */
+    int (*blend_row8_2x2)(uint8_t *dst, const uint8_t *mask,
+                          ptrdiff_t mask_linesize, int w,
+                          unsigned src, unsigned alpha);
 } FFDrawContext;
 
 typedef struct FFDrawColor {
@@ -76,6 +97,8 @@ typedef struct FFDrawColor {
  */
 int ff_draw_init(FFDrawContext *draw, enum AVPixelFormat format, unsigned flags);
 
+void ff_draw_init_x86(FFDrawContext *draw);
+
 /**
  * Prepare a color.
  */
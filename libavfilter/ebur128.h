@@ -0,0 +1,59 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef AVFILTER_EBUR128_H
+#define AVFILTER_EBUR128_H
+
+#define EBUR128_STATE_STRIDE 64     ///< distance between the planes of the K-weighting filter state
+#define EBUR128_TP_PHASES     4     ///< true-peak over-sampling factor
+#define EBUR128_TP_TAPS      12     ///< taps of each phase of the true-peak interpolation filter
+
+typedef struct EBUR128DSPContext {
+    /**
+     * Apply the K-weighting filter to nb_samples interleaved samples of
+     * nb_channels channels and update the integration windows.
+     *
+     * state holds the filter history of each channel, as 6 planes of
+     * EBUR128_STATE_STRIDE entries aligned on 32 bytes: X[i-1], X[i-2],
+     * Y[i-1], Y[i-2], Z[i-1] and Z[i-2], X being the input, Y the output of
+     * the pre-filter and Z the output of the RLB-filter.
+     * The square of each filtered sample replaces the entry at the same
+     * position in cache_400 and cache_3000, interleaved like samples, and the
+     * difference is accumulated in sum_400 and sum_3000.
+     */
+    void (*filter_channels)(double *state, const double *samples,
+                            double *cache_400, double *cache_3000,
+                            double *sum_400, double *sum_3000,
+                            int nb_channels, int nb_samples);
+
+    /**
+     * Over-sample nb_samples samples of a single channel EBUR128_TP_PHASES
+     * times and return the largest absolute value of the result.
+     *
+     * src must be preceded by EBUR128_TP_TAPS - 1 samples of history.
+     * coeffs holds the polyphase filter, aligned on 32 bytes, with the
+     * EBUR128_TP_PHASES taps applied to src[n - k] stored at
+     * coeffs[k * EBUR128_TP_PHASES].
+     */
+    double (*true_peak)(const double *src, const double *coeffs, int nb_samples);
+} EBUR128DSPContext;
+
+void ff_ebur128_init_dsp(EBUR128DSPContext *dsp);
+void ff_ebur128_init_dsp_x86(EBUR128DSPContext *dsp);
+
+#endif /* AVFILTER_EBUR128_H */
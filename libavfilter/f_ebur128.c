@@ -34,12 +34,13 @@
 #include "libavutil/channel_layout.h"
 #include "libavutil/dict.h"
 #include "libavutil/ffmath.h"
+#include "libavutil/mem.h"
 #include "libavutil/xga_font_data.h"
 #include "libavutil/opt.h"
 #include "libavutil/timestamp.h"
-#include "libswresample/swresample.h"
 #include "audio.h"
 #include "avfilter.h"
+#include "ebur128.h"
 #include "formats.h"
 #include "internal.h"
 
@@ -78,7 +79,7 @@ struct hist_entry {
 };
 
 struct integrator {
-    double *cache[MAX_CHANNELS];    ///< window of filtered samples (N ms)
+    double *cache;                  ///< window of filtered samples (N ms), interleaved
     int cache_pos;                  ///< focus on the last added bin in the cache array
     double sum[MAX_CHANNELS];       ///< sum of the last N ms filtered samples (cache content)
     int filled;                     ///< 1 if the cache is completely filled, 0 otherwise
@@ -98,11 +99,9 @@ typedef struct {
     double *true_peaks;             ///< true peaks per channel
     double *sample_peaks;           ///< sample peaks per channel
     double *true_peaks_per_frame;   ///< true peaks in a frame per channel
-#if CONFIG_SWRESAMPLE
-    SwrContext *swr_ctx;            ///< over-sampling context for true peak metering
-    double *swr_buf;                ///< resampled audio data for true peak metering
-    int swr_linesize;
-#endif
+    double *tp_buf;                 ///< history and samples of the channel being over-sampled
+    double tp_history[MAX_CHANNELS * (EBUR128_TP_TAPS - 1)]; ///< last samples of each channel
+    DECLARE_ALIGNED(32, double, tp_coeffs)[EBUR128_TP_TAPS * EBUR128_TP_PHASES]; ///< polyphase over-sampling filter
 
     /* video  */
     int do_video;                   ///< 1 if video output enabled, 0 otherwise
@@ -121,11 +120,9 @@ typedef struct {
     double *ch_weighting;           ///< channel weighting mapping
     int sample_count;               ///< sample count used for refresh frequency, reset at refresh
 
-    /* Filter caches.
-     * The mult by 3 in the following is for X[i], X[i-1] and X[i-2] */
-    double x[MAX_CHANNELS * 3];     ///< 3 input samples cache for each channel
-    double y[MAX_CHANNELS * 3];     ///< 3 pre-filter samples cache for each channel
-    double z[MAX_CHANNELS * 3];     ///< 3 RLB-filter samples cache for each channel
+    /* Filter caches: X[i-1], X[i-2], Y[i-1], Y[i-2], Z[i-1] and Z[i-2] of each
+     * channel, see EBUR128DSPContext.filter_channels */
+    DECLARE_ALIGNED(32, double, filter_state)[6 * EBUR128_STATE_STRIDE];
 
 #define I400_BINS  (48000 * 4 / 10)
 #define I3000_BINS (48000 * 3)
@@ -137,8 +134,11 @@ typedef struct {
     double loudness_range;          ///< loudness range in LU (LRA)
     double lra_low, lra_high;       ///< low and high LRA values
 
+    EBUR128DSPContext dsp;
+
     /* misc */
     int loglevel;                   ///< log level for frame logging
+    int summary_only;               ///< 1 if only the final summary is reported
     int metadata;                   ///< whether or not to inject loudness results in frames
     int dual_mono;                  ///< whether or not to treat single channel input files as dual-mono
     double pan_law;                 ///< pan law value used to calulate dual-mono measurements
@@ -161,6 +161,7 @@ static const AVOption ebur128_options[] = {
     { "framelog", "force frame logging level", OFFSET(loglevel), AV_OPT_TYPE_INT, {.i64 = -1},   INT_MIN, INT_MAX, A|V|F, "level" },
         { "info",    "information logging level", 0, AV_OPT_TYPE_CONST, {.i64 = AV_LOG_INFO},    INT_MIN, INT_MAX, A|V|F, "level" },
         { "verbose", "verbose logging level",     0, AV_OPT_TYPE_CONST, {.i64 = AV_LOG_VERBOSE}, INT_MIN, INT_MAX, A|V|F, "level" },
+        { "quiet",   "disable frame logging",     0, AV_OPT_TYPE_CONST, {.i64 = AV_LOG_QUIET},   INT_MIN, INT_MAX, A|V|F, "level" },
     { "metadata", "inject metadata in the filtergraph", OFFSET(metadata), AV_OPT_TYPE_BOOL, {.i64 = 0}, 0, 1, A|V|F },
     { "peak", "set peak mode", OFFSET(peak_mode), AV_OPT_TYPE_FLAGS, {.i64 = PEAK_MODE_NONE}, 0, INT_MAX, A|F, "mode" },
         { "none",   "disable any peak mode",   0, AV_OPT_TYPE_CONST, {.i64 = PEAK_MODE_NONE},          INT_MIN, INT_MAX, A|F, "mode" },
@@ -352,10 +353,8 @@ static int config_audio_input(AVFilterLink *inlink)
 
     /* Force 100ms framing in case of metadata injection: the frames must have
      * a granularity of the window overlap to be accurately exploited.
-     * As for the true peaks mode, it just simplifies the resampling buffer
-     * allocation and the lookup in it (since sample buffers differ in size, it
-     * can be more complex to integrate in the one-sample loop of
-     * filter_frame()). */
+     * As for the true peaks mode, it just simplifies the over-sampling buffer
+     * allocation. */
     if (ebur128->metadata || (ebur128->peak_mode & PEAK_MODE_TRUE_PEAKS))
         inlink->min_samples =
         inlink->max_samples =
@@ -363,6 +362,25 @@ static int config_audio_input(AVFilterLink *inlink)
     return 0;
 }
 
+/* The interpolation filter is a Hann windowed sinc of EBUR128_TP_TAPS
+ * periods of the input, centered on an input sample: phase 0 is a pure delay
+ * of EBUR128_TP_TAPS / 2 input samples. The per-frame true peaks thus lag the
+ * input by that many samples; the filter is flushed in uninit() so that the
+ * true peak of the whole stream is never below its sample peak. */
+static void init_tp_coeffs(double *coeffs)
+{
+    const int len = EBUR128_TP_TAPS * EBUR128_TP_PHASES;
+    int i;
+
+    for (i = 0; i < len; i++) {
+        const int m = i - len / 2;
+        const double x = M_PI * m / EBUR128_TP_PHASES;
+        const double sinc = m % EBUR128_TP_PHASES ? sin(x) / x : !m;
+
+        coeffs[i] = sinc * 0.5 * (1 - cos(2 * M_PI * i / len));
+    }
+}
+
 static int config_audio_output(AVFilterLink *outlink)
 {
     int i;
@@ -390,42 +408,24 @@ static int config_audio_output(AVFilterLink *outlink)
         } else {
             ebur128->ch_weighting[i] = 1.0;
         }
-
-        if (!ebur128->ch_weighting[i])
-            continue;
-
-        /* bins buffer for the two integration window (400ms and 3s) */
-        ebur128->i400.cache[i]  = av_calloc(I400_BINS,  sizeof(*ebur128->i400.cache[0]));
-        ebur128->i3000.cache[i] = av_calloc(I3000_BINS, sizeof(*ebur128->i3000.cache[0]));
-        if (!ebur128->i400.cache[i] || !ebur128->i3000.cache[i])
-            return AVERROR(ENOMEM);
     }
 
-#if CONFIG_SWRESAMPLE
-    if (ebur128->peak_mode & PEAK_MODE_TRUE_PEAKS) {
-        int ret;
+    /* bins buffer for the two integration window (400ms and 3s) */
+    ebur128->i400.cache  = av_calloc(I400_BINS  * nb_channels, sizeof(*ebur128->i400.cache));
+    ebur128->i3000.cache = av_calloc(I3000_BINS * nb_channels, sizeof(*ebur128->i3000.cache));
+    if (!ebur128->i400.cache || !ebur128->i3000.cache)
+        return AVERROR(ENOMEM);
 
-        ebur128->swr_buf    = av_malloc_array(nb_channels, 19200 * sizeof(double));
+    if (ebur128->peak_mode & PEAK_MODE_TRUE_PEAKS) {
+        ebur128->tp_buf     = av_malloc_array(EBUR128_TP_TAPS - 1 + outlink->sample_rate / 10,
+                                              sizeof(*ebur128->tp_buf));
         ebur128->true_peaks = av_calloc(nb_channels, sizeof(*ebur128->true_peaks));
         ebur128->true_peaks_per_frame = av_calloc(nb_channels, sizeof(*ebur128->true_peaks_per_frame));
-        ebur128->swr_ctx    = swr_alloc();
-        if (!ebur128->swr_buf || !ebur128->true_peaks ||
-            !ebur128->true_peaks_per_frame || !ebur128->swr_ctx)
+        if (!ebur128->tp_buf || !ebur128->true_peaks ||
+            !ebur128->true_peaks_per_frame)
             return AVERROR(ENOMEM);
-
-        av_opt_set_int(ebur128->swr_ctx, "in_channel_layout",    outlink->channel_layout, 0);
-        av_opt_set_int(ebur128->swr_ctx, "in_sample_rate",       outlink->sample_rate, 0);
-        av_opt_set_sample_fmt(ebur128->swr_ctx, "in_sample_fmt", outlink->format, 0);
-
-        av_opt_set_int(ebur128->swr_ctx, "out_channel_layout",    outlink->channel_layout, 0);
-        av_opt_set_int(ebur128->swr_ctx, "out_sample_rate",       192000, 0);
-        av_opt_set_sample_fmt(ebur128->swr_ctx, "out_sample_fmt", outlink->format, 0);
-
-        ret = swr_init(ebur128->swr_ctx);
-        if (ret < 0)
-            return ret;
+        init_tp_coeffs(ebur128->tp_coeffs);
     }
-#endif
 
     if (ebur128->peak_mode & PEAK_MODE_SAMPLES_PEAKS) {
         ebur128->sample_peaks = av_calloc(nb_channels, sizeof(*ebur128->sample_peaks));
@@ -460,18 +460,20 @@ static av_cold int init(AVFilterContext *ctx)
     AVFilterPad pad;
 
     if (ebur128->loglevel != AV_LOG_INFO &&
-        ebur128->loglevel != AV_LOG_VERBOSE) {
+        ebur128->loglevel != AV_LOG_VERBOSE &&
+        ebur128->loglevel != AV_LOG_QUIET) {
         if (ebur128->do_video || ebur128->metadata)
             ebur128->loglevel = AV_LOG_VERBOSE;
         else
             ebur128->loglevel = AV_LOG_INFO;
     }
 
-    if (!CONFIG_SWRESAMPLE && (ebur128->peak_mode & PEAK_MODE_TRUE_PEAKS)) {
-        av_log(ctx, AV_LOG_ERROR,
-               "True-peak mode requires libswresample to be performed\n");
-        return AVERROR(EINVAL);
-    }
+    /* with nothing reported before the end, the integrated loudness and the
+     * loudness range only need to be computed once, in uninit() */
+    ebur128->summary_only = ebur128->loglevel == AV_LOG_QUIET &&
+                            !ebur128->do_video && !ebur128->metadata;
+
+    ff_ebur128_init_dsp(&ebur128->dsp);
 
     // if meter is  +9 scale, scale range is from -18 LU to  +9 LU (or 3*9)
     // if meter is +18 scale, scale range is from -36 LU to +18 LU (or 3*18)
@@ -512,6 +514,7 @@ static av_cold int init(AVFilterContext *ctx)
 }
 
 #define HIST_POS(power) (int)(((power) - ABS_THRES) * HIST_GRAIN)
+#define GATE_HIST_POS(integ) av_clip(HIST_POS((integ)->rel_threshold), 0, HIST_SIZE - 1)
 
 /* loudness and power should be set such as loudness = -0.691 +
  * 10*log10(power), we just avoid doing that calculus two times */
@@ -533,14 +536,144 @@ static int gate_update(struct integrator *integ, double power,
     if (!relative_threshold)
         relative_threshold = 1e-12;
     integ->rel_threshold = LOUDNESS(relative_threshold) + gate_thres;
-    gate_hist_pos = av_clip(HIST_POS(integ->rel_threshold), 0, HIST_SIZE - 1);
+    gate_hist_pos = GATE_HIST_POS(integ);
 
     return gate_hist_pos;
 }
 
+/* compute integrated loudness by summing the histogram values above the
+ * relative threshold */
+static void update_integrated_loudness(EBUR128Context *ebur128, int gate_hist_pos)
+{
+    double integrated_sum = 0;
+    int nb_integrated = 0;
+    int i;
+
+    for (i = gate_hist_pos; i < HIST_SIZE; i++) {
+        const int nb_v = ebur128->i400.histogram[i].count;
+        nb_integrated  += nb_v;
+        integrated_sum += nb_v * ebur128->i400.histogram[i].energy;
+    }
+    if (nb_integrated) {
+        ebur128->integrated_loudness = LOUDNESS(integrated_sum / nb_integrated);
+        /* dual-mono correction */
+        if (ebur128->nb_channels == 1 && ebur128->dual_mono) {
+            ebur128->integrated_loudness -= ebur128->pan_law;
+        }
+    }
+}
+
+#define LRA_GATE_THRES -20
+#define LRA_LOWER_PRC   10
+#define LRA_HIGHER_PRC  95
+
+static void update_loudness_range(EBUR128Context *ebur128, int gate_hist_pos)
+{
+    int i, nb_powers = 0;
+
+    for (i = gate_hist_pos; i < HIST_SIZE; i++)
+        nb_powers += ebur128->i3000.histogram[i].count;
+    if (nb_powers) {
+        int n, nb_pow;
+
+        /* get lower loudness to consider */
+        n = 0;
+        nb_pow = LRA_LOWER_PRC  * nb_powers / 100. + 0.5;
+        for (i = gate_hist_pos; i < HIST_SIZE; i++) {
+            n += ebur128->i3000.histogram[i].count;
+            if (n >= nb_pow) {
+                ebur128->lra_low = ebur128->i3000.histogram[i].loudness;
+                break;
+            }
+        }
+
+        /* get higher loudness to consider */
+        n = nb_powers;
+        nb_pow = LRA_HIGHER_PRC * nb_powers / 100. + 0.5;
+        for (i = HIST_SIZE - 1; i >= 0; i--) {
+            n -= ebur128->i3000.histogram[i].count;
+            if (n < nb_pow) {
+                ebur128->lra_high = ebur128->i3000.histogram[i].loudness;
+                break;
+            }
+        }
+
+        // XXX: show low & high on the graph?
+        ebur128->loudness_range = ebur128->lra_high - ebur128->lra_low;
+    }
+}
+
+static void filter_channels_c(double *state, const double *samples,
+                              double *cache_400, double *cache_3000,
+                              double *sum_400, double *sum_3000,
+                              int nb_channels, int nb_samples)
+{
+    double *x1 = state,                     *x2 = x1 + EBUR128_STATE_STRIDE;
+    double *y1 = x2 + EBUR128_STATE_STRIDE, *y2 = y1 + EBUR128_STATE_STRIDE;
+    double *z1 = y2 + EBUR128_STATE_STRIDE, *z2 = z1 + EBUR128_STATE_STRIDE;
+    int i, ch;
+
+    for (i = 0; i < nb_samples; i++) {
+        for (ch = 0; ch < nb_channels; ch++) {
+            const double x0 = *samples++;
+            double y0, z0, bin;
+
+            /* Y[i] = X[i]*b0 + X[i-1]*b1 + X[i-2]*b2 - Y[i-1]*a1 - Y[i-2]*a2 */
+            // TODO: merge both filters in one?
+            y0 = x0*PRE_B0 + x1[ch]*PRE_B1 + x2[ch]*PRE_B2 - y1[ch]*PRE_A1 - y2[ch]*PRE_A2;
+            z0 = y0*RLB_B0 + y1[ch]*RLB_B1 + y2[ch]*RLB_B2 - z1[ch]*RLB_A1 - z2[ch]*RLB_A2;
+            x2[ch] = x1[ch];
+            x1[ch] = x0;
+            y2[ch] = y1[ch];
+            y1[ch] = y0;
+            z2[ch] = z1[ch];
+            z1[ch] = z0;
+
+            bin = z0 * z0;
+
+            /* add the new value, and limit the sum to the cache size (400ms or 3s)
+             * by removing the oldest one */
+            sum_400 [ch] = sum_400 [ch] + bin - cache_400 [ch];
+            sum_3000[ch] = sum_3000[ch] + bin - cache_3000[ch];
+
+            /* override old cache entry with the new value */
+            cache_400 [ch] = bin;
+            cache_3000[ch] = bin;
+        }
+        cache_400  += nb_channels;
+        cache_3000 += nb_channels;
+    }
+}
+
+static double true_peak_c(const double *src, const double *coeffs, int nb_samples)
+{
+    double peak = 0.0;
+    int i, k, p;
+
+    for (i = 0; i < nb_samples; i++) {
+        for (p = 0; p < EBUR128_TP_PHASES; p++) {
+            double v = 0.0;
+
+            for (k = 0; k < EBUR128_TP_TAPS; k++)
+                v += coeffs[k * EBUR128_TP_PHASES + p] * src[i - k];
+            peak = FFMAX(peak, fabs(v));
+        }
+    }
+    return peak;
+}
+
+av_cold void ff_ebur128_init_dsp(EBUR128DSPContext *dsp)
+{
+    dsp->filter_channels = filter_channels_c;
+    dsp->true_peak       = true_peak_c;
+
+    if (ARCH_X86)
+        ff_ebur128_init_dsp_x86(dsp);
+}
+
 static int filter_frame(AVFilterLink *inlink, AVFrame *insamples)
 {
-    int i, ch, idx_insample;
+    int i, ch, idx_insample, nb;
     AVFilterContext *ctx = inlink->dst;
     EBUR128Context *ebur128 = ctx->priv;
     const int nb_channels = ebur128->nb_channels;
@@ -548,32 +681,49 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *insamples)
     const double *samples = (double *)insamples->data[0];
     AVFrame *pic = ebur128->outpicref;
 
-#if CONFIG_SWRESAMPLE
     if (ebur128->peak_mode & PEAK_MODE_TRUE_PEAKS) {
-        const double *swr_samples = ebur128->swr_buf;
-        int ret = swr_convert(ebur128->swr_ctx, (uint8_t**)&ebur128->swr_buf, 19200,
-                              (const uint8_t **)insamples->data, nb_samples);
-        if (ret < 0)
-            return ret;
-        for (ch = 0; ch < nb_channels; ch++)
-            ebur128->true_peaks_per_frame[ch] = 0.0;
-        for (idx_insample = 0; idx_insample < ret; idx_insample++) {
-            for (ch = 0; ch < nb_channels; ch++) {
-                ebur128->true_peaks[ch] = FFMAX(ebur128->true_peaks[ch], fabs(*swr_samples));
-                ebur128->true_peaks_per_frame[ch] = FFMAX(ebur128->true_peaks_per_frame[ch],
-                                                          fabs(*swr_samples));
-                swr_samples++;
-            }
+        double *buf = ebur128->tp_buf + EBUR128_TP_TAPS - 1;
+
+        for (ch = 0; ch < nb_channels; ch++) {
+            double *history = ebur128->tp_history + ch * (EBUR128_TP_TAPS - 1);
+
+            memcpy(ebur128->tp_buf, history, (EBUR128_TP_TAPS - 1) * sizeof(*history));
+            for (i = 0; i < nb_samples; i++)
+                buf[i] = samples[i * nb_channels + ch];
+            ebur128->true_peaks_per_frame[ch] =
+                ebur128->dsp.true_peak(buf, ebur128->tp_coeffs, nb_samples);
+            ebur128->true_peaks[ch] = FFMAX(ebur128->true_peaks[ch],
+                                            ebur128->true_peaks_per_frame[ch]);
+            memcpy(history, buf + nb_samples - (EBUR128_TP_TAPS - 1),
+                   (EBUR128_TP_TAPS - 1) * sizeof(*history));
         }
     }
-#endif
 
-    for (idx_insample = 0; idx_insample < nb_samples; idx_insample++) {
+    /* The samples are filtered in runs that neither wrap around the caches
+     * nor cross a 100ms boundary. */
+    for (idx_insample = 0; idx_insample < nb_samples; idx_insample += nb) {
         const int bin_id_400  = ebur128->i400.cache_pos;
         const int bin_id_3000 = ebur128->i3000.cache_pos;
 
+        nb = FFMIN3(nb_samples - idx_insample, 4800 - ebur128->sample_count,
+                    FFMIN(I400_BINS - bin_id_400, I3000_BINS - bin_id_3000));
+
+        if (ebur128->peak_mode & PEAK_MODE_SAMPLES_PEAKS) {
+            for (i = 0; i < nb * nb_channels; i += nb_channels)
+                for (ch = 0; ch < nb_channels; ch++)
+                    ebur128->sample_peaks[ch] = FFMAX(ebur128->sample_peaks[ch],
+                                                      fabs(samples[i + ch]));
+        }
+
+        ebur128->dsp.filter_channels(ebur128->filter_state, samples,
+                                     ebur128->i400.cache  + bin_id_400  * nb_channels,
+                                     ebur128->i3000.cache + bin_id_3000 * nb_channels,
+                                     ebur128->i400.sum, ebur128->i3000.sum,
+                                     nb_channels, nb);
+        samples += nb * nb_channels;
+
 #define MOVE_TO_NEXT_CACHED_ENTRY(time) do {                \
-    ebur128->i##time.cache_pos++;                           \
+    ebur128->i##time.cache_pos += nb;                       \
     if (ebur128->i##time.cache_pos == I##time##_BINS) {     \
         ebur128->i##time.filled    = 1;                     \
         ebur128->i##time.cache_pos = 0;                     \
@@ -583,54 +733,16 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *insamples)
         MOVE_TO_NEXT_CACHED_ENTRY(400);
         MOVE_TO_NEXT_CACHED_ENTRY(3000);
 
-        for (ch = 0; ch < nb_channels; ch++) {
-            double bin;
-
-            if (ebur128->peak_mode & PEAK_MODE_SAMPLES_PEAKS)
-                ebur128->sample_peaks[ch] = FFMAX(ebur128->sample_peaks[ch], fabs(*samples));
-
-            ebur128->x[ch * 3] = *samples++; // set X[i]
-
-            if (!ebur128->ch_weighting[ch])
-                continue;
-
-            /* Y[i] = X[i]*b0 + X[i-1]*b1 + X[i-2]*b2 - Y[i-1]*a1 - Y[i-2]*a2 */
-#define FILTER(Y, X, name) do {                                                 \
-            double *dst = ebur128->Y + ch*3;                                    \
-            double *src = ebur128->X + ch*3;                                    \
-            dst[2] = dst[1];                                                    \
-            dst[1] = dst[0];                                                    \
-            dst[0] = src[0]*name##_B0 + src[1]*name##_B1 + src[2]*name##_B2     \
-                                      - dst[1]*name##_A1 - dst[2]*name##_A2;    \
-} while (0)
-
-            // TODO: merge both filters in one?
-            FILTER(y, x, PRE);  // apply pre-filter
-            ebur128->x[ch * 3 + 2] = ebur128->x[ch * 3 + 1];
-            ebur128->x[ch * 3 + 1] = ebur128->x[ch * 3    ];
-            FILTER(z, y, RLB);  // apply RLB-filter
-
-            bin = ebur128->z[ch * 3] * ebur128->z[ch * 3];
-
-            /* add the new value, and limit the sum to the cache size (400ms or 3s)
-             * by removing the oldest one */
-            ebur128->i400.sum [ch] = ebur128->i400.sum [ch] + bin - ebur128->i400.cache [ch][bin_id_400];
-            ebur128->i3000.sum[ch] = ebur128->i3000.sum[ch] + bin - ebur128->i3000.cache[ch][bin_id_3000];
-
-            /* override old cache entry with the new value */
-            ebur128->i400.cache [ch][bin_id_400 ] = bin;
-            ebur128->i3000.cache[ch][bin_id_3000] = bin;
-        }
-
         /* For integrated loudness, gating blocks are 400ms long with 75%
          * overlap (see BS.1770-2 p5), so a re-computation is needed each 100ms
          * (4800 samples at 48kHz). */
-        if (++ebur128->sample_count == 4800) {
+        ebur128->sample_count += nb;
+        if (ebur128->sample_count == 4800) {
             double loudness_400, loudness_3000;
             double power_400 = 1e-12, power_3000 = 1e-12;
             AVFilterLink *outlink = ctx->outputs[0];
             const int64_t pts = insamples->pts +
-                av_rescale_q(idx_insample, (AVRational){ 1, inlink->sample_rate },
+                av_rescale_q(idx_insample + nb - 1, (AVRational){ 1, inlink->sample_rate },
                              outlink->time_base);
 
             ebur128->sample_count = 0;
@@ -639,7 +751,8 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *insamples)
     if (ebur128->i##time.filled) {                                                  \
         /* weighting sum of the last <time> ms */                                   \
         for (ch = 0; ch < nb_channels; ch++)                                        \
-            power_##time += ebur128->ch_weighting[ch] * ebur128->i##time.sum[ch];   \
+            if (ebur128->ch_weighting[ch])                                          \
+                power_##time += ebur128->ch_weighting[ch] * ebur128->i##time.sum[ch]; \
         power_##time /= I##time##_BINS;                                             \
     }                                                                               \
     loudness_##time = LOUDNESS(power_##time);                                       \
@@ -652,69 +765,23 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *insamples)
 #define I_GATE_THRES -10  // initially defined to -8 LU in the first EBU standard
 
             if (loudness_400 >= ABS_THRES) {
-                double integrated_sum = 0;
-                int nb_integrated = 0;
                 int gate_hist_pos = gate_update(&ebur128->i400, power_400,
                                                 loudness_400, I_GATE_THRES);
 
-                /* compute integrated loudness by summing the histogram values
-                 * above the relative threshold */
-                for (i = gate_hist_pos; i < HIST_SIZE; i++) {
-                    const int nb_v = ebur128->i400.histogram[i].count;
-                    nb_integrated  += nb_v;
-                    integrated_sum += nb_v * ebur128->i400.histogram[i].energy;
-                }
-                if (nb_integrated) {
-                    ebur128->integrated_loudness = LOUDNESS(integrated_sum / nb_integrated);
-                    /* dual-mono correction */
-                    if (nb_channels == 1 && ebur128->dual_mono) {
-                        ebur128->integrated_loudness -= ebur128->pan_law;
-                    }
-                }
+                if (!ebur128->summary_only)
+                    update_integrated_loudness(ebur128, gate_hist_pos);
             }
 
             /* LRA */
-#define LRA_GATE_THRES -20
-#define LRA_LOWER_PRC   10
-#define LRA_HIGHER_PRC  95
 
             /* XXX: example code in EBU 3342 is ">=" but formula in BS.1770
              * specs is ">" */
             if (loudness_3000 >= ABS_THRES) {
-                int nb_powers = 0;
                 int gate_hist_pos = gate_update(&ebur128->i3000, power_3000,
                                                 loudness_3000, LRA_GATE_THRES);
 
-                for (i = gate_hist_pos; i < HIST_SIZE; i++)
-                    nb_powers += ebur128->i3000.histogram[i].count;
-                if (nb_powers) {
-                    int n, nb_pow;
-
-                    /* get lower loudness to consider */
-                    n = 0;
-                    nb_pow = LRA_LOWER_PRC  * nb_powers / 100. + 0.5;
-                    for (i = gate_hist_pos; i < HIST_SIZE; i++) {
-                        n += ebur128->i3000.histogram[i].count;
-                        if (n >= nb_pow) {
-                            ebur128->lra_low = ebur128->i3000.histogram[i].loudness;
-                            break;
-                        }
-                    }
-
-                    /* get higher loudness to consider */
-                    n = nb_powers;
-                    nb_pow = LRA_HIGHER_PRC * nb_powers / 100. + 0.5;
-                    for (i = HIST_SIZE - 1; i >= 0; i--) {
-                        n -= ebur128->i3000.histogram[i].count;
-                        if (n < nb_pow) {
-                            ebur128->lra_high = ebur128->i3000.histogram[i].loudness;
-                            break;
-                        }
-                    }
-
-                    // XXX: show low & high on the graph?
-                    ebur128->loudness_range = ebur128->lra_high - ebur128->lra_low;
-                }
+                if (!ebur128->summary_only)
+                    update_loudness_range(ebur128, gate_hist_pos);
             }
 
             /* dual-mono correction */
@@ -797,6 +864,9 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *insamples)
                 SET_META_PEAK(true,   TRUE);
             }
 
+            if (ebur128->loglevel == AV_LOG_QUIET)
+                continue;
+
             av_log(ctx, ebur128->loglevel, "t: %-10s " LOG_FMT,
                    av_ts2timestr(pts, &outlink->time_base),
                    loudness_400, loudness_3000,
@@ -868,6 +938,29 @@ static av_cold void uninit(AVFilterContext *ctx)
     int i;
     EBUR128Context *ebur128 = ctx->priv;
 
+    if (ebur128->summary_only) {
+        if (ebur128->i400.nb_kept_powers)
+            update_integrated_loudness(ebur128, GATE_HIST_POS(&ebur128->i400));
+        if (ebur128->i3000.nb_kept_powers)
+            update_loudness_range(ebur128, GATE_HIST_POS(&ebur128->i3000));
+    }
+
+    /* flush the true peak interpolation filter */
+    if ((ebur128->peak_mode & PEAK_MODE_TRUE_PEAKS) &&
+        ebur128->tp_buf && ebur128->true_peaks) {
+        double *buf = ebur128->tp_buf + EBUR128_TP_TAPS - 1;
+
+        for (i = 0; i < ebur128->nb_channels; i++) {
+            const double *history = ebur128->tp_history + i * (EBUR128_TP_TAPS - 1);
+
+            memcpy(ebur128->tp_buf, history, (EBUR128_TP_TAPS - 1) * sizeof(*history));
+            memset(buf, 0, EBUR128_TP_TAPS / 2 * sizeof(*buf));
+            ebur128->true_peaks[i] = FFMAX(ebur128->true_peaks[i],
+                                           ebur128->dsp.true_peak(buf, ebur128->tp_coeffs,
+                                                                  EBUR128_TP_TAPS / 2));
+        }
+    }
+
     /* dual-mono correction */
     if (ebur128->nb_channels == 1 && ebur128->dual_mono) {
         ebur128->i400.rel_threshold -= ebur128->pan_law;
@@ -913,17 +1006,12 @@ static av_cold void uninit(AVFilterContext *ctx)
     av_freep(&ebur128->true_peaks_per_frame);
     av_freep(&ebur128->i400.histogram);
     av_freep(&ebur128->i3000.histogram);
-    for (i = 0; i < ebur128->nb_channels; i++) {
-        av_freep(&ebur128->i400.cache[i]);
-        av_freep(&ebur128->i3000.cache[i]);
-    }
+    av_freep(&ebur128->i400.cache);
+    av_freep(&ebur128->i3000.cache);
     for (i = 0; i < ctx->nb_outputs; i++)
         av_freep(&ctx->output_pads[i].name);
     av_frame_free(&ebur128->outpicref);
-#if CONFIG_SWRESAMPLE
-    av_freep(&ebur128->swr_buf);
-    swr_free(&ebur128->swr_ctx);
-#endif
+    av_freep(&ebur128->tp_buf);
 }
 
 static const AVFilterPad ebur128_inputs[] = {
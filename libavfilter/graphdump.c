@@ -19,6 +19,7 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include <stdlib.h>
 #include <string.h>
 
 #include "libavutil/channel_layout.h"
@@ -152,15 +153,68 @@ static void avfilter_graph_dump_to_buf(AVBPrint *buf, AVFilterGraph *graph)
     }
 }
 
+static int compare_time(const void *a, const void *b)
+{
+    const AVFilterStats *sa = avfilter_get_stats(*(AVFilterContext * const *)a);
+    const AVFilterStats *sb = avfilter_get_stats(*(AVFilterContext * const *)b);
+    return FFDIFFSIGN(sb->time, sa->time);
+}
+
+static void avfilter_graph_dump_stats_to_buf(AVBPrint *buf, AVFilterGraph *graph,
+                                             AVFilterContext **sorted)
+{
+    int64_t total = 0;
+    unsigned i;
+
+    for (i = 0; i < graph->nb_filters; i++)
+        total += avfilter_get_stats(graph->filters[i])->time;
+
+    av_bprintf(buf, "%10s %6s %10s %8s %8s %8s %8s  %s\n", "time(ms)", "%",
+               "cpu(ms)", "calls", "in", "out", "buf/frm", "filter");
+    for (i = 0; i < graph->nb_filters; i++) {
+        AVFilterContext *filter = sorted ? sorted[i] : graph->filters[i];
+        const AVFilterStats *stats = avfilter_get_stats(filter);
+
+        av_bprintf(buf, "%10.3f %6.2f ", stats->time / 1000.0,
+                   total ? stats->time * 100.0 / total : 0.0);
+        if (stats->cpu_time >= 0)
+            av_bprintf(buf, "%10.3f ", stats->cpu_time / 1000.0);
+        else
+            av_bprintf(buf, "%10s ", "-");
+        av_bprintf(buf, "%8"PRId64" %8"PRId64" %8"PRId64" ",
+                   stats->nb_calls, stats->nb_frames_in, stats->nb_frames_out);
+        if (stats->nb_frames_out)
+            av_bprintf(buf, "%8.2f ", stats->nb_buffers / (double)stats->nb_frames_out);
+        else
+            av_bprintf(buf, "%8s ", "-");
+        av_bprintf(buf, " %s (%s)\n", filter->name, filter->filter->name);
+    }
+}
+
 char *avfilter_graph_dump(AVFilterGraph *graph, const char *options)
 {
     AVBPrint buf;
     char *dump;
 
+    AVFilterContext **sorted = NULL;
+
+    if (graph->profile && graph->nb_filters) {
+        sorted = av_malloc_array(graph->nb_filters, sizeof(*sorted));
+        if (sorted) {
+            memcpy(sorted, graph->filters, graph->nb_filters * sizeof(*sorted));
+            qsort(sorted, graph->nb_filters, sizeof(*sorted), compare_time);
+        }
+    }
+
     av_bprint_init(&buf, 0, 0);
     avfilter_graph_dump_to_buf(&buf, graph);
+    if (graph->profile)
+        avfilter_graph_dump_stats_to_buf(&buf, graph, sorted);
     av_bprint_init(&buf, buf.len + 1, buf.len + 1);
     avfilter_graph_dump_to_buf(&buf, graph);
+    if (graph->profile)
+        avfilter_graph_dump_stats_to_buf(&buf, graph, sorted);
+    av_freep(&sorted);
     av_bprint_finalize(&buf, &dump);
     return dump;
 }
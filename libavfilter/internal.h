@@ -147,10 +147,18 @@ struct AVFilterPad {
 struct AVFilterGraphInternal {
     void *thread;
     avfilter_execute_func *thread_execute;
+
+    /**
+     * Total time of the profiled callbacks which have returned so far,
+     * used to subtract the time of nested calls from their caller.
+     */
+    int64_t profile_time;
+    int64_t profile_cpu_time;
 };
 
 struct AVFilterInternal {
     avfilter_execute_func *execute;
+    AVFilterStats stats;
 };
 
 /**
@@ -243,6 +251,12 @@ void ff_avfilter_link_set_out_status(AVFilterLink *link, int status, int64_t pts
 
 void ff_command_queue_pop(AVFilterContext *filter);
 
+/**
+ * Count a frame allocated for link in the statistics of its source filter,
+ * if profiling is enabled.
+ */
+void ff_filter_profile_buffer(AVFilterLink *link);
+
 /* misc trace functions */
 
 /* #define FF_AVFILTER_TRACE */
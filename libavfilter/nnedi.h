@@ -0,0 +1,48 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef AVFILTER_NNEDI_H
+#define AVFILTER_NNEDI_H
+
+#include <stdint.h>
+
+typedef struct NNEDIDSPContext {
+    /**
+     * Evaluate the first layer of n neurons on len inputs:
+     * vals[i] = (data . weights[i * len]) * scale[0] + weights[n * len + i]
+     *
+     * n is a multiple of 4 and len a multiple of 16. The weights of each
+     * neuron are aligned to 16 bytes.
+     */
+    void (*dot_prod)(const float *data, const float *weights, float *vals,
+                     int n, int len, const float *scale);
+
+    /**
+     * Same as dot_prod, with int16 inputs and weights. The n * len weights
+     * are followed by a float scale and bias for each neuron, in groups of
+     * four scales followed by the four matching biases:
+     * vals[i] = (data . weights[i * len]) * scale[i] * scale[0] + bias[i]
+     */
+    void (*dot_prod_int16)(const int16_t *data, const int16_t *weights,
+                           float *vals, int n, int len, const float *scale);
+} NNEDIDSPContext;
+
+void ff_nnedi_init_dsp(NNEDIDSPContext *dsp);
+void ff_nnedi_init_dsp_x86(NNEDIDSPContext *dsp);
+
+#endif /* AVFILTER_NNEDI_H */
@@ -0,0 +1,60 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_OVERLAY_H
+#define AVFILTER_OVERLAY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct OverlayDSPContext {
+    /**
+     * Blend w pixels of the overlay plane s onto the main plane d, using
+     * the alpha a of the overlay as is (the main picture has no alpha).
+     * The alpha has the same resolution as the planes.
+     *
+     * @return the number of pixels blended, the caller is responsible
+     *         for blending the remaining w - ret pixels
+     */
+    int (*blend_row_44)(uint8_t *d, const uint8_t *s, const uint8_t *a,
+                        int w, ptrdiff_t alinesize);
+
+    /**
+     * Same as blend_row_44, but for a chroma plane subsampled by 2 in
+     * both directions: the alpha of each pixel is the average of the
+     * 2x2 alpha block at a and a + alinesize.
+     */
+    int (*blend_row_20)(uint8_t *d, const uint8_t *s, const uint8_t *a,
+                        int w, ptrdiff_t alinesize);
+
+    /**
+     * Blend w packed 32-bit pixels of s onto d, both having their alpha
+     * component in the same byte (the last one for blend_row_rgba, the
+     * first one for blend_row_argb) and the color components in the same
+     * order. The alpha of d is composited with the one of s.
+     *
+     * @return the number of pixels blended
+     */
+    int (*blend_row_rgba)(uint8_t *d, const uint8_t *s, int w);
+    int (*blend_row_argb)(uint8_t *d, const uint8_t *s, int w);
+} OverlayDSPContext;
+
+void ff_overlay_init_dsp(OverlayDSPContext *dsp);
+void ff_overlay_init_dsp_x86(OverlayDSPContext *dsp);
+
+#endif /* AVFILTER_OVERLAY_H */
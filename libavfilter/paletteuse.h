@@ -0,0 +1,46 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_PALETTEUSE_H
+#define AVFILTER_PALETTEUSE_H
+
+#include <stdint.h>
+
+#include "libavutil/pixfmt.h"
+
+typedef struct PaletteUseDSPContext {
+    /**
+     * Find the color of the palette nearest to (r, g, b).
+     *
+     * pal holds, in this order, the red, green and blue components of the
+     * candidate colors and their index in the palette, as 4 planes of
+     * AVPALETTE_COUNT entries aligned on 32 bytes. n is the number of
+     * candidates, a multiple of 16.
+     *
+     * @return (d << 8 | i), d being the smallest squared euclidean distance
+     *         to a candidate, and i the smallest palette index of the
+     *         candidates at that distance; UINT32_MAX if n is 0
+     */
+    uint32_t (*nearest_color)(const int32_t (*pal)[AVPALETTE_COUNT], int n,
+                              int r, int g, int b);
+} PaletteUseDSPContext;
+
+void ff_paletteuse_init_dsp(PaletteUseDSPContext *dsp);
+void ff_paletteuse_init_dsp_x86(PaletteUseDSPContext *dsp);
+
+#endif /* AVFILTER_PALETTEUSE_H */
@@ -28,6 +28,13 @@ typedef struct PSNRDSPContext {
     uint64_t (*sse_line)(const uint8_t *buf, const uint8_t *ref, int w);
 } PSNRDSPContext;
 
+/**
+ * Get the PSNR in dB of nb_frames frames of total mean squared error mse,
+ * for a maximum sample value max.
+ */
+double ff_psnr_get(double mse, uint64_t nb_frames, int max);
+
+void ff_psnr_init(PSNRDSPContext *dsp, int bpp);
 void ff_psnr_init_x86(PSNRDSPContext *dsp, int bpp);
 
 #endif /* AVFILTER_PSNR_H */
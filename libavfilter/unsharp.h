@@ -57,6 +57,33 @@ typedef struct {
 
 #endif
 
+typedef struct UnsharpDSPContext {
+    /**
+     * Apply nb_stages 2-tap sums to the w elements of h, the input of each
+     * stage being the output of the previous one: h[x] = h[x] + h[x - 1].
+     * h[-1] is 0 and is never written. w is a multiple of 8.
+     */
+    void (*hsum)(uint32_t *h, int nb_stages, int w);
+
+    /**
+     * Same as hsum, but along the columns: the previous element of each
+     * stage is the input of that stage for the previous row, kept in the
+     * row sc + z * stride for stage z. h is 32-byte aligned, and so are
+     * the rows of sc.
+     */
+    void (*vsum)(uint32_t *h, uint32_t *sc, ptrdiff_t stride, int nb_stages, int w);
+
+    /**
+     * Sharpen or blur w pixels of src using their blurred value:
+     * dst[x] = av_clip_uint8(src[x] + ((src[x] - ((blur[x] + (1 << (scalebits - 1))) >> scalebits)) * amount >> 16))
+     *
+     * @return the number of pixels processed, the caller is responsible
+     *         for the remaining w - ret pixels
+     */
+    int (*blend)(uint8_t *dst, const uint8_t *src, const uint32_t *blur,
+                 int w, int amount, int scalebits);
+} UnsharpDSPContext;
+
 typedef struct UnsharpFilterParam {
     int msize_x;                             ///< matrix width
     int msize_y;                             ///< matrix height
@@ -65,7 +92,8 @@ typedef struct UnsharpFilterParam {
     int steps_y;                             ///< vertical step count
     int scalebits;                           ///< bits to shift pixel
     int32_t halfscale;                       ///< amount to add to pixel
-    uint32_t *sc[MAX_MATRIX_SIZE - 1];       ///< finite state machine storage
+    uint32_t *sc;                            ///< finite state machine storage, for each thread
+    int sc_stride;                           ///< elements in a row of sc
 } UnsharpFilterParam;
 
 typedef struct UnsharpContext {
@@ -76,10 +104,15 @@ typedef struct UnsharpContext {
     UnsharpFilterParam chroma; ///< chroma parameters (width, height, amount)
     int hsub, vsub;
     int opencl;
+    int nb_threads;
+    UnsharpDSPContext dsp;
 #if CONFIG_OPENCL
     UnsharpOpenclContext opencl_ctx;
 #endif
     int (* apply_unsharp)(AVFilterContext *ctx, AVFrame *in, AVFrame *out);
 } UnsharpContext;
 
+void ff_unsharp_init_dsp(UnsharpDSPContext *dsp);
+void ff_unsharp_init_dsp_x86(UnsharpDSPContext *dsp);
+
 #endif /* AVFILTER_UNSHARP_H */
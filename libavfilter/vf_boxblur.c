@@ -25,12 +25,15 @@
  * Ported from MPlayer libmpcodecs/vf_boxblur.c.
  */
 
+#include "config.h"
+
 #include "libavutil/avstring.h"
 #include "libavutil/common.h"
 #include "libavutil/eval.h"
 #include "libavutil/opt.h"
 #include "libavutil/pixdesc.h"
 #include "avfilter.h"
+#include "boxblur.h"
 #include "formats.h"
 #include "internal.h"
 #include "video.h"
@@ -70,7 +73,13 @@ typedef struct BoxBlurContext {
     int hsub, vsub;
     int radius[4];
     int power[4];
-    uint8_t *temp[2]; ///< temporary buffer used in blur_power()
+    int nb_threads;
+    int temp_size;    ///< size of temp for each thread
+    uint8_t *temp[2]; ///< temporary buffers used in blur_power(), for each thread
+    int band_width;   ///< maximum width of the columns blurred by a thread
+    uint8_t *vtemp;   ///< temporary planes used in vblur(), for each thread
+    int32_t *sum;     ///< running sums used in vblur(), for each thread
+    BoxBlurDSPContext dsp;
 } BoxBlurContext;
 
 #define Y 0
@@ -104,6 +113,8 @@ static av_cold int init(AVFilterContext *ctx)
     if (s->alpha_param.power < 0)
         s->alpha_param.power = s->luma_param.power;
 
+    ff_boxblur_init_dsp(&s->dsp);
+
     return 0;
 }
 
@@ -113,6 +124,8 @@ static av_cold void uninit(AVFilterContext *ctx)
 
     av_freep(&s->temp[0]);
     av_freep(&s->temp[1]);
+    av_freep(&s->vtemp);
+    av_freep(&s->sum);
 }
 
 static int query_formats(AVFilterContext *ctx)
@@ -139,12 +152,19 @@ static int config_input(AVFilterLink *inlink)
     BoxBlurContext *s = ctx->priv;
     int w = inlink->w, h = inlink->h;
     int cw, ch;
+    const int pixsize = (desc->comp[0].depth + 7) / 8;
     double var_values[VARS_NB], res;
     char *expr;
     int ret;
 
-    if (!(s->temp[0] = av_malloc(2*FFMAX(w, h))) ||
-        !(s->temp[1] = av_malloc(2*FFMAX(w, h))))
+    s->nb_threads = FFMAX(1, ctx->graph->nb_threads);
+    s->temp_size  = 2*FFMAX(w, h);
+    s->band_width = (w + s->nb_threads - 1) / s->nb_threads;
+
+    if (!(s->temp[0] = av_malloc_array(s->nb_threads, s->temp_size)) ||
+        !(s->temp[1] = av_malloc_array(s->nb_threads, s->temp_size)) ||
+        !(s->vtemp   = av_malloc_array(s->nb_threads, 2 * h * s->band_width * pixsize)) ||
+        !(s->sum     = av_malloc_array(s->nb_threads * s->band_width, sizeof(*s->sum))))
         return AVERROR(ENOMEM);
 
     s->hsub = desc->log2_chroma_w;
@@ -306,17 +326,146 @@ static void hblur(uint8_t *dst, int dst_linesize, const uint8_t *src, int src_li
                    w, radius, power, temp, pixsize);
 }
 
-static void vblur(uint8_t *dst, int dst_linesize, const uint8_t *src, int src_linesize,
-                  int w, int h, int radius, int power, uint8_t *temp[2], int pixsize)
+static int vblur_row_c(uint8_t *dst, int32_t *sum, const uint8_t *add,
+                       const uint8_t *sub, int w, int inv)
 {
     int x;
 
-    if (radius == 0 && dst == src)
+    for (x = 0; x < w; x++) {
+        sum[x] += (add[x] - sub[x]) * inv;
+        dst[x] = sum[x] >> 16;
+    }
+    return w;
+}
+
+void ff_boxblur_init_dsp(BoxBlurDSPContext *dsp)
+{
+    dsp->vblur_row = vblur_row_c;
+
+    if (ARCH_X86)
+        ff_boxblur_init_dsp_x86(dsp);
+}
+
+/* The same as blur() on the w columns of the len rows of src, moving the
+ * box down all the columns at once. */
+#define BLUR_ROWS(type, depth)                                              \
+static void blur_rows ## depth(const BoxBlurDSPContext *dsp,                \
+                               uint8_t *dst, int dst_linesize,              \
+                               const uint8_t *src, int src_linesize,        \
+                               int w, int len, int radius, int32_t *sum)    \
+{                                                                           \
+    const int length = radius*2 + 1;                                        \
+    const int inv = ((1<<16) + length/2)/length;                            \
+    int x, y;                                                               \
+                                                                            \
+    for (x = 0; x < w; x++)                                                 \
+        sum[x] = ((const type *)(src + radius*src_linesize))[x];            \
+    for (y = 0; y < radius; y++)                                            \
+        for (x = 0; x < w; x++)                                             \
+            sum[x] += ((const type *)(src + y*src_linesize))[x]<<1;         \
+    for (x = 0; x < w; x++)                                                 \
+        sum[x] = sum[x]*inv + (1<<15);                                      \
+                                                                            \
+    /* a radius of len/2 moves the box one row past the end */             \
+    for (y = 0; y < len; y++) {                                             \
+        int add = y <= radius || y < len-radius ? radius+y : 2*len-radius-y-1; \
+        int sub = y <= radius ? radius-y : y-radius-1;                      \
+        const type *a = (const type *)(src + FFMIN(add, len-1)*src_linesize); \
+        const type *b = (const type *)(src + sub*src_linesize);             \
+        type *d = (type *)(dst + y*dst_linesize);                           \
+                                                                            \
+        x = depth == 8 ? dsp->vblur_row((uint8_t *)d, sum, (const uint8_t *)a, \
+                                        (const uint8_t *)b, w, inv) : 0;    \
+        for (; x < w; x++) {                                                \
+            sum[x] += (a[x] - b[x])*inv;                                    \
+            d[x] = sum[x]>>16;                                              \
+        }                                                                   \
+    }                                                                       \
+}
+
+BLUR_ROWS(uint8_t,   8)
+BLUR_ROWS(uint16_t, 16)
+
+#undef BLUR_ROWS
+
+/* blur_power() on the w columns of a plane, in place */
+static void vblur(BoxBlurContext *s, uint8_t *dst, int dst_linesize,
+                  int w, int h, int radius, int power, int jobnr, int pixsize)
+{
+    const int temp_linesize = s->band_width * pixsize;
+    uint8_t *temp[2], *src = dst;
+    int src_linesize = dst_linesize;
+    int32_t *sum = s->sum + jobnr * s->band_width;
+    int i, y;
+
+    if (!radius || !power || !w)
         return;
 
-    for (x = 0; x < w; x++)
-        blur_power(dst + x*pixsize, dst_linesize, src + x*pixsize, src_linesize,
-                   h, radius, power, temp, pixsize);
+    temp[0] = s->vtemp + jobnr * 2 * h * temp_linesize;
+    temp[1] = temp[0] + h * temp_linesize;
+
+    for (i = 0; i < power; i++) {
+        uint8_t *d = i && i == power - 1 ? dst : temp[i & 1];
+        int d_linesize = d == dst ? dst_linesize : temp_linesize;
+
+        if (pixsize == 1)
+            blur_rows8 (&s->dsp, d, d_linesize, src, src_linesize, w, h, radius, sum);
+        else
+            blur_rows16(&s->dsp, d, d_linesize, src, src_linesize, w, h, radius, sum);
+        src          = d;
+        src_linesize = d_linesize;
+    }
+
+    if (power == 1)
+        for (y = 0; y < h; y++)
+            memcpy(dst + y*dst_linesize, temp[0] + y*temp_linesize, w * pixsize);
+}
+
+typedef struct ThreadData {
+    AVFrame *in, *out;
+    int w[4], h[4];
+    int pixsize;
+} ThreadData;
+
+static int hblur_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    BoxBlurContext *s = ctx->priv;
+    ThreadData *td = arg;
+    AVFrame *in = td->in, *out = td->out;
+    uint8_t *temp[2] = { s->temp[0] + jobnr * s->temp_size,
+                         s->temp[1] + jobnr * s->temp_size };
+    int plane;
+
+    for (plane = 0; plane < 4 && in->data[plane] && in->linesize[plane]; plane++) {
+        const int slice_start = (td->h[plane] *  jobnr     ) / nb_jobs;
+        const int slice_end   = (td->h[plane] * (jobnr + 1)) / nb_jobs;
+
+        hblur(out->data[plane] + slice_start * out->linesize[plane], out->linesize[plane],
+              in ->data[plane] + slice_start * in ->linesize[plane], in ->linesize[plane],
+              td->w[plane], slice_end - slice_start, s->radius[plane], s->power[plane],
+              temp, td->pixsize);
+    }
+
+    return 0;
+}
+
+static int vblur_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    BoxBlurContext *s = ctx->priv;
+    ThreadData *td = arg;
+    AVFrame *out = td->out;
+    int plane;
+
+    for (plane = 0; plane < 4 && out->data[plane] && out->linesize[plane]; plane++) {
+        const int slice_start = (td->w[plane] *  jobnr     ) / nb_jobs;
+        const int slice_end   = (td->w[plane] * (jobnr + 1)) / nb_jobs;
+
+        vblur(s, out->data[plane] + slice_start * td->pixsize, out->linesize[plane],
+              slice_end - slice_start, td->h[plane], s->radius[plane], s->power[plane],
+              jobnr, td->pixsize);
+    }
+
+    return 0;
 }
 
 static int filter_frame(AVFilterLink *inlink, AVFrame *in)
@@ -325,13 +474,10 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
     BoxBlurContext *s = ctx->priv;
     AVFilterLink *outlink = inlink->dst->outputs[0];
     AVFrame *out;
-    int plane;
+    ThreadData td;
     int cw = AV_CEIL_RSHIFT(inlink->w, s->hsub), ch = AV_CEIL_RSHIFT(in->height, s->vsub);
-    int w[4] = { inlink->w, cw, cw, inlink->w };
-    int h[4] = { in->height, ch, ch, in->height };
     const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(inlink->format);
     const int depth = desc->comp[0].depth;
-    const int pixsize = (depth+7)/8;
 
     out = ff_get_video_buffer(outlink, outlink->w, outlink->h);
     if (!out) {
@@ -340,17 +486,18 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
     }
     av_frame_copy_props(out, in);
 
-    for (plane = 0; plane < 4 && in->data[plane] && in->linesize[plane]; plane++)
-        hblur(out->data[plane], out->linesize[plane],
-              in ->data[plane], in ->linesize[plane],
-              w[plane], h[plane], s->radius[plane], s->power[plane],
-              s->temp, pixsize);
+    td.in  = in;
+    td.out = out;
+    td.w[0] = td.w[3] = inlink->w;
+    td.w[1] = td.w[2] = cw;
+    td.h[0] = td.h[3] = in->height;
+    td.h[1] = td.h[2] = ch;
+    td.pixsize = (depth+7)/8;
 
-    for (plane = 0; plane < 4 && in->data[plane] && in->linesize[plane]; plane++)
-        vblur(out->data[plane], out->linesize[plane],
-              out->data[plane], out->linesize[plane],
-              w[plane], h[plane], s->radius[plane], s->power[plane],
-              s->temp, pixsize);
+    /* the rows are blurred before the columns, each pass in slices of
+     * its own direction */
+    ctx->internal->execute(ctx, hblur_slice, &td, NULL, s->nb_threads);
+    ctx->internal->execute(ctx, vblur_slice, &td, NULL, s->nb_threads);
 
     av_frame_free(&in);
 
@@ -409,5 +556,5 @@ AVFilter ff_vf_boxblur = {
     .query_formats = query_formats,
     .inputs        = avfilter_vf_boxblur_inputs,
     .outputs       = avfilter_vf_boxblur_outputs,
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -19,11 +19,14 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include "config.h"
+
 #include "libavutil/avstring.h"
 #include "libavutil/imgutils.h"
 #include "libavutil/opt.h"
 #include "libavutil/pixdesc.h"
 #include "avfilter.h"
+#include "convolution.h"
 #include "formats.h"
 #include "internal.h"
 #include "video.h"
@@ -35,8 +38,6 @@ typedef struct ConvolutionContext {
     float rdiv[4];
     float bias[4];
 
-    int bstride;
-    uint8_t *buffer;
     int nb_planes;
     int planewidth[4];
     int planeheight[4];
@@ -44,7 +45,7 @@ typedef struct ConvolutionContext {
     int matrix_length[4];
     int copy[4];
 
-    void (*filter[4])(struct ConvolutionContext *s, AVFrame *in, AVFrame *out, int plane);
+    ConvolutionDSPContext dsp;
 } ConvolutionContext;
 
 #define OFFSET(x) offsetof(ConvolutionContext, x)
@@ -108,134 +109,139 @@ static int config_input(AVFilterLink *inlink)
 
     s->nb_planes = av_pix_fmt_count_planes(inlink->format);
 
-    s->bstride = s->planewidth[0] + 32;
-    s->buffer = av_malloc(5 * s->bstride);
-    if (!s->buffer)
-        return AVERROR(ENOMEM);
-
     return 0;
 }
 
-static inline void line_copy8(uint8_t *line, const uint8_t *srcp, int width, int mergin)
+typedef struct ThreadData {
+    AVFrame *in, *out;
+} ThreadData;
+
+static inline int mirror(int x, int w)
 {
-    int i;
+    if (x < 0)
+        x = -x;
+    else if (x >= w)
+        x = 2 * w - 2 - x;
+    return av_clip(x, 0, w - 1);
+}
 
-    memcpy(line, srcp, width);
+static av_always_inline int filter_row(uint8_t *dst, int w, const int *matrix,
+                                       const uint8_t *const *c,
+                                       float rdiv, float bias, int taps)
+{
+    int x, i;
+
+    for (x = 0; x < w; x++) {
+        int sum = 0;
 
-    for (i = mergin; i > 0; i--) {
-        line[-i] = line[i];
-        line[width - 1 + i] = line[width - 1 - i];
+        for (i = 0; i < taps; i++)
+            sum += c[i][x] * matrix[i];
+        sum = (int)(sum * rdiv + bias + 0.5f);
+        dst[x] = av_clip_uint8(sum);
     }
+    return w;
 }
 
-static void filter_3x3(ConvolutionContext *s, AVFrame *in, AVFrame *out, int plane)
+static int filter_3x3_c(uint8_t *dst, int w, const int *matrix,
+                        const uint8_t *const *c, float rdiv, float bias)
 {
-    const uint8_t *src = in->data[plane];
-    uint8_t *dst = out->data[plane];
-    const int stride = in->linesize[plane];
-    const int bstride = s->bstride;
-    const int height = s->planeheight[plane];
-    const int width  = s->planewidth[plane];
-    uint8_t *p0 = s->buffer + 16;
-    uint8_t *p1 = p0 + bstride;
-    uint8_t *p2 = p1 + bstride;
-    uint8_t *orig = p0, *end = p2;
-    const int *matrix = s->matrix[plane];
-    const float rdiv = s->rdiv[plane];
-    const float bias = s->bias[plane];
-    int y, x;
-
-    line_copy8(p0, src + stride, width, 1);
-    line_copy8(p1, src, width, 1);
-
-    for (y = 0; y < height; y++) {
-        src += stride * (y < height - 1 ? 1 : -1);
-        line_copy8(p2, src, width, 1);
-
-        for (x = 0; x < width; x++) {
-            int sum = p0[x - 1] * matrix[0] +
-                      p0[x] *     matrix[1] +
-                      p0[x + 1] * matrix[2] +
-                      p1[x - 1] * matrix[3] +
-                      p1[x] *     matrix[4] +
-                      p1[x + 1] * matrix[5] +
-                      p2[x - 1] * matrix[6] +
-                      p2[x] *     matrix[7] +
-                      p2[x + 1] * matrix[8];
-            sum = (int)(sum * rdiv + bias + 0.5f);
-            dst[x] = av_clip_uint8(sum);
-        }
+    return filter_row(dst, w, matrix, c, rdiv, bias, 9);
+}
 
-        p0 = p1;
-        p1 = p2;
-        p2 = (p2 == end) ? orig: p2 + bstride;
-        dst += out->linesize[plane];
-    }
+static int filter_5x5_c(uint8_t *dst, int w, const int *matrix,
+                        const uint8_t *const *c, float rdiv, float bias)
+{
+    return filter_row(dst, w, matrix, c, rdiv, bias, 25);
 }
 
-static void filter_5x5(ConvolutionContext *s, AVFrame *in, AVFrame *out, int plane)
+void ff_convolution_init_dsp(ConvolutionDSPContext *dsp)
 {
-    const uint8_t *src = in->data[plane];
-    uint8_t *dst = out->data[plane];
-    const int stride = in->linesize[plane];
-    const int bstride = s->bstride;
-    const int height = s->planeheight[plane];
-    const int width  = s->planewidth[plane];
-    uint8_t *p0 = s->buffer + 16;
-    uint8_t *p1 = p0 + bstride;
-    uint8_t *p2 = p1 + bstride;
-    uint8_t *p3 = p2 + bstride;
-    uint8_t *p4 = p3 + bstride;
-    uint8_t *orig = p0, *end = p4;
-    const int *matrix = s->matrix[plane];
-    float rdiv = s->rdiv[plane];
-    float bias = s->bias[plane];
-    int y, x, i;
-
-    line_copy8(p0, src + 2 * stride, width, 2);
-    line_copy8(p1, src + stride, width, 2);
-    line_copy8(p2, src, width, 2);
-    src += stride;
-    line_copy8(p3, src, width, 2);
-
-
-    for (y = 0; y < height; y++) {
-        uint8_t *array[] = {
-            p0 - 2, p0 - 1, p0, p0 + 1, p0 + 2,
-            p1 - 2, p1 - 1, p1, p1 + 1, p1 + 2,
-            p2 - 2, p2 - 1, p2, p2 + 1, p2 + 2,
-            p3 - 2, p3 - 1, p3, p3 + 1, p3 + 2,
-            p4 - 2, p4 - 1, p4, p4 + 1, p4 + 2
-        };
-
-        src += stride * (y < height - 2 ? 1 : -1);
-        line_copy8(p4, src, width, 2);
-
-        for (x = 0; x < width; x++) {
-            int sum = 0;
-
-            for (i = 0; i < 25; i++) {
-                sum += *(array[i] + x) * matrix[i];
-            }
-            sum = (int)(sum * rdiv + bias + 0.5f);
-            dst[x] = av_clip_uint8(sum);
+    dsp->filter_3x3 = filter_3x3_c;
+    dsp->filter_5x5 = filter_5x5_c;
+
+    if (ARCH_X86)
+        ff_convolution_init_dsp_x86(dsp);
+}
+
+/* filter one pixel of the row, mirroring the columns out of the picture */
+static uint8_t filter_pixel(const uint8_t *const *rows, int x, int width,
+                            int radius, const int *matrix, float rdiv, float bias)
+{
+    const int size = 2 * radius + 1;
+    int sum = 0, i, j;
+
+    for (i = 0; i < size; i++)
+        for (j = 0; j < size; j++)
+            sum += rows[i][mirror(x + j - radius, width)] * matrix[i * size + j];
+    sum = (int)(sum * rdiv + bias + 0.5f);
+    return av_clip_uint8(sum);
+}
+
+static int filter_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    ConvolutionContext *s = ctx->priv;
+    ThreadData *td = arg;
+    AVFrame *in = td->in;
+    AVFrame *out = td->out;
+    int plane;
+
+    for (plane = 0; plane < s->nb_planes; plane++) {
+        const int height = s->planeheight[plane];
+        const int width  = s->planewidth[plane];
+        const int stride = in->linesize[plane];
+        const int slice_start = (height *  jobnr     ) / nb_jobs;
+        const int slice_end   = (height * (jobnr + 1)) / nb_jobs;
+        const int radius = s->matrix_length[plane] == 25 ? 2 : 1;
+        const int size = 2 * radius + 1;
+        /* the columns filtered without mirroring */
+        const int x0 = FFMIN(radius, width);
+        const int x1 = FFMAX(width - radius, x0);
+        const int *matrix = s->matrix[plane];
+        const float rdiv = s->rdiv[plane];
+        const float bias = s->bias[plane];
+        int (*filter)(uint8_t *dst, int w, const int *matrix,
+                      const uint8_t *const *c, float rdiv, float bias) =
+            radius == 2 ? s->dsp.filter_5x5 : s->dsp.filter_3x3;
+        uint8_t *dst = out->data[plane] + slice_start * out->linesize[plane];
+        int x, y, i, j;
+
+        if (s->copy[plane]) {
+            av_image_copy_plane(dst, out->linesize[plane],
+                                in->data[plane] + slice_start * stride, stride,
+                                width, slice_end - slice_start);
+            continue;
         }
 
-        p0 = p1;
-        p1 = p2;
-        p2 = p3;
-        p3 = p4;
-        p4 = (p4 == end) ? orig: p4 + bstride;
-        dst += out->linesize[plane];
+        for (y = slice_start; y < slice_end; y++) {
+            const uint8_t *rows[5];
+            const uint8_t *c[25];
+
+            for (i = 0; i < size; i++)
+                rows[i] = in->data[plane] + mirror(y + i - radius, height) * stride;
+            for (i = 0; i < size; i++)
+                for (j = 0; j < size; j++)
+                    c[i * size + j] = rows[i] + x0 + j - radius;
+
+            for (x = 0; x < x0; x++)
+                dst[x] = filter_pixel(rows, x, width, radius, matrix, rdiv, bias);
+            x += filter(dst + x, x1 - x, matrix, c, rdiv, bias);
+            for (; x < width; x++)
+                dst[x] = filter_pixel(rows, x, width, radius, matrix, rdiv, bias);
+
+            dst += out->linesize[plane];
+        }
     }
+
+    return 0;
 }
 
 static int filter_frame(AVFilterLink *inlink, AVFrame *in)
 {
-    ConvolutionContext *s = inlink->dst->priv;
-    AVFilterLink *outlink = inlink->dst->outputs[0];
+    AVFilterContext *ctx = inlink->dst;
+    ConvolutionContext *s = ctx->priv;
+    AVFilterLink *outlink = ctx->outputs[0];
+    ThreadData td;
     AVFrame *out;
-    int plane;
 
     out = ff_get_video_buffer(outlink, outlink->w, outlink->h);
     if (!out) {
@@ -244,17 +250,10 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
     }
     av_frame_copy_props(out, in);
 
-    for (plane = 0; plane < s->nb_planes; plane++) {
-        if (s->copy[plane]) {
-            av_image_copy_plane(out->data[plane], out->linesize[plane],
-                                in->data[plane], in->linesize[plane],
-                                s->planewidth[plane],
-                                s->planeheight[plane]);
-            continue;
-        }
-
-        s->filter[plane](s, in, out, plane);
-    }
+    td.in  = in;
+    td.out = out;
+    ctx->internal->execute(ctx, filter_slice, &td, NULL,
+                           FFMIN(s->planeheight[1], ctx->graph->nb_threads));
 
     av_frame_free(&in);
     return ff_filter_frame(outlink, out);
@@ -282,26 +281,17 @@ static av_cold int init(AVFilterContext *ctx)
         if (s->matrix_length[i] == 9) {
             if (!memcmp(matrix, same3x3, sizeof(same3x3)))
                 s->copy[i] = 1;
-            else
-                s->filter[i] = filter_3x3;
         } else if (s->matrix_length[i] == 25) {
             if (!memcmp(matrix, same5x5, sizeof(same5x5)))
                 s->copy[i] = 1;
-            else
-                s->filter[i] = filter_5x5;
         } else {
             return AVERROR(EINVAL);
         }
     }
 
-    return 0;
-}
+    ff_convolution_init_dsp(&s->dsp);
 
-static av_cold void uninit(AVFilterContext *ctx)
-{
-    ConvolutionContext *s = ctx->priv;
-
-    av_freep(&s->buffer);
+    return 0;
 }
 
 static const AVFilterPad convolution_inputs[] = {
@@ -328,9 +318,8 @@ AVFilter ff_vf_convolution = {
     .priv_size     = sizeof(ConvolutionContext),
     .priv_class    = &convolution_class,
     .init          = init,
-    .uninit        = uninit,
     .query_formats = query_formats,
     .inputs        = convolution_inputs,
     .outputs       = convolution_outputs,
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_SLICE_THREADS,
 };
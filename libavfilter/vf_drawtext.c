@@ -134,6 +134,15 @@ enum expansion_mode {
     EXP_STRFTIME,
 };
 
+/**
+ * A glyph of the text, positioned relative to the text origin.
+ */
+typedef struct TextGlyph {
+    uint32_t code;
+    struct Glyph *glyph;
+    int x, y;                       ///< position of the glyph bitmap
+} TextGlyph;
+
 typedef struct DrawTextContext {
     const AVClass *class;
     int exp_mode;                   ///< expansion mode to use for the text
@@ -174,6 +183,17 @@ typedef struct DrawTextContext {
     FT_Face face;                   ///< freetype font face handle
     FT_Stroker stroker;             ///< freetype stroker handle
     struct AVTreeNode *glyphs;      ///< rendered glyphs, stored using the UTF-32 char code
+    AVBPrint cached_text;           ///< expanded text of the cached layout and masks
+    int text_cached;                ///< tells if the cached layout and masks are valid
+    TextGlyph *layout;              ///< glyphs of the text being laid out
+    TextGlyph *prev_layout;         ///< glyphs rendered in the cached masks
+    unsigned layout_size, prev_layout_size;
+    int nb_layout, nb_prev_layout;
+    uint8_t *text_mask;             ///< cached 8 bits mask of the text
+    uint8_t *border_mask;           ///< cached 8 bits mask of the text border
+    unsigned text_mask_size, border_mask_size;
+    int mask_x, mask_y;             ///< position of the masks relative to the text
+    int mask_w, mask_h;             ///< size of the masks, also their linesize
     char *x_expr;                   ///< expression for x position
     char *y_expr;                   ///< expression for y position
     AVExpr *x_pexpr, *y_pexpr;      ///< parsed expressions for x and y
@@ -682,6 +702,7 @@ static av_cold int init(AVFilterContext *ctx)
 
     av_bprint_init(&s->expanded_text, 0, AV_BPRINT_SIZE_UNLIMITED);
     av_bprint_init(&s->expanded_fontcolor, 0, AV_BPRINT_SIZE_UNLIMITED);
+    av_bprint_init(&s->cached_text, 0, AV_BPRINT_SIZE_UNLIMITED);
 
     return 0;
 }
@@ -711,6 +732,15 @@ static av_cold void uninit(AVFilterContext *ctx)
     av_freep(&s->positions);
     s->nb_positions = 0;
 
+    av_freep(&s->layout);
+    av_freep(&s->prev_layout);
+    s->layout_size = s->prev_layout_size = 0;
+    s->nb_layout = s->nb_prev_layout = 0;
+    av_freep(&s->text_mask);
+    av_freep(&s->border_mask);
+    s->text_mask_size = s->border_mask_size = 0;
+    s->mask_w = s->mask_h = 0;
+    s->text_cached = 0;
 
     av_tree_enumerate(s->glyphs, NULL, NULL, glyph_enu_free);
     av_tree_destroy(s->glyphs);
@@ -722,6 +752,7 @@ static av_cold void uninit(AVFilterContext *ctx)
 
     av_bprint_finalize(&s->expanded_text, NULL);
     av_bprint_finalize(&s->expanded_fontcolor, NULL);
+    av_bprint_finalize(&s->cached_text, NULL);
 }
 
 static int config_input(AVFilterLink *inlink)
@@ -1070,50 +1101,142 @@ static int expand_text(AVFilterContext *ctx, char *text, AVBPrint *bp)
     return 0;
 }
 
-static int draw_glyphs(DrawTextContext *s, AVFrame *frame,
-                       int width, int height,
-                       FFDrawColor *color,
-                       int x, int y, int borderw)
+static void get_glyph_box(DrawTextContext *s, const TextGlyph *g, int box[4])
 {
-    char *text = s->expanded_text.str;
-    uint32_t code = 0;
-    int i, x1, y1;
-    uint8_t *p;
-    Glyph *glyph = NULL;
-
-    for (i = 0, p = text; *p; i++) {
-        FT_Bitmap bitmap;
-        Glyph dummy = { 0 };
-        GET_UTF8(code, *p++, continue;);
-
-        /* skip new line chars, just go to new line */
-        if (code == '\n' || code == '\r' || code == '\t')
-            continue;
+    const FT_Bitmap *bitmap = &g->glyph->bitmap;
 
-        dummy.code = code;
-        glyph = av_tree_find(s->glyphs, &dummy, glyph_cmp, NULL);
+    box[0] = g->x;
+    box[1] = g->y;
+    box[2] = g->x + (int)bitmap->width;
+    box[3] = g->y + (int)bitmap->rows;
+    if (s->borderw) {
+        bitmap = &g->glyph->border_bitmap;
+        box[0] = FFMIN(box[0], g->x - s->borderw);
+        box[1] = FFMIN(box[1], g->y - s->borderw);
+        box[2] = FFMAX(box[2], g->x - s->borderw + (int)bitmap->width);
+        box[3] = FFMAX(box[3], g->y - s->borderw + (int)bitmap->rows);
+    }
+}
 
-        bitmap = borderw ? glyph->border_bitmap : glyph->bitmap;
+static void merge_box(int dst[4], const int box[4])
+{
+    dst[0] = FFMIN(dst[0], box[0]);
+    dst[1] = FFMIN(dst[1], box[1]);
+    dst[2] = FFMAX(dst[2], box[2]);
+    dst[3] = FFMAX(dst[3], box[3]);
+}
 
-        if (glyph->bitmap.pixel_mode != FT_PIXEL_MODE_MONO &&
-            glyph->bitmap.pixel_mode != FT_PIXEL_MODE_GRAY)
-            return AVERROR(EINVAL);
+/**
+ * Draw the part of a glyph bitmap at (x, y) inside clip into an 8 bits
+ * mask. Where glyphs overlap, the coverages are combined the same way as
+ * blending the glyphs one after the other.
+ */
+static void blit_glyph(uint8_t *mask, int linesize, const FT_Bitmap *bitmap,
+                       int x, int y, const int clip[4])
+{
+    int x0 = FFMAX(clip[0] - x, 0), x1 = FFMIN(clip[2] - x, (int)bitmap->width);
+    int y0 = FFMAX(clip[1] - y, 0), y1 = FFMIN(clip[3] - y, (int)bitmap->rows);
+    int i, j;
+
+    for (j = y0; j < y1; j++) {
+        const uint8_t *src = bitmap->buffer + j * bitmap->pitch;
+        uint8_t *dst = mask + (y + j) * linesize + x;
+
+        for (i = x0; i < x1; i++) {
+            int v = bitmap->pixel_mode == FT_PIXEL_MODE_MONO ?
+                    (src[i >> 3] >> (~i & 7) & 1) * 255 : src[i];
+            dst[i] += v - (dst[i] * v + 127) / 255;
+        }
+    }
+}
 
-        x1 = s->positions[i].x+s->x+x - borderw;
-        y1 = s->positions[i].y+s->y+y - borderw;
+/**
+ * Render the glyphs of the layout into the cached text and border masks.
+ * If the masks keep their geometry, only the area covered by the glyphs
+ * following the first one which changed is rendered again.
+ */
+static int update_text_masks(DrawTextContext *s)
+{
+    int bbox[4] = { INT_MAX, INT_MAX, INT_MIN, INT_MIN };
+    int dirty[4] = { INT_MAX, INT_MAX, INT_MIN, INT_MIN };
+    int box[4];
+    int i, y, w, h;
+    TextGlyph *tmp;
+    unsigned tmp_size;
+
+    for (i = 0; i < s->nb_layout; i++) {
+        get_glyph_box(s, &s->layout[i], box);
+        merge_box(bbox, box);
+    }
+    w = FFMAX(bbox[2] - bbox[0], 0);
+    h = FFMAX(bbox[3] - bbox[1], 0);
+
+    if (s->text_mask && s->mask_x == bbox[0] && s->mask_y == bbox[1] &&
+        s->mask_w == w && s->mask_h == h) {
+        for (i = 0; i < s->nb_layout && i < s->nb_prev_layout; i++)
+            if (s->layout[i].code != s->prev_layout[i].code ||
+                s->layout[i].x    != s->prev_layout[i].x    ||
+                s->layout[i].y    != s->prev_layout[i].y)
+                break;
+        for (y = i; y < s->nb_layout; y++) {
+            get_glyph_box(s, &s->layout[y], box);
+            merge_box(dirty, box);
+        }
+        for (y = i; y < s->nb_prev_layout; y++) {
+            get_glyph_box(s, &s->prev_layout[y], box);
+            merge_box(dirty, box);
+        }
+    } else if (w && h) {
+        av_fast_malloc(&s->text_mask, &s->text_mask_size, w * h);
+        if (s->borderw)
+            av_fast_malloc(&s->border_mask, &s->border_mask_size, w * h);
+        if (!s->text_mask || (s->borderw && !s->border_mask))
+            return AVERROR(ENOMEM);
+        s->mask_x = bbox[0];
+        s->mask_y = bbox[1];
+        s->mask_w = w;
+        s->mask_h = h;
+        memcpy(dirty, bbox, sizeof(dirty));
+    } else {
+        s->mask_w = s->mask_h = 0;
+    }
 
-        ff_blend_mask(&s->dc, color,
-                      frame->data, frame->linesize, width, height,
-                      bitmap.buffer, bitmap.pitch,
-                      bitmap.width, bitmap.rows,
-                      bitmap.pixel_mode == FT_PIXEL_MODE_MONO ? 0 : 3,
-                      0, x1, y1);
+    if (dirty[0] < dirty[2] && dirty[1] < dirty[3]) {
+        dirty[0] -= s->mask_x;
+        dirty[1] -= s->mask_y;
+        dirty[2] -= s->mask_x;
+        dirty[3] -= s->mask_y;
+        for (y = dirty[1]; y < dirty[3]; y++) {
+            memset(s->text_mask + y * w + dirty[0], 0, dirty[2] - dirty[0]);
+            if (s->borderw)
+                memset(s->border_mask + y * w + dirty[0], 0, dirty[2] - dirty[0]);
+        }
+        for (i = 0; i < s->nb_layout; i++) {
+            const TextGlyph *g = &s->layout[i];
+            int x0 = g->x - s->mask_x, y0 = g->y - s->mask_y;
+
+            get_glyph_box(s, g, box);
+            if (box[0] - s->mask_x >= dirty[2] || box[2] - s->mask_x <= dirty[0] ||
+                box[1] - s->mask_y >= dirty[3] || box[3] - s->mask_y <= dirty[1])
+                continue;
+            blit_glyph(s->text_mask, w, &g->glyph->bitmap, x0, y0, dirty);
+            if (s->borderw)
+                blit_glyph(s->border_mask, w, &g->glyph->border_bitmap,
+                           x0 - s->borderw, y0 - s->borderw, dirty);
+        }
     }
 
+    tmp                 = s->prev_layout;
+    s->prev_layout      = s->layout;
+    s->layout           = tmp;
+    tmp_size            = s->prev_layout_size;
+    s->prev_layout_size = s->layout_size;
+    s->layout_size      = tmp_size;
+    s->nb_prev_layout   = s->nb_layout;
+    s->nb_layout        = 0;
     return 0;
 }
 
-
 static void update_color_with_alpha(DrawTextContext *s, FFDrawColor *color, const FFDrawColor incolor)
 {
     *color = incolor;
@@ -1136,17 +1259,17 @@ static void update_alpha(DrawTextContext *s)
         s->alpha = 256 * alpha;
 }
 
-static int draw_text(AVFilterContext *ctx, AVFrame *frame,
-                     int width, int height)
+/**
+ * Compute the position of each glyph of the expanded text and the text
+ * metrics, and render the text into the cached masks.
+ */
+static int layout_text(AVFilterContext *ctx)
 {
     DrawTextContext *s = ctx->priv;
-    AVFilterLink *inlink = ctx->inputs[0];
-
     uint32_t code = 0, prev_code = 0;
     int x = 0, y = 0, i = 0, ret;
     int max_text_line_w = 0, len;
-    int box_w, box_h;
-    char *text;
+    char *text = s->expanded_text.str;
     uint8_t *p;
     int y_min = 32000, y_max = -32000;
     int x_min = 32000, x_max = -32000;
@@ -1154,67 +1277,17 @@ static int draw_text(AVFilterContext *ctx, AVFrame *frame,
     Glyph *glyph = NULL, *prev_glyph = NULL;
     Glyph dummy = { 0 };
 
-    time_t now = time(0);
-    struct tm ltime;
-    AVBPrint *bp = &s->expanded_text;
-
-    FFDrawColor fontcolor;
-    FFDrawColor shadowcolor;
-    FFDrawColor bordercolor;
-    FFDrawColor boxcolor;
-
-    av_bprint_clear(bp);
-
-    if(s->basetime != AV_NOPTS_VALUE)
-        now= frame->pts*av_q2d(ctx->inputs[0]->time_base) + s->basetime/1000000;
+    s->text_cached = 0;
 
-    switch (s->exp_mode) {
-    case EXP_NONE:
-        av_bprintf(bp, "%s", s->text);
-        break;
-    case EXP_NORMAL:
-        if ((ret = expand_text(ctx, s->text, &s->expanded_text)) < 0)
-            return ret;
-        break;
-    case EXP_STRFTIME:
-        localtime_r(&now, &ltime);
-        av_bprint_strftime(bp, s->text, &ltime);
-        break;
-    }
-
-    if (s->tc_opt_string) {
-        char tcbuf[AV_TIMECODE_STR_SIZE];
-        av_timecode_make_string(&s->tc, tcbuf, inlink->frame_count);
-        av_bprint_clear(bp);
-        av_bprintf(bp, "%s%s", s->text, tcbuf);
-    }
-
-    if (!av_bprint_is_complete(bp))
-        return AVERROR(ENOMEM);
-    text = s->expanded_text.str;
     if ((len = s->expanded_text.len) > s->nb_positions) {
         if (!(s->positions =
               av_realloc(s->positions, len*sizeof(*s->positions))))
             return AVERROR(ENOMEM);
         s->nb_positions = len;
     }
-
-    if (s->fontcolor_expr[0]) {
-        /* If expression is set, evaluate and replace the static value */
-        av_bprint_clear(&s->expanded_fontcolor);
-        if ((ret = expand_text(ctx, s->fontcolor_expr, &s->expanded_fontcolor)) < 0)
-            return ret;
-        if (!av_bprint_is_complete(&s->expanded_fontcolor))
-            return AVERROR(ENOMEM);
-        av_log(s, AV_LOG_DEBUG, "Evaluated fontcolor is '%s'\n", s->expanded_fontcolor.str);
-        ret = av_parse_color(s->fontcolor.rgba, s->expanded_fontcolor.str, -1, s);
-        if (ret)
-            return ret;
-        ff_draw_color(&s->dc, &s->fontcolor, s->fontcolor.rgba);
-    }
-
-    x = 0;
-    y = 0;
+    av_fast_malloc(&s->layout, &s->layout_size, len * sizeof(*s->layout));
+    if (!s->layout)
+        return AVERROR(ENOMEM);
 
     /* load and cache glyphs */
     for (i = 0, p = text; *p; i++) {
@@ -1284,6 +1357,110 @@ static int draw_text(AVFilterContext *ctx, AVFrame *frame,
 
     s->var_values[VAR_LINE_H] = s->var_values[VAR_LH] = s->max_glyph_h;
 
+    /* list the glyphs to draw */
+    s->nb_layout = 0;
+    for (i = 0, p = text; *p; i++) {
+        TextGlyph *g = &s->layout[s->nb_layout];
+        GET_UTF8(code, *p++, continue;);
+
+        /* skip new line chars, just go to new line */
+        if (code == '\n' || code == '\r' || code == '\t')
+            continue;
+
+        dummy.code = code;
+        glyph = av_tree_find(s->glyphs, &dummy, glyph_cmp, NULL);
+
+        if (glyph->bitmap.pixel_mode != FT_PIXEL_MODE_MONO &&
+            glyph->bitmap.pixel_mode != FT_PIXEL_MODE_GRAY)
+            return AVERROR(EINVAL);
+
+        g->code  = code;
+        g->glyph = glyph;
+        g->x     = s->positions[i].x;
+        g->y     = s->positions[i].y;
+        s->nb_layout++;
+    }
+
+    if ((ret = update_text_masks(s)) < 0)
+        return ret;
+
+    av_bprint_clear(&s->cached_text);
+    av_bprint_append_data(&s->cached_text, text, len);
+    if (!av_bprint_is_complete(&s->cached_text))
+        return AVERROR(ENOMEM);
+    s->text_cached = 1;
+    return 0;
+}
+
+static int draw_text(AVFilterContext *ctx, AVFrame *frame,
+                     int width, int height)
+{
+    DrawTextContext *s = ctx->priv;
+    AVFilterLink *inlink = ctx->inputs[0];
+
+    int ret;
+    int box_w, box_h;
+
+    time_t now = time(0);
+    struct tm ltime;
+    AVBPrint *bp = &s->expanded_text;
+
+    FFDrawColor fontcolor;
+    FFDrawColor shadowcolor;
+    FFDrawColor bordercolor;
+    FFDrawColor boxcolor;
+
+    av_bprint_clear(bp);
+
+    if(s->basetime != AV_NOPTS_VALUE)
+        now= frame->pts*av_q2d(ctx->inputs[0]->time_base) + s->basetime/1000000;
+
+    switch (s->exp_mode) {
+    case EXP_NONE:
+        av_bprintf(bp, "%s", s->text);
+        break;
+    case EXP_NORMAL:
+        if ((ret = expand_text(ctx, s->text, &s->expanded_text)) < 0)
+            return ret;
+        break;
+    case EXP_STRFTIME:
+        localtime_r(&now, &ltime);
+        av_bprint_strftime(bp, s->text, &ltime);
+        break;
+    }
+
+    if (s->tc_opt_string) {
+        char tcbuf[AV_TIMECODE_STR_SIZE];
+        av_timecode_make_string(&s->tc, tcbuf, inlink->frame_count);
+        av_bprint_clear(bp);
+        av_bprintf(bp, "%s%s", s->text, tcbuf);
+    }
+
+    if (!av_bprint_is_complete(bp))
+        return AVERROR(ENOMEM);
+
+    if (s->fontcolor_expr[0]) {
+        /* If expression is set, evaluate and replace the static value */
+        av_bprint_clear(&s->expanded_fontcolor);
+        if ((ret = expand_text(ctx, s->fontcolor_expr, &s->expanded_fontcolor)) < 0)
+            return ret;
+        if (!av_bprint_is_complete(&s->expanded_fontcolor))
+            return AVERROR(ENOMEM);
+        av_log(s, AV_LOG_DEBUG, "Evaluated fontcolor is '%s'\n", s->expanded_fontcolor.str);
+        ret = av_parse_color(s->fontcolor.rgba, s->expanded_fontcolor.str, -1, s);
+        if (ret)
+            return ret;
+        ff_draw_color(&s->dc, &s->fontcolor, s->fontcolor.rgba);
+    }
+
+    /* the layout and the masks only depend on the text, keep them as long
+       as it does not change */
+    if (!s->text_cached || bp->len != s->cached_text.len ||
+        memcmp(bp->str, s->cached_text.str, bp->len)) {
+        if ((ret = layout_text(ctx)) < 0)
+            return ret;
+    }
+
     s->x = s->var_values[VAR_X] = av_expr_eval(s->x_pexpr, s->var_values, &s->prng);
     s->y = s->var_values[VAR_Y] = av_expr_eval(s->y_pexpr, s->var_values, &s->prng);
     s->x = s->var_values[VAR_X] = av_expr_eval(s->x_pexpr, s->var_values, &s->prng);
@@ -1294,8 +1471,8 @@ static int draw_text(AVFilterContext *ctx, AVFrame *frame,
     update_color_with_alpha(s, &bordercolor, s->bordercolor);
     update_color_with_alpha(s, &boxcolor   , s->boxcolor   );
 
-    box_w = FFMIN(width - 1 , max_text_line_w);
-    box_h = FFMIN(height - 1, y + s->max_glyph_h);
+    box_w = FFMIN(width - 1 , (int)s->var_values[VAR_TEXT_W]);
+    box_h = FFMIN(height - 1, (int)s->var_values[VAR_TEXT_H]);
 
     /* draw box */
     if (s->draw_box)
@@ -1304,20 +1481,23 @@ static int draw_text(AVFilterContext *ctx, AVFrame *frame,
                            s->x - s->boxborderw, s->y - s->boxborderw,
                            box_w + s->boxborderw * 2, box_h + s->boxborderw * 2);
 
-    if (s->shadowx || s->shadowy) {
-        if ((ret = draw_glyphs(s, frame, width, height,
-                               &shadowcolor, s->shadowx, s->shadowy, 0)) < 0)
-            return ret;
-    }
+    if (s->shadowx || s->shadowy)
+        ff_blend_mask(&s->dc, &shadowcolor,
+                      frame->data, frame->linesize, width, height,
+                      s->text_mask, s->mask_w, s->mask_w, s->mask_h, 3, 0,
+                      s->x + s->mask_x + s->shadowx,
+                      s->y + s->mask_y + s->shadowy);
 
-    if (s->borderw) {
-        if ((ret = draw_glyphs(s, frame, width, height,
-                               &bordercolor, 0, 0, s->borderw)) < 0)
-            return ret;
-    }
-    if ((ret = draw_glyphs(s, frame, width, height,
-                           &fontcolor, 0, 0, 0)) < 0)
-        return ret;
+    if (s->borderw)
+        ff_blend_mask(&s->dc, &bordercolor,
+                      frame->data, frame->linesize, width, height,
+                      s->border_mask, s->mask_w, s->mask_w, s->mask_h, 3, 0,
+                      s->x + s->mask_x, s->y + s->mask_y);
+
+    ff_blend_mask(&s->dc, &fontcolor,
+                  frame->data, frame->linesize, width, height,
+                  s->text_mask, s->mask_w, s->mask_w, s->mask_h, 3, 0,
+                  s->x + s->mask_x, s->y + s->mask_y);
 
     return 0;
 }
@@ -31,6 +31,7 @@
 #include "libavutil/avassert.h"
 #include "libavutil/imgutils.h"
 #include "libavutil/internal.h"
+#include "libavutil/motion_vector.h"
 #include "libavutil/opt.h"
 #include "libavutil/pixdesc.h"
 #include "libavutil/pixelutils.h"
@@ -41,6 +42,12 @@
 
 #define N_SRCE 3
 
+enum InterpolationMode {
+    MODE_BLEND,
+    MODE_MCI,
+    NB_MODES
+};
+
 typedef struct FrameRateContext {
     const AVClass *class;
     // parameters
@@ -50,8 +57,13 @@ typedef struct FrameRateContext {
     int interp_start;                   ///< start of range to apply linear interpolation
     int interp_end;                     ///< end of range to apply linear interpolation
 
+    int mode;                           ///< InterpolationMode
+    int mb_size;                        ///< size of the blocks of motion compensation
+    int search_param;                   ///< range of the motion vectors refinement
+
     int line_size[4];                   ///< bytes of pixel data per line for each plane
-    int vsub;
+    int hsub, vsub;
+    int nb_planes;
 
     int frst, next, prev, crnt, last;
     int pending_srce_frames;            ///< how many input frames are still waiting to be processed
@@ -78,6 +90,10 @@ typedef struct FrameRateContext {
     int max;
     int bitdepth;
     AVFrame *work;
+
+    av_pixelutils_sad_fn mb_sad;        ///< SAD of a mb_size x mb_size block (mci only)
+    int mb_w, mb_h;                     ///< number of blocks in a row and a column
+    int16_t (*mv)[2];                   ///< motion vector of each block, towards the previous frame
 } FrameRateContext;
 
 #define OFFSET(x) offsetof(FrameRateContext, x)
@@ -92,6 +108,12 @@ static const AVOption framerate_options[] = {
     {"interp_end",          "point to end linear interpolation",      OFFSET(interp_end),      AV_OPT_TYPE_INT,      {.i64=240},                0,       255,     V|F },
     {"scene",               "scene change level",                     OFFSET(scene_score),     AV_OPT_TYPE_DOUBLE,   {.dbl=7.0},                0,       INT_MAX, V|F },
 
+    {"mode",                "set interpolation mode",                 OFFSET(mode),            AV_OPT_TYPE_INT,      {.i64=MODE_BLEND},         0,       NB_MODES-1, V|F, "mode" },
+    {"blend",               "blend the frames",                       0,                       AV_OPT_TYPE_CONST,    {.i64=MODE_BLEND},         INT_MIN, INT_MAX, V|F, "mode" },
+    {"mci",                 "motion compensated interpolation",       0,                       AV_OPT_TYPE_CONST,    {.i64=MODE_MCI},           INT_MIN, INT_MAX, V|F, "mode" },
+    {"mb_size",             "set block size for motion compensation", OFFSET(mb_size),         AV_OPT_TYPE_INT,      {.i64=16},                 8,       16,      V|F },
+    {"search_param",        "set range of motion vectors refinement", OFFSET(search_param),    AV_OPT_TYPE_INT,      {.i64=8},                  0,       64,      V|F },
+
     {"flags",               "set flags",                              OFFSET(flags),           AV_OPT_TYPE_FLAGS,    {.i64=1},                  0,       INT_MAX, V|F, "flags" },
     {"scene_change_detect", "enable scene change detection",          0,                       AV_OPT_TYPE_CONST,    {.i64=FRAMERATE_FLAG_SCD}, INT_MIN, INT_MAX, V|F, "flags" },
     {"scd",                 "enable scene change detection",          0,                       AV_OPT_TYPE_CONST,    {.i64=FRAMERATE_FLAG_SCD}, INT_MIN, INT_MAX, V|F, "flags" },
@@ -341,6 +363,252 @@ static int blend_frames8(AVFilterContext *ctx, float interpolate,
     return 0;
 }
 
+typedef struct ThreadData {
+    AVFrame *prev, *next, *out;
+    int weight;                         ///< weight of next, out of 256
+} ThreadData;
+
+static int sad_block(const uint8_t *src1, ptrdiff_t stride1,
+                     const uint8_t *src2, ptrdiff_t stride2, int w, int h)
+{
+    int sum = 0;
+    int x, y;
+
+    for (y = 0; y < h; y++) {
+        for (x = 0; x < w; x++)
+            sum += FFABS(src1[x] - src2[x]);
+        src1 += stride1;
+        src2 += stride2;
+    }
+    return sum;
+}
+
+/*
+ * Block matching of the luma of the next frame in the previous one. Each
+ * block is tried with the vector exported by the decoder, the null vector
+ * and the vector of the block on its left, then the best one is refined
+ * with a small diamond search.
+ */
+static int motion_estimation_slice(AVFilterContext *ctx, void *arg,
+                                   int jobnr, int nb_jobs)
+{
+    FrameRateContext *s = ctx->priv;
+    ThreadData *td = arg;
+    const int w = ctx->inputs[0]->w;
+    const int h = ctx->inputs[0]->h;
+    const int mb_size = s->mb_size;
+    const uint8_t *prev = td->prev->data[0];
+    const uint8_t *next = td->next->data[0];
+    const ptrdiff_t prev_linesize = td->prev->linesize[0];
+    const ptrdiff_t next_linesize = td->next->linesize[0];
+    const int slice_start = (s->mb_h *  jobnr   ) / nb_jobs;
+    const int slice_end   = (s->mb_h * (jobnr+1)) / nb_jobs;
+    static const int8_t dia[4][2] = { { -1, 0 }, { 0, -1 }, { 1, 0 }, { 0, 1 } };
+    int mb_x, mb_y, i;
+
+    for (mb_y = slice_start; mb_y < slice_end; mb_y++) {
+        for (mb_x = 0; mb_x < s->mb_w; mb_x++) {
+            int16_t *mv = s->mv[mb_y * s->mb_w + mb_x];
+            const int x = mb_x * mb_size;
+            const int y = mb_y * mb_size;
+            const int bw = FFMIN(mb_size, w - x);
+            const int bh = FFMIN(mb_size, h - y);
+            const uint8_t *cur = next + y * next_linesize + x;
+            int cand[3][2], best_cost = INT_MAX, best_x = 0, best_y = 0, iter;
+
+#define COST(vx, vy) (bw == mb_size && bh == mb_size ?                                    \
+    s->mb_sad(cur, next_linesize, prev + (y + (vy)) * prev_linesize + x + (vx), prev_linesize) : \
+    sad_block(cur, next_linesize, prev + (y + (vy)) * prev_linesize + x + (vx), prev_linesize, bw, bh))
+
+            cand[0][0] = cand[0][1] = 0;
+            cand[1][0] = mv[0];
+            cand[1][1] = mv[1];
+            cand[2][0] = mb_x ? mv[-2] : 0;
+            cand[2][1] = mb_x ? mv[-1] : 0;
+
+            for (i = 0; i < 3; i++) {
+                const int vx = av_clip(cand[i][0], -x, w - bw - x);
+                const int vy = av_clip(cand[i][1], -y, h - bh - y);
+                const int cost = COST(vx, vy);
+
+                if (cost < best_cost) {
+                    best_cost = cost;
+                    best_x    = vx;
+                    best_y    = vy;
+                }
+            }
+
+            for (iter = 0; iter < s->search_param; iter++) {
+                const int cx = best_x, cy = best_y;
+
+                for (i = 0; i < 4; i++) {
+                    const int vx = cx + dia[i][0];
+                    const int vy = cy + dia[i][1];
+                    int cost;
+
+                    if (vx < -x || vx > w - bw - x ||
+                        vy < -y || vy > h - bh - y)
+                        continue;
+                    cost = COST(vx, vy);
+                    if (cost < best_cost) {
+                        best_cost = cost;
+                        best_x    = vx;
+                        best_y    = vy;
+                    }
+                }
+                if (best_x == cx && best_y == cy)
+                    break;
+            }
+#undef COST
+
+            mv[0] = best_x;
+            mv[1] = best_y;
+        }
+    }
+    emms_c();
+
+    return 0;
+}
+
+/*
+ * Build the frame at weight/256 between prev and next: the pixels of a block
+ * are taken along the vector of the block, from both frames.
+ */
+static int motion_compensation_slice(AVFilterContext *ctx, void *arg,
+                                     int jobnr, int nb_jobs)
+{
+    FrameRateContext *s = ctx->priv;
+    ThreadData *td = arg;
+    const int weight = td->weight;
+    const int slice_start = (s->mb_h *  jobnr   ) / nb_jobs;
+    const int slice_end   = (s->mb_h * (jobnr+1)) / nb_jobs;
+    int plane, mb_x, mb_y, x, y;
+
+    for (plane = 0; plane < s->nb_planes; plane++) {
+        const int hsub = plane == 1 || plane == 2 ? s->hsub : 0;
+        const int vsub = plane == 1 || plane == 2 ? s->vsub : 0;
+        const int pw = AV_CEIL_RSHIFT(ctx->inputs[0]->w, hsub);
+        const int ph = AV_CEIL_RSHIFT(ctx->inputs[0]->h, vsub);
+        const ptrdiff_t prev_linesize = td->prev->linesize[plane];
+        const ptrdiff_t next_linesize = td->next->linesize[plane];
+        const ptrdiff_t dst_linesize = td->out->linesize[plane];
+
+        for (mb_y = slice_start; mb_y < slice_end; mb_y++) {
+            const int y0 = (mb_y * s->mb_size) >> vsub;
+            const int y1 = mb_y == s->mb_h - 1 ? ph : ((mb_y + 1) * s->mb_size) >> vsub;
+
+            for (mb_x = 0; mb_x < s->mb_w; mb_x++) {
+                const int16_t *mv = s->mv[mb_y * s->mb_w + mb_x];
+                const int x0 = (mb_x * s->mb_size) >> hsub;
+                const int x1 = mb_x == s->mb_w - 1 ? pw : ((mb_x + 1) * s->mb_size) >> hsub;
+                /* offsets of the samples in prev and next, the vector
+                 * going from next to prev */
+                const int px = ROUNDED_DIV(mv[0] * weight, 256 << hsub);
+                const int py = ROUNDED_DIV(mv[1] * weight, 256 << vsub);
+                const int nx = -ROUNDED_DIV(mv[0] * (256 - weight), 256 << hsub);
+                const int ny = -ROUNDED_DIV(mv[1] * (256 - weight), 256 << vsub);
+                const int inside = x0 + FFMIN(px, nx) >= 0 && x1 + FFMAX(px, nx) <= pw &&
+                                   y0 + FFMIN(py, ny) >= 0 && y1 + FFMAX(py, ny) <= ph;
+
+                for (y = y0; y < y1; y++) {
+                    uint8_t *dst = td->out->data[plane] + y * dst_linesize;
+
+                    if (inside) {
+                        const uint8_t *p = td->prev->data[plane] + (y + py) * prev_linesize + px;
+                        const uint8_t *n = td->next->data[plane] + (y + ny) * next_linesize + nx;
+
+                        for (x = x0; x < x1; x++)
+                            dst[x] = (p[x] * (256 - weight) + n[x] * weight + 128) >> 8;
+                    } else {
+                        const uint8_t *p = td->prev->data[plane] + av_clip(y + py, 0, ph - 1) * prev_linesize;
+                        const uint8_t *n = td->next->data[plane] + av_clip(y + ny, 0, ph - 1) * next_linesize;
+
+                        for (x = x0; x < x1; x++)
+                            dst[x] = (p[av_clip(x + px, 0, pw - 1)] * (256 - weight) +
+                                      n[av_clip(x + nx, 0, pw - 1)] * weight + 128) >> 8;
+                    }
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+/* Use the motion vectors exported by the decoder as a starting point. */
+static void import_motion_vectors(FrameRateContext *s, AVFrame *frame)
+{
+    AVFrameSideData *sd = av_frame_get_side_data(frame, AV_FRAME_DATA_MOTION_VECTORS);
+    int i, mb_x, mb_y;
+
+    memset(s->mv, 0, s->mb_w * s->mb_h * sizeof(*s->mv));
+    if (!sd)
+        return;
+
+    for (i = 0; i < sd->size / sizeof(AVMotionVector); i++) {
+        const AVMotionVector *mv = (const AVMotionVector *)sd->data + i;
+        /* dst_x and dst_y are the center of the block */
+        const int x0 = FFMAX(mv->dst_x - mv->w / 2, 0);
+        const int y0 = FFMAX(mv->dst_y - mv->h / 2, 0);
+        const int x1 = FFMIN(mv->dst_x + mv->w / 2, s->mb_w * s->mb_size);
+        const int y1 = FFMIN(mv->dst_y + mv->h / 2, s->mb_h * s->mb_size);
+
+        if (mv->source != -1)
+            continue;
+
+        /* set the blocks whose center is covered by the vector */
+        for (mb_y = (y0 + s->mb_size / 2 - 1) / s->mb_size; mb_y * s->mb_size + s->mb_size / 2 < y1; mb_y++) {
+            for (mb_x = (x0 + s->mb_size / 2 - 1) / s->mb_size; mb_x * s->mb_size + s->mb_size / 2 < x1; mb_x++) {
+                s->mv[mb_y * s->mb_w + mb_x][0] = mv->src_x - mv->dst_x;
+                s->mv[mb_y * s->mb_w + mb_x][1] = mv->src_y - mv->dst_y;
+            }
+        }
+    }
+}
+
+static int mci_frames8(AVFilterContext *ctx, float interpolate,
+                       AVFrame *copy_src1, AVFrame *copy_src2)
+{
+    FrameRateContext *s = ctx->priv;
+    AVFilterLink *outlink = ctx->outputs[0];
+    double interpolate_scene_score = 0;
+
+    if ((s->flags & FRAMERATE_FLAG_SCD) && copy_src2) {
+        interpolate_scene_score = get_scene_score(ctx, copy_src1, copy_src2);
+        ff_dlog(ctx, "mci_frames8() interpolate scene score:%f\n", interpolate_scene_score);
+    }
+    // decide if the shot-change detection allows us to interpolate two frames
+    if (interpolate_scene_score < s->scene_score && copy_src2) {
+        const int nb_jobs = FFMIN(s->mb_h, ctx->graph->nb_threads);
+        ThreadData td;
+
+        if (interpolate > 0) {
+            td.prev   = copy_src1;
+            td.next   = copy_src2;
+            td.weight = fabsf(interpolate);
+        } else {
+            td.prev   = copy_src2;
+            td.next   = copy_src1;
+            td.weight = 256 - (int)fabsf(interpolate);
+        }
+
+        // get work-space for output frame
+        s->work = ff_get_video_buffer(outlink, outlink->w, outlink->h);
+        if (!s->work)
+            return AVERROR(ENOMEM);
+        td.out = s->work;
+
+        av_frame_copy_props(s->work, s->srce[s->crnt]);
+
+        ff_dlog(ctx, "mci_frames8() INTERPOLATE to create work frame\n");
+        import_motion_vectors(s, td.next);
+        ctx->internal->execute(ctx, motion_estimation_slice, &td, NULL, nb_jobs);
+        ctx->internal->execute(ctx, motion_compensation_slice, &td, NULL, nb_jobs);
+        return 1;
+    }
+    return 0;
+}
+
 static int process_work_frame(AVFilterContext *ctx, int stop)
 {
     FrameRateContext *s = ctx->priv;
@@ -531,6 +799,7 @@ static av_cold void uninit(AVFilterContext *ctx)
             av_frame_free(&s->srce[i]);
     }
     av_frame_free(&s->srce[s->last]);
+    av_freep(&s->mv);
 }
 
 static int query_formats(AVFilterContext *ctx)
@@ -567,7 +836,9 @@ static int config_input(AVFilterLink *inlink)
     }
 
     s->bitdepth = pix_desc->comp[0].depth;
+    s->hsub = pix_desc->log2_chroma_w;
     s->vsub = pix_desc->log2_chroma_h;
+    s->nb_planes = av_pix_fmt_count_planes(inlink->format);
 
     s->sad = av_pixelutils_get_sad_fn(3, 3, 2, s); // 8x8 both sources aligned
     if (!s->sad)
@@ -581,6 +852,34 @@ static int config_input(AVFilterLink *inlink)
         s->blend_frames = blend_frames16;
     s->max = 1 << (s->bitdepth);
 
+    if (s->mode == MODE_MCI) {
+        const int mb_bits = av_log2(s->mb_size);
+
+        if (s->bitdepth > 8) {
+            av_log(ctx, AV_LOG_WARNING, "Motion compensated interpolation "
+                   "is not supported with %s, blending frames instead.\n",
+                   pix_desc->name);
+            return 0;
+        }
+        if (s->mb_size != 1 << mb_bits) {
+            av_log(ctx, AV_LOG_ERROR, "mb_size must be a power of two.\n");
+            return AVERROR(EINVAL);
+        }
+
+        s->mb_sad = av_pixelutils_get_sad_fn(mb_bits, mb_bits, 0, s);
+        if (!s->mb_sad)
+            return AVERROR(EINVAL);
+
+        s->mb_w = AV_CEIL_RSHIFT(inlink->w, mb_bits);
+        s->mb_h = AV_CEIL_RSHIFT(inlink->h, mb_bits);
+        av_freep(&s->mv);
+        s->mv = av_malloc_array(s->mb_w * s->mb_h, sizeof(*s->mv));
+        if (!s->mv)
+            return AVERROR(ENOMEM);
+
+        s->blend_frames = mci_frames8;
+    }
+
     return 0;
 }
 
@@ -728,4 +1027,5 @@ AVFilter ff_vf_framerate = {
     .query_formats = query_formats,
     .inputs        = framerate_inputs,
     .outputs       = framerate_outputs,
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
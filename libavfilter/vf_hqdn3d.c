@@ -120,6 +120,25 @@ static void denoise_spatial(HQDN3DContext *s,
     }
 }
 
+av_always_inline
+static int init_frame_ant(uint8_t *src, uint16_t **frame_ant_ptr,
+                          int w, int h, int sstride, int depth)
+{
+    long x, y;
+    uint16_t *frame_ant = *frame_ant_ptr;
+
+    if (frame_ant)
+        return 0;
+
+    *frame_ant_ptr = frame_ant = av_malloc_array(w, h*sizeof(uint16_t));
+    if (!frame_ant)
+        return AVERROR(ENOMEM);
+    for (y = 0; y < h; y++, src += sstride, frame_ant += w)
+        for (x = 0; x < w; x++)
+            frame_ant[x] = LOAD(x);
+    return 0;
+}
+
 av_always_inline
 static int denoise_depth(HQDN3DContext *s,
                          uint8_t *src, uint8_t *dst,
@@ -129,30 +148,194 @@ static int denoise_depth(HQDN3DContext *s,
 {
     // FIXME: For 16bit depth, frame_ant could be a pointer to the previous
     // filtered frame rather than a separate buffer.
-    long x, y;
-    uint16_t *frame_ant = *frame_ant_ptr;
-    if (!frame_ant) {
-        uint8_t *frame_src = src;
-        *frame_ant_ptr = frame_ant = av_malloc_array(w, h*sizeof(uint16_t));
-        if (!frame_ant)
-            return AVERROR(ENOMEM);
-        for (y = 0; y < h; y++, src += sstride, frame_ant += w)
-            for (x = 0; x < w; x++)
-                frame_ant[x] = LOAD(x);
-        src = frame_src;
-        frame_ant = *frame_ant_ptr;
-    }
+    int ret = init_frame_ant(src, frame_ant_ptr, w, h, sstride, depth);
+    if (ret < 0)
+        return ret;
 
     if (spatial[0])
-        denoise_spatial(s, src, dst, line_ant, frame_ant,
+        denoise_spatial(s, src, dst, line_ant, *frame_ant_ptr,
                         w, h, sstride, dstride, spatial, temporal, depth);
     else
-        denoise_temporal(src, dst, frame_ant,
+        denoise_temporal(src, dst, *frame_ant_ptr,
                          w, h, sstride, dstride, temporal, depth);
     emms_c();
     return 0;
 }
 
+/**
+ * Horizontal half of denoise_spatial() for the rows [y0, y1) of a plane:
+ * store the value each pixel gets from its left neighbors, which is what
+ * the vertical recursion of the next pass takes as input.
+ */
+av_always_inline
+static void hpass_depth(uint8_t *src, uint16_t *hpass, int w, int y0, int y1,
+                        int sstride, int16_t *spatial, int depth)
+{
+    long x, y;
+    uint32_t pixel_ant;
+
+    spatial += 256 << LUT_BITS;
+    src     += y0 * sstride;
+    hpass   += y0 * w;
+
+    for (y = y0; y < y1; y++) {
+        pixel_ant = LOAD(0);
+        if (!y) {
+            for (x = 0; x < w; x++)
+                hpass[x] = pixel_ant = lowpass(pixel_ant, LOAD(x), spatial, depth);
+        } else {
+            for (x = 0; x < w-1; x++) {
+                hpass[x] = pixel_ant;
+                pixel_ant = lowpass(pixel_ant, LOAD(x+1), spatial, depth);
+            }
+            hpass[x] = pixel_ant;
+        }
+        src   += sstride;
+        hpass += w;
+    }
+}
+
+/**
+ * Vertical and temporal filtering of the columns [x0, x1) of a plane,
+ * from the output of hpass_depth(), or from the source if hpass is NULL
+ * (no spatial filtering).
+ */
+av_always_inline
+static void vpass_depth(uint8_t *src, uint8_t *dst, uint16_t *hpass,
+                        uint16_t *line_ant, uint16_t *frame_ant,
+                        int w, int h, int x0, int x1, int sstride, int dstride,
+                        int16_t *spatial, int16_t *temporal, int depth)
+{
+    long x, y;
+    uint32_t tmp;
+
+    spatial  += 256 << LUT_BITS;
+    temporal += 256 << LUT_BITS;
+
+    if (!hpass) {
+        for (y = 0; y < h; y++) {
+            for (x = x0; x < x1; x++) {
+                frame_ant[x] = tmp = lowpass(frame_ant[x], LOAD(x), temporal, depth);
+                STORE(x, tmp);
+            }
+            src += sstride;
+            dst += dstride;
+            frame_ant += w;
+        }
+        return;
+    }
+
+    for (x = x0; x < x1; x++) {
+        line_ant[x] = tmp = hpass[x];
+        frame_ant[x] = tmp = lowpass(frame_ant[x], tmp, temporal, depth);
+        STORE(x, tmp);
+    }
+    for (y = 1; y < h; y++) {
+        dst += dstride;
+        hpass += w;
+        frame_ant += w;
+        for (x = x0; x < x1; x++) {
+            line_ant[x] = tmp = lowpass(line_ant[x], hpass[x], spatial, depth);
+            frame_ant[x] = tmp = lowpass(frame_ant[x], tmp, temporal, depth);
+            STORE(x, tmp);
+        }
+    }
+}
+
+#define DEPTH_CASES(func, ...)                                                \
+    switch (s->depth) {                                                       \
+        case  8: func(__VA_ARGS__,  8); break;                                \
+        case  9: func(__VA_ARGS__,  9); break;                                \
+        case 10: func(__VA_ARGS__, 10); break;                                \
+        case 16: func(__VA_ARGS__, 16); break;                                \
+    }
+
+typedef struct ThreadData {
+    AVFrame *in, *out;
+} ThreadData;
+
+static int hpass_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    HQDN3DContext *s = ctx->priv;
+    ThreadData *td = arg;
+    int c;
+
+    for (c = 0; c < 3; c++) {
+        int w = AV_CEIL_RSHIFT(td->in->width,  (!!c * s->hsub));
+        int h = AV_CEIL_RSHIFT(td->in->height, (!!c * s->vsub));
+        int16_t *spatial = s->coefs[c ? CHROMA_SPATIAL : LUMA_SPATIAL];
+
+        if (!spatial[0])
+            continue;
+        DEPTH_CASES(hpass_depth, td->in->data[c], s->hpass[c], w,
+                    (h *  jobnr     ) / nb_jobs,
+                    (h * (jobnr + 1)) / nb_jobs,
+                    td->in->linesize[c], spatial);
+    }
+    return 0;
+}
+
+static int vpass_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    HQDN3DContext *s = ctx->priv;
+    ThreadData *td = arg;
+    int c;
+
+    for (c = 0; c < 3; c++) {
+        int w = AV_CEIL_RSHIFT(td->in->width,  (!!c * s->hsub));
+        int h = AV_CEIL_RSHIFT(td->in->height, (!!c * s->vsub));
+        int16_t *spatial  = s->coefs[c ? CHROMA_SPATIAL : LUMA_SPATIAL];
+        int16_t *temporal = s->coefs[c ? CHROMA_TMP     : LUMA_TMP];
+        /* keep the columns of different jobs in different cache lines */
+        int x0 = jobnr                ? ((w *  jobnr     ) / nb_jobs) & ~31 : 0;
+        int x1 = jobnr + 1 < nb_jobs ? ((w * (jobnr + 1)) / nb_jobs) & ~31 : w;
+
+        DEPTH_CASES(vpass_depth, td->in->data[c], td->out->data[c],
+                    spatial[0] ? s->hpass[c] : NULL,
+                    s->line[c], s->frame_prev[c], w, h, x0, x1,
+                    td->in->linesize[c], td->out->linesize[c],
+                    spatial, temporal);
+    }
+    return 0;
+}
+
+/**
+ * Denoise all the planes with nb_jobs jobs.
+ *
+ * The spatial filter is recursive in both directions, so it is split in
+ * a horizontal pass, run in bands of rows, and a vertical pass run in
+ * bands of columns together with the temporal filter. Each pixel goes
+ * through the same operations in the same order as in denoise_spatial(),
+ * so the output is identical.
+ */
+static int denoise_threaded(AVFilterContext *ctx, AVFrame *in, AVFrame *out,
+                            int nb_jobs)
+{
+    HQDN3DContext *s = ctx->priv;
+    ThreadData td = { .in = in, .out = out };
+    int c, ret = 0;
+
+    for (c = 0; c < 3; c++) {
+        int w = AV_CEIL_RSHIFT(in->width,  (!!c * s->hsub));
+        int h = AV_CEIL_RSHIFT(in->height, (!!c * s->vsub));
+
+        if (!s->frame_prev[c])
+            DEPTH_CASES(ret = init_frame_ant, in->data[c], &s->frame_prev[c],
+                        w, h, in->linesize[c]);
+        if (ret < 0)
+            return ret;
+        if (!s->hpass[c] && s->coefs[c ? CHROMA_SPATIAL : LUMA_SPATIAL][0]) {
+            s->hpass[c] = av_malloc_array(w, h * sizeof(*s->hpass[c]));
+            if (!s->hpass[c])
+                return AVERROR(ENOMEM);
+        }
+    }
+
+    ctx->internal->execute(ctx, hpass_slice, &td, NULL, nb_jobs);
+    ctx->internal->execute(ctx, vpass_slice, &td, NULL, nb_jobs);
+    return 0;
+}
+
 #define denoise(...)                                                          \
     do {                                                                      \
         int ret = AVERROR_BUG;                                                \
@@ -223,10 +406,15 @@ static av_cold void uninit(AVFilterContext *ctx)
     av_freep(&s->coefs[1]);
     av_freep(&s->coefs[2]);
     av_freep(&s->coefs[3]);
-    av_freep(&s->line);
+    av_freep(&s->line[0]);
+    av_freep(&s->line[1]);
+    av_freep(&s->line[2]);
     av_freep(&s->frame_prev[0]);
     av_freep(&s->frame_prev[1]);
     av_freep(&s->frame_prev[2]);
+    av_freep(&s->hpass[0]);
+    av_freep(&s->hpass[1]);
+    av_freep(&s->hpass[2]);
 }
 
 static int query_formats(AVFilterContext *ctx)
@@ -271,9 +459,11 @@ static int config_input(AVFilterLink *inlink)
     s->vsub  = desc->log2_chroma_h;
     s->depth = desc->comp[0].depth;
 
-    s->line = av_malloc_array(inlink->w, sizeof(*s->line));
-    if (!s->line)
-        return AVERROR(ENOMEM);
+    for (i = 0; i < 3; i++) {
+        s->line[i] = av_malloc_array(inlink->w, sizeof(*s->line[i]));
+        if (!s->line[i])
+            return AVERROR(ENOMEM);
+    }
 
     for (i = 0; i < 4; i++) {
         s->coefs[i] = precalc_coefs(s->strength[i], s->depth);
@@ -295,6 +485,9 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
 
     AVFrame *out;
     int c, direct = av_frame_is_writable(in) && !ctx->is_disabled;
+    int nb_jobs = FFMIN(ctx->graph->nb_threads,
+                        AV_CEIL_RSHIFT(FFMIN(in->width, in->height),
+                                       FFMAX(s->hsub, s->vsub)));
 
     if (direct) {
         out = in;
@@ -308,14 +501,24 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
         av_frame_copy_props(out, in);
     }
 
-    for (c = 0; c < 3; c++) {
-        denoise(s, in->data[c], out->data[c],
-                s->line, &s->frame_prev[c],
-                AV_CEIL_RSHIFT(in->width,  (!!c * s->hsub)),
-                AV_CEIL_RSHIFT(in->height, (!!c * s->vsub)),
-                in->linesize[c], out->linesize[c],
-                s->coefs[c ? CHROMA_SPATIAL : LUMA_SPATIAL],
-                s->coefs[c ? CHROMA_TMP     : LUMA_TMP]);
+    if (nb_jobs > 1) {
+        int ret = denoise_threaded(ctx, in, out, nb_jobs);
+        if (ret < 0) {
+            av_frame_free(&out);
+            if (!direct)
+                av_frame_free(&in);
+            return ret;
+        }
+    } else {
+        for (c = 0; c < 3; c++) {
+            denoise(s, in->data[c], out->data[c],
+                    s->line[c], &s->frame_prev[c],
+                    AV_CEIL_RSHIFT(in->width,  (!!c * s->hsub)),
+                    AV_CEIL_RSHIFT(in->height, (!!c * s->vsub)),
+                    in->linesize[c], out->linesize[c],
+                    s->coefs[c ? CHROMA_SPATIAL : LUMA_SPATIAL],
+                    s->coefs[c ? CHROMA_TMP     : LUMA_TMP]);
+        }
     }
 
     if (ctx->is_disabled) {
@@ -370,5 +573,5 @@ AVFilter ff_vf_hqdn3d = {
     .query_formats = query_formats,
     .inputs        = avfilter_vf_hqdn3d_inputs,
     .outputs       = avfilter_vf_hqdn3d_outputs,
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_INTERNAL,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_INTERNAL | AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -22,13 +22,13 @@
 #include <float.h>
 
 #include "libavutil/common.h"
-#include "libavutil/float_dsp.h"
 #include "libavutil/imgutils.h"
 #include "libavutil/opt.h"
 #include "libavutil/pixdesc.h"
 #include "avfilter.h"
 #include "formats.h"
 #include "internal.h"
+#include "nnedi.h"
 #include "video.h"
 
 typedef struct FrameData {
@@ -43,8 +43,11 @@ typedef struct FrameData {
     int field[3];
 
     int32_t *lcount[3];
+
+    // per thread scratch buffers
     float *input;
     float *temp;
+    int temp_size;
 } FrameData;
 
 typedef struct NNEDIContext {
@@ -58,7 +61,8 @@ typedef struct NNEDIContext {
     int eof;
     int64_t cur_pts;
 
-    AVFloatDSPContext *fdsp;
+    NNEDIDSPContext dsp;
+    int nb_threads;
     int nb_planes;
     int linesize[4];
     int planeheight[4];
@@ -84,8 +88,8 @@ typedef struct NNEDIContext {
     int max_value;
 
     void (*copy_pad)(const AVFrame *, FrameData *, struct NNEDIContext *, int);
-    void (*evalfunc_0)(struct NNEDIContext *, FrameData *);
-    void (*evalfunc_1)(struct NNEDIContext *, FrameData *);
+    void (*evalfunc_0)(struct NNEDIContext *, FrameData *, int, int);
+    void (*evalfunc_1)(struct NNEDIContext *, FrameData *, int, int);
 
     // Functions used in evalfunc_0
     void (*readpixels)(const uint8_t *, const int, float *);
@@ -161,6 +165,8 @@ static int config_input(AVFilterLink *inlink)
     s->planeheight[1] = s->planeheight[2] = AV_CEIL_RSHIFT(inlink->h, desc->log2_chroma_h);
     s->planeheight[0] = s->planeheight[3] = inlink->h;
 
+    s->nb_threads = FFMAX(1, ctx->graph->nb_threads);
+
     return 0;
 }
 
@@ -265,24 +271,23 @@ static void elliott(float *data, const int n)
         data[i] = data[i] / (1.0f + FFABS(data[i]));
 }
 
-static void dot_prod(NNEDIContext *s, const float *data, const float *weights, float *vals, const int n, const int len, const float *scale)
+static void dot_prod_c(const float *data, const float *weights, float *vals, int n, int len, const float *scale)
 {
-    int i;
+    int i, j;
 
     for (i = 0; i < n; i++) {
-        float sum;
+        float sum = 0.0f;
 
-        sum = s->fdsp->scalarproduct_float(data, &weights[i * len], len);
+        for (j = 0; j < len; j++)
+            sum += data[j] * weights[i * len + j];
 
         vals[i] = sum * scale[0] + weights[n * len + i];
     }
 }
 
-static void dot_prods(NNEDIContext *s, const float *dataf, const float *weightsf, float *vals, const int n, const int len, const float *scale)
+static void dot_prod_int16_c(const int16_t *data, const int16_t *weights, float *vals, int n, int len, const float *scale)
 {
-    const int16_t *data = (int16_t *)dataf;
-    const int16_t *weights = (int16_t *)weightsf;
-    const float *wf = (float *)&weights[n * len];
+    const float *wf = (const float *)&weights[n * len];
     int i, j;
 
     for (i = 0; i < n; i++) {
@@ -294,6 +299,25 @@ static void dot_prods(NNEDIContext *s, const float *dataf, const float *weightsf
     }
 }
 
+av_cold void ff_nnedi_init_dsp(NNEDIDSPContext *dsp)
+{
+    dsp->dot_prod       = dot_prod_c;
+    dsp->dot_prod_int16 = dot_prod_int16_c;
+
+    if (ARCH_X86)
+        ff_nnedi_init_dsp_x86(dsp);
+}
+
+static void dot_prod(NNEDIContext *s, const float *data, const float *weights, float *vals, const int n, const int len, const float *scale)
+{
+    s->dsp.dot_prod(data, weights, vals, n, len, scale);
+}
+
+static void dot_prods(NNEDIContext *s, const float *dataf, const float *weightsf, float *vals, const int n, const int len, const float *scale)
+{
+    s->dsp.dot_prod_int16((const int16_t *)dataf, (const int16_t *)weightsf, vals, n, len, scale);
+}
+
 static void compute_network0(NNEDIContext *s, const float *input, const float *weights, uint8_t *d)
 {
     float t, temp[12], scale = 1.0f;
@@ -302,9 +326,9 @@ static void compute_network0(NNEDIContext *s, const float *input, const float *w
     t = temp[0];
     elliott(temp, 4);
     temp[0] = t;
-    dot_prod(s, temp, weights + 4 * 49, temp + 4, 4, 4, &scale);
+    dot_prod_c(temp, weights + 4 * 49, temp + 4, 4, 4, &scale);
     elliott(temp + 4, 4);
-    dot_prod(s, temp, weights + 4 * 49 + 4 * 5, temp + 8, 4, 8, &scale);
+    dot_prod_c(temp, weights + 4 * 49 + 4 * 5, temp + 8, 4, 8, &scale);
     if (FFMAX(temp[10], temp[11]) <= FFMAX(temp[8], temp[9]))
         d[0] = 1;
     else
@@ -320,9 +344,9 @@ static void compute_network0_i16(NNEDIContext *s, const float *inputf, const flo
     t = temp[0];
     elliott(temp, 4);
     temp[0] = t;
-    dot_prod(s, temp, wf + 8, temp + 4, 4, 4, &scale);
+    dot_prod_c(temp, wf + 8, temp + 4, 4, 4, &scale);
     elliott(temp + 4, 4);
-    dot_prod(s, temp, wf + 8 + 4 * 5, temp + 8, 4, 8, &scale);
+    dot_prod_c(temp, wf + 8 + 4 * 5, temp + 8, 4, 8, &scale);
     if (FFMAX(temp[10], temp[11]) <= FFMAX(temp[8], temp[9]))
         d[0] = 1;
     else
@@ -382,21 +406,13 @@ static void byte2word64(const uint8_t *t, const int pitch, float *p)
 
 static void compute_network0new(NNEDIContext *s, const float *datai, const float *weights, uint8_t *d)
 {
-    int16_t *data = (int16_t *)datai;
-    int16_t *ws = (int16_t *)weights;
-    float *wf = (float *)&ws[4 * 64];
-    float vals[8];
+    const int16_t *ws = (const int16_t *)weights;
+    const float *wf = (const float *)&ws[4 * 64];
+    float vals[8], scale = 1.0f;
     int mask, i, j;
 
-    for (i = 0; i < 4; i++) {
-        int sum = 0;
-        float t;
-
-        for (j = 0; j < 64; j++)
-            sum += data[j] * ws[(i << 3) + ((j >> 3) << 5) + (j & 7)];
-        t = sum * wf[i] + wf[4 + i];
-        vals[i] = t / (1.0f + FFABS(t));
-    }
+    s->dsp.dot_prod_int16((const int16_t *)datai, ws, vals, 4, 64, &scale);
+    elliott(vals, 4);
 
     for (i = 0; i < 4; i++) {
         float sum = 0.0f;
@@ -415,12 +431,23 @@ static void compute_network0new(NNEDIContext *s, const float *datai, const float
     ((int *)d)[0] = mask;
 }
 
-static void evalfunc_0(NNEDIContext *s, FrameData *frame_data)
+/**
+ * Restrict the rows first, first + 2, ... below end to the share of the
+ * job jobnr out of nb_jobs.
+ */
+static void slice_rows(int *first, int *end, int jobnr, int nb_jobs)
+{
+    const int count = (*end - *first + 1) / 2;
+
+    *end    = *first + 2 * (count * (jobnr + 1) / nb_jobs);
+    *first += 2 * (count * jobnr / nb_jobs);
+}
+
+static void evalfunc_0(NNEDIContext *s, FrameData *frame_data, int jobnr, int nb_jobs)
 {
-    float *input = frame_data->input;
+    float *input = frame_data->input + jobnr * 512;
     const float *weights0 = s->weights0;
-    float *temp = frame_data->temp;
-    uint8_t *tempu = (uint8_t *)temp;
+    uint8_t *tempu = (uint8_t *)frame_data->temp + jobnr * frame_data->temp_size;
     int plane, x, y;
 
     // And now the actual work.
@@ -440,7 +467,10 @@ static void evalfunc_0(NNEDIContext *s, FrameData *frame_data)
         if (!(s->process_plane & (1 << plane)))
             continue;
 
-        for (y = 1 - frame_data->field[plane]; y < height - 12; y += 2) {
+        ystart = 1 - frame_data->field[plane];
+        ystop = height - 12;
+        slice_rows(&ystart, &ystop, jobnr, nb_jobs);
+        for (y = ystart; y < ystop; y += 2) {
             memcpy(dstp + y * dst_stride,
                    srcp + 32 + (6 + y) * src_stride,
                    (width - 64) * sizeof(uint8_t));
@@ -449,6 +479,7 @@ static void evalfunc_0(NNEDIContext *s, FrameData *frame_data)
 
         ystart = 6 + frame_data->field[plane];
         ystop = height - 6;
+        slice_rows(&ystart, &ystop, jobnr, nb_jobs);
         srcp += ystart * src_stride;
         dstp += (ystart - 6) * dst_stride - 32;
         src3p = srcp - src_stride * 3;
@@ -575,10 +606,10 @@ static void weighted_avg_elliott_mul5_m16(const float *w, const int n, float *ms
 }
 
 
-static void evalfunc_1(NNEDIContext *s, FrameData *frame_data)
+static void evalfunc_1(NNEDIContext *s, FrameData *frame_data, int jobnr, int nb_jobs)
 {
-    float *input = frame_data->input;
-    float *temp = frame_data->temp;
+    float *input = frame_data->input + jobnr * 512;
+    float *temp = (float *)((uint8_t *)frame_data->temp + jobnr * frame_data->temp_size);
     float **weights1 = s->weights1;
     const int qual = s->qual;
     const int asize = s->asize;
@@ -599,13 +630,15 @@ static void evalfunc_1(NNEDIContext *s, FrameData *frame_data)
         uint8_t *dstp = (uint8_t *)frame_data->dstp[plane];
         const int dst_stride = frame_data->dst_stride[plane] / sizeof(uint8_t);
 
-        const int ystart = frame_data->field[plane];
-        const int ystop = height - 12;
+        int ystart = frame_data->field[plane];
+        int ystop = height - 12;
         const uint8_t *srcpp;
 
         if (!(s->process_plane & (1 << plane)))
             continue;
 
+        slice_rows(&ystart, &ystop, jobnr, nb_jobs);
+
         srcp += (ystart + 6) * src_stride;
         dstp += ystart * dst_stride - 32;
         srcpp = srcp - (ydia - 1) * src_stride - xdiad2m1;
@@ -686,6 +719,20 @@ static int modnpf(const int m, const int n)
     return m + n - (m % n);
 }
 
+static int filter_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    NNEDIContext *s = ctx->priv;
+    FrameData *frame_data = arg;
+
+    // Handles prescreening and the cubic interpolation.
+    s->evalfunc_0(s, frame_data, jobnr, nb_jobs);
+
+    // The rest.
+    s->evalfunc_1(s, frame_data, jobnr, nb_jobs);
+
+    return 0;
+}
+
 static int get_frame(AVFilterContext *ctx, int is_second)
 {
     NNEDIContext *s = ctx->priv;
@@ -693,7 +740,6 @@ static int get_frame(AVFilterContext *ctx, int is_second)
     AVFrame *src = s->src;
     FrameData *frame_data;
     int effective_field = s->field;
-    size_t temp_size;
     int field_n;
     int plane;
 
@@ -766,15 +812,15 @@ static int get_frame(AVFilterContext *ctx, int is_second)
     }
 
     if (!frame_data->input) {
-        frame_data->input = av_malloc(512 * sizeof(float));
+        frame_data->input = av_malloc_array(s->nb_threads, 512 * sizeof(float));
         if (!frame_data->input)
             return AVERROR(ENOMEM);
     }
     // evalfunc_0 requires at least padded_width[0] bytes.
     // evalfunc_1 requires at least 512 floats.
     if (!frame_data->temp) {
-        temp_size = FFMAX(frame_data->padded_width[0], 512 * sizeof(float));
-        frame_data->temp = av_malloc(temp_size);
+        frame_data->temp_size = FFALIGN(FFMAX(frame_data->padded_width[0], 512 * sizeof(float)), 64);
+        frame_data->temp = av_malloc_array(s->nb_threads, frame_data->temp_size);
         if (!frame_data->temp)
             return AVERROR(ENOMEM);
     }
@@ -782,11 +828,8 @@ static int get_frame(AVFilterContext *ctx, int is_second)
     // Copy src to a padded "frame" in frame_data and mirror the edges.
     s->copy_pad(src, frame_data, s, field_n);
 
-    // Handles prescreening and the cubic interpolation.
-    s->evalfunc_0(s, frame_data);
-
-    // The rest.
-    s->evalfunc_1(s, frame_data);
+    ctx->internal->execute(ctx, filter_slice, frame_data, NULL,
+                           FFMAX(1, FFMIN(s->planeheight[0] / 2, s->nb_threads)));
 
     return 0;
 }
@@ -1020,6 +1063,7 @@ static av_cold int init(AVFilterContext *ctx)
         }
         // Factor mean removal and 1.0/127.5 scaling
         // into first layer weights. scale to int16 range
+        // and store the weights of each neuron contiguously.
         for (j = 0; j < 4; j++) {
             double scale, mval = 0.0;
 
@@ -1027,7 +1071,7 @@ static av_cold int init(AVFilterContext *ctx)
                 mval = FFMAX(mval, FFABS((bdw[offt[j * 64 + k]] - mean[j]) / 127.5));
             scale = 32767.0 / mval;
             for (k = 0; k < 64; k++)
-                ws[offt[j * 64 + k]] = roundds(((bdw[offt[j * 64 + k]] - mean[j]) / 127.5) * scale);
+                ws[j * 64 + k] = roundds(((bdw[offt[j * 64 + k]] - mean[j]) / 127.5) * scale);
             wf[j] = (float)(mval / 32767.0);
         }
         memcpy(wf + 4, bdw + 4 * 64, (dims0new - 4 * 64) * sizeof(float));
@@ -1147,9 +1191,7 @@ static av_cold int init(AVFilterContext *ctx)
 
     select_functions(s);
 
-    s->fdsp = avpriv_float_dsp_alloc(0);
-    if (!s->fdsp)
-        ret = AVERROR(ENOMEM);
+    ff_nnedi_init_dsp(&s->dsp);
 
 fail:
     av_free(bdata);
@@ -1173,7 +1215,6 @@ static av_cold void uninit(AVFilterContext *ctx)
 
     av_freep(&s->frame_data.input);
     av_freep(&s->frame_data.temp);
-    av_freep(&s->fdsp);
     av_frame_free(&s->second);
 }
 
@@ -1207,5 +1248,5 @@ AVFilter ff_vf_nnedi = {
     .query_formats = query_formats,
     .inputs        = inputs,
     .outputs       = outputs,
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_INTERNAL,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_INTERNAL | AVFILTER_FLAG_SLICE_THREADS,
 };
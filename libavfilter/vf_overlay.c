@@ -38,6 +38,7 @@
 #include "internal.h"
 #include "dualinput.h"
 #include "drawutils.h"
+#include "overlay.h"
 #include "video.h"
 
 static const char *const var_names[] = {
@@ -132,6 +133,8 @@ typedef struct OverlayContext {
     int eof_action;             ///< action to take on EOF from source
 
     AVExpr *x_pexpr, *y_pexpr;
+
+    OverlayDSPContext dsp;
 } OverlayContext;
 
 static av_cold void uninit(AVFilterContext *ctx)
@@ -394,195 +397,358 @@ static int config_output(AVFilterLink *outlink)
 // ((((x) + (y)) << 8) - ((x) + (y)) - (y) * (x)) is a faster version of: 255 * (x + y)
 #define UNPREMULTIPLY_ALPHA(x, y) ((((x) << 16) - ((x) << 9) + (x)) / ((((x) + (y)) << 8) - ((x) + (y)) - (y) * (x)))
 
-/**
- * Blend image in src to destination buffer dst at position (x, y).
- */
-static void blend_image(AVFilterContext *ctx,
-                        AVFrame *dst, const AVFrame *src,
-                        int x, int y)
+typedef struct ThreadData {
+    AVFrame *dst;
+    const AVFrame *src;
+    int x, y;
+} ThreadData;
+
+static int blend_row_44_c(uint8_t *d, const uint8_t *s, const uint8_t *a,
+                          int w, ptrdiff_t alinesize)
 {
-    OverlayContext *s = ctx->priv;
-    int i, imax, j, jmax, k, kmax;
+    int k;
+
+    for (k = 0; k < w; k++)
+        d[k] = FAST_DIV255(d[k] * (255 - a[k]) + s[k] * a[k]);
+    return w;
+}
+
+static int blend_row_20_c(uint8_t *d, const uint8_t *s, const uint8_t *a,
+                          int w, ptrdiff_t alinesize)
+{
+    int k;
+
+    for (k = 0; k < w; k++) {
+        int alpha = (a[2 * k]             + a[2 * k + 1] +
+                     a[2 * k + alinesize] + a[2 * k + alinesize + 1]) >> 2;
+        d[k] = FAST_DIV255(d[k] * (255 - alpha) + s[k] * alpha);
+    }
+    return w;
+}
+
+/* A zero or opaque overlay alpha goes through the generic blending
+ * equations unchanged, so no special case is needed here. */
+#define BLEND_ROW_PACKED(name, ia)                                            \
+static int blend_row_##name##_c(uint8_t *d, const uint8_t *s, int w)          \
+{                                                                             \
+    int j, c;                                                                 \
+                                                                              \
+    for (j = 0; j < w; j++) {                                                 \
+        int alpha = s[ia];                                                    \
+        if (alpha != 0 && alpha != 255)                                       \
+            alpha = UNPREMULTIPLY_ALPHA(alpha, d[ia]);                        \
+        for (c = 0; c < 4; c++)                                               \
+            if (c != ia)                                                      \
+                d[c] = FAST_DIV255(d[c] * (255 - alpha) + s[c] * alpha);      \
+        d[ia] += FAST_DIV255((255 - d[ia]) * s[ia]);                          \
+        d += 4;                                                               \
+        s += 4;                                                               \
+    }                                                                         \
+    return w;                                                                 \
+}
+
+BLEND_ROW_PACKED(rgba, 3)
+BLEND_ROW_PACKED(argb, 0)
+
+void ff_overlay_init_dsp(OverlayDSPContext *dsp)
+{
+    dsp->blend_row_44   = blend_row_44_c;
+    dsp->blend_row_20   = blend_row_20_c;
+    dsp->blend_row_rgba = blend_row_rgba_c;
+    dsp->blend_row_argb = blend_row_argb_c;
+
+    if (ARCH_X86)
+        ff_overlay_init_dsp_x86(dsp);
+}
+
+static void blend_slice_packed_rgb(AVFilterContext *ctx,
+                                   AVFrame *dst, const AVFrame *src,
+                                   int x, int y, int jobnr, int nb_jobs)
+{
+    OverlayContext *ov = ctx->priv;
+    int i, imax, j, jmax;
     const int src_w = src->width;
     const int src_h = src->height;
     const int dst_w = dst->width;
     const int dst_h = dst->height;
+    uint8_t alpha;          ///< the amount of overlay to blend on to main
+    const int dr = ov->main_rgba_map[R];
+    const int dg = ov->main_rgba_map[G];
+    const int db = ov->main_rgba_map[B];
+    const int da = ov->main_rgba_map[A];
+    const int dstep = ov->main_pix_step[0];
+    const int sr = ov->overlay_rgba_map[R];
+    const int sg = ov->overlay_rgba_map[G];
+    const int sb = ov->overlay_rgba_map[B];
+    const int sa = ov->overlay_rgba_map[A];
+    const int sstep = ov->overlay_pix_step[0];
+    const int main_has_alpha = ov->main_has_alpha;
+    const int slice_start = FFMAX(-y, 0);
+    const int slice_h     = FFMIN(-y + dst_h, src_h) - slice_start;
+    int (*blend_row)(uint8_t *d, const uint8_t *s, int w) = NULL;
+    uint8_t *s, *sp, *d, *dp;
+
+    if (main_has_alpha && dstep == 4 && sstep == 4 &&
+        !memcmp(ov->main_rgba_map, ov->overlay_rgba_map, 4))
+        blend_row = da == 3 ? ov->dsp.blend_row_rgba :
+                    da == 0 ? ov->dsp.blend_row_argb : NULL;
+
+    i = slice_start + (slice_h *  jobnr     ) / nb_jobs;
+    sp = src->data[0] + i     * src->linesize[0];
+    dp = dst->data[0] + (y+i) * dst->linesize[0];
+
+    for (imax = slice_start + (slice_h * (jobnr + 1)) / nb_jobs; i < imax; i++) {
+        j = FFMAX(-x, 0);
+        s = sp + j     * sstep;
+        d = dp + (x+j) * dstep;
+        jmax = FFMIN(-x + dst_w, src_w);
+
+        if (blend_row) {
+            int c = blend_row(d, s, jmax - j);
+            s += c * sstep;
+            d += c * dstep;
+            j += c;
+        }
 
-    if (x >= dst_w || x+src_w < 0 ||
-        y >= dst_h || y+src_h < 0)
-        return; /* no intersection */
+        for (; j < jmax; j++) {
+            alpha = s[sa];
 
-    if (s->main_is_packed_rgb) {
-        uint8_t alpha;          ///< the amount of overlay to blend on to main
-        const int dr = s->main_rgba_map[R];
-        const int dg = s->main_rgba_map[G];
-        const int db = s->main_rgba_map[B];
-        const int da = s->main_rgba_map[A];
-        const int dstep = s->main_pix_step[0];
-        const int sr = s->overlay_rgba_map[R];
-        const int sg = s->overlay_rgba_map[G];
-        const int sb = s->overlay_rgba_map[B];
-        const int sa = s->overlay_rgba_map[A];
-        const int sstep = s->overlay_pix_step[0];
-        const int main_has_alpha = s->main_has_alpha;
-        uint8_t *s, *sp, *d, *dp;
-
-        i = FFMAX(-y, 0);
-        sp = src->data[0] + i     * src->linesize[0];
-        dp = dst->data[0] + (y+i) * dst->linesize[0];
-
-        for (imax = FFMIN(-y + dst_h, src_h); i < imax; i++) {
-            j = FFMAX(-x, 0);
-            s = sp + j     * sstep;
-            d = dp + (x+j) * dstep;
-
-            for (jmax = FFMIN(-x + dst_w, src_w); j < jmax; j++) {
-                alpha = s[sa];
-
-                // if the main channel has an alpha channel, alpha has to be calculated
-                // to create an un-premultiplied (straight) alpha value
-                if (main_has_alpha && alpha != 0 && alpha != 255) {
-                    uint8_t alpha_d = d[da];
-                    alpha = UNPREMULTIPLY_ALPHA(alpha, alpha_d);
-                }
+            // if the main channel has an alpha channel, alpha has to be calculated
+            // to create an un-premultiplied (straight) alpha value
+            if (main_has_alpha && alpha != 0 && alpha != 255) {
+                uint8_t alpha_d = d[da];
+                alpha = UNPREMULTIPLY_ALPHA(alpha, alpha_d);
+            }
 
+            switch (alpha) {
+            case 0:
+                break;
+            case 255:
+                d[dr] = s[sr];
+                d[dg] = s[sg];
+                d[db] = s[sb];
+                break;
+            default:
+                // main_value = main_value * (1 - alpha) + overlay_value * alpha
+                // since alpha is in the range 0-255, the result must divided by 255
+                d[dr] = FAST_DIV255(d[dr] * (255 - alpha) + s[sr] * alpha);
+                d[dg] = FAST_DIV255(d[dg] * (255 - alpha) + s[sg] * alpha);
+                d[db] = FAST_DIV255(d[db] * (255 - alpha) + s[sb] * alpha);
+            }
+            if (main_has_alpha) {
                 switch (alpha) {
                 case 0:
                     break;
                 case 255:
-                    d[dr] = s[sr];
-                    d[dg] = s[sg];
-                    d[db] = s[sb];
+                    d[da] = s[sa];
                     break;
                 default:
-                    // main_value = main_value * (1 - alpha) + overlay_value * alpha
-                    // since alpha is in the range 0-255, the result must divided by 255
-                    d[dr] = FAST_DIV255(d[dr] * (255 - alpha) + s[sr] * alpha);
-                    d[dg] = FAST_DIV255(d[dg] * (255 - alpha) + s[sg] * alpha);
-                    d[db] = FAST_DIV255(d[db] * (255 - alpha) + s[sb] * alpha);
+                    // apply alpha compositing: main_alpha += (1-main_alpha) * overlay_alpha
+                    d[da] += FAST_DIV255((255 - d[da]) * s[sa]);
                 }
-                if (main_has_alpha) {
-                    switch (alpha) {
-                    case 0:
-                        break;
-                    case 255:
-                        d[da] = s[sa];
-                        break;
-                    default:
-                        // apply alpha compositing: main_alpha += (1-main_alpha) * overlay_alpha
-                        d[da] += FAST_DIV255((255 - d[da]) * s[sa]);
-                    }
-                }
-                d += dstep;
-                s += sstep;
             }
-            dp += dst->linesize[0];
-            sp += src->linesize[0];
+            d += dstep;
+            s += sstep;
         }
-    } else {
-        const int main_has_alpha = s->main_has_alpha;
-        if (main_has_alpha) {
-            uint8_t alpha;          ///< the amount of overlay to blend on to main
-            uint8_t *s, *sa, *d, *da;
-
-            i = FFMAX(-y, 0);
-            sa = src->data[3] + i     * src->linesize[3];
-            da = dst->data[3] + (y+i) * dst->linesize[3];
-
-            for (imax = FFMIN(-y + dst_h, src_h); i < imax; i++) {
-                j = FFMAX(-x, 0);
-                s = sa + j;
-                d = da + x+j;
-
-                for (jmax = FFMIN(-x + dst_w, src_w); j < jmax; j++) {
-                    alpha = *s;
-                    if (alpha != 0 && alpha != 255) {
-                        uint8_t alpha_d = *d;
-                        alpha = UNPREMULTIPLY_ALPHA(alpha, alpha_d);
-                    }
-                    switch (alpha) {
-                    case 0:
-                        break;
-                    case 255:
-                        *d = *s;
-                        break;
-                    default:
-                        // apply alpha compositing: main_alpha += (1-main_alpha) * overlay_alpha
-                        *d += FAST_DIV255((255 - *d) * *s);
-                    }
-                    d += 1;
-                    s += 1;
-                }
-                da += dst->linesize[3];
-                sa += src->linesize[3];
+        dp += dst->linesize[0];
+        sp += src->linesize[0];
+    }
+}
+
+static void blend_slice_alpha(AVFrame *dst, const AVFrame *src,
+                              int x, int y, int jobnr, int nb_jobs)
+{
+    int i, imax, j, jmax;
+    const int src_w = src->width;
+    const int src_h = src->height;
+    const int dst_w = dst->width;
+    const int dst_h = dst->height;
+    const int slice_start = FFMAX(-y, 0);
+    const int slice_h     = FFMIN(-y + dst_h, src_h) - slice_start;
+    uint8_t alpha;          ///< the amount of overlay to blend on to main
+    uint8_t *s, *sa, *d, *da;
+
+    i = slice_start + (slice_h *  jobnr     ) / nb_jobs;
+    sa = src->data[3] + i     * src->linesize[3];
+    da = dst->data[3] + (y+i) * dst->linesize[3];
+
+    for (imax = slice_start + (slice_h * (jobnr + 1)) / nb_jobs; i < imax; i++) {
+        j = FFMAX(-x, 0);
+        s = sa + j;
+        d = da + x+j;
+
+        for (jmax = FFMIN(-x + dst_w, src_w); j < jmax; j++) {
+            alpha = *s;
+            if (alpha != 0 && alpha != 255) {
+                uint8_t alpha_d = *d;
+                alpha = UNPREMULTIPLY_ALPHA(alpha, alpha_d);
+            }
+            switch (alpha) {
+            case 0:
+                break;
+            case 255:
+                *d = *s;
+                break;
+            default:
+                // apply alpha compositing: main_alpha += (1-main_alpha) * overlay_alpha
+                *d += FAST_DIV255((255 - *d) * *s);
             }
+            d += 1;
+            s += 1;
         }
-        for (i = 0; i < 3; i++) {
-            int hsub = i ? s->hsub : 0;
-            int vsub = i ? s->vsub : 0;
-            int src_wp = AV_CEIL_RSHIFT(src_w, hsub);
-            int src_hp = AV_CEIL_RSHIFT(src_h, vsub);
-            int dst_wp = AV_CEIL_RSHIFT(dst_w, hsub);
-            int dst_hp = AV_CEIL_RSHIFT(dst_h, vsub);
-            int yp = y>>vsub;
-            int xp = x>>hsub;
-            uint8_t *s, *sp, *d, *dp, *a, *ap;
-
-            j = FFMAX(-yp, 0);
-            sp = src->data[i] + j         * src->linesize[i];
-            dp = dst->data[i] + (yp+j)    * dst->linesize[i];
-            ap = src->data[3] + (j<<vsub) * src->linesize[3];
-
-            for (jmax = FFMIN(-yp + dst_hp, src_hp); j < jmax; j++) {
-                k = FFMAX(-xp, 0);
-                d = dp + xp+k;
-                s = sp + k;
-                a = ap + (k<<hsub);
-
-                for (kmax = FFMIN(-xp + dst_wp, src_wp); k < kmax; k++) {
-                    int alpha_v, alpha_h, alpha;
-
-                    // average alpha for color components, improve quality
-                    if (hsub && vsub && j+1 < src_hp && k+1 < src_wp) {
-                        alpha = (a[0] + a[src->linesize[3]] +
-                                 a[1] + a[src->linesize[3]+1]) >> 2;
-                    } else if (hsub || vsub) {
-                        alpha_h = hsub && k+1 < src_wp ?
-                            (a[0] + a[1]) >> 1 : a[0];
-                        alpha_v = vsub && j+1 < src_hp ?
-                            (a[0] + a[src->linesize[3]]) >> 1 : a[0];
-                        alpha = (alpha_v + alpha_h) >> 1;
-                    } else
-                        alpha = a[0];
-                    // if the main channel has an alpha channel, alpha has to be calculated
-                    // to create an un-premultiplied (straight) alpha value
-                    if (main_has_alpha && alpha != 0 && alpha != 255) {
-                        // average alpha for color components, improve quality
-                        uint8_t alpha_d;
-                        if (hsub && vsub && j+1 < src_hp && k+1 < src_wp) {
-                            alpha_d = (d[0] + d[src->linesize[3]] +
-                                       d[1] + d[src->linesize[3]+1]) >> 2;
-                        } else if (hsub || vsub) {
-                            alpha_h = hsub && k+1 < src_wp ?
-                                (d[0] + d[1]) >> 1 : d[0];
-                            alpha_v = vsub && j+1 < src_hp ?
-                                (d[0] + d[src->linesize[3]]) >> 1 : d[0];
-                            alpha_d = (alpha_v + alpha_h) >> 1;
-                        } else
-                            alpha_d = d[0];
-                        alpha = UNPREMULTIPLY_ALPHA(alpha, alpha_d);
-                    }
-                    *d = FAST_DIV255(*d * (255 - alpha) + *s * alpha);
-                    s++;
-                    d++;
-                    a += 1 << hsub;
-                }
-                dp += dst->linesize[i];
-                sp += src->linesize[i];
-                ap += (1 << vsub) * src->linesize[3];
+        da += dst->linesize[3];
+        sa += src->linesize[3];
+    }
+}
+
+static void blend_slice_plane(AVFilterContext *ctx,
+                              AVFrame *dst, const AVFrame *src,
+                              int x, int y, int i, int jobnr, int nb_jobs)
+{
+    OverlayContext *ov = ctx->priv;
+    const int main_has_alpha = ov->main_has_alpha;
+    const int src_w = src->width;
+    const int src_h = src->height;
+    const int dst_w = dst->width;
+    const int dst_h = dst->height;
+    int hsub = i ? ov->hsub : 0;
+    int vsub = i ? ov->vsub : 0;
+    int src_wp = AV_CEIL_RSHIFT(src_w, hsub);
+    int src_hp = AV_CEIL_RSHIFT(src_h, vsub);
+    int dst_wp = AV_CEIL_RSHIFT(dst_w, hsub);
+    int dst_hp = AV_CEIL_RSHIFT(dst_h, vsub);
+    int yp = y>>vsub;
+    int xp = x>>hsub;
+    const int slice_start = FFMAX(-yp, 0);
+    const int slice_h     = FFMIN(-yp + dst_hp, src_hp) - slice_start;
+    int (*blend_row_44)(uint8_t *d, const uint8_t *s, const uint8_t *a,
+                        int w, ptrdiff_t alinesize) = NULL;
+    int (*blend_row_20)(uint8_t *d, const uint8_t *s, const uint8_t *a,
+                        int w, ptrdiff_t alinesize) = NULL;
+    int j, jmax, k, kmax;
+    uint8_t *s, *sp, *d, *dp, *a, *ap;
+
+    if (!main_has_alpha) {
+        if (!hsub && !vsub)
+            blend_row_44 = ov->dsp.blend_row_44;
+        else if (hsub == 1 && vsub == 1)
+            blend_row_20 = ov->dsp.blend_row_20;
+    }
+
+    j = slice_start + (slice_h *  jobnr     ) / nb_jobs;
+    sp = src->data[i] + j         * src->linesize[i];
+    dp = dst->data[i] + (yp+j)    * dst->linesize[i];
+    ap = src->data[3] + (j<<vsub) * src->linesize[3];
+
+    for (jmax = slice_start + (slice_h * (jobnr + 1)) / nb_jobs; j < jmax; j++) {
+        k = FFMAX(-xp, 0);
+        d = dp + xp+k;
+        s = sp + k;
+        a = ap + (k<<hsub);
+        kmax = FFMIN(-xp + dst_wp, src_wp);
+
+        if (blend_row_44) {
+            int c = blend_row_44(d, s, a, kmax - k, src->linesize[3]);
+            s += c;
+            d += c;
+            a += c;
+            k += c;
+        } else if (blend_row_20 && j+1 < src_hp && FFMIN(kmax, src_wp - 1) > k) {
+            // the last column and row use a different alpha average
+            int c = blend_row_20(d, s, a, FFMIN(kmax, src_wp - 1) - k,
+                                 src->linesize[3]);
+            s += c;
+            d += c;
+            a += 2 * c;
+            k += c;
+        }
+
+        for (; k < kmax; k++) {
+            int alpha_v, alpha_h, alpha;
+
+            // average alpha for color components, improve quality
+            if (hsub && vsub && j+1 < src_hp && k+1 < src_wp) {
+                alpha = (a[0] + a[src->linesize[3]] +
+                         a[1] + a[src->linesize[3]+1]) >> 2;
+            } else if (hsub || vsub) {
+                alpha_h = hsub && k+1 < src_wp ?
+                    (a[0] + a[1]) >> 1 : a[0];
+                alpha_v = vsub && j+1 < src_hp ?
+                    (a[0] + a[src->linesize[3]]) >> 1 : a[0];
+                alpha = (alpha_v + alpha_h) >> 1;
+            } else
+                alpha = a[0];
+            // if the main channel has an alpha channel, alpha has to be calculated
+            // to create an un-premultiplied (straight) alpha value
+            if (main_has_alpha && alpha != 0 && alpha != 255) {
+                // average alpha for color components, improve quality
+                uint8_t alpha_d;
+                if (hsub && vsub && j+1 < src_hp && k+1 < src_wp) {
+                    alpha_d = (d[0] + d[src->linesize[3]] +
+                               d[1] + d[src->linesize[3]+1]) >> 2;
+                } else if (hsub || vsub) {
+                    alpha_h = hsub && k+1 < src_wp ?
+                        (d[0] + d[1]) >> 1 : d[0];
+                    alpha_v = vsub && j+1 < src_hp ?
+                        (d[0] + d[src->linesize[3]]) >> 1 : d[0];
+                    alpha_d = (alpha_v + alpha_h) >> 1;
+                } else
+                    alpha_d = d[0];
+                alpha = UNPREMULTIPLY_ALPHA(alpha, alpha_d);
             }
+            *d = FAST_DIV255(*d * (255 - alpha) + *s * alpha);
+            s++;
+            d++;
+            a += 1 << hsub;
         }
+        dp += dst->linesize[i];
+        sp += src->linesize[i];
+        ap += (1 << vsub) * src->linesize[3];
+    }
+}
+
+static int blend_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    OverlayContext *s = ctx->priv;
+    ThreadData *td = arg;
+
+    if (s->main_is_packed_rgb) {
+        blend_slice_packed_rgb(ctx, td->dst, td->src, td->x, td->y, jobnr, nb_jobs);
+    } else {
+        int i;
+
+        if (s->main_has_alpha)
+            blend_slice_alpha(td->dst, td->src, td->x, td->y, jobnr, nb_jobs);
+        for (i = 0; i < 3; i++)
+            blend_slice_plane(ctx, td->dst, td->src, td->x, td->y, i, jobnr, nb_jobs);
     }
+    return 0;
+}
+
+/**
+ * Blend image in src to destination buffer dst at position (x, y).
+ */
+static void blend_image(AVFilterContext *ctx,
+                        AVFrame *dst, const AVFrame *src,
+                        int x, int y)
+{
+    OverlayContext *s = ctx->priv;
+    ThreadData td = { .dst = dst, .src = src, .x = x, .y = y };
+    int nb_jobs;
+
+    if (x >= dst->width  || x+src->width  < 0 ||
+        y >= dst->height || y+src->height < 0)
+        return; /* no intersection */
+
+    /* When the main picture has an alpha, the subsampled planes read the
+     * main pixels of the following rows, which must not be blended yet. */
+    if (!s->main_is_packed_rgb && s->main_has_alpha && (s->hsub || s->vsub))
+        nb_jobs = 1;
+    else
+        nb_jobs = FFMIN(AV_CEIL_RSHIFT(FFMIN(dst->height, src->height), s->vsub),
+                        ctx->graph->nb_threads);
+
+    ctx->internal->execute(ctx, blend_slice, &td, NULL, FFMAX(nb_jobs, 1));
 }
 
 static AVFrame *do_blend(AVFilterContext *ctx, AVFrame *mainpic,
@@ -647,6 +813,7 @@ static av_cold int init(AVFilterContext *ctx)
     }
 
     s->dinput.process = do_blend;
+    ff_overlay_init_dsp(&s->dsp);
     return 0;
 }
 
@@ -716,5 +883,6 @@ AVFilter ff_vf_overlay = {
     .process_command = process_command,
     .inputs        = avfilter_vf_overlay_inputs,
     .outputs       = avfilter_vf_overlay_outputs,
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_INTERNAL,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_INTERNAL |
+                     AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -73,6 +73,8 @@ typedef struct {
     struct range_box boxes[256];            // define the segmentation of the colorspace (the final palette)
     int nb_boxes;                           // number of boxes (increase will segmenting them)
     int palette_pushed;                     // if the palette frame is pushed into the outlink or not
+    int nb_jobs;                            // number of histogram update jobs
+    int *jobs_rets;                         // number of new colors found by each job
 } PaletteGenContext;
 
 #define OFFSET(x) offsetof(PaletteGenContext, x)
@@ -405,10 +407,9 @@ static inline unsigned color_hash(uint32_t color)
 /**
  * Locate the color in the hash table and increment its counter.
  */
-static int color_inc(struct hist_node *hist, uint32_t color)
+static int color_inc(struct hist_node *hist, uint32_t color, unsigned hash)
 {
     int i;
-    const unsigned hash = color_hash(color);
     struct hist_node *node = &hist[hash];
     struct color_ref *e;
 
@@ -431,9 +432,11 @@ static int color_inc(struct hist_node *hist, uint32_t color)
 
 /**
  * Update histogram when pixels differ from previous frame.
+ * Only the colors hashed in [hash_start;hash_end) are accounted.
  */
 static int update_histogram_diff(struct hist_node *hist,
-                                 const AVFrame *f1, const AVFrame *f2)
+                                 const AVFrame *f1, const AVFrame *f2,
+                                 unsigned hash_start, unsigned hash_end)
 {
     int x, y, ret, nb_diff_colors = 0;
 
@@ -442,9 +445,11 @@ static int update_histogram_diff(struct hist_node *hist,
         const uint32_t *q = (const uint32_t *)(f2->data[0] + y*f2->linesize[0]);
 
         for (x = 0; x < f1->width; x++) {
-            if (p[x] == q[x])
+            const unsigned hash = color_hash(p[x]);
+
+            if (p[x] == q[x] || hash < hash_start || hash >= hash_end)
                 continue;
-            ret = color_inc(hist, p[x]);
+            ret = color_inc(hist, p[x], hash);
             if (ret < 0)
                 return ret;
             nb_diff_colors += ret;
@@ -455,8 +460,10 @@ static int update_histogram_diff(struct hist_node *hist,
 
 /**
  * Simple histogram of the frame.
+ * Only the colors hashed in [hash_start;hash_end) are accounted.
  */
-static int update_histogram_frame(struct hist_node *hist, const AVFrame *f)
+static int update_histogram_frame(struct hist_node *hist, const AVFrame *f,
+                                  unsigned hash_start, unsigned hash_end)
 {
     int x, y, ret, nb_diff_colors = 0;
 
@@ -464,7 +471,11 @@ static int update_histogram_frame(struct hist_node *hist, const AVFrame *f)
         const uint32_t *p = (const uint32_t *)(f->data[0] + y*f->linesize[0]);
 
         for (x = 0; x < f->width; x++) {
-            ret = color_inc(hist, p[x]);
+            const unsigned hash = color_hash(p[x]);
+
+            if (hash < hash_start || hash >= hash_end)
+                continue;
+            ret = color_inc(hist, p[x], hash);
             if (ret < 0)
                 return ret;
             nb_diff_colors += ret;
@@ -473,6 +484,26 @@ static int update_histogram_frame(struct hist_node *hist, const AVFrame *f)
     return nb_diff_colors;
 }
 
+typedef struct ThreadData {
+    const AVFrame *prev, *cur;
+} ThreadData;
+
+/**
+ * Each job owns a range of the hash table and scans the whole frame for the
+ * colors falling in it, so the jobs never touch the same entries and the
+ * table ends up identical to the one built by a single job.
+ */
+static int update_histogram_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    PaletteGenContext *s = ctx->priv;
+    const ThreadData *td = arg;
+    const unsigned hash_start = (HIST_SIZE *  jobnr   ) / nb_jobs;
+    const unsigned hash_end   = (HIST_SIZE * (jobnr+1)) / nb_jobs;
+
+    return td->prev ? update_histogram_diff(s->histogram, td->prev, td->cur, hash_start, hash_end)
+                    : update_histogram_frame(s->histogram, td->cur, hash_start, hash_end);
+}
+
 /**
  * Update the histogram for each passing frame. No frame will be pushed here.
  */
@@ -480,11 +511,19 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
 {
     AVFilterContext *ctx = inlink->dst;
     PaletteGenContext *s = ctx->priv;
-    const int ret = s->prev_frame ? update_histogram_diff(s->histogram, s->prev_frame, in)
-                                  : update_histogram_frame(s->histogram, in);
-
-    if (ret > 0)
-        s->nb_refs += ret;
+    ThreadData td;
+    int i, ret = 0;
+
+    td.prev = s->prev_frame;
+    td.cur  = in;
+    ctx->internal->execute(ctx, update_histogram_slice, &td, s->jobs_rets, s->nb_jobs);
+    for (i = 0; i < s->nb_jobs; i++) {
+        if (s->jobs_rets[i] < 0) {
+            ret = s->jobs_rets[i];
+            break;
+        }
+        s->nb_refs += s->jobs_rets[i];
+    }
 
     if (s->stats_mode == STATS_MODE_DIFF_FRAMES) {
         av_frame_free(&s->prev_frame);
@@ -520,8 +559,17 @@ static int request_frame(AVFilterLink *outlink)
  */
 static int config_output(AVFilterLink *outlink)
 {
+    AVFilterContext *ctx = outlink->src;
+    PaletteGenContext *s = ctx->priv;
+
     outlink->w = outlink->h = 16;
     outlink->sample_aspect_ratio = av_make_q(1, 1);
+
+    s->nb_jobs = FFMAX(1, ctx->graph->nb_threads);
+    av_freep(&s->jobs_rets);
+    s->jobs_rets = av_malloc_array(s->nb_jobs, sizeof(*s->jobs_rets));
+    if (!s->jobs_rets)
+        return AVERROR(ENOMEM);
     return 0;
 }
 
@@ -533,6 +581,7 @@ static av_cold void uninit(AVFilterContext *ctx)
     for (i = 0; i < HIST_SIZE; i++)
         av_freep(&s->histogram[i].entries);
     av_freep(&s->refs);
+    av_freep(&s->jobs_rets);
     av_frame_free(&s->prev_frame);
 }
 
@@ -564,4 +613,5 @@ AVFilter ff_vf_palettegen = {
     .inputs        = palettegen_inputs,
     .outputs       = palettegen_outputs,
     .priv_class    = &palettegen_class,
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
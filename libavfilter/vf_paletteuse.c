@@ -29,6 +29,7 @@
 #include "libavutil/qsort.h"
 #include "dualinput.h"
 #include "avfilter.h"
+#include "paletteuse.h"
 
 enum dithering_mode {
     DITHERING_NONE,
@@ -75,15 +76,19 @@ struct cache_node {
 
 struct PaletteUseContext;
 
-typedef int (*set_frame_func)(struct PaletteUseContext *s, AVFrame *out, AVFrame *in,
+typedef int (*set_frame_func)(struct PaletteUseContext *s, struct cache_node *cache,
+                              AVFrame *out, AVFrame *in,
                               int x_start, int y_start, int width, int height);
 
 typedef struct PaletteUseContext {
     const AVClass *class;
     FFDualInputContext dinput;
-    struct cache_node cache[CACHE_SIZE];    /* lookup cache */
+    struct cache_node *cache;               /* lookup caches, CACHE_SIZE entries per job */
     struct color_node map[AVPALETTE_COUNT]; /* 3D-Tree (KD-Tree with K=3) for reverse colormap */
     uint32_t palette[AVPALETTE_COUNT];
+    DECLARE_ALIGNED(32, int32_t, pal_colors)[4][AVPALETTE_COUNT]; /* opaque colors for the brute-force search */
+    int nb_pal_colors;
+    PaletteUseDSPContext dsp;
     int palette_loaded;
     int dither;
     set_frame_func set_frame;
@@ -92,6 +97,8 @@ typedef struct PaletteUseContext {
     int diff_mode;
     AVFrame *last_in;
     AVFrame *last_out;
+    int nb_jobs;
+    int *jobs_rets;
 
     /* debug options */
     char *dot_filename;
@@ -308,10 +315,15 @@ end:
     return root[best_node_id].palette_id;
 }
 
-#define COLORMAP_NEAREST(search, palette, root, target)                                    \
-    search == COLOR_SEARCH_NNS_ITERATIVE ? colormap_nearest_iterative(root, target) :      \
-    search == COLOR_SEARCH_NNS_RECURSIVE ? colormap_nearest_recursive(root, target) :      \
-                                           colormap_nearest_bruteforce(palette, target)
+static av_always_inline uint8_t colormap_nearest_dsp(const PaletteUseContext *s, const uint8_t *rgb)
+{
+    return s->dsp.nearest_color(s->pal_colors, s->nb_pal_colors, rgb[0], rgb[1], rgb[2]) & 0xff;
+}
+
+#define COLORMAP_NEAREST(s, search, target)                                                \
+    search == COLOR_SEARCH_NNS_ITERATIVE ? colormap_nearest_iterative(s->map, target) :    \
+    search == COLOR_SEARCH_NNS_RECURSIVE ? colormap_nearest_recursive(s->map, target) :    \
+                                           colormap_nearest_dsp(s, target)
 
 /**
  * Check if the requested color is in the cache already. If not, find it in the
@@ -319,10 +331,9 @@ end:
  * Note: r, g, and b are the component of c but are passed as well to avoid
  * recomputing them (they are generally computed by the caller for other uses).
  */
-static av_always_inline int color_get(struct cache_node *cache, uint32_t color,
+static av_always_inline int color_get(const PaletteUseContext *s,
+                                      struct cache_node *cache, uint32_t color,
                                       uint8_t r, uint8_t g, uint8_t b,
-                                      const struct color_node *map,
-                                      const uint32_t *palette,
                                       const enum color_search_method search_method)
 {
     int i;
@@ -345,36 +356,33 @@ static av_always_inline int color_get(struct cache_node *cache, uint32_t color,
     if (!e)
         return AVERROR(ENOMEM);
     e->color = color;
-    e->pal_entry = COLORMAP_NEAREST(search_method, palette, map, rgb);
+    e->pal_entry = COLORMAP_NEAREST(s, search_method, rgb);
     return e->pal_entry;
 }
 
-static av_always_inline int get_dst_color_err(struct cache_node *cache,
-                                              uint32_t c, const struct color_node *map,
-                                              const uint32_t *palette,
+static av_always_inline int get_dst_color_err(const PaletteUseContext *s,
+                                              struct cache_node *cache, uint32_t c,
                                               int *er, int *eg, int *eb,
                                               const enum color_search_method search_method)
 {
     const uint8_t r = c >> 16 & 0xff;
     const uint8_t g = c >>  8 & 0xff;
     const uint8_t b = c       & 0xff;
-    const int dstx = color_get(cache, c, r, g, b, map, palette, search_method);
-    const uint32_t dstc = palette[dstx];
+    const int dstx = color_get(s, cache, c, r, g, b, search_method);
+    const uint32_t dstc = s->palette[dstx];
     *er = r - (dstc >> 16 & 0xff);
     *eg = g - (dstc >>  8 & 0xff);
     *eb = b - (dstc       & 0xff);
     return dstx;
 }
 
-static av_always_inline int set_frame(PaletteUseContext *s, AVFrame *out, AVFrame *in,
+static av_always_inline int set_frame(PaletteUseContext *s, struct cache_node *cache,
+                                      AVFrame *out, AVFrame *in,
                                       int x_start, int y_start, int w, int h,
                                       enum dithering_mode dither,
                                       const enum color_search_method search_method)
 {
     int x, y;
-    const struct color_node *map = s->map;
-    struct cache_node *cache = s->cache;
-    const uint32_t *palette = s->palette;
     const int src_linesize = in ->linesize[0] >> 2;
     const int dst_linesize = out->linesize[0];
     uint32_t *src = ((uint32_t *)in ->data[0]) + y_start*src_linesize;
@@ -396,7 +404,7 @@ static av_always_inline int set_frame(PaletteUseContext *s, AVFrame *out, AVFram
                 const uint8_t g = av_clip_uint8(g8 + d);
                 const uint8_t b = av_clip_uint8(b8 + d);
                 const uint32_t c = r<<16 | g<<8 | b;
-                const int color = color_get(cache, c, r, g, b, map, palette, search_method);
+                const int color = color_get(s, cache, c, r, g, b, search_method);
 
                 if (color < 0)
                     return color;
@@ -404,7 +412,7 @@ static av_always_inline int set_frame(PaletteUseContext *s, AVFrame *out, AVFram
 
             } else if (dither == DITHERING_HECKBERT) {
                 const int right = x < w - 1, down = y < h - 1;
-                const int color = get_dst_color_err(cache, src[x], map, palette, &er, &eg, &eb, search_method);
+                const int color = get_dst_color_err(s, cache, src[x], &er, &eg, &eb, search_method);
 
                 if (color < 0)
                     return color;
@@ -416,7 +424,7 @@ static av_always_inline int set_frame(PaletteUseContext *s, AVFrame *out, AVFram
 
             } else if (dither == DITHERING_FLOYD_STEINBERG) {
                 const int right = x < w - 1, down = y < h - 1, left = x > x_start;
-                const int color = get_dst_color_err(cache, src[x], map, palette, &er, &eg, &eb, search_method);
+                const int color = get_dst_color_err(s, cache, src[x], &er, &eg, &eb, search_method);
 
                 if (color < 0)
                     return color;
@@ -430,7 +438,7 @@ static av_always_inline int set_frame(PaletteUseContext *s, AVFrame *out, AVFram
             } else if (dither == DITHERING_SIERRA2) {
                 const int right  = x < w - 1, down  = y < h - 1, left  = x > x_start;
                 const int right2 = x < w - 2,                    left2 = x > x_start + 1;
-                const int color = get_dst_color_err(cache, src[x], map, palette, &er, &eg, &eb, search_method);
+                const int color = get_dst_color_err(s, cache, src[x], &er, &eg, &eb, search_method);
 
                 if (color < 0)
                     return color;
@@ -449,7 +457,7 @@ static av_always_inline int set_frame(PaletteUseContext *s, AVFrame *out, AVFram
 
             } else if (dither == DITHERING_SIERRA2_4A) {
                 const int right = x < w - 1, down = y < h - 1, left = x > x_start;
-                const int color = get_dst_color_err(cache, src[x], map, palette, &er, &eg, &eb, search_method);
+                const int color = get_dst_color_err(s, cache, src[x], &er, &eg, &eb, search_method);
 
                 if (color < 0)
                     return color;
@@ -463,7 +471,7 @@ static av_always_inline int set_frame(PaletteUseContext *s, AVFrame *out, AVFram
                 const uint8_t r = src[x] >> 16 & 0xff;
                 const uint8_t g = src[x] >>  8 & 0xff;
                 const uint8_t b = src[x]       & 0xff;
-                const int color = color_get(cache, src[x] & 0xffffff, r, g, b, map, palette, search_method);
+                const int color = color_get(s, cache, src[x] & 0xffffff, r, g, b, search_method);
 
                 if (color < 0)
                     return color;
@@ -530,16 +538,16 @@ static int disp_tree(const struct color_node *node, const char *fname)
     return 0;
 }
 
-static int debug_accuracy(const struct color_node *node, const uint32_t *palette,
-                          const enum color_search_method search_method)
+static int debug_accuracy(const PaletteUseContext *s, const enum color_search_method search_method)
 {
     int r, g, b, ret = 0;
+    const uint32_t *palette = s->palette;
 
     for (r = 0; r < 256; r++) {
         for (g = 0; g < 256; g++) {
             for (b = 0; b < 256; b++) {
                 const uint8_t rgb[] = {r, g, b};
-                const int r1 = COLORMAP_NEAREST(search_method, palette, node, rgb);
+                const int r1 = COLORMAP_NEAREST(s, search_method, rgb);
                 const int r2 = colormap_nearest_bruteforce(palette, rgb);
                 if (r1 != r2) {
                     const uint32_t c1 = palette[r1];
@@ -696,6 +704,33 @@ static int cmp_pal_entry(const void *a, const void *b)
     return c1 - c2;
 }
 
+/**
+ * Load the colors left after the removal of the transparent ones and of the
+ * duplicates in the planes used by the brute-force search. The count is padded
+ * to a multiple of 16 with copies of the first color, which do not change the
+ * result of the search.
+ */
+static void load_pal_colors(PaletteUseContext *s, const uint8_t *color_used)
+{
+    int i, n = 0;
+
+    for (i = 0; i < AVPALETTE_COUNT; i++) {
+        const uint32_t c = s->palette[i];
+
+        if (color_used[i])
+            continue;
+        s->pal_colors[0][n] = c >> 16 & 0xff;
+        s->pal_colors[1][n] = c >>  8 & 0xff;
+        s->pal_colors[2][n] = c       & 0xff;
+        s->pal_colors[3][n] = i;
+        n++;
+    }
+    s->nb_pal_colors = FFALIGN(n, 16);
+    for (; n < s->nb_pal_colors; n++)
+        for (i = 0; i < 4; i++)
+            s->pal_colors[i][n] = s->pal_colors[i][0];
+}
+
 static void load_colormap(PaletteUseContext *s)
 {
     int i, nb_used = 0;
@@ -718,6 +753,8 @@ static void load_colormap(PaletteUseContext *s)
         }
     }
 
+    load_pal_colors(s, color_used);
+
     box.min[0] = box.min[1] = box.min[2] = 0x00;
     box.max[0] = box.max[1] = box.max[2] = 0xff;
 
@@ -727,7 +764,7 @@ static void load_colormap(PaletteUseContext *s)
         disp_tree(s->map, s->dot_filename);
 
     if (s->debug_accuracy) {
-        if (!debug_accuracy(s->map, s->palette, s->color_search_method))
+        if (!debug_accuracy(s, s->color_search_method))
             av_log(NULL, AV_LOG_INFO, "Accuracy check passed\n");
     }
 }
@@ -851,9 +888,26 @@ static void set_processing_window(enum diff_mode diff_mode,
     *hp = height;
 }
 
+typedef struct ThreadData {
+    AVFrame *in, *out;
+    int x, y, w, h;
+} ThreadData;
+
+static int set_frame_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    PaletteUseContext *s = ctx->priv;
+    const ThreadData *td = arg;
+    const int slice_start = td->y + (td->h *  jobnr   ) / nb_jobs;
+    const int slice_end   = td->y + (td->h * (jobnr+1)) / nb_jobs;
+
+    return s->set_frame(s, s->cache + jobnr * CACHE_SIZE, td->out, td->in,
+                        td->x, slice_start, td->w, slice_end - slice_start);
+}
+
 static AVFrame *apply_palette(AVFilterLink *inlink, AVFrame *in)
 {
-    int x, y, w, h;
+    int i, x, y, w, h, nb_jobs;
+    ThreadData td;
     AVFilterContext *ctx = inlink->dst;
     PaletteUseContext *s = ctx->priv;
     AVFilterLink *outlink = inlink->dst->outputs[0];
@@ -881,9 +935,21 @@ static AVFrame *apply_palette(AVFilterLink *inlink, AVFrame *in)
     ff_dlog(ctx, "%dx%d rect: (%d;%d) -> (%d,%d) [area:%dx%d]\n",
             w, h, x, y, x+w, y+h, in->width, in->height);
 
-    if (s->set_frame(s, out, in, x, y, w, h) < 0) {
-        av_frame_free(&out);
-        return NULL;
+    /* the error diffusion dithering modes are serial, they always run as
+     * a single job */
+    td.in  = in;
+    td.out = out;
+    td.x = x; td.y = y;
+    td.w = w; td.h = h;
+    nb_jobs = FFMIN(h, s->nb_jobs);
+    memset(s->jobs_rets, 0, nb_jobs * sizeof(*s->jobs_rets));
+    ctx->internal->execute(ctx, set_frame_slice, &td, s->jobs_rets, nb_jobs);
+    for (i = 0; i < nb_jobs; i++) {
+        if (s->jobs_rets[i] < 0) {
+            av_frame_free(&in);
+            av_frame_free(&out);
+            return NULL;
+        }
     }
     memcpy(out->data[1], s->palette, AVPALETTE_SIZE);
     if (s->calc_mean_err)
@@ -892,6 +958,17 @@ static AVFrame *apply_palette(AVFilterLink *inlink, AVFrame *in)
     return out;
 }
 
+static void free_caches(PaletteUseContext *s)
+{
+    int i;
+
+    if (s->cache)
+        for (i = 0; i < s->nb_jobs * CACHE_SIZE; i++)
+            av_freep(&s->cache[i].entries);
+    av_freep(&s->cache);
+    av_freep(&s->jobs_rets);
+}
+
 static int config_output(AVFilterLink *outlink)
 {
     int ret;
@@ -901,6 +978,18 @@ static int config_output(AVFilterLink *outlink)
     outlink->w = ctx->inputs[0]->w;
     outlink->h = ctx->inputs[0]->h;
 
+    /* every job has its own lookup cache; only the bayer and none dithering
+     * modes can be split in slices, the others diffuse the error over the
+     * following rows */
+    free_caches(s);
+    s->nb_jobs = 1;
+    if (s->dither == DITHERING_NONE || s->dither == DITHERING_BAYER)
+        s->nb_jobs = FFMAX(1, FFMIN(outlink->h, ctx->graph->nb_threads));
+    s->cache     = av_mallocz_array(s->nb_jobs * CACHE_SIZE, sizeof(*s->cache));
+    s->jobs_rets = av_malloc_array(s->nb_jobs, sizeof(*s->jobs_rets));
+    if (!s->cache || !s->jobs_rets)
+        return AVERROR(ENOMEM);
+
     outlink->time_base = ctx->inputs[0]->time_base;
     if ((ret = ff_dualinput_init(ctx, &s->dinput)) < 0)
         return ret;
@@ -958,10 +1047,12 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
 }
 
 #define DEFINE_SET_FRAME(color_search, name, value)                             \
-static int set_frame_##name(PaletteUseContext *s, AVFrame *out, AVFrame *in,    \
+static int set_frame_##name(PaletteUseContext *s, struct cache_node *cache,     \
+                            AVFrame *out, AVFrame *in,                          \
                             int x_start, int y_start, int w, int h)             \
 {                                                                               \
-    return set_frame(s, out, in, x_start, y_start, w, h, value, color_search);  \
+    return set_frame(s, cache, out, in, x_start, y_start, w, h,                 \
+                     value, color_search);                                      \
 }
 
 #define DEFINE_SET_FRAME_COLOR_SEARCH(color_search, color_search_macro)                                 \
@@ -999,6 +1090,31 @@ static int dither_value(int p)
            | (p & 1) << 4 | (q & 1) << 5;
 }
 
+static uint32_t nearest_color_c(const int32_t (*pal)[AVPALETTE_COUNT], int n,
+                                int r, int g, int b)
+{
+    int i;
+    uint32_t best = UINT32_MAX;
+
+    for (i = 0; i < n; i++) {
+        const int dr = pal[0][i] - r;
+        const int dg = pal[1][i] - g;
+        const int db = pal[2][i] - b;
+        const uint32_t key = (dr*dr + dg*dg + db*db) << 8 | pal[3][i];
+
+        best = FFMIN(best, key);
+    }
+    return best;
+}
+
+av_cold void ff_paletteuse_init_dsp(PaletteUseDSPContext *dsp)
+{
+    dsp->nearest_color = nearest_color_c;
+
+    if (ARCH_X86)
+        ff_paletteuse_init_dsp_x86(dsp);
+}
+
 static av_cold int init(AVFilterContext *ctx)
 {
     PaletteUseContext *s = ctx->priv;
@@ -1006,6 +1122,7 @@ static av_cold int init(AVFilterContext *ctx)
     s->dinput.process    = load_apply_palette;
 
     s->set_frame = set_frame_lut[s->color_search_method][s->dither];
+    ff_paletteuse_init_dsp(&s->dsp);
 
     if (s->dither == DITHERING_BAYER) {
         int i;
@@ -1026,12 +1143,10 @@ static int request_frame(AVFilterLink *outlink)
 
 static av_cold void uninit(AVFilterContext *ctx)
 {
-    int i;
     PaletteUseContext *s = ctx->priv;
 
     ff_dualinput_uninit(&s->dinput);
-    for (i = 0; i < CACHE_SIZE; i++)
-        av_freep(&s->cache[i].entries);
+    free_caches(s);
     av_frame_free(&s->last_in);
     av_frame_free(&s->last_out);
 }
@@ -1071,4 +1186,5 @@ AVFilter ff_vf_paletteuse = {
     .inputs        = paletteuse_inputs,
     .outputs       = paletteuse_outputs,
     .priv_class    = &paletteuse_class,
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
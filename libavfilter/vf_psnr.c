@@ -51,6 +51,8 @@ typedef struct PSNRContext {
     int planewidth[4];
     int planeheight[4];
     double planeweight[4];
+    int nb_threads;
+    uint64_t (*sse)[4];     ///< per-job sum of squared errors of each plane
     PSNRDSPContext dsp;
 } PSNRContext;
 
@@ -65,62 +67,65 @@ static const AVOption psnr_options[] = {
 
 AVFILTER_DEFINE_CLASS(psnr);
 
-static inline unsigned pow2(unsigned base)
-{
-    return base*base;
-}
+typedef struct ThreadData {
+    const uint8_t *main_data[4];
+    const uint8_t *ref_data[4];
+    int main_linesize[4];
+    int ref_linesize[4];
+} ThreadData;
 
-static inline double get_psnr(double mse, uint64_t nb_frames, int max)
+static int compute_images_sse(AVFilterContext *ctx, void *arg,
+                              int jobnr, int nb_jobs)
 {
-    return 10.0 * log10(pow2(max) / (mse / nb_frames));
-}
+    PSNRContext *s = ctx->priv;
+    ThreadData *td = arg;
+    int i, c;
 
-static uint64_t sse_line_8bit(const uint8_t *main_line,  const uint8_t *ref_line, int outw)
-{
-    int j;
-    unsigned m2 = 0;
+    for (c = 0; c < s->nb_components; c++) {
+        const int outw = s->planewidth[c];
+        const int outh = s->planeheight[c];
+        const int slice_start = (outh *  jobnr   ) / nb_jobs;
+        const int slice_end   = (outh * (jobnr+1)) / nb_jobs;
+        const int ref_linesize = td->ref_linesize[c];
+        const int main_linesize = td->main_linesize[c];
+        const uint8_t *main_line = td->main_data[c] + slice_start * main_linesize;
+        const uint8_t *ref_line = td->ref_data[c] + slice_start * ref_linesize;
+        uint64_t m = 0;
 
-    for (j = 0; j < outw; j++)
-        m2 += pow2(main_line[j] - ref_line[j]);
+        for (i = slice_start; i < slice_end; i++) {
+            m += s->dsp.sse_line(main_line, ref_line, outw);
+            ref_line += ref_linesize;
+            main_line += main_linesize;
+        }
+        s->sse[jobnr][c] = m;
+    }
 
-    return m2;
+    return 0;
 }
 
-static uint64_t sse_line_16bit(const uint8_t *_main_line, const uint8_t *_ref_line, int outw)
+static void compute_images_mse(AVFilterContext *ctx, const AVFrame *main,
+                               const AVFrame *ref, double mse[4])
 {
-    int j;
-    uint64_t m2 = 0;
-    const uint16_t *main_line = (const uint16_t *) _main_line;
-    const uint16_t *ref_line = (const uint16_t *) _ref_line;
-
-    for (j = 0; j < outw; j++)
-        m2 += pow2(main_line[j] - ref_line[j]);
+    PSNRContext *s = ctx->priv;
+    const int nb_jobs = FFMIN(s->planeheight[1], s->nb_threads);
+    ThreadData td;
+    int i, c;
 
-    return m2;
-}
+    for (c = 0; c < s->nb_components; c++) {
+        td.main_data[c] = main->data[c];
+        td.ref_data[c] = ref->data[c];
+        td.main_linesize[c] = main->linesize[c];
+        td.ref_linesize[c] = ref->linesize[c];
+    }
 
-static inline
-void compute_images_mse(PSNRContext *s,
-                        const uint8_t *main_data[4], const int main_linesizes[4],
-                        const uint8_t *ref_data[4], const int ref_linesizes[4],
-                        int w, int h, double mse[4])
-{
-    int i, c;
+    ctx->internal->execute(ctx, compute_images_sse, &td, NULL, nb_jobs);
 
     for (c = 0; c < s->nb_components; c++) {
-        const int outw = s->planewidth[c];
-        const int outh = s->planeheight[c];
-        const uint8_t *main_line = main_data[c];
-        const uint8_t *ref_line = ref_data[c];
-        const int ref_linesize = ref_linesizes[c];
-        const int main_linesize = main_linesizes[c];
         uint64_t m = 0;
-        for (i = 0; i < outh; i++) {
-            m += s->dsp.sse_line(main_line, ref_line, outw);
-            ref_line += ref_linesize;
-            main_line += main_linesize;
-        }
-        mse[c] = m / (double)(outw * outh);
+
+        for (i = 0; i < nb_jobs; i++)
+            m += s->sse[i][c];
+        mse[c] = m / (double)(s->planewidth[c] * s->planeheight[c]);
     }
 }
 
@@ -145,9 +150,7 @@ static AVFrame *do_psnr(AVFilterContext *ctx, AVFrame *main,
     int j, c;
     AVDictionary **metadata = avpriv_frame_get_metadatap(main);
 
-    compute_images_mse(s, (const uint8_t **)main->data, main->linesize,
-                          (const uint8_t **)ref->data, ref->linesize,
-                          main->width, main->height, comp_mse);
+    compute_images_mse(ctx, main, ref, comp_mse);
 
     for (j = 0; j < s->nb_components; j++)
         mse += comp_mse[j] * s->planeweight[j];
@@ -163,10 +166,10 @@ static AVFrame *do_psnr(AVFilterContext *ctx, AVFrame *main,
     for (j = 0; j < s->nb_components; j++) {
         c = s->is_rgb ? s->rgba_map[j] : j;
         set_meta(metadata, "lavfi.psnr.mse.", s->comps[j], comp_mse[c]);
-        set_meta(metadata, "lavfi.psnr.psnr.", s->comps[j], get_psnr(comp_mse[c], 1, s->max[c]));
+        set_meta(metadata, "lavfi.psnr.psnr.", s->comps[j], ff_psnr_get(comp_mse[c], 1, s->max[c]));
     }
     set_meta(metadata, "lavfi.psnr.mse_avg", 0, mse);
-    set_meta(metadata, "lavfi.psnr.psnr_avg", 0, get_psnr(mse, 1, s->average_max));
+    set_meta(metadata, "lavfi.psnr.psnr_avg", 0, ff_psnr_get(mse, 1, s->average_max));
 
     if (s->stats_file) {
         fprintf(s->stats_file, "n:%"PRId64" mse_avg:%0.2f ", s->nb_frames, mse);
@@ -174,11 +177,11 @@ static AVFrame *do_psnr(AVFilterContext *ctx, AVFrame *main,
             c = s->is_rgb ? s->rgba_map[j] : j;
             fprintf(s->stats_file, "mse_%c:%0.2f ", s->comps[j], comp_mse[c]);
         }
-        fprintf(s->stats_file, "psnr_avg:%0.2f ", get_psnr(mse, 1, s->average_max));
+        fprintf(s->stats_file, "psnr_avg:%0.2f ", ff_psnr_get(mse, 1, s->average_max));
         for (j = 0; j < s->nb_components; j++) {
             c = s->is_rgb ? s->rgba_map[j] : j;
             fprintf(s->stats_file, "psnr_%c:%0.2f ", s->comps[j],
-                    get_psnr(comp_mse[c], 1, s->max[c]));
+                    ff_psnr_get(comp_mse[c], 1, s->max[c]));
         }
         fprintf(s->stats_file, "\n");
     }
@@ -278,9 +281,12 @@ static int config_input_ref(AVFilterLink *inlink)
         s->average_max += s->max[j] * s->planeweight[j];
     }
 
-    s->dsp.sse_line = desc->comp[0].depth > 8 ? sse_line_16bit : sse_line_8bit;
-    if (ARCH_X86)
-        ff_psnr_init_x86(&s->dsp, desc->comp[0].depth);
+    ff_psnr_init(&s->dsp, desc->comp[0].depth);
+
+    s->nb_threads = FFMAX(1, ctx->graph->nb_threads);
+    s->sse = av_malloc_array(s->nb_threads, sizeof(*s->sse));
+    if (!s->sse)
+        return AVERROR(ENOMEM);
 
     return 0;
 }
@@ -327,19 +333,21 @@ static av_cold void uninit(AVFilterContext *ctx)
         for (j = 0; j < s->nb_components; j++) {
             int c = s->is_rgb ? s->rgba_map[j] : j;
             av_strlcatf(buf, sizeof(buf), " %c:%f", s->comps[j],
-                        get_psnr(s->mse_comp[c], s->nb_frames, s->max[c]));
+                        ff_psnr_get(s->mse_comp[c], s->nb_frames, s->max[c]));
         }
         av_log(ctx, AV_LOG_INFO, "PSNR%s average:%f min:%f max:%f\n",
                buf,
-               get_psnr(s->mse, s->nb_frames, s->average_max),
-               get_psnr(s->max_mse, 1, s->average_max),
-               get_psnr(s->min_mse, 1, s->average_max));
+               ff_psnr_get(s->mse, s->nb_frames, s->average_max),
+               ff_psnr_get(s->max_mse, 1, s->average_max),
+               ff_psnr_get(s->min_mse, 1, s->average_max));
     }
 
     ff_dualinput_uninit(&s->dinput);
 
     if (s->stats_file && s->stats_file != stdout)
         fclose(s->stats_file);
+
+    av_freep(&s->sse);
 }
 
 static const AVFilterPad psnr_inputs[] = {
@@ -376,4 +384,5 @@ AVFilter ff_vf_psnr = {
     .priv_class    = &psnr_class,
     .inputs        = psnr_inputs,
     .outputs       = psnr_outputs,
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
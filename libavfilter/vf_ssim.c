@@ -42,6 +42,7 @@
 #include "drawutils.h"
 #include "formats.h"
 #include "internal.h"
+#include "psnr.h"
 #include "ssim.h"
 #include "video.h"
 
@@ -58,9 +59,18 @@ typedef struct SSIMContext {
     uint8_t rgba_map[4];
     int planewidth[4];
     int planeheight[4];
-    int *temp;
+    int **temp;
+    float *score[4];        ///< SSIM of each line of 4x4 blocks
     int is_rgb;
+    int nb_threads;
     SSIMDSPContext dsp;
+
+    int psnr;
+    double mse, min_mse, max_mse, mse_comp[4];
+    double planeweight[4];
+    int average_max;
+    uint64_t (*sse)[4];     ///< per-job sum of squared errors of each plane
+    PSNRDSPContext psnr_dsp;
 } SSIMContext;
 
 #define OFFSET(x) offsetof(SSIMContext, x)
@@ -69,6 +79,7 @@ typedef struct SSIMContext {
 static const AVOption ssim_options[] = {
     {"stats_file", "Set file where to store per-frame difference information", OFFSET(stats_file_str), AV_OPT_TYPE_STRING, {.str=NULL}, 0, 0, FLAGS },
     {"f",          "Set file where to store per-frame difference information", OFFSET(stats_file_str), AV_OPT_TYPE_STRING, {.str=NULL}, 0, 0, FLAGS },
+    {"psnr",       "Also compute the PSNR",                                    OFFSET(psnr),           AV_OPT_TYPE_BOOL,   {.i64=0},    0, 1, FLAGS },
     { NULL }
 };
 
@@ -147,20 +158,24 @@ static float ssim_endn(const int (*sum0)[4], const int (*sum1)[4], int width)
     return ssim;
 }
 
-static float ssim_plane(SSIMDSPContext *dsp,
-                        uint8_t *main, int main_stride,
-                        uint8_t *ref, int ref_stride,
-                        int width, int height, void *temp)
+/*
+ * Compute the SSIM of the lines of 4x4 blocks [slice_start, slice_end) of a
+ * plane. Each line also needs the sums of the previous line of blocks, so
+ * slices overlap by one line of 4x4 sums.
+ */
+static void ssim_plane_slice(SSIMDSPContext *dsp, float *score,
+                             const uint8_t *main, int main_stride,
+                             const uint8_t *ref, int ref_stride,
+                             int width, int slice_start, int slice_end,
+                             void *temp)
 {
-    int z = 0, y;
-    float ssim = 0.0;
+    int z = slice_start - 1, y;
     int (*sum0)[4] = temp;
     int (*sum1)[4] = sum0 + (width >> 2) + 3;
 
     width >>= 2;
-    height >>= 2;
 
-    for (y = 1; y < height; y++) {
+    for (y = slice_start; y < slice_end; y++) {
         for (; z <= y; z++) {
             FFSWAP(void*, sum0, sum1);
             dsp->ssim_4x4_line(&main[4 * z * main_stride], main_stride,
@@ -168,9 +183,61 @@ static float ssim_plane(SSIMDSPContext *dsp,
                                sum0, width);
         }
 
-        ssim += dsp->ssim_end_line((const int (*)[4])sum0, (const int (*)[4])sum1, width - 1);
+        score[y] = dsp->ssim_end_line((const int (*)[4])sum0, (const int (*)[4])sum1, width - 1);
+    }
+}
+
+typedef struct ThreadData {
+    const AVFrame *main, *ref;
+} ThreadData;
+
+static int ssim_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    SSIMContext *s = ctx->priv;
+    ThreadData *td = arg;
+    const AVFrame *main = td->main, *ref = td->ref;
+    int i, y;
+
+    for (i = 0; i < s->nb_components; i++) {
+        const int lines = (s->planeheight[i] >> 2) - 1;
+
+        if (lines > 0)
+            ssim_plane_slice(&s->dsp, s->score[i],
+                             main->data[i], main->linesize[i],
+                             ref->data[i], ref->linesize[i], s->planewidth[i],
+                             1 + (lines *  jobnr   ) / nb_jobs,
+                             1 + (lines * (jobnr+1)) / nb_jobs,
+                             s->temp[jobnr]);
+
+        if (s->psnr) {
+            const int h = s->planeheight[i];
+            const int slice_start = (h *  jobnr   ) / nb_jobs;
+            const int slice_end   = (h * (jobnr+1)) / nb_jobs;
+            uint64_t m = 0;
+
+            for (y = slice_start; y < slice_end; y++)
+                m += s->psnr_dsp.sse_line(main->data[i] + y * main->linesize[i],
+                                          ref->data[i] + y * ref->linesize[i],
+                                          s->planewidth[i]);
+            s->sse[jobnr][i] = m;
+        }
     }
 
+    return 0;
+}
+
+static float ssim_plane(SSIMContext *s, int plane)
+{
+    int width  = s->planewidth[plane]  >> 2;
+    int height = s->planeheight[plane] >> 2;
+    float ssim = 0.0;
+    int y;
+
+    /* summed in the order of the lines, for the result not to depend
+     * on the number of threads */
+    for (y = 1; y < height; y++)
+        ssim += s->score[plane][y];
+
     return ssim / ((height - 1) * (width - 1));
 }
 
@@ -184,15 +251,18 @@ static AVFrame *do_ssim(AVFilterContext *ctx, AVFrame *main,
 {
     AVDictionary **metadata = avpriv_frame_get_metadatap(main);
     SSIMContext *s = ctx->priv;
+    const int nb_jobs = FFMIN(s->planeheight[1], s->nb_threads);
+    ThreadData td = { .main = main, .ref = ref };
     float c[4], ssimv = 0.0;
-    int i;
+    double comp_mse[4], mse = 0;
+    int i, j;
 
     s->nb_frames++;
 
+    ctx->internal->execute(ctx, ssim_slice, &td, NULL, nb_jobs);
+
     for (i = 0; i < s->nb_components; i++) {
-        c[i] = ssim_plane(&s->dsp, main->data[i], main->linesize[i],
-                          ref->data[i], ref->linesize[i],
-                          s->planewidth[i], s->planeheight[i], s->temp);
+        c[i] = ssim_plane(s, i);
         ssimv += s->coefs[i] * c[i];
         s->ssim[i] += c[i];
     }
@@ -205,6 +275,30 @@ static AVFrame *do_ssim(AVFilterContext *ctx, AVFrame *main,
     set_meta(metadata, "lavfi.ssim.All", 0, ssimv);
     set_meta(metadata, "lavfi.ssim.dB", 0, ssim_db(ssimv, 1.0));
 
+    if (s->psnr) {
+        for (i = 0; i < s->nb_components; i++) {
+            uint64_t m = 0;
+
+            for (j = 0; j < nb_jobs; j++)
+                m += s->sse[j][i];
+            comp_mse[i] = m / (double)(s->planewidth[i] * s->planeheight[i]);
+            mse += comp_mse[i] * s->planeweight[i];
+            s->mse_comp[i] += comp_mse[i];
+        }
+        s->min_mse = FFMIN(s->min_mse, mse);
+        s->max_mse = FFMAX(s->max_mse, mse);
+        s->mse += mse;
+
+        for (i = 0; i < s->nb_components; i++) {
+            int cidx = s->is_rgb ? s->rgba_map[i] : i;
+            char comp = av_tolower(s->comps[i]);
+            set_meta(metadata, "lavfi.psnr.mse.", comp, comp_mse[cidx]);
+            set_meta(metadata, "lavfi.psnr.psnr.", comp, ff_psnr_get(comp_mse[cidx], 1, 255));
+        }
+        set_meta(metadata, "lavfi.psnr.mse_avg", 0, mse);
+        set_meta(metadata, "lavfi.psnr.psnr_avg", 0, ff_psnr_get(mse, 1, s->average_max));
+    }
+
     if (s->stats_file) {
         fprintf(s->stats_file, "n:%"PRId64" ", s->nb_frames);
 
@@ -213,7 +307,22 @@ static AVFrame *do_ssim(AVFilterContext *ctx, AVFrame *main,
             fprintf(s->stats_file, "%c:%f ", s->comps[i], c[cidx]);
         }
 
-        fprintf(s->stats_file, "All:%f (%f)\n", ssimv, ssim_db(ssimv, 1.0));
+        fprintf(s->stats_file, "All:%f (%f)", ssimv, ssim_db(ssimv, 1.0));
+
+        if (s->psnr) {
+            fprintf(s->stats_file, " mse_avg:%0.2f", mse);
+            for (i = 0; i < s->nb_components; i++) {
+                int cidx = s->is_rgb ? s->rgba_map[i] : i;
+                fprintf(s->stats_file, " mse_%c:%0.2f", av_tolower(s->comps[i]), comp_mse[cidx]);
+            }
+            fprintf(s->stats_file, " psnr_avg:%0.2f", ff_psnr_get(mse, 1, s->average_max));
+            for (i = 0; i < s->nb_components; i++) {
+                int cidx = s->is_rgb ? s->rgba_map[i] : i;
+                fprintf(s->stats_file, " psnr_%c:%0.2f", av_tolower(s->comps[i]),
+                        ff_psnr_get(comp_mse[cidx], 1, 255));
+            }
+        }
+        fprintf(s->stats_file, "\n");
     }
 
     return main;
@@ -223,6 +332,9 @@ static av_cold int init(AVFilterContext *ctx)
 {
     SSIMContext *s = ctx->priv;
 
+    s->min_mse = +INFINITY;
+    s->max_mse = -INFINITY;
+
     if (s->stats_file_str) {
         if (!strcmp(s->stats_file_str, "-")) {
             s->stats_file = stdout;
@@ -297,15 +409,40 @@ static int config_input_ref(AVFilterLink *inlink)
     for (i = 0; i < s->nb_components; i++)
         s->coefs[i] = (double) s->planeheight[i] * s->planewidth[i] / sum;
 
-    s->temp = av_malloc((2 * inlink->w + 12) * sizeof(*s->temp));
+    s->nb_threads = FFMAX(1, ctx->graph->nb_threads);
+    s->temp = av_mallocz_array(s->nb_threads, sizeof(*s->temp));
     if (!s->temp)
         return AVERROR(ENOMEM);
+    for (i = 0; i < s->nb_threads; i++) {
+        s->temp[i] = av_malloc((2 * inlink->w + 12) * sizeof(*s->temp[i]));
+        if (!s->temp[i])
+            return AVERROR(ENOMEM);
+    }
+    for (i = 0; i < s->nb_components; i++) {
+        s->score[i] = av_malloc_array(FFMAX(1, s->planeheight[i] >> 2), sizeof(*s->score[i]));
+        if (!s->score[i])
+            return AVERROR(ENOMEM);
+    }
 
     s->dsp.ssim_4x4_line = ssim_4x4xn;
     s->dsp.ssim_end_line = ssim_endn;
     if (ARCH_X86)
         ff_ssim_init_x86(&s->dsp);
 
+    if (s->psnr) {
+        s->sse = av_malloc_array(s->nb_threads, sizeof(*s->sse));
+        if (!s->sse)
+            return AVERROR(ENOMEM);
+
+        /* same weighting as the psnr filter, for the results to match */
+        for (i = 0; i < s->nb_components; i++) {
+            s->planeweight[i] = (double) s->planeheight[i] * s->planewidth[i] / sum;
+            s->average_max += 255 * s->planeweight[i];
+        }
+
+        ff_psnr_init(&s->psnr_dsp, 8);
+    }
+
     return 0;
 }
 
@@ -343,10 +480,10 @@ static int request_frame(AVFilterLink *outlink)
 static av_cold void uninit(AVFilterContext *ctx)
 {
     SSIMContext *s = ctx->priv;
+    int i;
 
     if (s->nb_frames > 0) {
         char buf[256];
-        int i;
         buf[0] = 0;
         for (i = 0; i < s->nb_components; i++) {
             int c = s->is_rgb ? s->rgba_map[i] : i;
@@ -355,6 +492,19 @@ static av_cold void uninit(AVFilterContext *ctx)
         }
         av_log(ctx, AV_LOG_INFO, "SSIM%s All:%f (%f)\n", buf,
                s->ssim_total / s->nb_frames, ssim_db(s->ssim_total, s->nb_frames));
+
+        if (s->psnr) {
+            buf[0] = 0;
+            for (i = 0; i < s->nb_components; i++) {
+                int c = s->is_rgb ? s->rgba_map[i] : i;
+                av_strlcatf(buf, sizeof(buf), " %c:%f", av_tolower(s->comps[i]),
+                            ff_psnr_get(s->mse_comp[c] / s->nb_frames, 1, 255));
+            }
+            av_log(ctx, AV_LOG_INFO, "PSNR%s average:%f min:%f max:%f\n", buf,
+                   ff_psnr_get(s->mse / s->nb_frames, 1, s->average_max),
+                   ff_psnr_get(s->max_mse, 1, s->average_max),
+                   ff_psnr_get(s->min_mse, 1, s->average_max));
+        }
     }
 
     ff_dualinput_uninit(&s->dinput);
@@ -362,7 +512,14 @@ static av_cold void uninit(AVFilterContext *ctx)
     if (s->stats_file && s->stats_file != stdout)
         fclose(s->stats_file);
 
+    if (s->temp) {
+        for (i = 0; i < s->nb_threads; i++)
+            av_freep(&s->temp[i]);
+    }
+    for (i = 0; i < 4; i++)
+        av_freep(&s->score[i]);
     av_freep(&s->temp);
+    av_freep(&s->sse);
 }
 
 static const AVFilterPad ssim_inputs[] = {
@@ -399,4 +556,5 @@ AVFilter ff_vf_ssim = {
     .priv_class    = &ssim_class,
     .inputs        = ssim_inputs,
     .outputs       = ssim_outputs,
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
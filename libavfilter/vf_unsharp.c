@@ -48,64 +48,114 @@
 #include "unsharp.h"
 #include "unsharp_opencl.h"
 
-static void apply_unsharp(      uint8_t *dst, int dst_stride,
-                          const uint8_t *src, int src_stride,
-                          int width, int height, UnsharpFilterParam *fp)
+static void hsum_c(uint32_t *h, int nb_stages, int w)
+{
+    int x, z;
+
+    for (z = 0; z < nb_stages; z++)
+        for (x = w - 1; x >= 0; x--)
+            h[x] += h[x - 1];
+}
+
+static void vsum_c(uint32_t *h, uint32_t *sc, ptrdiff_t stride, int nb_stages, int w)
 {
-    uint32_t **sc = fp->sc;
-    uint32_t sr[MAX_MATRIX_SIZE - 1], tmp1, tmp2;
+    int x, z;
 
-    int32_t res;
-    int x, y, z;
-    const uint8_t *src2 = NULL;  //silence a warning
+    for (z = 0; z < nb_stages; z++) {
+        for (x = 0; x < w; x++) {
+            uint32_t tmp = sc[x] + h[x];
+            sc[x] = h[x];
+            h[x]  = tmp;
+        }
+        sc += stride;
+    }
+}
+
+static int blend_c(uint8_t *dst, const uint8_t *src, const uint32_t *blur,
+                   int w, int amount, int scalebits)
+{
+    const uint32_t halfscale = 1 << (scalebits - 1);
+    int x;
+
+    for (x = 0; x < w; x++) {
+        int32_t res = (int32_t)src[x] + ((((int32_t)src[x] - (int32_t)((blur[x] + halfscale) >> scalebits)) * amount) >> 16);
+        dst[x] = av_clip_uint8(res);
+    }
+    return w;
+}
+
+void ff_unsharp_init_dsp(UnsharpDSPContext *dsp)
+{
+    dsp->hsum  = hsum_c;
+    dsp->vsum  = vsum_c;
+    dsp->blend = blend_c;
+
+    if (ARCH_X86)
+        ff_unsharp_init_dsp_x86(dsp);
+}
+
+/* Each row goes through steps_x pairs of 2-tap sums horizontally, then
+ * steps_y pairs vertically, the state of the vertical sums being kept in
+ * sc. That state only depends on the last 2 * steps_y rows, so a slice
+ * starts 2 * steps_y rows before its first output row, which gives the
+ * same result as filtering the whole plane at once. */
+static void apply_unsharp(const UnsharpDSPContext *dsp,
+                                uint8_t *dst, int dst_stride,
+                          const uint8_t *src, int src_stride,
+                          int width, int height, UnsharpFilterParam *fp,
+                          int jobnr, int nb_jobs)
+{
     const int amount = fp->amount;
     const int steps_x = fp->steps_x;
     const int steps_y = fp->steps_y;
     const int scalebits = fp->scalebits;
-    const int32_t halfscale = fp->halfscale;
+    const int stride = fp->sc_stride;
+    const int slice_start = (height *  jobnr     ) / nb_jobs;
+    const int slice_end   = (height * (jobnr + 1)) / nb_jobs;
+    /* h is preceded by a zero element for hsum */
+    uint32_t *h  = fp->sc + jobnr * (8 + (2 * steps_y + 1) * stride) + 8;
+    uint32_t *sc = h + stride;
+    int x, y;
 
     if (!amount) {
-        av_image_copy_plane(dst, dst_stride, src, src_stride, width, height);
+        av_image_copy_plane(dst + slice_start * dst_stride, dst_stride,
+                            src + slice_start * src_stride, src_stride,
+                            width, slice_end - slice_start);
         return;
     }
+    if (slice_start == slice_end)
+        return;
 
-    for (y = 0; y < 2 * steps_y; y++)
-        memset(sc[y], 0, sizeof(sc[y][0]) * (width + 2 * steps_x));
-
-    for (y = -steps_y; y < height + steps_y; y++) {
-        if (y < height)
-            src2 = src;
-
-        memset(sr, 0, sizeof(sr[0]) * (2 * steps_x - 1));
-        for (x = -steps_x; x < width + steps_x; x++) {
-            tmp1 = x <= 0 ? src2[0] : x >= width ? src2[width-1] : src2[x];
-            for (z = 0; z < steps_x * 2; z += 2) {
-                tmp2 = sr[z + 0] + tmp1; sr[z + 0] = tmp1;
-                tmp1 = sr[z + 1] + tmp2; sr[z + 1] = tmp2;
-            }
-            for (z = 0; z < steps_y * 2; z += 2) {
-                tmp2 = sc[z + 0][x + steps_x] + tmp1; sc[z + 0][x + steps_x] = tmp1;
-                tmp1 = sc[z + 1][x + steps_x] + tmp2; sc[z + 1][x + steps_x] = tmp2;
-            }
-            if (x >= steps_x && y >= steps_y) {
-                const uint8_t *srx = src - steps_y * src_stride + x - steps_x;
-                uint8_t *dsx       = dst - steps_y * dst_stride + x - steps_x;
-
-                res = (int32_t)*srx + ((((int32_t) * srx - (int32_t)((tmp1 + halfscale) >> scalebits)) * amount) >> 16);
-                *dsx = av_clip_uint8(res);
-            }
-        }
-        if (y >= 0) {
-            dst += dst_stride;
-            src += src_stride;
+    memset(h - 8, 0, sizeof(*h) * (8 + (2 * steps_y + 1) * stride));
+
+    for (y = slice_start - steps_y; y < slice_end + steps_y; y++) {
+        const uint8_t *src2 = src + av_clip(y, 0, height - 1) * src_stride;
+
+        for (x = 0; x < stride; x++)
+            h[x] = src2[av_clip(x - steps_x, 0, width - 1)];
+        dsp->hsum(h, 2 * steps_x, stride);
+        dsp->vsum(h, sc, stride, 2 * steps_y, stride);
+
+        if (y >= slice_start + steps_y) {
+            const uint8_t *srx = src + (y - steps_y) * src_stride;
+            uint8_t *dsx       = dst + (y - steps_y) * dst_stride;
+            const uint32_t *blur = h + 2 * steps_x;
+
+            x = dsp->blend(dsx, srx, blur, width, amount, scalebits);
+            blend_c(dsx + x, srx + x, blur + x, width - x, amount, scalebits);
         }
     }
 }
 
-static int apply_unsharp_c(AVFilterContext *ctx, AVFrame *in, AVFrame *out)
+typedef struct ThreadData {
+    AVFrame *in, *out;
+} ThreadData;
+
+static int unsharp_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
     AVFilterLink *inlink = ctx->inputs[0];
     UnsharpContext *s = ctx->priv;
+    ThreadData *td = arg;
     int i, plane_w[3], plane_h[3];
     UnsharpFilterParam *fp[3];
     plane_w[0] = inlink->w;
@@ -115,11 +165,25 @@ static int apply_unsharp_c(AVFilterContext *ctx, AVFrame *in, AVFrame *out)
     fp[0] = &s->luma;
     fp[1] = fp[2] = &s->chroma;
     for (i = 0; i < 3; i++) {
-        apply_unsharp(out->data[i], out->linesize[i], in->data[i], in->linesize[i], plane_w[i], plane_h[i], fp[i]);
+        apply_unsharp(&s->dsp, td->out->data[i], td->out->linesize[i],
+                      td->in->data[i], td->in->linesize[i],
+                      plane_w[i], plane_h[i], fp[i], jobnr, nb_jobs);
     }
     return 0;
 }
 
+static int apply_unsharp_c(AVFilterContext *ctx, AVFrame *in, AVFrame *out)
+{
+    UnsharpContext *s = ctx->priv;
+    ThreadData td;
+
+    td.in  = in;
+    td.out = out;
+    ctx->internal->execute(ctx, unsharp_slice, &td, NULL,
+                           FFMIN(in->height, s->nb_threads));
+    return 0;
+}
+
 static void set_filter_param(UnsharpFilterParam *fp, int msize_x, int msize_y, float amount)
 {
     fp->msize_x = msize_x;
@@ -142,6 +206,7 @@ static av_cold int init(AVFilterContext *ctx)
     set_filter_param(&s->chroma, s->cmsize_x, s->cmsize_y, s->camount);
 
     s->apply_unsharp = apply_unsharp_c;
+    ff_unsharp_init_dsp(&s->dsp);
     if (!CONFIG_OPENCL && s->opencl) {
         av_log(ctx, AV_LOG_ERROR, "OpenCL support was not enabled in this build, cannot be selected\n");
         return AVERROR(EINVAL);
@@ -171,7 +236,7 @@ static int query_formats(AVFilterContext *ctx)
 
 static int init_filter_param(AVFilterContext *ctx, UnsharpFilterParam *fp, const char *effect_type, int width)
 {
-    int z;
+    UnsharpContext *s = ctx->priv;
     const char *effect = fp->amount == 0 ? "none" : fp->amount < 0 ? "blur" : "sharpen";
 
     if  (!(fp->msize_x & fp->msize_y & 1)) {
@@ -184,10 +249,11 @@ static int init_filter_param(AVFilterContext *ctx, UnsharpFilterParam *fp, const
     av_log(ctx, AV_LOG_VERBOSE, "effect:%s type:%s msize_x:%d msize_y:%d amount:%0.2f\n",
            effect, effect_type, fp->msize_x, fp->msize_y, fp->amount / 65535.0);
 
-    for (z = 0; z < 2 * fp->steps_y; z++)
-        if (!(fp->sc[z] = av_malloc_array(width + 2 * fp->steps_x,
-                                          sizeof(*(fp->sc[z])))))
-            return AVERROR(ENOMEM);
+    fp->sc_stride = FFALIGN(width + 2 * fp->steps_x, 8);
+    fp->sc = av_malloc_array(s->nb_threads * (8 + (2 * fp->steps_y + 1) * fp->sc_stride),
+                             sizeof(*fp->sc));
+    if (!fp->sc)
+        return AVERROR(ENOMEM);
 
     return 0;
 }
@@ -200,6 +266,7 @@ static int config_props(AVFilterLink *link)
 
     s->hsub = desc->log2_chroma_w;
     s->vsub = desc->log2_chroma_h;
+    s->nb_threads = FFMAX(1, link->dst->graph->nb_threads);
 
     ret = init_filter_param(link->dst, &s->luma,   "luma",   link->w);
     if (ret < 0)
@@ -213,10 +280,7 @@ static int config_props(AVFilterLink *link)
 
 static void free_filter_param(UnsharpFilterParam *fp)
 {
-    int z;
-
-    for (z = 0; z < 2 * fp->steps_y; z++)
-        av_freep(&fp->sc[z]);
+    av_freep(&fp->sc);
 }
 
 static av_cold void uninit(AVFilterContext *ctx)
@@ -310,5 +374,5 @@ AVFilter ff_vf_unsharp = {
     .query_formats = query_formats,
     .inputs        = avfilter_vf_unsharp_inputs,
     .outputs       = avfilter_vf_unsharp_outputs,
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -74,6 +74,16 @@ enum var_name {
     VARS_NB
 };
 
+enum InterpMode {
+    INTERP_SWS,
+    INTERP_BILINEAR,
+    INTERP_BICUBIC,
+    NB_INTERP
+};
+
+#define COEF_BITS 14
+#define TMP_BITS  7
+
 typedef struct ZPcontext {
     const AVClass *class;
     char *zoom_expr_str;
@@ -81,10 +91,18 @@ typedef struct ZPcontext {
     char *y_expr_str;
     char *duration_expr_str;
     int w, h;
+    int interp;
     double x, y;
     double prev_zoom;
     int prev_nb_frames;
     struct SwsContext *sws;
+    AVExpr *zoom_expr, *x_expr, *y_expr, *duration_expr;
+    int nb_planes;
+    int nb_threads;
+    int ntaps;
+    int *xidx[2];               ///< source columns of the taps of each output column, luma and chroma
+    int16_t *xcoef[2];          ///< coefficients of the taps of each output column, luma and chroma
+    int32_t **tmp;              ///< per thread row of the vertical pass
     int64_t frame_count;
     const AVPixFmtDescriptor *desc;
     AVFrame *in;
@@ -105,6 +123,10 @@ static const AVOption zoompan_options[] = {
     { "d", "set the duration expression", OFFSET(duration_expr_str), AV_OPT_TYPE_STRING, {.str="90"}, .flags = FLAGS },
     { "s", "set the output image size", OFFSET(w), AV_OPT_TYPE_IMAGE_SIZE, {.str="hd720"}, .flags = FLAGS },
     { "fps", "set the output framerate", OFFSET(framerate), AV_OPT_TYPE_VIDEO_RATE, { .str = "25" }, .flags = FLAGS },
+    { "interp", "set the interpolation method", OFFSET(interp), AV_OPT_TYPE_INT, {.i64=INTERP_SWS}, 0, NB_INTERP-1, FLAGS, "interp" },
+        { "sws",      "scale the crop rounded to whole pixels with libswscale", 0, AV_OPT_TYPE_CONST, {.i64=INTERP_SWS},      0, 0, FLAGS, "interp" },
+        { "bilinear", "resample the exact crop with a bilinear filter",         0, AV_OPT_TYPE_CONST, {.i64=INTERP_BILINEAR}, 0, 0, FLAGS, "interp" },
+        { "bicubic",  "resample the exact crop with a bicubic filter",          0, AV_OPT_TYPE_CONST, {.i64=INTERP_BICUBIC},  0, 0, FLAGS, "interp" },
     { NULL }
 };
 
@@ -113,8 +135,64 @@ AVFILTER_DEFINE_CLASS(zoompan);
 static av_cold int init(AVFilterContext *ctx)
 {
     ZPContext *s = ctx->priv;
+    int ret;
 
     s->prev_zoom = 1;
+
+    if ((ret = av_expr_parse(&s->zoom_expr, s->zoom_expr_str, var_names,
+                             NULL, NULL, NULL, NULL, 0, ctx)) < 0 ||
+        (ret = av_expr_parse(&s->x_expr, s->x_expr_str, var_names,
+                             NULL, NULL, NULL, NULL, 0, ctx)) < 0 ||
+        (ret = av_expr_parse(&s->y_expr, s->y_expr_str, var_names,
+                             NULL, NULL, NULL, NULL, 0, ctx)) < 0 ||
+        (ret = av_expr_parse(&s->duration_expr, s->duration_expr_str, var_names,
+                             NULL, NULL, NULL, NULL, 0, ctx)) < 0)
+        return ret;
+
+    s->ntaps = s->interp == INTERP_BICUBIC ? 4 : 2;
+    return 0;
+}
+
+static void free_rows(ZPContext *s)
+{
+    int i;
+
+    if (s->tmp)
+        for (i = 0; i < s->nb_threads; i++)
+            av_freep(&s->tmp[i]);
+    av_freep(&s->tmp);
+}
+
+static void free_taps(ZPContext *s)
+{
+    int i;
+
+    for (i = 0; i < 2; i++) {
+        av_freep(&s->xidx[i]);
+        av_freep(&s->xcoef[i]);
+    }
+}
+
+static int config_input(AVFilterLink *inlink)
+{
+    AVFilterContext *ctx = inlink->dst;
+    ZPContext *s = ctx->priv;
+    int i;
+
+    if (s->interp == INTERP_SWS)
+        return 0;
+
+    free_rows(s);
+    s->nb_threads = FFMAX(1, ctx->graph->nb_threads);
+    s->tmp = av_mallocz_array(s->nb_threads, sizeof(*s->tmp));
+    if (!s->tmp)
+        return AVERROR(ENOMEM);
+    for (i = 0; i < s->nb_threads; i++) {
+        s->tmp[i] = av_malloc_array(inlink->w, sizeof(*s->tmp[i]));
+        if (!s->tmp[i])
+            return AVERROR(ENOMEM);
+    }
+
     return 0;
 }
 
@@ -122,16 +200,167 @@ static int config_output(AVFilterLink *outlink)
 {
     AVFilterContext *ctx = outlink->src;
     ZPContext *s = ctx->priv;
+    int i;
 
     outlink->w = s->w;
     outlink->h = s->h;
     outlink->time_base = av_inv_q(s->framerate);
     outlink->frame_rate = s->framerate;
     s->desc = av_pix_fmt_desc_get(outlink->format);
+    s->nb_planes = av_pix_fmt_count_planes(outlink->format);
+
+    if (s->interp != INTERP_SWS) {
+        free_taps(s);
+        for (i = 0; i < 2; i++) {
+            s->xidx[i]  = av_malloc_array(outlink->w, s->ntaps * sizeof(*s->xidx[i]));
+            s->xcoef[i] = av_malloc_array(outlink->w, s->ntaps * sizeof(*s->xcoef[i]));
+            if (!s->xidx[i] || !s->xcoef[i])
+                return AVERROR(ENOMEM);
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Compute the source samples and the coefficients of the filter
+ * interpolating a plane of length len at position pos.
+ */
+static void get_taps(int interp, double pos, int len, int *idx, int16_t *coef)
+{
+    int i = floor(pos), k, sum = 0;
+    int ntaps = interp == INTERP_BICUBIC ? 4 : 2;
+    int first = interp == INTERP_BICUBIC ? i - 1 : i;
+    double f = pos - i, c[4];
+
+    if (interp == INTERP_BICUBIC) {
+        /* Catmull-Rom spline */
+        c[0] = ((-0.5 * f + 1.0) * f - 0.5) * f;
+        c[1] = (1.5 * f - 2.5) * f * f + 1.0;
+        c[2] = ((-1.5 * f + 2.0) * f + 0.5) * f;
+        c[3] = (0.5 * f - 0.5) * f * f;
+    } else {
+        c[0] = 1.0 - f;
+        c[1] = f;
+    }
+    for (k = 0; k < ntaps; k++) {
+        idx[k]  = av_clip(first + k, 0, len - 1);
+        coef[k] = lrint(c[k] * (1 << COEF_BITS));
+        sum    += coef[k];
+    }
+    /* make the coefficients sum to unity, on the nearest tap */
+    coef[ntaps / 2 - 1 + (f >= 0.5)] += (1 << COEF_BITS) - sum;
+}
+
+typedef struct ThreadData {
+    AVFrame *in, *out;
+    double x, y, h;             ///< position and height of the crop
+} ThreadData;
+
+static av_always_inline void resample_row(uint8_t *dst, const uint8_t *const *src,
+                                          const int16_t *ycoef, const int *xidx,
+                                          const int16_t *xcoef, int32_t *tmp,
+                                          int xmin, int xmax, int w, const int ntaps)
+{
+    int x, k;
+
+    for (x = xmin; x <= xmax; x++) {
+        int sum = 0;
+
+        for (k = 0; k < ntaps; k++)
+            sum += ycoef[k] * src[k][x];
+        tmp[x] = (sum + (1 << (COEF_BITS - TMP_BITS - 1))) >> (COEF_BITS - TMP_BITS);
+    }
+
+    for (x = 0; x < w; x++) {
+        int sum = 0;
+
+        for (k = 0; k < ntaps; k++)
+            sum += xcoef[k] * tmp[xidx[k]];
+        dst[x] = av_clip_uint8((sum + (1 << (COEF_BITS + TMP_BITS - 1))) >> (COEF_BITS + TMP_BITS));
+        xidx  += ntaps;
+        xcoef += ntaps;
+    }
+}
+
+static int resample_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    ZPContext *s = ctx->priv;
+    ThreadData *td = arg;
+    const AVFrame *in = td->in;
+    AVFrame *out = td->out;
+    int32_t *tmp = s->tmp[jobnr];
+    const int ntaps = s->ntaps;
+    const double scale = td->h / out->height;
+    int p, y, k;
+
+    for (p = 0; p < s->nb_planes; p++) {
+        const int chroma = p == 1 || p == 2;
+        const int vsub = chroma ? s->desc->log2_chroma_h : 0;
+        const int hsub = chroma ? s->desc->log2_chroma_w : 0;
+        const int ih = AV_CEIL_RSHIFT(in->height, vsub);
+        const int ow = AV_CEIL_RSHIFT(out->width, hsub);
+        const int oh = AV_CEIL_RSHIFT(out->height, vsub);
+        const int slice_start = (oh * jobnr) / nb_jobs;
+        const int slice_end = (oh * (jobnr+1)) / nb_jobs;
+        const int *xidx = s->xidx[chroma];
+        const int16_t *xcoef = s->xcoef[chroma];
+        const int xmin = xidx[0], xmax = xidx[ow * ntaps - 1];
+        const double y0 = td->y / (1 << vsub);
+
+        for (y = slice_start; y < slice_end; y++) {
+            uint8_t *dst = out->data[p] + y * out->linesize[p];
+            const uint8_t *src[4];
+            int yidx[4];
+            int16_t ycoef[4];
+
+            get_taps(s->interp, y0 + (y + 0.5) * scale - 0.5, ih, yidx, ycoef);
+            for (k = 0; k < ntaps; k++)
+                src[k] = in->data[p] + yidx[k] * in->linesize[p];
+
+            if (ntaps == 4)
+                resample_row(dst, src, ycoef, xidx, xcoef, tmp, xmin, xmax, ow, 4);
+            else
+                resample_row(dst, src, ycoef, xidx, xcoef, tmp, xmin, xmax, ow, 2);
+        }
+    }
 
     return 0;
 }
 
+/**
+ * Resample the crop of in at (x, y), of size in / zoom, to out.
+ */
+static void resample_crop(AVFilterContext *ctx, AVFrame *in, AVFrame *out,
+                          double x, double y, double zoom)
+{
+    ZPContext *s = ctx->priv;
+    const double scale = in->width / zoom / out->width;
+    ThreadData td;
+    int i, k;
+
+    /* the columns are the same for all the rows */
+    for (i = 0; i < FFMIN(s->nb_planes, 2); i++) {
+        const int hsub = i ? s->desc->log2_chroma_w : 0;
+        const int iw = AV_CEIL_RSHIFT(in->width, hsub);
+        const int ow = AV_CEIL_RSHIFT(out->width, hsub);
+        const double x0 = x / (1 << hsub);
+
+        for (k = 0; k < ow; k++)
+            get_taps(s->interp, x0 + (k + 0.5) * scale - 0.5, iw,
+                     s->xidx[i] + k * s->ntaps, s->xcoef[i] + k * s->ntaps);
+    }
+
+    td.in  = in;
+    td.out = out;
+    td.x   = x;
+    td.y   = y;
+    td.h   = in->height / zoom;
+    ctx->internal->execute(ctx, resample_slice, &td, NULL,
+                           FFMIN(AV_CEIL_RSHIFT(out->height, s->desc->log2_chroma_h),
+                                 s->nb_threads));
+}
+
 static int output_single_frame(AVFilterContext *ctx, AVFrame *in, double *var_values, int i,
                                double *zoom, double *dx, double *dy)
 {
@@ -146,28 +375,19 @@ static int output_single_frame(AVFilterContext *ctx, AVFrame *in, double *var_va
     var_values[VAR_TIME] = pts * av_q2d(outlink->time_base);
     var_values[VAR_FRAME] = i;
     var_values[VAR_ON] = outlink->frame_count + 1;
-    if ((ret = av_expr_parse_and_eval(zoom, s->zoom_expr_str,
-                                      var_names, var_values,
-                                      NULL, NULL, NULL, NULL, NULL, 0, ctx)) < 0)
-        return ret;
+    *zoom = av_expr_eval(s->zoom_expr, var_values, NULL);
 
     *zoom = av_clipd(*zoom, 1, 10);
     var_values[VAR_ZOOM] = *zoom;
     w = in->width * (1.0 / *zoom);
     h = in->height * (1.0 / *zoom);
 
-    if ((ret = av_expr_parse_and_eval(dx, s->x_expr_str,
-                                      var_names, var_values,
-                                      NULL, NULL, NULL, NULL, NULL, 0, ctx)) < 0)
-        return ret;
+    *dx = av_expr_eval(s->x_expr, var_values, NULL);
     x = *dx = av_clipd(*dx, 0, FFMAX(in->width - w, 0));
     var_values[VAR_X] = *dx;
     x &= ~((1 << s->desc->log2_chroma_w) - 1);
 
-    if ((ret = av_expr_parse_and_eval(dy, s->y_expr_str,
-                                      var_names, var_values,
-                                      NULL, NULL, NULL, NULL, NULL, 0, ctx)) < 0)
-        return ret;
+    *dy = av_expr_eval(s->y_expr, var_values, NULL);
     y = *dy = av_clipd(*dy, 0, FFMAX(in->height - h, 0));
     var_values[VAR_Y] = *dy;
     y &= ~((1 << s->desc->log2_chroma_h) - 1);
@@ -178,40 +398,34 @@ static int output_single_frame(AVFilterContext *ctx, AVFrame *in, double *var_va
         return ret;
     }
 
-    px[1] = px[2] = AV_CEIL_RSHIFT(x, s->desc->log2_chroma_w);
-    px[0] = px[3] = x;
-
-    py[1] = py[2] = AV_CEIL_RSHIFT(y, s->desc->log2_chroma_h);
-    py[0] = py[3] = y;
+    if (s->interp != INTERP_SWS) {
+        resample_crop(ctx, in, out, *dx, *dy, *zoom);
+    } else {
+        px[1] = px[2] = AV_CEIL_RSHIFT(x, s->desc->log2_chroma_w);
+        px[0] = px[3] = x;
 
-    s->sws = sws_alloc_context();
-    if (!s->sws) {
-        ret = AVERROR(ENOMEM);
-        return ret;
-    }
+        py[1] = py[2] = AV_CEIL_RSHIFT(y, s->desc->log2_chroma_h);
+        py[0] = py[3] = y;
 
-    for (k = 0; in->data[k]; k++)
-        input[k] = in->data[k] + py[k] * in->linesize[k] + px[k];
+        for (k = 0; in->data[k]; k++)
+            input[k] = in->data[k] + py[k] * in->linesize[k] + px[k];
 
-    av_opt_set_int(s->sws, "srcw", w, 0);
-    av_opt_set_int(s->sws, "srch", h, 0);
-    av_opt_set_int(s->sws, "src_format", in->format, 0);
-    av_opt_set_int(s->sws, "dstw", outlink->w, 0);
-    av_opt_set_int(s->sws, "dsth", outlink->h, 0);
-    av_opt_set_int(s->sws, "dst_format", outlink->format, 0);
-    av_opt_set_int(s->sws, "sws_flags", SWS_BICUBIC, 0);
-
-    if ((ret = sws_init_context(s->sws, NULL, NULL)) < 0)
-        return ret;
+        /* the context is only reinitialized when the crop size changes */
+        s->sws = sws_getCachedContext(s->sws, w, h, in->format,
+                                      outlink->w, outlink->h, outlink->format,
+                                      SWS_BICUBIC, NULL, NULL, NULL);
+        if (!s->sws) {
+            av_frame_free(&out);
+            return AVERROR(EINVAL);
+        }
 
-    sws_scale(s->sws, (const uint8_t *const *)&input, in->linesize, 0, h, out->data, out->linesize);
+        sws_scale(s->sws, (const uint8_t *const *)&input, in->linesize, 0, h, out->data, out->linesize);
+    }
 
     out->pts = pts;
     s->frame_count++;
 
     ret = ff_filter_frame(outlink, out);
-    sws_freeContext(s->sws);
-    s->sws = NULL;
     s->current_frame++;
     return ret;
 }
@@ -222,7 +436,6 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
     AVFilterLink *outlink = ctx->outputs[0];
     ZPContext *s = ctx->priv;
     double nb_frames;
-    int ret;
 
     av_assert0(s->in == NULL);
 
@@ -247,12 +460,7 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
     s->var_values[VAR_HSUB]  = 1 << s->desc->log2_chroma_w;
     s->var_values[VAR_VSUB]  = 1 << s->desc->log2_chroma_h;
 
-    if ((ret = av_expr_parse_and_eval(&nb_frames, s->duration_expr_str,
-                                      var_names, s->var_values,
-                                      NULL, NULL, NULL, NULL, NULL, 0, ctx)) < 0) {
-        av_frame_free(&in);
-        return ret;
-    }
+    nb_frames = av_expr_eval(s->duration_expr, s->var_values, NULL);
 
     s->var_values[VAR_DURATION] = s->nb_frames = nb_frames;
     s->in = in;
@@ -288,9 +496,6 @@ static int request_frame(AVFilterLink *outlink)
     }
 
 fail:
-    sws_freeContext(s->sws);
-    s->sws = NULL;
-
     return ret;
 }
 
@@ -328,6 +533,13 @@ static av_cold void uninit(AVFilterContext *ctx)
 
     sws_freeContext(s->sws);
     s->sws = NULL;
+    av_expr_free(s->zoom_expr);
+    av_expr_free(s->x_expr);
+    av_expr_free(s->y_expr);
+    av_expr_free(s->duration_expr);
+    s->zoom_expr = s->x_expr = s->y_expr = s->duration_expr = NULL;
+    free_taps(s);
+    free_rows(s);
 }
 
 static const AVFilterPad inputs[] = {
@@ -335,6 +547,7 @@ static const AVFilterPad inputs[] = {
         .name         = "default",
         .type         = AVMEDIA_TYPE_VIDEO,
         .filter_frame = filter_frame,
+        .config_props = config_input,
         .needs_fifo   = 1,
     },
     { NULL }
@@ -361,5 +574,6 @@ AVFilter ff_vf_zoompan = {
     .query_formats = query_formats,
     .inputs        = inputs,
     .outputs       = outputs,
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC |
+                     AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -46,6 +46,7 @@ AVFrame *ff_default_get_video_buffer(AVFilterLink *link, int w, int h)
     int pool_height = 0;
     int pool_align = 0;
     enum AVPixelFormat pool_format = AV_PIX_FMT_NONE;
+    AVFrame *frame;
 
     if (!link->video_frame_pool) {
         link->video_frame_pool = ff_video_frame_pool_init(av_buffer_allocz, w, h,
@@ -70,7 +71,11 @@ AVFrame *ff_default_get_video_buffer(AVFilterLink *link, int w, int h)
         }
     }
 
-    return ff_video_frame_pool_get(link->video_frame_pool);
+    frame = ff_video_frame_pool_get(link->video_frame_pool);
+    if (frame)
+        ff_filter_profile_buffer(link);
+
+    return frame;
 }
 
 AVFrame *ff_get_video_buffer(AVFilterLink *link, int w, int h)
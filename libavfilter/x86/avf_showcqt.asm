@@ -0,0 +1,132 @@
+;*****************************************************************************
+;* x86-optimized functions for showcqt filter
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA
+
+; sign masks giving (a.re, a.im, a.im, -a.re) and (b.re, -b.im, b.im, b.re)
+ps_sign_a: dd 0, 0, 0, 0x80000000
+ps_sign_b: dd 0, 0x80000000, 0, 0
+
+SECTION .text
+
+%if ARCH_X86_64
+
+; layout of Coeffs
+%define COEFFS_VAL    0
+%define COEFFS_START  8
+%define COEFFS_LEN   12
+%define COEFFS_SIZE  16
+
+;-----------------------------------------------------------------------------
+; void ff_showcqt_cqt_calc(FFTComplex *dst, const FFTComplex *src,
+;                          const Coeffs *coeffs, int len, int fft_len)
+;
+; Each iteration handles mmsize/8 coefficients. The products with src[i] are
+; accumulated in m0, the ones with src[fft_len - i] in m1; the latter are
+; loaded in the reverse order, so the coefficients are reversed for them.
+;-----------------------------------------------------------------------------
+%macro CQT_CALC 0
+cglobal showcqt_cqt_calc, 5, 10, 7, dst, src, coeffs, len, fft_len, val, srci, srcj, cnt, start
+    movsxdifnidn    lenq, lend
+    movsxdifnidn fft_lenq, fft_lend
+    test            lenq, lenq
+    jz .end
+    ; fft_lenq now points to src[fft_len]
+    lea         fft_lenq, [srcq + fft_lenq*8]
+.loop_k:
+    xorps             m0, m0
+    xorps             m1, m1
+    movsxd          cntq, dword [coeffsq + COEFFS_LEN]
+    test            cntq, cntq
+    jz .reduced
+    mov             valq, [coeffsq + COEFFS_VAL]
+    movsxd        startq, dword [coeffsq + COEFFS_START]
+    shl           startq, 3
+    lea            srciq, [srcq + startq]
+    mov            srcjq, fft_lenq
+    sub            srcjq, startq
+    sub            srcjq, mmsize - 8
+    lea             valq, [valq + cntq*4]
+    neg             cntq
+.loop_x:
+%if mmsize == 32
+    movu             xm4, [valq + cntq*4]
+    unpckhps         xm3, xm4, xm4
+    unpcklps         xm2, xm4, xm4
+    shufps           xm4, xm3, xm3, q1032
+    shufps           xm5, xm2, xm2, q1032
+    vinsertf128       m2, m2, xm3, 1
+    vinsertf128       m3, m4, xm5, 1
+%else
+    movq              m4, [valq + cntq*4]
+    shufps            m2, m4, m4, q1100
+    shufps            m3, m4, m4, q0011
+%endif
+    movu              m4, [srciq]
+    movu              m5, [srcjq]
+    FMULADD_PS        m0, m2, m4, m0, m6
+    FMULADD_PS        m1, m3, m5, m1, m6
+    add            srciq, mmsize
+    sub            srcjq, mmsize
+    add             cntq, mmsize/8
+    jl .loop_x
+
+%if mmsize == 32
+    vextractf128     xm2, m0, 1
+    vextractf128     xm3, m1, 1
+    addps            xm0, xm2
+    addps            xm1, xm3
+%endif
+    movhlps          xm2, xm0
+    movhlps          xm3, xm1
+    addps            xm0, xm2
+    addps            xm1, xm3
+.reduced:
+    ; l = (a.re + b.re, a.im - b.im), r = (b.im + a.im, b.re - a.re)
+    shufps           xm0, xm0, q0110
+    shufps           xm1, xm1, q0110
+    xorps            xm0, [ps_sign_a]
+    xorps            xm1, [ps_sign_b]
+    addps            xm0, xm1
+    mulps            xm0, xm0
+    haddps           xm0, xm0
+    movlps        [dstq], xm0
+    add             dstq, 8
+    add          coeffsq, COEFFS_SIZE
+    dec             lenq
+    jg .loop_k
+.end:
+    RET
+%endmacro
+
+INIT_XMM sse3
+CQT_CALC
+%if HAVE_AVX_EXTERNAL
+INIT_YMM avx
+CQT_CALC
+%endif
+%if HAVE_FMA3_EXTERNAL
+INIT_YMM fma3
+CQT_CALC
+%endif
+
+%endif ; ARCH_X86_64
@@ -0,0 +1,50 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/x86/cpu.h"
+#include "libavfilter/avf_showcqt.h"
+
+#define CQT_CALC_FUNC(opt)                                                      \
+void ff_showcqt_cqt_calc_##opt(FFTComplex *dst, const FFTComplex *src,         \
+                               const Coeffs *coeffs, int len, int fft_len);
+
+CQT_CALC_FUNC(sse3)
+CQT_CALC_FUNC(avx)
+CQT_CALC_FUNC(fma3)
+
+av_cold void ff_showcqt_init_x86(ShowCQTContext *s)
+{
+#if ARCH_X86_64
+    int cpu_flags = av_get_cpu_flags();
+
+    if (EXTERNAL_SSE3(cpu_flags)) {
+        s->cqt_calc  = ff_showcqt_cqt_calc_sse3;
+        s->cqt_align = 2;
+    }
+    if (EXTERNAL_AVX_FAST(cpu_flags)) {
+        s->cqt_calc  = ff_showcqt_cqt_calc_avx;
+        s->cqt_align = 4;
+    }
+    if (EXTERNAL_FMA3_FAST(cpu_flags)) {
+        s->cqt_calc  = ff_showcqt_cqt_calc_fma3;
+        s->cqt_align = 4;
+    }
+#endif
+}
@@ -0,0 +1,193 @@
+;*****************************************************************************
+;* x86-optimized IIR sections cascades
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;*****************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION .text
+
+%if ARCH_X86_64
+
+; A row of lanes (BIQUAD_LANES_FLT floats or BIQUAD_LANES_DBL doubles) is 32
+; bytes: it fits a ymm register, or two xmm registers processed side by side.
+%define ROW 32
+
+; Filter one sample of the lanes at offset %8 of the row, keeping the
+; operation order of the C version.
+; %1-%4 = x[n-1], x[n-2], y[n-1], y[n-2], %5-%7 = temporary registers,
+; %8 = offset in the row, %9 = ps or pd
+%macro BIQUAD_STEP 9
+    mova           m%5, [bufq + cntq + %8]
+    mul%9          m%6, m%2, [coeffsq + 2 * ROW + %8]
+    mul%9          m%7, m%1, [coeffsq + 1 * ROW + %8]
+    add%9          m%6, m%7
+    mul%9          m%7, m%5, [coeffsq + 0 * ROW + %8]
+    add%9          m%6, m%7
+    mul%9          m%7, m%4, [coeffsq + 4 * ROW + %8]
+    add%9          m%6, m%7
+    mul%9          m%7, m%3, [coeffsq + 3 * ROW + %8]
+    add%9          m%6, m%7
+    mova [bufq + cntq + %8], m%6
+    mova           m%2, m%1
+    mova           m%1, m%5
+    mova           m%4, m%3
+    mova           m%3, m%6
+%endmacro
+
+;-----------------------------------------------------------------------------
+; void ff_biquad_{flt,dbl}(type *buf, type *state, const type *coeffs,
+;                          int nb_sections, int len)
+;-----------------------------------------------------------------------------
+; %1 = flt or dbl, %2 = ps or pd
+%macro BIQUAD 2
+cglobal biquad_%1, 5, 6, 14, buf, state, coeffs, nb_sections, len, cnt
+    test            lend, lend
+    jle .end
+    test    nb_sectionsd, nb_sectionsd
+    jle .end
+    movsxdifnidn    lenq, lend
+    shl             lenq, 5
+    add             bufq, lenq
+    neg             lenq
+.loop_section:
+    mova              m0, [stateq + 0 * ROW]
+    mova              m1, [stateq + 1 * ROW]
+    mova              m2, [stateq + 2 * ROW]
+    mova              m3, [stateq + 3 * ROW]
+%if mmsize == 16
+    mova              m7, [stateq + 0 * ROW + 16]
+    mova              m8, [stateq + 1 * ROW + 16]
+    mova              m9, [stateq + 2 * ROW + 16]
+    mova             m10, [stateq + 3 * ROW + 16]
+%endif
+    mov             cntq, lenq
+.loop_sample:
+    BIQUAD_STEP 0, 1, 2,  3,  4,  5,  6,  0, %2
+%if mmsize == 16
+    BIQUAD_STEP 7, 8, 9, 10, 11, 12, 13, 16, %2
+%endif
+    add             cntq, ROW
+    jl .loop_sample
+    mova [stateq + 0 * ROW], m0
+    mova [stateq + 1 * ROW], m1
+    mova [stateq + 2 * ROW], m2
+    mova [stateq + 3 * ROW], m3
+%if mmsize == 16
+    mova [stateq + 0 * ROW + 16], m7
+    mova [stateq + 1 * ROW + 16], m8
+    mova [stateq + 2 * ROW + 16], m9
+    mova [stateq + 3 * ROW + 16], m10
+%endif
+    add           stateq, 4 * ROW
+    add          coeffsq, 5 * ROW
+    dec     nb_sectionsd
+    jg .loop_section
+.end:
+    RET
+%endmacro
+
+; out += x[n-k] * bk - y[n-k] * ak
+; %1 = x[n-k], %2 = y[n-k], %3 = row of bk, %4 = offset in the row
+%macro FOURTH_ORDER_TAP 4
+    mulpd            m10, m%1, [coeffsq + (%3    ) * ROW + %4]
+    mulpd            m11, m%2, [coeffsq + (%3 + 1) * ROW + %4]
+    subpd            m10, m11
+    addpd             m9, m10
+%endmacro
+
+; Filter all the samples of the lanes at offset %1 of the row through the
+; current section.
+%macro FOURTH_ORDER_COLUMN 1
+    mova              m0, [stateq + 0 * ROW + %1]
+    mova              m1, [stateq + 1 * ROW + %1]
+    mova              m2, [stateq + 2 * ROW + %1]
+    mova              m3, [stateq + 3 * ROW + %1]
+    mova              m4, [stateq + 4 * ROW + %1]
+    mova              m5, [stateq + 5 * ROW + %1]
+    mova              m6, [stateq + 6 * ROW + %1]
+    mova              m7, [stateq + 7 * ROW + %1]
+    mov             cntq, lenq
+%%loop:
+    mova              m8, [bufq + cntq + %1]
+    mulpd             m9, m8, [coeffsq + %1]
+    FOURTH_ORDER_TAP   0, 4, 1, %1
+    FOURTH_ORDER_TAP   1, 5, 3, %1
+    FOURTH_ORDER_TAP   2, 6, 5, %1
+    FOURTH_ORDER_TAP   3, 7, 7, %1
+    mova [bufq + cntq + %1], m9
+    mova              m3, m2
+    mova              m2, m1
+    mova              m1, m0
+    mova              m0, m8
+    mova              m7, m6
+    mova              m6, m5
+    mova              m5, m4
+    mova              m4, m9
+    add             cntq, ROW
+    jl %%loop
+    mova [stateq + 0 * ROW + %1], m0
+    mova [stateq + 1 * ROW + %1], m1
+    mova [stateq + 2 * ROW + %1], m2
+    mova [stateq + 3 * ROW + %1], m3
+    mova [stateq + 4 * ROW + %1], m4
+    mova [stateq + 5 * ROW + %1], m5
+    mova [stateq + 6 * ROW + %1], m6
+    mova [stateq + 7 * ROW + %1], m7
+%endmacro
+
+;-----------------------------------------------------------------------------
+; void ff_fourth_order_dbl(double *buf, double *state, const double *coeffs,
+;                          int nb_sections, int len)
+;-----------------------------------------------------------------------------
+%macro FOURTH_ORDER 0
+cglobal fourth_order_dbl, 5, 6, 12, buf, state, coeffs, nb_sections, len, cnt
+    test            lend, lend
+    jle .end
+    test    nb_sectionsd, nb_sectionsd
+    jle .end
+    movsxdifnidn    lenq, lend
+    shl             lenq, 5
+    add             bufq, lenq
+    neg             lenq
+.loop_section:
+    FOURTH_ORDER_COLUMN 0
+%if mmsize == 16
+    FOURTH_ORDER_COLUMN 16
+%endif
+    add           stateq, 8 * ROW
+    add          coeffsq, 9 * ROW
+    dec     nb_sectionsd
+    jg .loop_section
+.end:
+    RET
+%endmacro
+
+INIT_XMM sse
+BIQUAD flt, ps
+INIT_XMM sse2
+BIQUAD dbl, pd
+FOURTH_ORDER
+%if HAVE_AVX_EXTERNAL
+INIT_YMM avx
+BIQUAD flt, ps
+BIQUAD dbl, pd
+FOURTH_ORDER
+%endif
+
+%endif ; ARCH_X86_64
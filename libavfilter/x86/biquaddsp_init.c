@@ -0,0 +1,54 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/x86/cpu.h"
+#include "libavfilter/biquaddsp.h"
+
+void ff_biquad_flt_sse(float *buf, float *state, const float *coeffs,
+                       int nb_sections, int len);
+void ff_biquad_flt_avx(float *buf, float *state, const float *coeffs,
+                       int nb_sections, int len);
+void ff_biquad_dbl_sse2(double *buf, double *state, const double *coeffs,
+                        int nb_sections, int len);
+void ff_biquad_dbl_avx(double *buf, double *state, const double *coeffs,
+                       int nb_sections, int len);
+void ff_fourth_order_dbl_sse2(double *buf, double *state, const double *coeffs,
+                              int nb_sections, int len);
+void ff_fourth_order_dbl_avx(double *buf, double *state, const double *coeffs,
+                             int nb_sections, int len);
+
+av_cold void ff_biquaddsp_init_x86(BiquadDSPContext *dsp)
+{
+#if ARCH_X86_64
+    int cpu_flags = av_get_cpu_flags();
+
+    if (EXTERNAL_SSE(cpu_flags))
+        dsp->biquad_flt = ff_biquad_flt_sse;
+    if (EXTERNAL_SSE2(cpu_flags)) {
+        dsp->biquad_dbl       = ff_biquad_dbl_sse2;
+        dsp->fourth_order_dbl = ff_fourth_order_dbl_sse2;
+    }
+    if (EXTERNAL_AVX_FAST(cpu_flags)) {
+        dsp->biquad_flt       = ff_biquad_flt_avx;
+        dsp->biquad_dbl       = ff_biquad_dbl_avx;
+        dsp->fourth_order_dbl = ff_fourth_order_dbl_avx;
+    }
+#endif
+}
@@ -0,0 +1,144 @@
+;*****************************************************************************
+;* x86-optimized functions for drawutils
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA 32
+
+pd_0x1010101: times 8 dd 0x1010101
+pb_1:         times 32 db 1
+
+SECTION .text
+
+; broadcast src to m5 and alpha to m4
+%macro LOAD_COLOR 2 ; src, alpha
+    movd             xm4, %2
+    movd             xm5, %1
+%if cpuflag(avx2)
+    vpbroadcastd      m4, xm4
+    vpbroadcastd      m5, xm5
+%else
+    pshufd            m4, m4, 0
+    pshufd            m5, m5, 0
+%endif
+%endmacro
+
+; Blend the mmsize/2 pixels at dstq + xq, with the mask values of the first
+; and second halves as dwords in m0 and m1. The 32 bits computations wrap
+; around, but ((0x1010101 - a) * d + a * s) = d * 0x1010101 + a * (s - d)
+; is in [0 ; 0xffffffff], so the result is the same as the C version.
+%macro BLEND_PIXELS 0
+    pmovzxbd          m2, [dstq + xq]
+    pmovzxbd          m3, [dstq + xq + mmsize/4]
+    pmulld            m0, m4
+    pmulld            m1, m4
+    psubd             m6, m5, m2
+    pmulld            m6, m0
+    pmulld            m2, [pd_0x1010101]
+    paddd             m2, m6
+    psubd             m6, m5, m3
+    pmulld            m6, m1
+    pmulld            m3, [pd_0x1010101]
+    paddd             m3, m6
+    psrld             m2, 24
+    psrld             m3, 24
+    packusdw          m2, m3
+%if mmsize == 32
+    vpermq            m2, m2, q3120
+    vextracti128     xm3, m2, 1
+    packuswb         xm2, xm3
+    movu     [dstq + xq], xm2
+%else
+    packuswb          m2, m2
+    movq     [dstq + xq], m2
+%endif
+%endmacro
+
+;-----------------------------------------------------------------------------
+; int ff_blend_row8(uint8_t *dst, const uint8_t *mask, int w,
+;                   unsigned src, unsigned alpha)
+;-----------------------------------------------------------------------------
+%macro BLEND_ROW8 0
+cglobal blend_row8, 5, 6, 7, dst, mask, w, src, alpha, x
+    LOAD_COLOR      srcd, alphad
+    movsxdifnidn      wq, wd
+    and               wq, ~(mmsize/2 - 1)
+    jz .end
+    xor               xq, xq
+.loop:
+    pmovzxbd          m0, [maskq + xq]
+    pmovzxbd          m1, [maskq + xq + mmsize/4]
+    BLEND_PIXELS
+    add               xq, mmsize/2
+    cmp               xq, wq
+    jl .loop
+.end:
+    mov              eax, wd
+    RET
+%endmacro
+
+;-----------------------------------------------------------------------------
+; int ff_blend_row8_2x2(uint8_t *dst, const uint8_t *mask,
+;                       ptrdiff_t mask_linesize, int w,
+;                       unsigned src, unsigned alpha)
+;-----------------------------------------------------------------------------
+%macro BLEND_ROW8_2X2 0
+cglobal blend_row8_2x2, 6, 7, 8, dst, mask, mask2, w, src, alpha, x
+    LOAD_COLOR      srcd, alphad
+    add           mask2q, maskq
+    movsxdifnidn      wq, wd
+    and               wq, ~(mmsize/2 - 1)
+    jz .end
+    xor               xq, xq
+    pxor              m7, m7
+.loop:
+    ; sum the 2x2 samples of each pixel, as words
+    movu              m0, [maskq + xq*2]
+    movu              m1, [mask2q + xq*2]
+    pmaddubsw         m0, [pb_1]
+    pmaddubsw         m1, [pb_1]
+    paddw             m0, m1
+    psrlw             m0, 2
+%if mmsize == 32
+    vextracti128     xm1, m0, 1
+    pmovzxwd          m0, xm0
+    pmovzxwd          m1, xm1
+%else
+    punpckhwd         m1, m0, m7
+    punpcklwd         m0, m7
+%endif
+    BLEND_PIXELS
+    add               xq, mmsize/2
+    cmp               xq, wq
+    jl .loop
+.end:
+    mov              eax, wd
+    RET
+%endmacro
+
+INIT_XMM sse4
+BLEND_ROW8
+BLEND_ROW8_2X2
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+BLEND_ROW8
+BLEND_ROW8_2X2
+%endif
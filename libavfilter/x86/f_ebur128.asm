@@ -0,0 +1,216 @@
+;*****************************************************************************
+;* x86-optimized functions for ebur128 filter
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or modify
+;* it under the terms of the GNU General Public License as published by
+;* the Free Software Foundation; either version 2 of the License, or
+;* (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+;* GNU General Public License for more details.
+;*
+;* You should have received a copy of the GNU General Public License along
+;* with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+;* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+;*****************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA 32
+
+; pre-filter and RLB-filter coefficients, see f_ebur128.c
+pd_pre_b0:   times 4 dq  1.53512485958697
+pd_pre_b1:   times 4 dq -2.69169618940638
+pd_pre_b2:   times 4 dq  1.19839281085285
+pd_pre_a1:   times 4 dq -1.69065929318241
+pd_pre_a2:   times 4 dq  0.73248077421585
+pd_rlb_b1:   times 4 dq -2.0
+pd_rlb_a1:   times 4 dq -1.99004745483398
+pd_rlb_a2:   times 4 dq  0.99007225036621
+pd_abs_mask: times 4 dq 0x7fffffffffffffff
+
+SECTION .text
+
+%if ARCH_X86_64
+
+%define STATE_STRIDE 64 * 8 ; EBUR128_STATE_STRIDE doubles
+%define X1 0 * STATE_STRIDE
+%define X2 1 * STATE_STRIDE
+%define Y1 2 * STATE_STRIDE
+%define Y2 3 * STATE_STRIDE
+%define Z1 4 * STATE_STRIDE
+%define Z2 5 * STATE_STRIDE
+
+; K-weight the channels from chq on, keeping the operation order of the C
+; version so that the results are identical. RLB_B0 and RLB_B2 being 1.0,
+; the products by them are omitted.
+; %1 = p or s (packed or scalar), %2 = aligned move, %3 = unaligned move,
+; %4-%8 = temporary registers
+%macro KWEIGHT 8
+    %3               %4, [samplesq + chq*8]
+    %2               %5, [stateq + chq*8 + X1]
+    %2               %6, [stateq + chq*8 + X2]
+    %2 [stateq + chq*8 + X2], %5
+    %2 [stateq + chq*8 + X1], %4
+    ; Y[i] = X[i]*b0 + X[i-1]*b1 + X[i-2]*b2 - Y[i-1]*a1 - Y[i-2]*a2
+    mul%1d           %4, [pd_pre_b0]
+    mul%1d           %5, [pd_pre_b1]
+    mul%1d           %6, [pd_pre_b2]
+    add%1d           %4, %5
+    add%1d           %4, %6
+    %2               %5, [stateq + chq*8 + Y1]
+    %2               %6, [stateq + chq*8 + Y2]
+    %2 [stateq + chq*8 + Y2], %5
+    mul%1d           %7, %5, [pd_pre_a1]
+    mul%1d           %8, %6, [pd_pre_a2]
+    sub%1d           %4, %7
+    sub%1d           %4, %8
+    %2 [stateq + chq*8 + Y1], %4
+    ; Z[i] = Y[i] + Y[i-1]*b1 + Y[i-2] - Z[i-1]*a1 - Z[i-2]*a2
+    mul%1d           %5, [pd_rlb_b1]
+    add%1d           %4, %5
+    add%1d           %4, %6
+    %2               %5, [stateq + chq*8 + Z1]
+    %2               %6, [stateq + chq*8 + Z2]
+    %2 [stateq + chq*8 + Z2], %5
+    mul%1d           %5, [pd_rlb_a1]
+    mul%1d           %6, [pd_rlb_a2]
+    sub%1d           %4, %5
+    sub%1d           %4, %6
+    %2 [stateq + chq*8 + Z1], %4
+    ; slide the windows
+    mul%1d           %4, %4
+    %3               %5, [sum_400q + chq*8]
+    %3               %6, [cache_400q + chq*8]
+    %3 [cache_400q + chq*8], %4
+    add%1d           %5, %4
+    sub%1d           %5, %6
+    %3 [sum_400q + chq*8], %5
+    %3               %5, [sum_3000q + chq*8]
+    %3               %6, [cache_3000q + chq*8]
+    %3 [cache_3000q + chq*8], %4
+    add%1d           %5, %4
+    sub%1d           %5, %6
+    %3 [sum_3000q + chq*8], %5
+%endmacro
+
+;-----------------------------------------------------------------------------
+; void ff_ebur128_filter_channels(double *state, const double *samples,
+;                                 double *cache_400, double *cache_3000,
+;                                 double *sum_400, double *sum_3000,
+;                                 int nb_channels, int nb_samples)
+;
+; The channels are processed mmsize/8 at a time, the remaining ones one by
+; one.
+;-----------------------------------------------------------------------------
+%macro FILTER_CHANNELS 0
+cglobal ebur128_filter_channels, 8, 10, 5, state, samples, cache_400, cache_3000, \
+                                           sum_400, sum_3000, nb_channels, len, ch, vec_end
+    movsxd  nb_channelsq, nb_channelsd
+    test            lend, lend
+    jz .end
+    mov         vec_endq, nb_channelsq
+    and         vec_endq, ~(mmsize/8 - 1)
+.loop_sample:
+    xor              chd, chd
+    cmp              chq, vec_endq
+    jge .tail
+.loop_vec:
+    KWEIGHT p, mova, movu, m0, m1, m2, m3, m4
+    add              chq, mmsize/8
+    cmp              chq, vec_endq
+    jl .loop_vec
+.tail:
+    cmp              chq, nb_channelsq
+    jge .next
+.loop_tail:
+    KWEIGHT s, movsd, movsd, xm0, xm1, xm2, xm3, xm4
+    inc              chq
+    cmp              chq, nb_channelsq
+    jl .loop_tail
+.next:
+    lea         samplesq, [samplesq    + nb_channelsq*8]
+    lea       cache_400q, [cache_400q  + nb_channelsq*8]
+    lea      cache_3000q, [cache_3000q + nb_channelsq*8]
+    dec             lend
+    jg .loop_sample
+.end:
+    RET
+%endmacro
+
+;-----------------------------------------------------------------------------
+; double ff_ebur128_true_peak(const double *src, const double *coeffs,
+;                             int nb_samples)
+;
+; All the phases of an input sample are computed together: each tap is
+; broadcast and multiplied by the EBUR128_TP_PHASES coefficients applied to it.
+;-----------------------------------------------------------------------------
+%define TP_TAPS 12 ; EBUR128_TP_TAPS
+
+%macro TRUE_PEAK 0
+cglobal ebur128_true_peak, 3, 3, 6, src, coeffs, len
+    xorpd             m0, m0
+    xorpd             m1, m1
+    movsxdifnidn    lenq, lend
+    test            lenq, lenq
+    jz .end
+    lea             srcq, [srcq + lenq*8]
+    neg             lenq
+.loop:
+%assign k 0
+%rep TP_TAPS
+%if mmsize == 32
+    vbroadcastsd      m4, [srcq + lenq*8 - k*8]
+%if k == 0
+    mulpd             m2, m4, [coeffsq]
+%else
+    mulpd             m4, [coeffsq + k*32]
+    addpd             m2, m4
+%endif
+%else
+    movsd             m4, [srcq + lenq*8 - k*8]
+    unpcklpd          m4, m4
+%if k == 0
+    mulpd             m2, m4, [coeffsq]
+    mulpd             m3, m4, [coeffsq + 16]
+%else
+    mulpd             m5, m4, [coeffsq + k*32]
+    mulpd             m4, [coeffsq + k*32 + 16]
+    addpd             m2, m5
+    addpd             m3, m4
+%endif
+%endif
+%assign k k+1
+%endrep
+    andpd             m2, [pd_abs_mask]
+    maxpd             m0, m2
+%if mmsize == 16
+    andpd             m3, [pd_abs_mask]
+    maxpd             m1, m3
+%endif
+    inc             lenq
+    jl .loop
+%if mmsize == 32
+    vextractf128     xm1, m0, 1
+%endif
+    maxpd            xm0, xm1
+    unpckhpd         xm1, xm0, xm0
+    maxsd            xm0, xm1
+.end:
+    RET
+%endmacro
+
+INIT_XMM sse2
+FILTER_CHANNELS
+TRUE_PEAK
+%if HAVE_AVX_EXTERNAL
+INIT_YMM avx
+FILTER_CHANNELS
+TRUE_PEAK
+%endif
+
+%endif ; ARCH_X86_64
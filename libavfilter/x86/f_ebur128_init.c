@@ -0,0 +1,49 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/x86/cpu.h"
+#include "libavfilter/ebur128.h"
+
+#define EBUR128_FUNCS(opt)                                                      \
+void ff_ebur128_filter_channels_##opt(double *state, const double *samples,    \
+                                      double *cache_400, double *cache_3000,   \
+                                      double *sum_400, double *sum_3000,       \
+                                      int nb_channels, int nb_samples);        \
+double ff_ebur128_true_peak_##opt(const double *src, const double *coeffs,     \
+                                  int nb_samples);
+
+EBUR128_FUNCS(sse2)
+EBUR128_FUNCS(avx)
+
+av_cold void ff_ebur128_init_dsp_x86(EBUR128DSPContext *dsp)
+{
+#if ARCH_X86_64
+    int cpu_flags = av_get_cpu_flags();
+
+    if (EXTERNAL_SSE2(cpu_flags)) {
+        dsp->filter_channels = ff_ebur128_filter_channels_sse2;
+        dsp->true_peak       = ff_ebur128_true_peak_sse2;
+    }
+    if (EXTERNAL_AVX_FAST(cpu_flags)) {
+        dsp->filter_channels = ff_ebur128_filter_channels_avx;
+        dsp->true_peak       = ff_ebur128_true_peak_avx;
+    }
+#endif
+}
@@ -0,0 +1,99 @@
+;*****************************************************************************
+;* x86-optimized functions for boxblur filter
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or modify
+;* it under the terms of the GNU General Public License as published by
+;* the Free Software Foundation; either version 2 of the License, or
+;* (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+;* GNU General Public License for more details.
+;*
+;* You should have received a copy of the GNU General Public License along
+;* with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+;* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+;*****************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA 32
+
+pd_255: times 8 dd 255
+
+SECTION .text
+
+;-----------------------------------------------------------------------------
+; int ff_boxblur_vblur_row(uint8_t *dst, int32_t *sum, const uint8_t *add,
+;                          const uint8_t *sub, int w, int inv)
+;-----------------------------------------------------------------------------
+%macro VBLUR_ROW 0
+cglobal boxblur_vblur_row, 6, 7, 6, dst, sum, add, sub, w, inv, x
+    movd             xm4, invd
+%if cpuflag(avx2)
+    vpbroadcastd      m4, xm4
+%else
+    pshufd            m4, m4, 0
+    pxor              m5, m5
+%endif
+    movsxdifnidn      wq, wd
+    and               wq, ~(mmsize/2 - 1)
+    jz .end
+    xor               xq, xq
+.loop:
+%if mmsize == 32
+    pmovzxbw          m0, [addq + xq]
+    pmovzxbw          m1, [subq + xq]
+    psubw             m0, m1
+    vpermq            m0, m0, q3120
+%else
+    movq              m0, [addq + xq]
+    movq              m1, [subq + xq]
+    punpcklbw         m0, m5
+    punpcklbw         m1, m5
+    psubw             m0, m1
+%endif
+    ; the differences fit in words: multiply the low word of each dword
+    ; by inv, the high word of inv being 0
+    punpcklwd         m2, m0, m0
+    punpckhwd         m3, m0, m0
+    pmaddwd           m2, m4
+    pmaddwd           m3, m4
+    movu              m0, [sumq + xq*4]
+    movu              m1, [sumq + xq*4 + mmsize]
+    paddd             m2, m0
+    paddd             m3, m1
+    movu [sumq + xq*4], m2
+    movu [sumq + xq*4 + mmsize], m3
+    ; the C version stores the low byte of sum >> 16
+    psrad             m2, 16
+    psrad             m3, 16
+    pand              m2, [pd_255]
+    pand              m3, [pd_255]
+    packssdw          m2, m3
+%if mmsize == 32
+    vpermq            m2, m2, q3120
+    vextracti128     xm3, m2, 1
+    packuswb         xm2, xm3
+    movu     [dstq + xq], xm2
+%else
+    packuswb          m2, m2
+    movq     [dstq + xq], m2
+%endif
+    add               xq, mmsize/2
+    cmp               xq, wq
+    jl .loop
+.end:
+    mov              eax, wd
+    RET
+%endmacro
+
+INIT_XMM sse2
+VBLUR_ROW
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+VBLUR_ROW
+%endif
@@ -0,0 +1,37 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/x86/cpu.h"
+#include "libavfilter/boxblur.h"
+
+int ff_boxblur_vblur_row_sse2(uint8_t *dst, int32_t *sum, const uint8_t *add,
+                              const uint8_t *sub, int w, int inv);
+int ff_boxblur_vblur_row_avx2(uint8_t *dst, int32_t *sum, const uint8_t *add,
+                              const uint8_t *sub, int w, int inv);
+
+av_cold void ff_boxblur_init_dsp_x86(BoxBlurDSPContext *dsp)
+{
+    int cpu_flags = av_get_cpu_flags();
+
+    if (EXTERNAL_SSE2(cpu_flags))
+        dsp->vblur_row = ff_boxblur_vblur_row_sse2;
+    if (EXTERNAL_AVX2_FAST(cpu_flags))
+        dsp->vblur_row = ff_boxblur_vblur_row_avx2;
+}
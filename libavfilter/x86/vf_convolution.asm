@@ -0,0 +1,106 @@
+;*****************************************************************************
+;* x86-optimized functions for convolution filter
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;*****************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA 32
+
+ps_0_5: times 8 dd 0.5
+
+SECTION .text
+
+%if ARCH_X86_64
+
+;-----------------------------------------------------------------------------
+; int ff_convolution_filter_<taps>(uint8_t *dst, int w, const int *matrix,
+;                                  const uint8_t *const *c, float rdiv, float bias)
+;-----------------------------------------------------------------------------
+%macro FILTER 1 ; number of taps
+cglobal convolution_filter_%1, 4, 6, 7, dst, w, matrix, c, x, ptr
+%if WIN64
+    movss            xm0, r4m
+    movss            xm1, r5m
+%endif
+%if cpuflag(avx2)
+    vbroadcastss      m0, xm0
+    vbroadcastss      m1, xm1
+%else
+    shufps            m0, m0, 0
+    shufps            m1, m1, 0
+%endif
+    movsxdifnidn      wq, wd
+    and               wq, ~(mmsize/2 - 1)
+    jz .end
+    xor               xq, xq
+.loop:
+    ; two vectors of dword sums
+    pxor              m2, m2
+    pxor              m3, m3
+%assign i 0
+%rep %1
+    mov             ptrq, [cq + i*gprsize]
+    pmovzxbd          m4, [ptrq + xq]
+    pmovzxbd          m5, [ptrq + xq + mmsize/4]
+    VBROADCASTSS      m6, [matrixq + i*4]
+    pmulld            m4, m6
+    pmulld            m5, m6
+    paddd             m2, m4
+    paddd             m3, m5
+%assign i i+1
+%endrep
+    ; same order of operations as the C version, so that it is bitexact
+    cvtdq2ps          m2, m2
+    cvtdq2ps          m3, m3
+    mulps             m2, m0
+    mulps             m3, m0
+    addps             m2, m1
+    addps             m3, m1
+    addps             m2, [ps_0_5]
+    addps             m3, [ps_0_5]
+    cvttps2dq         m2, m2
+    cvttps2dq         m3, m3
+    packssdw          m2, m3
+%if mmsize == 32
+    vpermq            m2, m2, q3120
+    vextracti128     xm3, m2, 1
+    packuswb         xm2, xm3
+    movu     [dstq + xq], xm2
+%else
+    packuswb          m2, m2
+    movq     [dstq + xq], m2
+%endif
+    add               xq, mmsize/2
+    cmp               xq, wq
+    jl .loop
+.end:
+    mov              eax, wd
+    RET
+%endmacro
+
+INIT_XMM sse4
+FILTER 9
+FILTER 25
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+FILTER 9
+FILTER 25
+%endif
+
+%endif ; ARCH_X86_64
@@ -0,0 +1,48 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/x86/cpu.h"
+#include "libavfilter/convolution.h"
+
+#define FILTER_FUNC(taps, opt)                                                 \
+int ff_convolution_filter_##taps##_##opt(uint8_t *dst, int w, const int *matrix,\
+                                         const uint8_t *const *c,              \
+                                         float rdiv, float bias);
+
+FILTER_FUNC(9,  sse4)
+FILTER_FUNC(25, sse4)
+FILTER_FUNC(9,  avx2)
+FILTER_FUNC(25, avx2)
+
+av_cold void ff_convolution_init_dsp_x86(ConvolutionDSPContext *dsp)
+{
+#if ARCH_X86_64
+    int cpu_flags = av_get_cpu_flags();
+
+    if (EXTERNAL_SSE4(cpu_flags)) {
+        dsp->filter_3x3 = ff_convolution_filter_9_sse4;
+        dsp->filter_5x5 = ff_convolution_filter_25_sse4;
+    }
+    if (EXTERNAL_AVX2_FAST(cpu_flags)) {
+        dsp->filter_3x3 = ff_convolution_filter_9_avx2;
+        dsp->filter_5x5 = ff_convolution_filter_25_avx2;
+    }
+#endif
+}
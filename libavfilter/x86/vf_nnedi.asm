@@ -0,0 +1,157 @@
+;*****************************************************************************
+;* x86-optimized functions for nnedi filter
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or modify
+;* it under the terms of the GNU General Public License as published by
+;* the Free Software Foundation; either version 2 of the License, or
+;* (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+;* GNU General Public License for more details.
+;*
+;* You should have received a copy of the GNU General Public License along
+;* with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+;* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+;*****************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION .text
+
+%if ARCH_X86_64
+
+; Both functions evaluate four neurons at a time, so that every load of the
+; input is shared by four multiplications. weightsq and dataq point to the
+; end of the first row of weights and of the input, offq runs from -len to 0.
+
+; set up w1q-w3q to the following rows of weights and clear the accumulators
+%macro NEURONS_START 0
+    lea              w1q, [weightsq + lenq]
+    lea              w2q, [weightsq + lenq*2]
+    lea              w3q, [w1q + lenq*2]
+    mov             offq, lenq
+    neg             offq
+    xorps             m0, m0
+    xorps             m1, m1
+    xorps             m2, m2
+    xorps             m3, m3
+%endmacro
+
+; go to the next four rows of weights, four outputs and decrement n
+%macro NEURONS_END 1 ; size of the scale and bias of four neurons
+    lea         weightsq, [weightsq + lenq*4]
+    add            biasq, %1
+    add            valsq, 16
+    sub               nd, 4
+    jg .loop_n
+    RET
+%endmacro
+
+;-----------------------------------------------------------------------------
+; void ff_nnedi_dot_prod(const float *data, const float *weights, float *vals,
+;                        int n, int len, const float *scale)
+;-----------------------------------------------------------------------------
+%macro DOT_PROD 0
+cglobal nnedi_dot_prod, 6, 11, 8, data, weights, vals, n, len, scale, bias, w1, w2, w3, off
+    movsxdifnidn      nq, nd
+    movsxdifnidn    lenq, lend
+    VBROADCASTSS     xm6, [scaleq]
+    mov            biasq, lenq
+    imul           biasq, nq
+    lea            biasq, [weightsq + biasq*4]
+    shl             lenq, 2
+    add            dataq, lenq
+    add         weightsq, lenq
+.loop_n:
+    NEURONS_START
+.loop_len:
+    movu              m4, [dataq + offq]
+    FMULADD_PS        m0, m4, [weightsq + offq], m0, m5
+    FMULADD_PS        m1, m4, [w1q + offq], m1, m5
+    FMULADD_PS        m2, m4, [w2q + offq], m2, m5
+    FMULADD_PS        m3, m4, [w3q + offq], m3, m5
+    add             offq, mmsize
+    jl .loop_len
+
+    haddps            m0, m1
+    haddps            m2, m3
+    haddps            m0, m2
+%if mmsize == 32
+    vextractf128     xm1, m0, 1
+    addps            xm0, xm1
+%endif
+    mulps            xm0, xm6
+    addps            xm0, [biasq]
+    movu          [valsq], xm0
+    NEURONS_END 16
+%endmacro
+
+INIT_XMM sse3
+DOT_PROD
+%if HAVE_AVX_EXTERNAL
+INIT_YMM avx
+DOT_PROD
+%endif
+%if HAVE_FMA3_EXTERNAL
+INIT_YMM fma3
+DOT_PROD
+%endif
+
+;-----------------------------------------------------------------------------
+; void ff_nnedi_dot_prod_int16(const int16_t *data, const int16_t *weights,
+;                              float *vals, int n, int len, const float *scale)
+;-----------------------------------------------------------------------------
+%macro DOT_PROD_INT16 0
+cglobal nnedi_dot_prod_int16, 6, 11, 8, data, weights, vals, n, len, scale, bias, w1, w2, w3, off
+    movsxdifnidn      nq, nd
+    movsxdifnidn    lenq, lend
+    VBROADCASTSS     xm6, [scaleq]
+    mov            biasq, lenq
+    imul           biasq, nq
+    lea            biasq, [weightsq + biasq*2]
+    add             lenq, lenq
+    add            dataq, lenq
+    add         weightsq, lenq
+.loop_n:
+    NEURONS_START
+.loop_len:
+    movu              m4, [dataq + offq]
+    pmaddwd           m5, m4, [weightsq + offq]
+    paddd             m0, m5
+    pmaddwd           m5, m4, [w1q + offq]
+    paddd             m1, m5
+    pmaddwd           m5, m4, [w2q + offq]
+    paddd             m2, m5
+    pmaddwd           m5, m4, [w3q + offq]
+    paddd             m3, m5
+    add             offq, mmsize
+    jl .loop_len
+
+    phaddd            m0, m1
+    phaddd            m2, m3
+    phaddd            m0, m2
+%if mmsize == 32
+    vextracti128     xm1, m0, 1
+    paddd            xm0, xm1
+%endif
+    ; same order of operations as the C version, so that it is bitexact
+    cvtdq2ps         xm0, xm0
+    mulps            xm0, [biasq]
+    mulps            xm0, xm6
+    addps            xm0, [biasq + 16]
+    movu          [valsq], xm0
+    NEURONS_END 32
+%endmacro
+
+INIT_XMM ssse3
+DOT_PROD_INT16
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+DOT_PROD_INT16
+%endif
+
+%endif ; ARCH_X86_64
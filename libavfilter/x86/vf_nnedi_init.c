@@ -0,0 +1,56 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/x86/cpu.h"
+#include "libavfilter/nnedi.h"
+
+#define DOT_PROD_FUNC(opt)                                                     \
+void ff_nnedi_dot_prod_##opt(const float *data, const float *weights,          \
+                             float *vals, int n, int len, const float *scale);
+
+#define DOT_PROD_INT16_FUNC(opt)                                               \
+void ff_nnedi_dot_prod_int16_##opt(const int16_t *data, const int16_t *weights,\
+                                   float *vals, int n, int len,                \
+                                   const float *scale);
+
+DOT_PROD_FUNC(sse3)
+DOT_PROD_FUNC(avx)
+DOT_PROD_FUNC(fma3)
+DOT_PROD_INT16_FUNC(ssse3)
+DOT_PROD_INT16_FUNC(avx2)
+
+av_cold void ff_nnedi_init_dsp_x86(NNEDIDSPContext *dsp)
+{
+#if ARCH_X86_64
+    int cpu_flags = av_get_cpu_flags();
+
+    if (EXTERNAL_SSE3(cpu_flags))
+        dsp->dot_prod = ff_nnedi_dot_prod_sse3;
+    if (EXTERNAL_AVX_FAST(cpu_flags))
+        dsp->dot_prod = ff_nnedi_dot_prod_avx;
+    if (EXTERNAL_FMA3_FAST(cpu_flags))
+        dsp->dot_prod = ff_nnedi_dot_prod_fma3;
+
+    if (EXTERNAL_SSSE3(cpu_flags))
+        dsp->dot_prod_int16 = ff_nnedi_dot_prod_int16_ssse3;
+    if (EXTERNAL_AVX2_FAST(cpu_flags))
+        dsp->dot_prod_int16 = ff_nnedi_dot_prod_int16_avx2;
+#endif
+}
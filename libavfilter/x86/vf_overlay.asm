@@ -0,0 +1,230 @@
+;*****************************************************************************
+;* x86-optimized functions for overlay filter
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;*****************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA 32
+
+pb_1:       times 32 db 1
+pw_128:     times 16 dw 128
+pw_255:     times 16 dw 255
+pw_257:     times 16 dw 257
+pd_1:       times 8 dd 1
+pd_128:     times 8 dd 128
+pd_255:     times 8 dd 255
+pd_65025:   times 8 dd 65025
+pd_rgb:     times 8 dd 0x00ffffff
+pd_gba:     times 8 dd 0xffffff00
+pb_bcast:   times 2 db 0, 0, 0, 0, 4, 4, 4, 4, 8, 8, 8, 8, 12, 12, 12, 12
+
+SECTION .text
+
+; m0 = main, m1 = overlay, m2 = alpha, as words
+; m0 = (main * (255 - alpha) + overlay * alpha) / 255, using m3-m5
+%macro BLEND_WORDS 0
+    pmullw       m1, m2
+    pxor         m2, m3
+    pmullw       m0, m2
+    paddw        m0, m1
+    paddw        m0, m4
+    pmulhuw      m0, m5
+    packuswb     m0, m0
+%if mmsize == 32
+    vpermq       m0, m0, q3120
+    movu  [dq + xq], xm0
+%else
+    movq  [dq + xq], m0
+%endif
+%endmacro
+
+;------------------------------------------------------------------------------
+; int ff_overlay_row_44(uint8_t *d, const uint8_t *s, const uint8_t *a,
+;                       int w, ptrdiff_t alinesize)
+;------------------------------------------------------------------------------
+
+%macro OVERLAY_ROW_44 0
+cglobal overlay_row_44, 5, 7, 6, d, s, a, w, alinesize, n, x
+    movsxdifnidn wq, wd
+    mov          nq, wq
+    and          nq, ~(mmsize / 2 - 1)
+    jle .end
+    mova         m3, [pw_255]
+    mova         m4, [pw_128]
+    mova         m5, [pw_257]
+    xor          xq, xq
+.loop:
+    pmovzxbw     m0, [dq + xq]
+    pmovzxbw     m1, [sq + xq]
+    pmovzxbw     m2, [aq + xq]
+    BLEND_WORDS
+    add          xq, mmsize / 2
+    cmp          xq, nq
+    jl .loop
+.end:
+    mov         eax, nd
+    RET
+%endmacro
+
+;------------------------------------------------------------------------------
+; int ff_overlay_row_20(uint8_t *d, const uint8_t *s, const uint8_t *a,
+;                       int w, ptrdiff_t alinesize)
+;------------------------------------------------------------------------------
+
+%macro OVERLAY_ROW_20 0
+cglobal overlay_row_20, 5, 7, 8, d, s, a, w, alinesize, n, x
+    movsxdifnidn wq, wd
+    mov          nq, wq
+    and          nq, ~(mmsize / 2 - 1)
+    jle .end
+    add  alinesizeq, aq
+    mova         m3, [pw_255]
+    mova         m4, [pw_128]
+    mova         m5, [pw_257]
+    mova         m6, [pb_1]
+    xor          xq, xq
+.loop:
+    movu         m2, [aq + 2 * xq]
+    movu         m7, [alinesizeq + 2 * xq]
+    pmaddubsw    m2, m6
+    pmaddubsw    m7, m6
+    paddw        m2, m7
+    psrlw        m2, 2
+    pmovzxbw     m0, [dq + xq]
+    pmovzxbw     m1, [sq + xq]
+    BLEND_WORDS
+    add          xq, mmsize / 2
+    cmp          xq, nq
+    jl .loop
+.end:
+    mov         eax, nd
+    RET
+%endmacro
+
+;------------------------------------------------------------------------------
+; int ff_overlay_row_rgba(uint8_t *d, const uint8_t *s, int w)
+; int ff_overlay_row_argb(uint8_t *d, const uint8_t *s, int w)
+;------------------------------------------------------------------------------
+
+; %1 = name, %2 = byte index of the alpha component
+%macro OVERLAY_ROW_PACKED 2
+cglobal overlay_row_%1, 3, 5, 16, d, s, w, n, x
+    movsxdifnidn wq, wd
+    mov          nq, wq
+    and          nq, ~(mmsize / 4 - 1)
+    jle .end
+    pxor        m11, m11
+    mova        m12, [pd_255]
+    mova        m13, [pw_255]
+    mova        m14, [pw_128]
+    mova        m15, [pw_257]
+    xor          xq, xq
+.loop:
+    movu         m0, [dq + 4 * xq]
+    movu         m1, [sq + 4 * xq]
+%if %2 == 3
+    psrld        m2, m1, 24
+    psrld        m3, m0, 24
+%else
+    pand         m2, m12, m1
+    pand         m3, m12, m0
+%endif
+
+    ; unpremultiplied alpha = 255 * 255 * a / (255 * (a + ad) - a * ad)
+    paddd        m4, m2, m3
+    pmulld       m4, m12
+    pmulld       m5, m2, m3
+    psubd        m4, m5
+    pmaxsd       m4, [pd_1]
+    pmulld       m5, m2, [pd_65025]
+    cvtdq2ps     m6, m5
+    cvtdq2ps     m7, m4
+    divps        m6, m7
+    cvttps2dq    m6, m6
+    ; the float quotient is off by one at most, fix it with the remainder
+    pmulld       m7, m6, m4
+    psubd        m8, m5, m7
+    pcmpgtd      m9, m11, m8
+    paddd        m6, m9
+    pcmpgtd      m9, m4, m8
+    paddd        m6, [pd_1]
+    paddd        m6, m9
+
+    ; main alpha += (255 - main alpha) * a / 255
+    pxor         m7, m3, m12
+    pmullw       m7, m2
+    paddw        m7, [pd_128]
+    pmulhuw      m7, m15
+    paddd        m7, m3
+%if %2 == 3
+    pslld        m7, 24
+%endif
+
+    pshufb       m6, [pb_bcast]
+    punpcklbw    m2, m0, m11
+    punpckhbw    m0, m11
+    punpcklbw    m3, m1, m11
+    punpckhbw    m1, m11
+    punpcklbw    m4, m6, m11
+    punpckhbw    m6, m11
+    pmullw       m3, m4
+    pxor         m4, m13
+    pmullw       m2, m4
+    paddw        m2, m3
+    pmullw       m1, m6
+    pxor         m6, m13
+    pmullw       m0, m6
+    paddw        m0, m1
+    paddw        m2, m14
+    paddw        m0, m14
+    pmulhuw      m2, m15
+    pmulhuw      m0, m15
+    packuswb     m2, m0
+%if %2 == 3
+    pand         m2, [pd_rgb]
+%else
+    pand         m2, [pd_gba]
+%endif
+    por          m2, m7
+    movu [dq + 4 * xq], m2
+    add          xq, mmsize / 4
+    cmp          xq, nq
+    jl .loop
+.end:
+    mov         eax, nd
+    RET
+%endmacro
+
+INIT_XMM sse4
+OVERLAY_ROW_44
+OVERLAY_ROW_20
+%if ARCH_X86_64
+OVERLAY_ROW_PACKED rgba, 3
+OVERLAY_ROW_PACKED argb, 0
+%endif
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+OVERLAY_ROW_44
+OVERLAY_ROW_20
+%if ARCH_X86_64
+OVERLAY_ROW_PACKED rgba, 3
+OVERLAY_ROW_PACKED argb, 0
+%endif
+%endif
@@ -0,0 +1,56 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/x86/cpu.h"
+#include "libavfilter/overlay.h"
+
+#define OVERLAY_FUNCS(opt)                                                     \
+int ff_overlay_row_44_##opt(uint8_t *d, const uint8_t *s, const uint8_t *a,    \
+                            int w, ptrdiff_t alinesize);                       \
+int ff_overlay_row_20_##opt(uint8_t *d, const uint8_t *s, const uint8_t *a,    \
+                            int w, ptrdiff_t alinesize);                       \
+int ff_overlay_row_rgba_##opt(uint8_t *d, const uint8_t *s, int w);            \
+int ff_overlay_row_argb_##opt(uint8_t *d, const uint8_t *s, int w);
+
+OVERLAY_FUNCS(sse4)
+OVERLAY_FUNCS(avx2)
+
+av_cold void ff_overlay_init_dsp_x86(OverlayDSPContext *dsp)
+{
+    int cpu_flags = av_get_cpu_flags();
+
+    if (EXTERNAL_SSE4(cpu_flags)) {
+        dsp->blend_row_44 = ff_overlay_row_44_sse4;
+        dsp->blend_row_20 = ff_overlay_row_20_sse4;
+#if ARCH_X86_64
+        dsp->blend_row_rgba = ff_overlay_row_rgba_sse4;
+        dsp->blend_row_argb = ff_overlay_row_argb_sse4;
+#endif
+    }
+
+    if (EXTERNAL_AVX2_FAST(cpu_flags)) {
+        dsp->blend_row_44 = ff_overlay_row_44_avx2;
+        dsp->blend_row_20 = ff_overlay_row_20_avx2;
+#if ARCH_X86_64
+        dsp->blend_row_rgba = ff_overlay_row_rgba_avx2;
+        dsp->blend_row_argb = ff_overlay_row_argb_avx2;
+#endif
+    }
+}
@@ -0,0 +1,89 @@
+;*****************************************************************************
+;* x86-optimized functions for paletteuse filter
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION .text
+
+%macro SPLATD_ARG 2 ; dst, gpr
+    movd            xm%1, %2
+%if cpuflag(avx2)
+    vpbroadcastd     m%1, xm%1
+%else
+    pshufd           m%1, m%1, 0
+%endif
+%endmacro
+
+;-----------------------------------------------------------------------------
+; uint32_t ff_nearest_color(const int32_t (*pal)[256], int n,
+;                           int r, int g, int b)
+;
+; The distance of every candidate is combined with its palette index in a
+; (dist << 8 | index) key, the unsigned minimum of the keys is then both the
+; nearest color and the smallest index amongst the colors at that distance.
+;-----------------------------------------------------------------------------
+%macro NEAREST_COLOR 0
+cglobal nearest_color, 5, 5, 8, pal, n, red, green, blue
+    SPLATD_ARG         4, redd
+    SPLATD_ARG         5, greend
+    SPLATD_ARG         6, blued
+    pcmpeqd           m7, m7
+    movsxdifnidn      nq, nd
+    shl               nq, 2
+    add             palq, nq
+    neg               nq
+    jz .end
+.loop:
+    mova              m0, [palq + nq]
+    mova              m1, [palq + nq + 1024]
+    mova              m2, [palq + nq + 2048]
+    psubd             m0, m4
+    psubd             m1, m5
+    psubd             m2, m6
+    pmulld            m0, m0
+    pmulld            m1, m1
+    pmulld            m2, m2
+    paddd             m0, m1
+    paddd             m0, m2
+    pslld             m0, 8
+    por               m0, [palq + nq + 3072]
+    pminud            m7, m0
+    add               nq, mmsize
+    jl .loop
+.end:
+%if mmsize == 32
+    vextracti128     xm0, m7, 1
+    pminud           xm7, xm0
+%endif
+    pshufd           xm0, xm7, q1032
+    pminud           xm7, xm0
+    pshufd           xm0, xm7, q0001
+    pminud           xm7, xm0
+    movd             eax, xm7
+    RET
+%endmacro
+
+INIT_XMM sse4
+NEAREST_COLOR
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+NEAREST_COLOR
+%endif
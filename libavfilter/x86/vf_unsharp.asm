@@ -0,0 +1,142 @@
+;*****************************************************************************
+;* x86-optimized functions for unsharp filter
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;*****************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION .text
+
+;-----------------------------------------------------------------------------
+; void ff_unsharp_hsum(uint32_t *h, int nb_stages, int w)
+;-----------------------------------------------------------------------------
+%macro HSUM 0
+cglobal unsharp_hsum, 3, 4, 2, h, stages, w, x
+    movsxdifnidn      wq, wd
+    shl               wq, 2
+.loop_stage:
+    ; backwards, so that h[x - 1] is read before being updated
+    mov               xq, wq
+.loop_x:
+    sub               xq, mmsize
+    movu              m0, [hq + xq - 4]
+    paddd             m0, [hq + xq]
+    mova       [hq + xq], m0
+    jg .loop_x
+    dec          stagesd
+    jg .loop_stage
+    RET
+%endmacro
+
+;-----------------------------------------------------------------------------
+; void ff_unsharp_vsum(uint32_t *h, uint32_t *sc, ptrdiff_t stride,
+;                      int nb_stages, int w)
+;-----------------------------------------------------------------------------
+%macro VSUM 0
+cglobal unsharp_vsum, 5, 7, 2, h, sc, stride, stages, w, x, ptr
+    movsxdifnidn      wq, wd
+    shl          strideq, 2
+    shl               wq, 2
+    add               hq, wq
+    add              scq, wq
+    neg               wq
+.loop_x:
+    mova              m0, [hq + wq]
+    lea             ptrq, [scq + wq]
+    mov               xd, stagesd
+.loop_stage:
+    mova              m1, [ptrq]
+    mova          [ptrq], m0
+    paddd             m0, m1
+    add             ptrq, strideq
+    dec               xd
+    jg .loop_stage
+    mova       [hq + wq], m0
+    add               wq, mmsize
+    jl .loop_x
+    RET
+%endmacro
+
+;-----------------------------------------------------------------------------
+; int ff_unsharp_blend(uint8_t *dst, const uint8_t *src, const uint32_t *blur,
+;                      int w, int amount, int scalebits)
+;-----------------------------------------------------------------------------
+%macro BLEND 0
+cglobal unsharp_blend, 6, 7, 8, dst, src, blur, w, amount, scalebits, x
+    movd             xm5, scalebitsd
+    movd             xm6, amountd
+%if cpuflag(avx2)
+    vpbroadcastd      m6, xm6
+%else
+    pshufd            m6, m6, 0
+%endif
+    ; halfscale
+    pcmpeqd           m4, m4
+    psrld             m4, 31
+    pslld             m4, xm5
+    psrld             m4, 1
+    movsxdifnidn      wq, wd
+    and               wq, ~(mmsize/2 - 1)
+    jz .end
+    xor               xq, xq
+.loop:
+    pmovzxbd          m0, [srcq + xq]
+    pmovzxbd          m1, [srcq + xq + mmsize/4]
+    movu              m2, [blurq + xq*4]
+    movu              m3, [blurq + xq*4 + mmsize]
+    paddd             m2, m4
+    paddd             m3, m4
+    psrld             m2, xm5
+    psrld             m3, xm5
+    psubd             m7, m0, m2
+    psubd             m2, m1, m3
+    pmulld            m7, m6
+    pmulld            m2, m6
+    psrad             m7, 16
+    psrad             m2, 16
+    paddd             m0, m7
+    paddd             m1, m2
+    packssdw          m0, m1
+%if mmsize == 32
+    vpermq            m0, m0, q3120
+    vextracti128     xm1, m0, 1
+    packuswb         xm0, xm1
+    movu     [dstq + xq], xm0
+%else
+    packuswb          m0, m0
+    movq     [dstq + xq], m0
+%endif
+    add               xq, mmsize/2
+    cmp               xq, wq
+    jl .loop
+.end:
+    mov              eax, wd
+    RET
+%endmacro
+
+INIT_XMM sse2
+HSUM
+VSUM
+INIT_XMM sse4
+BLEND
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+HSUM
+VSUM
+BLEND
+%endif
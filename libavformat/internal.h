@@ -70,6 +70,31 @@ struct AVFormatInternal {
      */
     int nb_interleaved_streams;
 
+    /**
+     * Binary min-heap of the indices of the streams which have packets
+     * queued in the default dts-based interleaver, ordered by the first
+     * queued packet of each stream.
+     * Muxing only.
+     */
+    int *interleave_heap;
+    int nb_interleave_heap;
+    int interleave_heap_size;
+
+    /**
+     * Number of streams which hold back the max_interleave_delta check
+     * while they have no packets queued, in total and among the streams
+     * in interleave_heap.
+     * Muxing only.
+     */
+    int nb_interleave_delta_streams;
+    int nb_queued_interleave_delta_streams;
+
+    /**
+     * Largest dts queued in the default interleaver, in AV_TIME_BASE_Q.
+     * Muxing only.
+     */
+    int64_t interleave_max_dts;
+
     /**
      * This buffer is only needed when packets were already buffered but
      * not decoded, for example to get the codec parameters in MPEG
@@ -160,6 +185,13 @@ struct AVStreamInternal {
      * Whether the internal avctx needs to be updated from codecpar (after a late change to codecpar)
      */
     int need_context_update;
+
+    /**
+     * Packets queued for this stream by the default dts-based interleaver,
+     * in input order. The last one is AVStream.last_in_packet_buffer.
+     * Muxing only.
+     */
+    struct AVPacketList *interleave_queue;
 };
 
 #ifdef __GNUC__
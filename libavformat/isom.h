@@ -172,6 +172,8 @@ typedef struct MOVStreamContext {
     int32_t *display_matrix;
     uint32_t format;
 
+    struct MOVLazyIndex *lazy_index; ///< index entries computed from the sample tables on demand
+
     struct {
         int use_subsamples;
         uint8_t* auxiliary_info;
@@ -231,6 +233,7 @@ typedef struct MOVContext {
     uint8_t *decryption_key;
     int decryption_key_len;
     int enable_drefs;
+    int lazy_index;
 } MOVContext;
 
 int ff_mp4_read_descr_len(AVIOContext *pb);
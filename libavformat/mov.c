@@ -2667,17 +2667,355 @@ static int mov_read_sbgp(MOVContext *c, AVIOContext *pb, MOVAtom atom)
     return pb->eof_reached ? AVERROR_EOF : 0;
 }
 
+/**
+ * State of the conversion of the sample tables (stco, stsc, stsz, stts,
+ * stss, stps and sbgp) into index entries, one sample at a time.
+ */
+typedef struct MOVIndexCursor {
+    unsigned int chunk;         ///< current chunk
+    unsigned int chunk_sample;  ///< sample in the current chunk
+    int chunk_started;
+    unsigned int stsc_index;
+    unsigned int stts_index;
+    unsigned int stts_sample;
+    unsigned int stss_index;
+    unsigned int stps_index;
+    unsigned int rap_group_index;
+    unsigned int rap_group_sample;
+    unsigned int current_sample;
+    unsigned int distance;
+    int key_off;
+    int64_t current_offset;
+    int64_t current_dts;
+    int64_t last_dts;
+    int64_t dts_correction;
+    uint64_t stream_size;
+    unsigned int nb_entries;    ///< number of index entries produced
+} MOVIndexCursor;
+
+#define MOV_LAZY_INDEX_WINDOW 4
+
+/**
+ * Index entries computed on demand from the sample tables, used instead of
+ * AVStream.index_entries until the full index is needed for seeking.
+ */
+typedef struct MOVLazyIndex {
+    MOVIndexCursor start;       ///< cursor positioned on the first sample
+    MOVIndexCursor cursor;      ///< cursor positioned after the last computed entry
+    unsigned int nb_entries;    ///< total number of index entries
+    AVIndexEntry entries[MOV_LAZY_INDEX_WINDOW]; ///< last computed entries
+} MOVLazyIndex;
+
+static void mov_index_cursor_init(MOVStreamContext *sc, int64_t current_dts,
+                                  MOVIndexCursor *c)
+{
+    memset(c, 0, sizeof(*c));
+    c->key_off     = (sc->keyframe_count && sc->keyframes[0] > 0) ||
+                     (sc->stps_count && sc->stps_data[0] > 0);
+    c->current_dts = current_dts - sc->dts_shift;
+    c->last_dts    = c->current_dts;
+}
+
+/**
+ * Compute the next index entry from the sample tables.
+ *
+ * @return 1 if an entry was computed, 0 at the end of the tables,
+ *         a negative error code if the tables are inconsistent
+ */
+static int mov_index_cursor_next(MOVContext *mov, AVStream *st,
+                                 MOVIndexCursor *c, AVIndexEntry *e)
+{
+    MOVStreamContext *sc = st->priv_data;
+    int rap_group_present = sc->rap_group_count && sc->rap_group;
+
+    for (;;) {
+        unsigned int sample_size;
+        int keyframe = 0, found = 0;
+
+        if (!c->chunk_started) {
+            int64_t next_offset;
+
+            if (c->chunk >= sc->chunk_count)
+                return 0;
+
+            next_offset = c->chunk + 1 < sc->chunk_count ? sc->chunk_offsets[c->chunk + 1] : INT64_MAX;
+            c->current_offset = sc->chunk_offsets[c->chunk];
+            while (c->stsc_index + 1 < sc->stsc_count &&
+                c->chunk + 1 == sc->stsc_data[c->stsc_index + 1].first)
+                c->stsc_index++;
+
+            if (next_offset > c->current_offset && sc->sample_size>0 && sc->sample_size < sc->stsz_sample_size &&
+                sc->stsc_data[c->stsc_index].count * (int64_t)sc->stsz_sample_size > next_offset - c->current_offset) {
+                av_log(mov->fc, AV_LOG_WARNING, "STSZ sample size %d invalid (too large), ignoring\n", sc->stsz_sample_size);
+                sc->stsz_sample_size = sc->sample_size;
+            }
+            if (sc->stsz_sample_size>0 && sc->stsz_sample_size < sc->sample_size) {
+                av_log(mov->fc, AV_LOG_WARNING, "STSZ sample size %d invalid (too small), ignoring\n", sc->stsz_sample_size);
+                sc->stsz_sample_size = sc->sample_size;
+            }
+
+            c->chunk_sample  = 0;
+            c->chunk_started = 1;
+        }
+
+        if (c->chunk_sample >= sc->stsc_data[c->stsc_index].count) {
+            c->chunk++;
+            c->chunk_started = 0;
+            continue;
+        }
+
+        if (c->current_sample >= sc->sample_count) {
+            av_log(mov->fc, AV_LOG_ERROR, "wrong sample count\n");
+            return AVERROR_INVALIDDATA;
+        }
+
+        if (!sc->keyframe_absent && (!sc->keyframe_count || c->current_sample+c->key_off == sc->keyframes[c->stss_index])) {
+            keyframe = 1;
+            if (c->stss_index + 1 < sc->keyframe_count)
+                c->stss_index++;
+        } else if (sc->stps_count && c->current_sample+c->key_off == sc->stps_data[c->stps_index]) {
+            keyframe = 1;
+            if (c->stps_index + 1 < sc->stps_count)
+                c->stps_index++;
+        }
+        if (rap_group_present && c->rap_group_index < sc->rap_group_count) {
+            if (sc->rap_group[c->rap_group_index].index > 0)
+                keyframe = 1;
+            if (++c->rap_group_sample == sc->rap_group[c->rap_group_index].count) {
+                c->rap_group_sample = 0;
+                c->rap_group_index++;
+            }
+        }
+        if (sc->keyframe_absent
+            && !sc->stps_count
+            && !rap_group_present
+            && (st->codecpar->codec_type == AVMEDIA_TYPE_AUDIO || (c->chunk==0 && c->chunk_sample==0)))
+             keyframe = 1;
+        if (keyframe)
+            c->distance = 0;
+        sample_size = sc->stsz_sample_size > 0 ? sc->stsz_sample_size : sc->sample_sizes[c->current_sample];
+        if (sc->pseudo_stream_id == -1 ||
+           sc->stsc_data[c->stsc_index].id - 1 == sc->pseudo_stream_id) {
+            e->pos = c->current_offset;
+            e->timestamp = c->current_dts;
+            e->size = sample_size;
+            e->min_distance = c->distance;
+            e->flags = keyframe ? AVINDEX_KEYFRAME : 0;
+            av_log(mov->fc, AV_LOG_TRACE, "AVIndex stream %d, sample %d, offset %"PRIx64", dts %"PRId64", "
+                    "size %d, distance %d, keyframe %d\n", st->index, c->current_sample,
+                    c->current_offset, c->current_dts, sample_size, c->distance, keyframe);
+            c->nb_entries++;
+            found = 1;
+        }
+
+        c->current_offset += sample_size;
+        c->stream_size += sample_size;
+
+        /* A negative sample duration is invalid based on the spec,
+         * but some samples need it to correct the DTS. */
+        if (sc->stts_data[c->stts_index].duration < 0) {
+            av_log(mov->fc, AV_LOG_WARNING,
+                   "Invalid SampleDelta %d in STTS, at %d st:%d\n",
+                   sc->stts_data[c->stts_index].duration, c->stts_index,
+                   st->index);
+            c->dts_correction += sc->stts_data[c->stts_index].duration - 1;
+            sc->stts_data[c->stts_index].duration = 1;
+        }
+        c->current_dts += sc->stts_data[c->stts_index].duration;
+        if (!c->dts_correction || c->current_dts + c->dts_correction > c->last_dts) {
+            c->current_dts += c->dts_correction;
+            c->dts_correction = 0;
+        } else {
+            /* Avoid creating non-monotonous DTS */
+            c->dts_correction += c->current_dts - c->last_dts - 1;
+            c->current_dts = c->last_dts + 1;
+        }
+        c->last_dts = c->current_dts;
+        c->distance++;
+        c->stts_sample++;
+        c->current_sample++;
+        c->chunk_sample++;
+        if (c->stts_index + 1 < sc->stts_count && c->stts_sample == sc->stts_data[c->stts_index].count) {
+            c->stts_sample = 0;
+            c->stts_index++;
+        }
+
+        if (found)
+            return 1;
+    }
+}
+
+/**
+ * Build AVStream.index_entries from the sample tables.
+ *
+ * @param at_open 1 when called while reading the header, in which case the
+ *                frame rate estimation and the bitrate are updated as well
+ */
+static void mov_fill_index(MOVContext *mov, AVStream *st, MOVIndexCursor *c,
+                           int at_open)
+{
+    MOVStreamContext *sc = st->priv_data;
+    int ret;
+
+    if (av_reallocp_array(&st->index_entries,
+                          st->nb_index_entries + sc->sample_count,
+                          sizeof(*st->index_entries)) < 0) {
+        st->nb_index_entries = 0;
+        return;
+    }
+    st->index_entries_allocated_size = (st->nb_index_entries + sc->sample_count) * sizeof(*st->index_entries);
+
+    while ((ret = mov_index_cursor_next(mov, st, c, &st->index_entries[st->nb_index_entries])) > 0) {
+        st->nb_index_entries++;
+        if (at_open && st->codecpar->codec_type == AVMEDIA_TYPE_VIDEO && st->nb_index_entries < 100)
+            ff_rfps_add_frame(mov->fc, st, st->index_entries[st->nb_index_entries - 1].timestamp);
+    }
+    if (ret < 0)
+        return;
+
+    if (at_open && st->duration > 0)
+        st->codecpar->bit_rate = c->stream_size*8*sc->time_scale/st->duration;
+}
+
+/**
+ * Check whether the sample tables can be converted into index entries
+ * several times, that is if the conversion does not need to correct them.
+ */
+static int mov_index_tables_are_stable(MOVStreamContext *sc)
+{
+    unsigned int i, stsc_index = 0;
+
+    for (i = 0; i < sc->stts_count; i++)
+        if (sc->stts_data[i].duration < 0)
+            return 0;
+
+    if (sc->stsz_sample_size > 0 && sc->stsz_sample_size < sc->sample_size)
+        return 0;
+
+    if (sc->sample_size > 0 && sc->sample_size < sc->stsz_sample_size) {
+        for (i = 0; i < sc->chunk_count; i++) {
+            int64_t next_offset = i+1 < sc->chunk_count ? sc->chunk_offsets[i+1] : INT64_MAX;
+            while (stsc_index + 1 < sc->stsc_count &&
+                   i + 1 == sc->stsc_data[stsc_index + 1].first)
+                stsc_index++;
+            if (next_offset > sc->chunk_offsets[i] &&
+                sc->stsc_data[stsc_index].count * (int64_t)sc->stsz_sample_size > next_offset - sc->chunk_offsets[i])
+                return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * Set the stream up to compute its index entries on demand instead of
+ * building AVStream.index_entries. The sample tables are scanned once to
+ * count the entries, without storing them. The tables must be stable, see
+ * mov_index_tables_are_stable().
+ */
+static int mov_init_lazy_index(MOVContext *mov, AVStream *st,
+                               const MOVIndexCursor *start)
+{
+    MOVStreamContext *sc = st->priv_data;
+    MOVLazyIndex *lazy;
+    MOVIndexCursor c = *start;
+    AVIndexEntry e;
+    int ret;
+
+    lazy = av_mallocz(sizeof(*lazy));
+    if (!lazy)
+        return AVERROR(ENOMEM);
+
+    while ((ret = mov_index_cursor_next(mov, st, &c, &e)) > 0) {
+        if (st->codecpar->codec_type == AVMEDIA_TYPE_VIDEO && c.nb_entries < 100)
+            ff_rfps_add_frame(mov->fc, st, e.timestamp);
+    }
+    if (ret >= 0 && st->duration > 0)
+        st->codecpar->bit_rate = c.stream_size*8*sc->time_scale/st->duration;
+
+    lazy->start      = *start;
+    lazy->cursor     = *start;
+    lazy->nb_entries = c.nb_entries;
+    sc->lazy_index   = lazy;
+
+    return 0;
+}
+
+static void mov_free_sample_tables(MOVStreamContext *sc)
+{
+    av_freep(&sc->chunk_offsets);
+    av_freep(&sc->stsc_data);
+    av_freep(&sc->sample_sizes);
+    av_freep(&sc->keyframes);
+    av_freep(&sc->stts_data);
+    av_freep(&sc->stps_data);
+    av_freep(&sc->elst_data);
+    av_freep(&sc->rap_group);
+}
+
+/**
+ * Build AVStream.index_entries of a stream set up with a lazy index, for
+ * code which needs random access to the whole index.
+ */
+static void mov_materialize_index(MOVContext *mov, AVStream *st)
+{
+    MOVStreamContext *sc = st->priv_data;
+    MOVIndexCursor c;
+
+    if (!sc->lazy_index)
+        return;
+
+    c = sc->lazy_index->start;
+    av_freep(&sc->lazy_index);
+    mov_fill_index(mov, st, &c, 0);
+    mov_free_sample_tables(sc);
+}
+
+static void mov_materialize_all_indexes(MOVContext *mov)
+{
+    int i;
+
+    for (i = 0; i < mov->fc->nb_streams; i++)
+        mov_materialize_index(mov, mov->fc->streams[i]);
+}
+
+/**
+ * Get an index entry of a stream, computing it from the sample tables if
+ * the stream has a lazy index.
+ *
+ * @return the entry or NULL if there is no such entry; the returned entry
+ *         of a lazy index stays valid until entries more than
+ *         MOV_LAZY_INDEX_WINDOW samples apart are requested
+ */
+static AVIndexEntry *mov_get_index_entry(MOVContext *mov, AVStream *st, int sample)
+{
+    MOVStreamContext *sc = st->priv_data;
+    MOVLazyIndex *lazy   = sc->lazy_index;
+
+    if (!lazy)
+        return sample >= 0 && sample < st->nb_index_entries ? &st->index_entries[sample] : NULL;
+
+    if (sample < 0 || sample >= lazy->nb_entries)
+        return NULL;
+
+    if ((unsigned)sample + MOV_LAZY_INDEX_WINDOW < lazy->cursor.nb_entries)
+        lazy->cursor = lazy->start;
+    while (lazy->cursor.nb_entries <= sample) {
+        AVIndexEntry *e = &lazy->entries[lazy->cursor.nb_entries % MOV_LAZY_INDEX_WINDOW];
+        if (mov_index_cursor_next(mov, st, &lazy->cursor, e) <= 0)
+            return NULL;
+    }
+
+    return &lazy->entries[sample % MOV_LAZY_INDEX_WINDOW];
+}
+
 static void mov_build_index(MOVContext *mov, AVStream *st)
 {
     MOVStreamContext *sc = st->priv_data;
     int64_t current_offset;
     int64_t current_dts = 0;
-    unsigned int stts_index = 0;
     unsigned int stsc_index = 0;
-    unsigned int stss_index = 0;
-    unsigned int stps_index = 0;
-    unsigned int i, j;
-    uint64_t stream_size = 0;
+    unsigned int i;
 
     if (sc->elst_count) {
         int i, edit_start_index = 0, unsupported = 0;
@@ -2722,130 +3060,18 @@ static void mov_build_index(MOVContext *mov, AVStream *st)
     /* only use old uncompressed audio chunk demuxing when stts specifies it */
     if (!(st->codecpar->codec_type == AVMEDIA_TYPE_AUDIO &&
           sc->stts_count == 1 && sc->stts_data[0].duration == 1)) {
-        unsigned int current_sample = 0;
-        unsigned int stts_sample = 0;
-        unsigned int sample_size;
-        unsigned int distance = 0;
-        unsigned int rap_group_index = 0;
-        unsigned int rap_group_sample = 0;
-        int64_t last_dts = 0;
-        int64_t dts_correction = 0;
-        int rap_group_present = sc->rap_group_count && sc->rap_group;
-        int key_off = (sc->keyframe_count && sc->keyframes[0] > 0) || (sc->stps_count && sc->stps_data[0] > 0);
-
-        current_dts -= sc->dts_shift;
-        last_dts     = current_dts;
-
-        if (!sc->sample_count || st->nb_index_entries)
+        MOVIndexCursor cursor;
+
+        if (!sc->sample_count || st->nb_index_entries || sc->lazy_index)
             return;
         if (sc->sample_count >= UINT_MAX / sizeof(*st->index_entries) - st->nb_index_entries)
             return;
-        if (av_reallocp_array(&st->index_entries,
-                              st->nb_index_entries + sc->sample_count,
-                              sizeof(*st->index_entries)) < 0) {
-            st->nb_index_entries = 0;
-            return;
-        }
-        st->index_entries_allocated_size = (st->nb_index_entries + sc->sample_count) * sizeof(*st->index_entries);
-
-        for (i = 0; i < sc->chunk_count; i++) {
-            int64_t next_offset = i+1 < sc->chunk_count ? sc->chunk_offsets[i+1] : INT64_MAX;
-            current_offset = sc->chunk_offsets[i];
-            while (stsc_index + 1 < sc->stsc_count &&
-                i + 1 == sc->stsc_data[stsc_index + 1].first)
-                stsc_index++;
 
-            if (next_offset > current_offset && sc->sample_size>0 && sc->sample_size < sc->stsz_sample_size &&
-                sc->stsc_data[stsc_index].count * (int64_t)sc->stsz_sample_size > next_offset - current_offset) {
-                av_log(mov->fc, AV_LOG_WARNING, "STSZ sample size %d invalid (too large), ignoring\n", sc->stsz_sample_size);
-                sc->stsz_sample_size = sc->sample_size;
-            }
-            if (sc->stsz_sample_size>0 && sc->stsz_sample_size < sc->sample_size) {
-                av_log(mov->fc, AV_LOG_WARNING, "STSZ sample size %d invalid (too small), ignoring\n", sc->stsz_sample_size);
-                sc->stsz_sample_size = sc->sample_size;
-            }
-
-            for (j = 0; j < sc->stsc_data[stsc_index].count; j++) {
-                int keyframe = 0;
-                if (current_sample >= sc->sample_count) {
-                    av_log(mov->fc, AV_LOG_ERROR, "wrong sample count\n");
-                    return;
-                }
-
-                if (!sc->keyframe_absent && (!sc->keyframe_count || current_sample+key_off == sc->keyframes[stss_index])) {
-                    keyframe = 1;
-                    if (stss_index + 1 < sc->keyframe_count)
-                        stss_index++;
-                } else if (sc->stps_count && current_sample+key_off == sc->stps_data[stps_index]) {
-                    keyframe = 1;
-                    if (stps_index + 1 < sc->stps_count)
-                        stps_index++;
-                }
-                if (rap_group_present && rap_group_index < sc->rap_group_count) {
-                    if (sc->rap_group[rap_group_index].index > 0)
-                        keyframe = 1;
-                    if (++rap_group_sample == sc->rap_group[rap_group_index].count) {
-                        rap_group_sample = 0;
-                        rap_group_index++;
-                    }
-                }
-                if (sc->keyframe_absent
-                    && !sc->stps_count
-                    && !rap_group_present
-                    && (st->codecpar->codec_type == AVMEDIA_TYPE_AUDIO || (i==0 && j==0)))
-                     keyframe = 1;
-                if (keyframe)
-                    distance = 0;
-                sample_size = sc->stsz_sample_size > 0 ? sc->stsz_sample_size : sc->sample_sizes[current_sample];
-                if (sc->pseudo_stream_id == -1 ||
-                   sc->stsc_data[stsc_index].id - 1 == sc->pseudo_stream_id) {
-                    AVIndexEntry *e = &st->index_entries[st->nb_index_entries++];
-                    e->pos = current_offset;
-                    e->timestamp = current_dts;
-                    e->size = sample_size;
-                    e->min_distance = distance;
-                    e->flags = keyframe ? AVINDEX_KEYFRAME : 0;
-                    av_log(mov->fc, AV_LOG_TRACE, "AVIndex stream %d, sample %d, offset %"PRIx64", dts %"PRId64", "
-                            "size %d, distance %d, keyframe %d\n", st->index, current_sample,
-                            current_offset, current_dts, sample_size, distance, keyframe);
-                    if (st->codecpar->codec_type == AVMEDIA_TYPE_VIDEO && st->nb_index_entries < 100)
-                        ff_rfps_add_frame(mov->fc, st, current_dts);
-                }
-
-                current_offset += sample_size;
-                stream_size += sample_size;
-
-                /* A negative sample duration is invalid based on the spec,
-                 * but some samples need it to correct the DTS. */
-                if (sc->stts_data[stts_index].duration < 0) {
-                    av_log(mov->fc, AV_LOG_WARNING,
-                           "Invalid SampleDelta %d in STTS, at %d st:%d\n",
-                           sc->stts_data[stts_index].duration, stts_index,
-                           st->index);
-                    dts_correction += sc->stts_data[stts_index].duration - 1;
-                    sc->stts_data[stts_index].duration = 1;
-                }
-                current_dts += sc->stts_data[stts_index].duration;
-                if (!dts_correction || current_dts + dts_correction > last_dts) {
-                    current_dts += dts_correction;
-                    dts_correction = 0;
-                } else {
-                    /* Avoid creating non-monotonous DTS */
-                    dts_correction += current_dts - last_dts - 1;
-                    current_dts = last_dts + 1;
-                }
-                last_dts = current_dts;
-                distance++;
-                stts_sample++;
-                current_sample++;
-                if (stts_index + 1 < sc->stts_count && stts_sample == sc->stts_data[stts_index].count) {
-                    stts_sample = 0;
-                    stts_index++;
-                }
-            }
-        }
-        if (st->duration > 0)
-            st->codecpar->bit_rate = stream_size*8*sc->time_scale/st->duration;
+        mov_index_cursor_init(sc, current_dts, &cursor);
+        if (mov->lazy_index && mov_index_tables_are_stable(sc) &&
+            mov_init_lazy_index(mov, st, &cursor) >= 0)
+            return;
+        mov_fill_index(mov, st, &cursor, 1);
     } else {
         unsigned chunk_samples, total = 0;
 
@@ -3157,15 +3383,11 @@ static int mov_read_trak(MOVContext *c, AVIOContext *pb, MOVAtom atom)
         && sc->time_scale == st->codecpar->sample_rate) {
             st->need_parsing = AVSTREAM_PARSE_FULL;
     }
-    /* Do not need those anymore. */
-    av_freep(&sc->chunk_offsets);
-    av_freep(&sc->stsc_data);
-    av_freep(&sc->sample_sizes);
-    av_freep(&sc->keyframes);
-    av_freep(&sc->stts_data);
-    av_freep(&sc->stps_data);
-    av_freep(&sc->elst_data);
-    av_freep(&sc->rap_group);
+    /* Do not need those anymore, unless the index is built later. */
+    if (sc->lazy_index)
+        av_freep(&sc->elst_data);
+    else
+        mov_free_sample_tables(sc);
 
     return 0;
 }
@@ -3569,6 +3791,8 @@ static int mov_read_trun(MOVContext *c, AVIOContext *pb, MOVAtom atom)
     sc = st->priv_data;
     if (sc->pseudo_stream_id+1 != frag->stsd_id && sc->pseudo_stream_id != -1)
         return 0;
+    /* fragments add index entries and may reposition samples */
+    mov_materialize_all_indexes(c);
     avio_r8(pb); /* version */
     flags = avio_rb24(pb);
     entries = avio_rb32(pb);
@@ -4565,6 +4789,7 @@ static void mov_read_chapters(AVFormatContext *s)
     st->discard = AVDISCARD_ALL;
     sc = st->priv_data;
     cur_pos = avio_tell(sc->pb);
+    mov_materialize_index(mov, st);
 
     for (i = 0; i < st->nb_index_entries; i++) {
         AVIndexEntry *sample = &st->index_entries[i];
@@ -4639,6 +4864,7 @@ static int mov_read_timecode_track(AVFormatContext *s, AVStream *st)
     int64_t cur_pos = avio_tell(sc->pb);
     uint32_t value;
 
+    mov_materialize_index(s->priv_data, st);
     if (!st->nb_index_entries)
         return -1;
 
@@ -4694,6 +4920,7 @@ static int mov_read_close(AVFormatContext *s)
         av_freep(&sc->elst_data);
         av_freep(&sc->rap_group);
         av_freep(&sc->display_matrix);
+        av_freep(&sc->lazy_index);
 
         av_freep(&sc->cenc.auxiliary_info);
         av_freep(&sc->cenc.auxiliary_info_sizes);
@@ -5032,14 +5259,15 @@ static int mov_read_header(AVFormatContext *s)
 
 static AVIndexEntry *mov_find_next_sample(AVFormatContext *s, AVStream **st)
 {
+    MOVContext *mov = s->priv_data;
     AVIndexEntry *sample = NULL;
     int64_t best_dts = INT64_MAX;
     int i;
     for (i = 0; i < s->nb_streams; i++) {
         AVStream *avst = s->streams[i];
         MOVStreamContext *msc = avst->priv_data;
-        if (msc->pb && msc->current_sample < avst->nb_index_entries) {
-            AVIndexEntry *current_sample = &avst->index_entries[msc->current_sample];
+        AVIndexEntry *current_sample;
+        if (msc->pb && (current_sample = mov_get_index_entry(mov, avst, msc->current_sample))) {
             int64_t dts = av_rescale(current_sample->timestamp, AV_TIME_BASE, msc->time_scale);
             av_log(s, AV_LOG_TRACE, "stream %d, sample %d, dts %"PRId64"\n", i, msc->current_sample, dts);
             if (!sample || (!s->pb->seekable && current_sample->pos < sample->pos) ||
@@ -5117,6 +5345,9 @@ static int mov_read_packet(AVFormatContext *s, AVPacket *pkt)
     AVStream *st = NULL;
     int ret;
     mov->fc = s;
+    /* samples may be repositioned at fragment boundaries */
+    if (mov->next_root_atom)
+        mov_materialize_all_indexes(mov);
  retry:
     sample = mov_find_next_sample(s, &st);
     if (!sample || (mov->next_root_atom && sample->pos > mov->next_root_atom)) {
@@ -5185,8 +5416,8 @@ static int mov_read_packet(AVFormatContext *s, AVPacket *pkt)
         if (sc->wrong_dts)
             pkt->dts = AV_NOPTS_VALUE;
     } else {
-        int64_t next_dts = (sc->current_sample < st->nb_index_entries) ?
-            st->index_entries[sc->current_sample].timestamp : st->duration;
+        AVIndexEntry *next = mov_get_index_entry(mov, st, sc->current_sample);
+        int64_t next_dts = next ? next->timestamp : st->duration;
         pkt->duration = next_dts - pkt->dts;
         pkt->pts = pkt->dts;
     }
@@ -5283,6 +5514,8 @@ static int mov_read_seek(AVFormatContext *s, int stream_index, int64_t sample_ti
     if (stream_index >= s->nb_streams)
         return AVERROR_INVALIDDATA;
 
+    mov_materialize_all_indexes(mc);
+
     st = s->streams[stream_index];
     sample = mov_seek_stream(s, st, sample_time, flags);
     if (sample < 0)
@@ -5364,6 +5597,8 @@ static const AVOption mov_options[] = {
     { "decryption_key", "The media decryption key (hex)", OFFSET(decryption_key), AV_OPT_TYPE_BINARY, .flags = AV_OPT_FLAG_DECODING_PARAM },
     { "enable_drefs", "Enable external track support.", OFFSET(enable_drefs), AV_OPT_TYPE_BOOL,
         {.i64 = 0}, 0, 1, FLAGS },
+    { "lazy_index", "Compute the index from the sample tables on demand, build it only when seeking",
+        OFFSET(lazy_index), AV_OPT_TYPE_BOOL, {.i64 = 0}, 0, 1, FLAGS },
 
     { NULL },
 };
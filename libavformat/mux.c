@@ -231,6 +231,16 @@ static int validate_codec_tag(AVFormatContext *s, AVStream *st)
     return 1;
 }
 
+/**
+ * Return 1 if the stream holds back the max_interleave_delta check of the
+ * dts-based interleaver while it has no packets queued.
+ */
+static int is_interleave_delta_stream(const AVStream *st)
+{
+    return st->codecpar->codec_type != AVMEDIA_TYPE_ATTACHMENT &&
+           st->codecpar->codec_id   != AV_CODEC_ID_VP8 &&
+           st->codecpar->codec_id   != AV_CODEC_ID_VP9;
+}
 
 static int init_muxer(AVFormatContext *s, AVDictionary **options)
 {
@@ -385,6 +395,8 @@ FF_ENABLE_DEPRECATION_WARNINGS
 
         if (par->codec_type != AVMEDIA_TYPE_ATTACHMENT)
             s->internal->nb_interleaved_streams++;
+        if (is_interleave_delta_stream(st))
+            s->internal->nb_interleave_delta_streams++;
     }
 
     if (!s->priv_data && of->priv_data_size > 0) {
@@ -833,31 +845,42 @@ int av_write_frame(AVFormatContext *s, AVPacket *pkt)
 
 #define CHUNK_START 0x1000
 
-int ff_interleave_add_packet(AVFormatContext *s, AVPacket *pkt,
-                             int (*compare)(AVFormatContext *, AVPacket *, AVPacket *))
+static int alloc_packet_list_entry(AVPacketList **ppktl, AVPacket *pkt)
 {
+    AVPacketList *pktl = av_mallocz(sizeof(AVPacketList));
     int ret;
-    AVPacketList **next_point, *this_pktl;
-    AVStream *st   = s->streams[pkt->stream_index];
-    int chunked    = s->max_chunk_size || s->max_chunk_duration;
 
-    this_pktl      = av_mallocz(sizeof(AVPacketList));
-    if (!this_pktl)
+    if (!pktl)
         return AVERROR(ENOMEM);
     if ((pkt->flags & AV_PKT_FLAG_UNCODED_FRAME)) {
         av_assert0(pkt->size == UNCODED_FRAME_PACKET_SIZE);
         av_assert0(((AVFrame *)pkt->data)->buf);
-        this_pktl->pkt = *pkt;
+        pktl->pkt = *pkt;
         pkt->buf = NULL;
         pkt->side_data = NULL;
         pkt->side_data_elems = 0;
     } else {
-        if ((ret = av_packet_ref(&this_pktl->pkt, pkt)) < 0) {
-            av_free(this_pktl);
+        if ((ret = av_packet_ref(&pktl->pkt, pkt)) < 0) {
+            av_free(pktl);
             return ret;
         }
     }
 
+    *ppktl = pktl;
+    return 0;
+}
+
+int ff_interleave_add_packet(AVFormatContext *s, AVPacket *pkt,
+                             int (*compare)(AVFormatContext *, AVPacket *, AVPacket *))
+{
+    int ret;
+    AVPacketList **next_point, *this_pktl;
+    AVStream *st   = s->streams[pkt->stream_index];
+    int chunked    = s->max_chunk_size || s->max_chunk_duration;
+
+    if ((ret = alloc_packet_list_entry(&this_pktl, pkt)) < 0)
+        return ret;
+
     if (s->streams[pkt->stream_index]->last_in_packet_buffer) {
         next_point = &(st->last_in_packet_buffer->next);
     } else {
@@ -950,9 +973,7 @@ int ff_interleave_packet_per_dts(AVFormatContext *s, AVPacket *out,
     for (i = 0; i < s->nb_streams; i++) {
         if (s->streams[i]->last_in_packet_buffer) {
             ++stream_count;
-        } else if (s->streams[i]->codecpar->codec_type != AVMEDIA_TYPE_ATTACHMENT &&
-                   s->streams[i]->codecpar->codec_id != AV_CODEC_ID_VP8 &&
-                   s->streams[i]->codecpar->codec_id != AV_CODEC_ID_VP9) {
+        } else if (is_interleave_delta_stream(s->streams[i])) {
             ++noninterleaved_count;
         }
     }
@@ -1014,6 +1035,188 @@ int ff_interleave_packet_per_dts(AVFormatContext *s, AVPacket *out,
     }
 }
 
+/**
+ * Return 1 if the first packet queued for stream a must be output before
+ * the first packet queued for stream b, using the same ordering as
+ * interleave_compare_dts().
+ */
+static int interleave_heap_less(AVFormatContext *s, int a, int b)
+{
+    return interleave_compare_dts(s, &s->streams[b]->internal->interleave_queue->pkt,
+                                     &s->streams[a]->internal->interleave_queue->pkt);
+}
+
+static void interleave_heap_push(AVFormatContext *s, int stream_index)
+{
+    int *heap = s->internal->interleave_heap;
+    int i     = s->internal->nb_interleave_heap++;
+
+    while (i > 0) {
+        int parent = (i - 1) >> 1;
+        if (!interleave_heap_less(s, stream_index, heap[parent]))
+            break;
+        heap[i] = heap[parent];
+        i       = parent;
+    }
+    heap[i] = stream_index;
+}
+
+/**
+ * Move the stream at the top of the heap down to its place, after its
+ * first queued packet changed.
+ */
+static void interleave_heap_sift_down(AVFormatContext *s)
+{
+    int *heap = s->internal->interleave_heap;
+    int nb    = s->internal->nb_interleave_heap;
+    int top   = heap[0];
+    int i     = 0;
+
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= nb)
+            break;
+        if (child + 1 < nb && interleave_heap_less(s, heap[child + 1], heap[child]))
+            child++;
+        if (!interleave_heap_less(s, heap[child], top))
+            break;
+        heap[i] = heap[child];
+        i       = child;
+    }
+    heap[i] = top;
+}
+
+static void interleave_update_max_dts(AVFormatContext *s)
+{
+    AVFormatInternal *internal = s->internal;
+    int i;
+
+    internal->interleave_max_dts = INT64_MIN;
+    for (i = 0; i < internal->nb_interleave_heap; i++) {
+        AVStream *st = s->streams[internal->interleave_heap[i]];
+        int64_t dts  = av_rescale_q(st->last_in_packet_buffer->pkt.dts,
+                                    st->time_base, AV_TIME_BASE_Q);
+        internal->interleave_max_dts = FFMAX(internal->interleave_max_dts, dts);
+    }
+}
+
+static int interleave_queue_packet(AVFormatContext *s, AVPacket *pkt)
+{
+    AVFormatInternal *internal = s->internal;
+    AVStream *st = s->streams[pkt->stream_index];
+    AVPacketList *pktl;
+    int64_t dts;
+    int ret;
+
+    if (internal->interleave_heap_size < s->nb_streams) {
+        if ((ret = av_reallocp_array(&internal->interleave_heap, s->nb_streams,
+                                     sizeof(*internal->interleave_heap))) < 0) {
+            internal->nb_interleave_heap  = 0;
+            internal->interleave_heap_size = 0;
+            return ret;
+        }
+        internal->interleave_heap_size = s->nb_streams;
+    }
+
+    if ((ret = alloc_packet_list_entry(&pktl, pkt)) < 0)
+        return ret;
+
+    dts = av_rescale_q(pkt->dts, st->time_base, AV_TIME_BASE_Q);
+    if (!internal->nb_interleave_heap || dts > internal->interleave_max_dts)
+        internal->interleave_max_dts = dts;
+
+    if (st->last_in_packet_buffer) {
+        st->last_in_packet_buffer->next = pktl;
+    } else {
+        st->internal->interleave_queue = pktl;
+        interleave_heap_push(s, pkt->stream_index);
+        if (is_interleave_delta_stream(st))
+            internal->nb_queued_interleave_delta_streams++;
+    }
+    st->last_in_packet_buffer = pktl;
+
+    av_packet_unref(pkt);
+
+    return 0;
+}
+
+/**
+ * Same as ff_interleave_packet_per_dts(), but instead of a single sorted
+ * list the packets are kept in one queue per stream, and the streams in a
+ * min-heap ordered by their first packet. This keeps the cost per packet
+ * logarithmic in the number of streams.
+ */
+static int interleave_packet_per_dts(AVFormatContext *s, AVPacket *out,
+                                     AVPacket *pkt, int flush)
+{
+    AVFormatInternal *internal = s->internal;
+    int stream_count, noninterleaved_count, ret;
+
+    if (pkt) {
+        if ((ret = interleave_queue_packet(s, pkt)) < 0)
+            return ret;
+    }
+
+    stream_count         = internal->nb_interleave_heap;
+    noninterleaved_count = internal->nb_interleave_delta_streams -
+                           internal->nb_queued_interleave_delta_streams;
+
+    if (internal->nb_interleaved_streams == stream_count)
+        flush = 1;
+
+    if (s->max_interleave_delta > 0 &&
+        stream_count &&
+        !flush &&
+        internal->nb_interleaved_streams == stream_count+noninterleaved_count
+    ) {
+        AVStream *top_st  = s->streams[internal->interleave_heap[0]];
+        int64_t top_dts   = av_rescale_q(top_st->internal->interleave_queue->pkt.dts,
+                                         top_st->time_base, AV_TIME_BASE_Q);
+        int64_t delta_dts = internal->interleave_max_dts - top_dts;
+
+        if (delta_dts > s->max_interleave_delta) {
+            av_log(s, AV_LOG_DEBUG,
+                   "Delay between the first packet and last packet in the "
+                   "muxing queue is %"PRId64" > %"PRId64": forcing output\n",
+                   delta_dts, s->max_interleave_delta);
+            flush = 1;
+        }
+    }
+
+    if (stream_count && flush) {
+        AVStream *st       = s->streams[internal->interleave_heap[0]];
+        AVPacketList *pktl = st->internal->interleave_queue;
+
+        *out = pktl->pkt;
+
+        st->internal->interleave_queue = pktl->next;
+        if (!st->internal->interleave_queue) {
+            /* Without audio_preload the stream order matches the dts
+             * order, so the packet leaving the queue cannot hold the
+             * largest dts unless another stream holds it as well. */
+            int update_max_dts = s->audio_preload &&
+                                 av_rescale_q(out->dts, st->time_base, AV_TIME_BASE_Q) >=
+                                 internal->interleave_max_dts;
+
+            st->last_in_packet_buffer = NULL;
+            if (is_interleave_delta_stream(st))
+                internal->nb_queued_interleave_delta_streams--;
+            internal->interleave_heap[0] =
+                internal->interleave_heap[--internal->nb_interleave_heap];
+            if (update_max_dts)
+                interleave_update_max_dts(s);
+        }
+        if (internal->nb_interleave_heap)
+            interleave_heap_sift_down(s);
+        av_freep(&pktl);
+
+        return 1;
+    } else {
+        av_init_packet(out);
+        return 0;
+    }
+}
+
 /**
  * Interleave an AVPacket correctly so it can be muxed.
  * @param out the interleaved packet will be output here
@@ -1030,8 +1233,10 @@ static int interleave_packet(AVFormatContext *s, AVPacket *out, AVPacket *in, in
         if (in)
             av_packet_unref(in);
         return ret;
-    } else
+    } else if (s->max_chunk_size || s->max_chunk_duration)
         return ff_interleave_packet_per_dts(s, out, in, flush);
+    else
+        return interleave_packet_per_dts(s, out, in, flush);
 }
 
 int av_interleaved_write_frame(AVFormatContext *s, AVPacket *pkt)
@@ -3938,6 +3938,8 @@ static void free_stream(AVStream **pst)
 
     if (st->internal) {
         avcodec_free_context(&st->internal->avctx);
+        free_packet_buffer(&st->internal->interleave_queue,
+                           &st->last_in_packet_buffer);
     }
     av_freep(&st->internal);
 
@@ -4001,6 +4003,8 @@ void avformat_free_context(AVFormatContext *s)
     av_freep(&s->chapters);
     av_dict_free(&s->metadata);
     av_freep(&s->streams);
+    if (s->internal)
+        av_freep(&s->internal->interleave_heap);
     av_freep(&s->internal);
     flush_packet_queue(s);
     av_free(s);
@@ -206,7 +206,7 @@ int av_buffer_realloc(AVBufferRef **buf, int size);
  * @ingroup lavu_data
  *
  * @{
- * AVBufferPool is an API for a lock-free thread-safe pool of AVBuffers.
+ * AVBufferPool is an API for a thread-safe pool of AVBuffers.
  *
  * Frequently allocating and freeing large buffers may be slow. AVBufferPool is
  * meant to solve this in cases when the caller needs a set of buffers of the
@@ -283,6 +283,18 @@ void av_buffer_pool_uninit(AVBufferPool **pool);
  */
 AVBufferRef *av_buffer_pool_get(AVBufferPool *pool);
 
+/**
+ * Get usage statistics of a buffer pool, e.g. to check whether it is sized
+ * appropriately. This function may be called simultaneously from multiple
+ * threads.
+ *
+ * @param hits   if not NULL, set to the number of av_buffer_pool_get() calls
+ *               which reused a buffer from the pool
+ * @param misses if not NULL, set to the number of av_buffer_pool_get() calls
+ *               which had to allocate a new buffer
+ */
+void av_buffer_pool_get_stats(AVBufferPool *pool, int64_t *hits, int64_t *misses);
+
 /**
  * @}
  */
@@ -32,6 +32,11 @@
  * The buffer was av_realloc()ed, so it is reallocatable.
  */
 #define BUFFER_FLAG_REALLOCATABLE (1 << 1)
+/**
+ * The AVBuffer structure is part of a larger structure
+ * and should not be freed.
+ */
+#define BUFFER_FLAG_NO_FREE       (1 << 2)
 
 struct AVBuffer {
     uint8_t *data; /**< data described by this buffer */
@@ -70,6 +75,12 @@ typedef struct BufferPoolEntry {
 
     AVBufferPool *pool;
     struct BufferPoolEntry *next;
+
+    /*
+     * An AVBuffer structure to (re)use as AVBuffer for subsequent uses
+     * of this BufferPoolEntry.
+     */
+    AVBuffer buffer;
 } BufferPoolEntry;
 
 struct AVBufferPool {
@@ -87,7 +98,12 @@ struct AVBufferPool {
      */
     volatile int refcount;
 
-    volatile int nb_allocated;
+    /*
+     * Number of av_buffer_pool_get() calls served from the pool and
+     * requiring a new allocation, protected by mutex.
+     */
+    int64_t nb_hits;
+    int64_t nb_misses;
 
     int size;
     void *opaque;
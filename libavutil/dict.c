@@ -26,9 +26,25 @@
 #include "mem.h"
 #include "bprint.h"
 
+/**
+ * Number of entries from which exact key lookups use a hash index instead
+ * of scanning all entries.
+ */
+#define DICT_HASH_MIN_ENTRIES 16
+
 struct AVDictionary {
     int count;
     AVDictionaryEntry *elems;
+    int elems_size;     ///< number of allocated elems
+
+    /**
+     * Hash index of the keys, built once the dictionary has
+     * DICT_HASH_MIN_ENTRIES entries. Keys are hashed case-insensitively,
+     * each bucket is a chain of indices into elems, -1 terminated.
+     */
+    int *hash_buckets;  ///< first entry of each bucket
+    int *hash_next;     ///< next entry in the same bucket, elems_size entries
+    unsigned hash_mask; ///< number of buckets - 1
 };
 
 int av_dict_count(const AVDictionary *m)
@@ -36,10 +52,83 @@ int av_dict_count(const AVDictionary *m)
     return m ? m->count : 0;
 }
 
+static unsigned dict_hash(const char *key)
+{
+    unsigned h = 0;
+
+    while (*key)
+        h = h * 31 + av_toupper(*key++);
+    return h;
+}
+
+static void dict_hash_link(AVDictionary *m, int i)
+{
+    int *bucket = &m->hash_buckets[dict_hash(m->elems[i].key) & m->hash_mask];
+
+    m->hash_next[i] = *bucket;
+    *bucket = i;
+}
+
+static void dict_hash_unlink(AVDictionary *m, int i)
+{
+    int *p = &m->hash_buckets[dict_hash(m->elems[i].key) & m->hash_mask];
+
+    while (*p != i)
+        p = &m->hash_next[*p];
+    *p = m->hash_next[i];
+}
+
+static void dict_hash_free(AVDictionary *m)
+{
+    av_freep(&m->hash_buckets);
+    av_freep(&m->hash_next);
+    m->hash_mask = 0;
+}
+
+/**
+ * (Re)build the hash index with one bucket per allocated entry.
+ * On allocation failure the index is dropped, lookups then fall back
+ * to scanning the entries.
+ */
+static void dict_hash_build(AVDictionary *m)
+{
+    int i;
+
+    dict_hash_free(m);
+    m->hash_buckets = av_malloc_array(m->elems_size, sizeof(*m->hash_buckets));
+    m->hash_next    = av_malloc_array(m->elems_size, sizeof(*m->hash_next));
+    if (!m->hash_buckets || !m->hash_next) {
+        dict_hash_free(m);
+        return;
+    }
+    m->hash_mask = m->elems_size - 1;
+    memset(m->hash_buckets, -1, m->elems_size * sizeof(*m->hash_buckets));
+
+    for (i = 0; i < m->count; i++)
+        dict_hash_link(m, i);
+}
+
+static int dict_key_cmp(const char *s, const char *key, int flags)
+{
+    unsigned int j;
+
+    if (flags & AV_DICT_MATCH_CASE)
+        for (j = 0; s[j] == key[j] && key[j]; j++)
+            ;
+    else
+        for (j = 0; av_toupper(s[j]) == av_toupper(key[j]) && key[j]; j++)
+            ;
+    if (key[j])
+        return 1;
+    if (s[j] && !(flags & AV_DICT_IGNORE_SUFFIX))
+        return 1;
+    return 0;
+}
+
 AVDictionaryEntry *av_dict_get(const AVDictionary *m, const char *key,
                                const AVDictionaryEntry *prev, int flags)
 {
-    unsigned int i, j;
+    unsigned int i;
 
     if (!m)
         return NULL;
@@ -49,20 +138,21 @@ AVDictionaryEntry *av_dict_get(const AVDictionary *m, const char *key,
     else
         i = 0;
 
-    for (; i < m->count; i++) {
-        const char *s = m->elems[i].key;
-        if (flags & AV_DICT_MATCH_CASE)
-            for (j = 0; s[j] == key[j] && key[j]; j++)
-                ;
-        else
-            for (j = 0; av_toupper(s[j]) == av_toupper(key[j]) && key[j]; j++)
-                ;
-        if (key[j])
-            continue;
-        if (s[j] && !(flags & AV_DICT_IGNORE_SUFFIX))
-            continue;
-        return &m->elems[i];
+    if (m->hash_buckets && !(flags & AV_DICT_IGNORE_SUFFIX)) {
+        /* the chains are not ordered, look for the first match after prev */
+        int best = -1;
+        int k    = m->hash_buckets[dict_hash(key) & m->hash_mask];
+
+        for (; k >= 0; k = m->hash_next[k])
+            if (k >= i && (best < 0 || k < best) &&
+                !dict_key_cmp(m->elems[k].key, key, flags))
+                best = k;
+        return best >= 0 ? &m->elems[best] : NULL;
     }
+
+    for (; i < m->count; i++)
+        if (!dict_key_cmp(m->elems[i].key, key, flags))
+            return &m->elems[i];
     return NULL;
 }
 
@@ -99,14 +189,28 @@ int av_dict_set(AVDictionary **pm, const char *key, const char *value,
             oldval = tag->value;
         else
             av_free(tag->value);
+        if (m->hash_buckets) {
+            dict_hash_unlink(m, tag - m->elems);
+            if (tag != &m->elems[m->count - 1])
+                dict_hash_unlink(m, m->count - 1);
+        }
         av_free(tag->key);
         *tag = m->elems[--m->count];
-    } else if (copy_value) {
-        AVDictionaryEntry *tmp = av_realloc(m->elems,
-                                            (m->count + 1) * sizeof(*m->elems));
+        if (m->hash_buckets && tag != &m->elems[m->count])
+            dict_hash_link(m, tag - m->elems);
+    } else if (copy_value && m->count == m->elems_size) {
+        int new_size = FFMAX(2 * m->elems_size, 4);
+        AVDictionaryEntry *tmp;
+
+        if (new_size > INT_MAX / sizeof(*m->elems))
+            goto err_out;
+        tmp = av_realloc(m->elems, new_size * sizeof(*m->elems));
         if (!tmp)
             goto err_out;
-        m->elems = tmp;
+        m->elems      = tmp;
+        m->elems_size = new_size;
+        if (m->hash_buckets)
+            dict_hash_build(m);
     }
     if (copy_value) {
         m->elems[m->count].key = copy_key;
@@ -122,11 +226,16 @@ int av_dict_set(AVDictionary **pm, const char *key, const char *value,
             m->elems[m->count].value = newval;
             av_freep(&copy_value);
         }
+        if (m->hash_buckets)
+            dict_hash_link(m, m->count);
         m->count++;
+        if (!m->hash_buckets && m->count == DICT_HASH_MIN_ENTRIES)
+            dict_hash_build(m);
     } else {
         av_freep(&copy_key);
     }
     if (!m->count) {
+        dict_hash_free(m);
         av_freep(&m->elems);
         av_freep(pm);
     }
@@ -135,6 +244,7 @@ int av_dict_set(AVDictionary **pm, const char *key, const char *value,
 
 err_out:
     if (m && !m->count) {
+        dict_hash_free(m);
         av_freep(&m->elems);
         av_freep(pm);
     }
@@ -208,6 +318,7 @@ void av_dict_free(AVDictionary **pm)
             av_freep(&m->elems[m->count].key);
             av_freep(&m->elems[m->count].value);
         }
+        dict_hash_free(m);
         av_freep(&m->elems);
     }
     av_freep(pm);
@@ -255,6 +366,8 @@ int av_dict_get_string(const AVDictionary *m, char **buffer,
 }
 
 #ifdef TEST
+#include "timer.h"
+
 static void print_dict(const AVDictionary *m)
 {
     AVDictionaryEntry *t = NULL;
@@ -281,11 +394,47 @@ static void test_separators(const AVDictionary *m, const char pair, const char v
     av_dict_free(&dict);
 }
 
-int main(void)
+static void bench_dict(int nb_entries)
+{
+    AVDictionary *dict = NULL;
+    char key[32];
+    int i, j;
+
+    for (i = 0; i < nb_entries; i++) {
+        snprintf(key, sizeof(key), "TAG_%d", i);
+        av_dict_set(&dict, key, "value", 0);
+    }
+    for (j = 0; j < 256; j++) {
+        START_TIMER;
+        for (i = 0; i < nb_entries; i++) {
+            snprintf(key, sizeof(key), "tag_%d", i);
+            av_dict_get(dict, key, NULL, 0);
+        }
+        STOP_TIMER("av_dict_get");
+    }
+    for (j = 0; j < 256; j++) {
+        START_TIMER;
+        for (i = 0; i < nb_entries; i++) {
+            snprintf(key, sizeof(key), "TAG_%d", i);
+            av_dict_set(&dict, key, "other value", 0);
+        }
+        STOP_TIMER("av_dict_set");
+    }
+    av_dict_free(&dict);
+}
+
+int main(int argc, char **argv)
 {
     AVDictionary *dict = NULL;
     AVDictionaryEntry *e;
     char *buffer = NULL;
+    char key[16], val[16];
+    int i;
+
+    if (argc > 1 && !strcmp(argv[1], "-t")) {
+        bench_dict(argc > 2 ? atoi(argv[2]) : 1000);
+        return 0;
+    }
 
     printf("Testing av_dict_get_string() and av_dict_parse_string()\n");
     av_dict_get_string(dict, &buffer, '=', ',');
@@ -364,6 +513,34 @@ int main(void)
     printf("%s\n", e->value);
     av_dict_free(&dict);
 
+    printf("\nTesting av_dict_get() and av_dict_set() with many entries\n");
+    for (i = 0; i < 100; i++) {
+        snprintf(key, sizeof(key), "key%d", i);
+        snprintf(val, sizeof(val), "%d", i);
+        av_dict_set(&dict, key, val, 0);
+    }
+    av_dict_set(&dict, "key10", "new", 0);
+    av_dict_set(&dict, "key20", NULL, 0);
+    av_dict_set(&dict, "key99", NULL, 0);
+    av_dict_set(&dict, "KEY30", "30b", AV_DICT_MULTIKEY);
+    av_dict_set(&dict, "key40", "b", AV_DICT_APPEND);
+    av_dict_set(&dict, "key50", "b", AV_DICT_DONT_OVERWRITE);
+    printf("%d\n", av_dict_count(dict));
+    print_dict(dict);
+    e = av_dict_get(dict, "KEY42", NULL, 0);
+    printf("%s\n", e ? e->value : "(null)");
+    e = av_dict_get(dict, "KEY42", NULL, AV_DICT_MATCH_CASE);
+    printf("%s\n", e ? e->value : "(null)");
+    e = av_dict_get(dict, "key20", NULL, 0);
+    printf("%s\n", e ? e->value : "(null)");
+    e = NULL;
+    while ((e = av_dict_get(dict, "key30", e, 0)))
+        printf("%s %s\n", e->key, e->value);
+    e = NULL;
+    while ((e = av_dict_get(dict, "key9", e, AV_DICT_IGNORE_SUFFIX)))
+        printf("%s %s\n", e->key, e->value);
+    av_dict_free(&dict);
+
     return 0;
 }
 #endif
@@ -360,6 +360,7 @@ av_cold int swri_rematrix_init(SwrContext *s){
     int nb_out = av_get_channel_layout_nb_channels(s->out_ch_layout);
 
     s->mix_any_f = NULL;
+    s->mix_add_f = NULL;
 
     if (!s->rematrix_custom) {
         int r = auto_matrix(s);
@@ -389,6 +390,7 @@ av_cold int swri_rematrix_init(SwrContext *s){
         *((float*)s->native_one) = 1.0;
         s->mix_1_1_f = (mix_1_1_func_type*)copy_float;
         s->mix_2_1_f = (mix_2_1_func_type*)sum2_float;
+        s->mix_add_f = (mix_1_1_func_type*)add_float;
         s->mix_any_f = (mix_any_func_type*)get_mix_any_func_float(s);
     }else if(s->midbuf.fmt == AV_SAMPLE_FMT_DBLP){
         s->native_matrix = av_calloc(nb_in * nb_out, sizeof(double));
@@ -401,6 +403,7 @@ av_cold int swri_rematrix_init(SwrContext *s){
         *((double*)s->native_one) = 1.0;
         s->mix_1_1_f = (mix_1_1_func_type*)copy_double;
         s->mix_2_1_f = (mix_2_1_func_type*)sum2_double;
+        s->mix_add_f = (mix_1_1_func_type*)add_double;
         s->mix_any_f = (mix_any_func_type*)get_mix_any_func_double(s);
     }else if(s->midbuf.fmt == AV_SAMPLE_FMT_S32P){
         // Only for dithering currently
@@ -441,83 +444,96 @@ av_cold void swri_rematrix_free(SwrContext *s){
     av_freep(&s->native_simd_one);
 }
 
+typedef struct RematrixThreadData {
+    AudioData *out, *in;
+    int len, len1, mustcopy;
+} RematrixThreadData;
+
+static int rematrix_channel(SwrContext *s, void *arg, int out_i, int nb_jobs)
+{
+    RematrixThreadData *td = arg;
+    AudioData *out = td->out, *in = td->in;
+    int len  = td->len;
+    int len1 = td->len1;
+    int off  = len1 * out->bps;
+    int in_i, i, j;
+
+    switch(s->matrix_ch[out_i][0]){
+    case 0:
+        if(td->mustcopy)
+            memset(out->ch[out_i], 0, len * av_get_bytes_per_sample(s->int_sample_fmt));
+        break;
+    case 1:
+        in_i= s->matrix_ch[out_i][1];
+        if(s->matrix[out_i][in_i]!=1.0){
+            if(s->mix_1_1_simd && len1)
+                s->mix_1_1_simd(out->ch[out_i]    , in->ch[in_i]    , s->native_simd_matrix, in->ch_count*out_i + in_i, len1);
+            if(len != len1)
+                s->mix_1_1_f   (out->ch[out_i]+off, in->ch[in_i]+off, s->native_matrix, in->ch_count*out_i + in_i, len-len1);
+        }else if(td->mustcopy){
+            memcpy(out->ch[out_i], in->ch[in_i], len*out->bps);
+        }else{
+            out->ch[out_i]= in->ch[in_i];
+        }
+        break;
+    case 2: {
+        int in_i1 = s->matrix_ch[out_i][1];
+        int in_i2 = s->matrix_ch[out_i][2];
+        if(s->mix_2_1_simd && len1)
+            s->mix_2_1_simd(out->ch[out_i]    , in->ch[in_i1]    , in->ch[in_i2]    , s->native_simd_matrix, in->ch_count*out_i + in_i1, in->ch_count*out_i + in_i2, len1);
+        else
+            s->mix_2_1_f   (out->ch[out_i]    , in->ch[in_i1]    , in->ch[in_i2]    , s->native_matrix, in->ch_count*out_i + in_i1, in->ch_count*out_i + in_i2, len1);
+        if(len != len1)
+            s->mix_2_1_f   (out->ch[out_i]+off, in->ch[in_i1]+off, in->ch[in_i2]+off, s->native_matrix, in->ch_count*out_i + in_i1, in->ch_count*out_i + in_i2, len-len1);
+        break;}
+    default:
+        if(s->mix_add_f){
+            /* scale the first input, then accumulate the others one by one;
+             * this sums in the same order as a per sample loop would */
+            for(j=0; j<s->matrix_ch[out_i][0]; j++){
+                mix_1_1_func_type *mix_f    = j ? s->mix_add_f    : s->mix_1_1_f;
+                mix_1_1_func_type *mix_simd = j ? s->mix_add_simd : s->mix_1_1_simd;
+                in_i= s->matrix_ch[out_i][1+j];
+                if(mix_simd && len1){
+                    mix_simd(out->ch[out_i]    , in->ch[in_i]    , s->native_simd_matrix, in->ch_count*out_i + in_i, len1);
+                    if(len != len1)
+                        mix_f(out->ch[out_i]+off, in->ch[in_i]+off, s->native_matrix, in->ch_count*out_i + in_i, len-len1);
+                }else{
+                    mix_f(out->ch[out_i], in->ch[in_i], s->native_matrix, in->ch_count*out_i + in_i, len);
+                }
+            }
+        }else{
+            /* s16 rounds the sum of all the inputs once, which the per input
+             * passes above cannot do without a 32 bit accumulator; this path
+             * stays scalar */
+            for(i=0; i<len; i++){
+                int v=0;
+                for(j=0; j<s->matrix_ch[out_i][0]; j++){
+                    in_i= s->matrix_ch[out_i][1+j];
+                    v+= ((int16_t*)in->ch[in_i])[i] * s->matrix32[out_i][in_i];
+                }
+                ((int16_t*)out->ch[out_i])[i]= (v + 16384)>>15;
+            }
+        }
+    }
+    return 0;
+}
+
 int swri_rematrix(SwrContext *s, AudioData *out, AudioData *in, int len, int mustcopy){
-    int out_i, in_i, i, j;
-    int len1 = 0;
-    int off = 0;
+    RematrixThreadData td = { out, in, len, 0, mustcopy };
 
     if(s->mix_any_f) {
         s->mix_any_f(out->ch, (const uint8_t **)in->ch, s->native_matrix, len);
         return 0;
     }
 
-    if(s->mix_2_1_simd || s->mix_1_1_simd){
-        len1= len&~15;
-        off = len1 * out->bps;
-    }
+    if(s->mix_2_1_simd || s->mix_1_1_simd)
+        td.len1 = len&~15;
 
     av_assert0(!s->out_ch_layout || out->ch_count == av_get_channel_layout_nb_channels(s->out_ch_layout));
     av_assert0(!s-> in_ch_layout || in ->ch_count == av_get_channel_layout_nb_channels(s-> in_ch_layout));
 
-    for(out_i=0; out_i<out->ch_count; out_i++){
-        switch(s->matrix_ch[out_i][0]){
-        case 0:
-            if(mustcopy)
-                memset(out->ch[out_i], 0, len * av_get_bytes_per_sample(s->int_sample_fmt));
-            break;
-        case 1:
-            in_i= s->matrix_ch[out_i][1];
-            if(s->matrix[out_i][in_i]!=1.0){
-                if(s->mix_1_1_simd && len1)
-                    s->mix_1_1_simd(out->ch[out_i]    , in->ch[in_i]    , s->native_simd_matrix, in->ch_count*out_i + in_i, len1);
-                if(len != len1)
-                    s->mix_1_1_f   (out->ch[out_i]+off, in->ch[in_i]+off, s->native_matrix, in->ch_count*out_i + in_i, len-len1);
-            }else if(mustcopy){
-                memcpy(out->ch[out_i], in->ch[in_i], len*out->bps);
-            }else{
-                out->ch[out_i]= in->ch[in_i];
-            }
-            break;
-        case 2: {
-            int in_i1 = s->matrix_ch[out_i][1];
-            int in_i2 = s->matrix_ch[out_i][2];
-            if(s->mix_2_1_simd && len1)
-                s->mix_2_1_simd(out->ch[out_i]    , in->ch[in_i1]    , in->ch[in_i2]    , s->native_simd_matrix, in->ch_count*out_i + in_i1, in->ch_count*out_i + in_i2, len1);
-            else
-                s->mix_2_1_f   (out->ch[out_i]    , in->ch[in_i1]    , in->ch[in_i2]    , s->native_matrix, in->ch_count*out_i + in_i1, in->ch_count*out_i + in_i2, len1);
-            if(len != len1)
-                s->mix_2_1_f   (out->ch[out_i]+off, in->ch[in_i1]+off, in->ch[in_i2]+off, s->native_matrix, in->ch_count*out_i + in_i1, in->ch_count*out_i + in_i2, len-len1);
-            break;}
-        default:
-            if(s->int_sample_fmt == AV_SAMPLE_FMT_FLTP){
-                for(i=0; i<len; i++){
-                    float v=0;
-                    for(j=0; j<s->matrix_ch[out_i][0]; j++){
-                        in_i= s->matrix_ch[out_i][1+j];
-                        v+= ((float*)in->ch[in_i])[i] * s->matrix[out_i][in_i];
-                    }
-                    ((float*)out->ch[out_i])[i]= v;
-                }
-            }else if(s->int_sample_fmt == AV_SAMPLE_FMT_DBLP){
-                for(i=0; i<len; i++){
-                    double v=0;
-                    for(j=0; j<s->matrix_ch[out_i][0]; j++){
-                        in_i= s->matrix_ch[out_i][1+j];
-                        v+= ((double*)in->ch[in_i])[i] * s->matrix[out_i][in_i];
-                    }
-                    ((double*)out->ch[out_i])[i]= v;
-                }
-            }else{
-                for(i=0; i<len; i++){
-                    int v=0;
-                    for(j=0; j<s->matrix_ch[out_i][0]; j++){
-                        in_i= s->matrix_ch[out_i][1+j];
-                        v+= ((int16_t*)in->ch[in_i])[i] * s->matrix32[out_i][in_i];
-                    }
-                    ((int16_t*)out->ch[out_i])[i]= (v + 16384)>>15;
-                }
-            }
-        }
-    }
+    swri_execute(s, rematrix_channel, &td, out->ch_count);
+
     return 0;
 }
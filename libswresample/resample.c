@@ -27,6 +27,7 @@
  */
 
 #include "libavutil/avassert.h"
+#include "libavutil/thread.h"
 #include "resample.h"
 
 static inline double eval_poly(const double *coeff, int size, double x) {
@@ -295,6 +296,138 @@ fail:
     return 0;
 }
 
+/* Filter banks only depend on the parameters below and are never written
+ * after being built, so contexts with identical parameters share them.
+ * The cache holds one reference to each bank; it is dropped once the last
+ * context using the bank is freed. All references to cached buffers are
+ * taken and released with filter_bank_mutex held. */
+typedef struct FilterBankEntry {
+    double factor;
+    int filter_length;
+    int phase_shift;
+    enum SwrFilterType filter_type;
+    double kaiser_beta;
+    enum AVSampleFormat format;
+    AVBufferRef *buf;
+    struct FilterBankEntry *next;
+} FilterBankEntry;
+
+static FilterBankEntry *filter_bank_cache;
+static AVMutex filter_bank_mutex;
+static AVOnce filter_bank_once = AV_ONCE_INIT;
+
+static void filter_bank_init_mutex(void)
+{
+    ff_mutex_init(&filter_bank_mutex, NULL);
+}
+
+static FilterBankEntry *filter_bank_find(const ResampleContext *c)
+{
+    FilterBankEntry *e;
+
+    for (e = filter_bank_cache; e; e = e->next)
+        if (e->factor == c->factor && e->filter_length == c->filter_length &&
+            e->phase_shift == c->phase_shift && e->filter_type == c->filter_type &&
+            e->kaiser_beta == c->kaiser_beta && e->format == c->format)
+            return e;
+    return NULL;
+}
+
+/* Get the filter bank matching the parameters set in c, building it if it
+ * is not cached yet. The build is done without the lock held, if another
+ * thread inserted the same bank meanwhile, that one is used instead. */
+static int filter_bank_get(ResampleContext *c)
+{
+    int phase_count = 1 << c->phase_shift;
+    FilterBankEntry *e;
+    AVBufferRef *buf;
+
+    ff_thread_once(&filter_bank_once, filter_bank_init_mutex);
+
+    ff_mutex_lock(&filter_bank_mutex);
+    e = filter_bank_find(c);
+    if (e)
+        c->filter_buf = av_buffer_ref(e->buf);
+    ff_mutex_unlock(&filter_bank_mutex);
+    if (e)
+        goto end;
+
+    buf = av_buffer_allocz(c->filter_alloc * (phase_count + 1) * c->felem_size);
+    if (!buf)
+        return AVERROR(ENOMEM);
+    if (build_filter(c, buf->data, c->factor, c->filter_length, c->filter_alloc, phase_count,
+                     1 << c->filter_shift, c->filter_type, c->kaiser_beta)) {
+        av_buffer_unref(&buf);
+        return AVERROR(ENOMEM);
+    }
+    memcpy(buf->data + (c->filter_alloc*phase_count+1)*c->felem_size, buf->data, (c->filter_alloc-1)*c->felem_size);
+    memcpy(buf->data + (c->filter_alloc*phase_count  )*c->felem_size, buf->data + (c->filter_alloc - 1)*c->felem_size, c->felem_size);
+
+    ff_mutex_lock(&filter_bank_mutex);
+    e = filter_bank_find(c);
+    if (e) {
+        c->filter_buf = av_buffer_ref(e->buf);
+    } else if ((e = av_mallocz(sizeof(*e)))) {
+        e->factor        = c->factor;
+        e->filter_length = c->filter_length;
+        e->phase_shift   = c->phase_shift;
+        e->filter_type   = c->filter_type;
+        e->kaiser_beta   = c->kaiser_beta;
+        e->format        = c->format;
+        e->buf           = buf;
+        e->next          = filter_bank_cache;
+        filter_bank_cache = e;
+        c->filter_buf    = av_buffer_ref(buf);
+        buf = NULL;
+    } else {
+        /* not cached, the context owns the only reference */
+        c->filter_buf = buf;
+        buf = NULL;
+    }
+    ff_mutex_unlock(&filter_bank_mutex);
+    av_buffer_unref(&buf);
+
+end:
+    if (!c->filter_buf)
+        return AVERROR(ENOMEM);
+    c->filter_bank = c->filter_buf->data;
+    return 0;
+}
+
+static void filter_bank_unref(ResampleContext *c)
+{
+    FilterBankEntry **e;
+
+    if (!c->filter_buf)
+        return;
+
+    ff_thread_once(&filter_bank_once, filter_bank_init_mutex);
+
+    ff_mutex_lock(&filter_bank_mutex);
+    for (e = &filter_bank_cache; *e; e = &(*e)->next) {
+        if ((*e)->buf->buffer == c->filter_buf->buffer) {
+            if (av_buffer_get_ref_count((*e)->buf) == 2) {
+                FilterBankEntry *entry = *e;
+
+                *e = entry->next;
+                av_buffer_unref(&entry->buf);
+                av_free(entry);
+            }
+            break;
+        }
+    }
+    av_buffer_unref(&c->filter_buf);
+    ff_mutex_unlock(&filter_bank_mutex);
+    c->filter_bank = NULL;
+}
+
+static void resample_free(ResampleContext **c){
+    if(!*c)
+        return;
+    filter_bank_unref(*c);
+    av_freep(c);
+}
+
 static ResampleContext *resample_init(ResampleContext *c, int out_rate, int in_rate, int filter_size, int phase_shift, int linear,
                                     double cutoff0, enum AVSampleFormat format, enum SwrFilterType filter_type, double kaiser_beta,
                                     double precision, int cheby)
@@ -306,6 +439,7 @@ static ResampleContext *resample_init(ResampleContext *c, int out_rate, int in_r
     if (!c || c->phase_shift != phase_shift || c->linear!=linear || c->factor != factor
            || c->filter_length != FFMAX((int)ceil(filter_size/factor), 1) || c->format != format
            || c->filter_type != filter_type || c->kaiser_beta != kaiser_beta) {
+        resample_free(&c);
         c = av_mallocz(sizeof(*c));
         if (!c)
             return NULL;
@@ -340,16 +474,12 @@ static ResampleContext *resample_init(ResampleContext *c, int out_rate, int in_r
         c->linear        = linear;
         c->factor        = factor;
         c->filter_length = FFMAX((int)ceil(filter_size/factor), 1);
-        c->filter_alloc  = FFALIGN(c->filter_length, 8);
-        c->filter_bank   = av_calloc(c->filter_alloc, (phase_count+1)*c->felem_size);
+        /* the AVX2 int16 functions load 16 taps at a time */
+        c->filter_alloc  = FFALIGN(c->filter_length, 16);
         c->filter_type   = filter_type;
         c->kaiser_beta   = kaiser_beta;
-        if (!c->filter_bank)
-            goto error;
-        if (build_filter(c, (void*)c->filter_bank, factor, c->filter_length, c->filter_alloc, phase_count, 1<<c->filter_shift, filter_type, kaiser_beta))
+        if (filter_bank_get(c) < 0)
             goto error;
-        memcpy(c->filter_bank + (c->filter_alloc*phase_count+1)*c->felem_size, c->filter_bank, (c->filter_alloc-1)*c->felem_size);
-        memcpy(c->filter_bank + (c->filter_alloc*phase_count  )*c->felem_size, c->filter_bank + (c->filter_alloc - 1)*c->felem_size, c->felem_size);
     }
 
     c->compensation_distance= 0;
@@ -370,18 +500,11 @@ static ResampleContext *resample_init(ResampleContext *c, int out_rate, int in_r
 
     return c;
 error:
-    av_freep(&c->filter_bank);
+    filter_bank_unref(c);
     av_free(c);
     return NULL;
 }
 
-static void resample_free(ResampleContext **c){
-    if(!*c)
-        return;
-    av_freep(&(*c)->filter_bank);
-    av_freep(c);
-}
-
 static int set_compensation(ResampleContext *c, int sample_delta, int compensation_distance){
     c->compensation_distance= compensation_distance;
     if (compensation_distance)
@@ -433,8 +556,28 @@ static int swri_resample(ResampleContext *c,
     return dst_size;
 }
 
-static int multiple_resample(ResampleContext *c, AudioData *dst, int dst_size, AudioData *src, int src_size, int *consumed){
-    int i, ret= -1;
+typedef struct ResampleThreadData {
+    ResampleContext *c;
+    AudioData *dst, *src;
+    int dst_size, src_size;
+    int need_emms;
+} ResampleThreadData;
+
+static int resample_channel(SwrContext *s, void *arg, int jobnr, int nb_jobs)
+{
+    ResampleThreadData *td = arg;
+    int consumed;
+
+    swri_resample(td->c, td->dst->ch[jobnr], td->src->ch[jobnr],
+                  &consumed, td->src_size, td->dst_size, 0);
+    if (td->need_emms)
+        emms_c();
+    return 0;
+}
+
+static int multiple_resample(SwrContext *s, AudioData *dst, int dst_size, AudioData *src, int src_size, int *consumed){
+    ResampleContext *c = s->resample;
+    int i = 0, ret= -1;
     int av_unused mm_flags = av_get_cpu_flags();
     int need_emms = c->format == AV_SAMPLE_FMT_S16P && ARCH_X86_32 &&
                     (mm_flags & (AV_CPU_FLAG_MMX2 | AV_CPU_FLAG_SSE2)) == AV_CPU_FLAG_MMX2;
@@ -444,7 +587,15 @@ static int multiple_resample(ResampleContext *c, AudioData *dst, int dst_size, A
         dst_size = FFMIN(dst_size, c->compensation_distance);
     src_size = FFMIN(src_size, max_src_size);
 
-    for(i=0; i<dst->ch_count; i++){
+    /* All channels but the last one only read the resampler state, so they
+     * can be processed in parallel; the last one updates it afterwards. */
+    if (s->thread && dst->ch_count > 1) {
+        ResampleThreadData td = { c, dst, src, dst_size, src_size, need_emms };
+
+        i = dst->ch_count - 1;
+        swri_execute(s, resample_channel, &td, i);
+    }
+    for(; i<dst->ch_count; i++){
         ret= swri_resample(c, dst->ch[i], src->ch[i],
                            consumed, src_size, dst_size, i+1==dst->ch_count);
     }
@@ -22,6 +22,7 @@
 #ifndef SWRESAMPLE_RESAMPLE_H
 #define SWRESAMPLE_RESAMPLE_H
 
+#include "libavutil/buffer.h"
 #include "libavutil/log.h"
 #include "libavutil/samplefmt.h"
 
@@ -49,6 +50,7 @@ typedef struct ResampleContext {
     enum AVSampleFormat format;
     int felem_size;
     int filter_shift;
+    AVBufferRef *filter_buf;    ///< shared reference owning filter_bank
 
     struct {
         void (*resample_one)(void *dst, const void *src,
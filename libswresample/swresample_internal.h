@@ -71,7 +71,7 @@ struct DitherContext {
 typedef struct ResampleContext * (* resample_init_func)(struct ResampleContext *c, int out_rate, int in_rate, int filter_size, int phase_shift, int linear,
                                     double cutoff, enum AVSampleFormat format, enum SwrFilterType filter_type, double kaiser_beta, double precision, int cheby);
 typedef void    (* resample_free_func)(struct ResampleContext **c);
-typedef int     (* multiple_resample_func)(struct ResampleContext *c, AudioData *dst, int dst_size, AudioData *src, int src_size, int *consumed);
+typedef int     (* multiple_resample_func)(struct SwrContext *s, AudioData *dst, int dst_size, AudioData *src, int src_size, int *consumed);
 typedef int     (* resample_flush_func)(struct SwrContext *c);
 typedef int     (* set_compensation_func)(struct ResampleContext *c, int sample_delta, int compensation_distance);
 typedef int64_t (* get_delay_func)(struct SwrContext *s, int64_t base);
@@ -165,6 +165,8 @@ struct SwrContext {
     struct AudioConvert *full_convert;              ///< full conversion context (single conversion for input and output)
     struct ResampleContext *resample;               ///< resampling context
     struct Resampler const *resampler;              ///< resampler virtual function table
+    int nb_threads;                                 ///< number of threads to use, 0 for automatic
+    struct SwriThreadContext *thread;               ///< worker threads, NULL if running single threaded
 
     float matrix[SWR_CH_MAX][SWR_CH_MAX];           ///< floating point rematrixing coefficients
     uint8_t *native_matrix;
@@ -181,6 +183,9 @@ struct SwrContext {
 
     mix_any_func_type *mix_any_f;
 
+    mix_1_1_func_type *mix_add_f;                   ///< out += coeff * in, float and double only
+    mix_1_1_func_type *mix_add_simd;                ///< float only, double uses mix_add_f
+
     /* TODO: callbacks for ASM optimizations */
 };
 
@@ -192,6 +197,22 @@ void swri_noise_shaping_int32 (SwrContext *s, AudioData *dsts, const AudioData *
 void swri_noise_shaping_float (SwrContext *s, AudioData *dsts, const AudioData *srcs, const AudioData *noises, int count);
 void swri_noise_shaping_double(SwrContext *s, AudioData *dsts, const AudioData *srcs, const AudioData *noises, int count);
 
+/**
+ * Function run by swri_execute() for each job.
+ * @param arg    argument passed to swri_execute()
+ * @param jobnr  index of the job, from 0 to nb_jobs-1
+ */
+typedef int (swri_action_func)(SwrContext *s, void *arg, int jobnr, int nb_jobs);
+
+av_warn_unused_result
+int swri_thread_init(SwrContext *s);
+void swri_thread_free(SwrContext *s);
+/**
+ * Run func for all jobs, in parallel if worker threads were started, and
+ * return once all of them are done.
+ */
+void swri_execute(SwrContext *s, swri_action_func *func, void *arg, int nb_jobs);
+
 av_warn_unused_result
 int swri_rematrix_init(SwrContext *s);
 void swri_rematrix_free(SwrContext *s);
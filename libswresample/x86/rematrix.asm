@@ -103,6 +103,44 @@ mix_1_1_float_u_int %+ SUFFIX:
     REP_RET
 %endmacro
 
+%macro MIXADD_FLT 1
+cglobal mix_add_%1_float, 5, 5, 5, out, in, coeffp, index, len
+%ifidn %1, a
+    test inq, mmsize-1
+        jne mix_add_float_u_int %+ SUFFIX
+    test outq, mmsize-1
+        jne mix_add_float_u_int %+ SUFFIX
+%else
+mix_add_float_u_int %+ SUFFIX:
+%endif
+    VBROADCASTSS m2, [coeffpq + 4*indexq]
+    shl lenq    , 2
+    add inq     , lenq
+    add outq    , lenq
+    neg lenq
+.next:
+%ifidn %1, a
+    mulps        m0, m2, [inq + lenq         ]
+    mulps        m1, m2, [inq + lenq + mmsize]
+    addps        m0, m0, [outq + lenq         ]
+    addps        m1, m1, [outq + lenq + mmsize]
+%else
+    movu         m0, [inq + lenq         ]
+    movu         m1, [inq + lenq + mmsize]
+    movu         m3, [outq + lenq         ]
+    movu         m4, [outq + lenq + mmsize]
+    mulps        m0, m0, m2
+    mulps        m1, m1, m2
+    addps        m0, m0, m3
+    addps        m1, m1, m4
+%endif
+    mov%1  [outq + lenq         ], m0
+    mov%1  [outq + lenq + mmsize], m1
+    add        lenq, mmsize*2
+        jl .next
+    REP_RET
+%endmacro
+
 %macro MIX1_INT16 1
 cglobal mix_1_1_%1_int16, 5, 5, 6, out, in, coeffp, index, len
 %ifidn %1, a
@@ -234,6 +272,8 @@ MIX2_FLT u
 MIX2_FLT a
 MIX1_FLT u
 MIX1_FLT a
+MIXADD_FLT u
+MIXADD_FLT a
 
 INIT_XMM sse2
 MIX1_INT16 u
@@ -247,4 +287,6 @@ MIX2_FLT u
 MIX2_FLT a
 MIX1_FLT u
 MIX1_FLT a
+MIXADD_FLT u
+MIXADD_FLT a
 %endif
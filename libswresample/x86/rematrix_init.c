@@ -27,6 +27,9 @@ mix_2_1_func_type ff_mix_2_1_a_## type ## _ ## simd;
 
 D(float, sse)
 D(float, avx)
+
+mix_1_1_func_type ff_mix_add_a_float_sse;
+mix_1_1_func_type ff_mix_add_a_float_avx;
 D(int16, mmx)
 D(int16, sse2)
 
@@ -40,6 +43,7 @@ av_cold int swri_rematrix_init_x86(struct SwrContext *s){
 
     s->mix_1_1_simd = NULL;
     s->mix_2_1_simd = NULL;
+    s->mix_add_simd = NULL;
 
     if (s->midbuf.fmt == AV_SAMPLE_FMT_S16P){
         if(EXTERNAL_MMX(mm_flags)) {
@@ -72,10 +76,12 @@ av_cold int swri_rematrix_init_x86(struct SwrContext *s){
         if(EXTERNAL_SSE(mm_flags)) {
             s->mix_1_1_simd = ff_mix_1_1_a_float_sse;
             s->mix_2_1_simd = ff_mix_2_1_a_float_sse;
+            s->mix_add_simd = ff_mix_add_a_float_sse;
         }
         if(EXTERNAL_AVX_FAST(mm_flags)) {
             s->mix_1_1_simd = ff_mix_1_1_a_float_avx;
             s->mix_2_1_simd = ff_mix_2_1_a_float_avx;
+            s->mix_add_simd = ff_mix_add_a_float_avx;
         }
         s->native_simd_matrix = av_mallocz_array(num, sizeof(float));
         s->native_simd_one = av_mallocz(sizeof(float));
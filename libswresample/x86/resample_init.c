@@ -37,11 +37,14 @@ int ff_resample_linear_##type##_##opt(ResampleContext *c, void *dst, \
 RESAMPLE_FUNCS(int16,  mmxext);
 RESAMPLE_FUNCS(int16,  sse2);
 RESAMPLE_FUNCS(int16,  xop);
+RESAMPLE_FUNCS(int16,  avx2);
 RESAMPLE_FUNCS(float,  sse);
 RESAMPLE_FUNCS(float,  avx);
 RESAMPLE_FUNCS(float,  fma3);
 RESAMPLE_FUNCS(float,  fma4);
 RESAMPLE_FUNCS(double, sse2);
+RESAMPLE_FUNCS(double, avx);
+RESAMPLE_FUNCS(double, fma3);
 
 av_cold void swri_resample_dsp_x86_init(ResampleContext *c)
 {
@@ -61,6 +64,10 @@ av_cold void swri_resample_dsp_x86_init(ResampleContext *c)
             c->dsp.resample = c->linear ? ff_resample_linear_int16_xop
                                         : ff_resample_common_int16_xop;
         }
+        if (EXTERNAL_AVX2_FAST(mm_flags)) {
+            c->dsp.resample = c->linear ? ff_resample_linear_int16_avx2
+                                        : ff_resample_common_int16_avx2;
+        }
         break;
     case AV_SAMPLE_FMT_FLTP:
         if (EXTERNAL_SSE(mm_flags)) {
@@ -85,6 +92,14 @@ av_cold void swri_resample_dsp_x86_init(ResampleContext *c)
             c->dsp.resample = c->linear ? ff_resample_linear_double_sse2
                                         : ff_resample_common_double_sse2;
         }
+        if (EXTERNAL_AVX_FAST(mm_flags)) {
+            c->dsp.resample = c->linear ? ff_resample_linear_double_avx
+                                        : ff_resample_common_double_avx;
+        }
+        if (EXTERNAL_FMA3_FAST(mm_flags)) {
+            c->dsp.resample = c->linear ? ff_resample_linear_double_fma3
+                                        : ff_resample_common_double_fma3;
+        }
         break;
     }
 }
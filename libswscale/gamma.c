@@ -18,55 +18,124 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include "libavutil/pixdesc.h"
+
+#include "swscale.h"
 #include "swscale_internal.h"
 
-typedef struct GammaContext
+/* Convert lines of the packed RGB source to linear light planes in
+ * R, G, B, A order; alpha is copied unchanged. The source is either the
+ * 16-bit RGB output of the first cascaded context or, if there is none,
+ * 8-bit packed RGB read directly from the input slice. */
+static void linearize(SwsContext *c, const uint8_t *src, int srcStride, int y, int h)
 {
-    uint16_t *table;
-} GammaContext;
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(c->srcFormat);
+    const uint16_t *table = c->gamma;
+    int alpha = !!c->gamma_tmp[3];
+    int i, j;
 
-// gamma_convert expects 16 bit rgb format
-// it writes directly in src slice thus it must be modifiable (done through cascade context)
-static int gamma_convert(SwsContext *c, SwsFilterDescriptor *desc, int sliceY, int sliceH)
-{
-    GammaContext *instance = desc->instance;
-    uint16_t *table = instance->table;
-    int srcW = desc->src->width;
-
-    int i;
-    for (i = 0; i < sliceH; ++i) {
-        uint8_t ** src = desc->src->plane[0].line;
-        int src_pos = sliceY+i - desc->src->plane[0].sliceY;
-
-        uint16_t *src1 = (uint16_t*)*(src+src_pos);
-        int j;
-        for (j = 0; j < srcW; ++j) {
-            uint16_t r = AV_RL16(src1 + j*4 + 0);
-            uint16_t g = AV_RL16(src1 + j*4 + 1);
-            uint16_t b = AV_RL16(src1 + j*4 + 2);
-
-            AV_WL16(src1 + j*4 + 0, table[r]);
-            AV_WL16(src1 + j*4 + 1, table[g]);
-            AV_WL16(src1 + j*4 + 2, table[b]);
-        }
+    for (j = y; j < y + h; j++, src += srcStride) {
+        uint16_t *r = (uint16_t *)(c->gamma_tmp[0] + j * c->gamma_tmpStride[0]);
+        uint16_t *g = (uint16_t *)(c->gamma_tmp[1] + j * c->gamma_tmpStride[1]);
+        uint16_t *b = (uint16_t *)(c->gamma_tmp[2] + j * c->gamma_tmpStride[2]);
+        uint16_t *a = alpha ? (uint16_t *)(c->gamma_tmp[3] + j * c->gamma_tmpStride[3]) : NULL;
+
+        if (c->cascaded_context[0]) {
+            const uint16_t *s = (const uint16_t *)src;
+            int step = alpha ? 4 : 3;
+
+            for (i = 0; i < c->srcW; i++) {
+                r[i] = table[s[step * i + 0]];
+                g[i] = table[s[step * i + 1]];
+                b[i] = table[s[step * i + 2]];
+            }
+            if (alpha)
+                for (i = 0; i < c->srcW; i++)
+                    a[i] = s[4 * i + 3];
+        } else {
+            const uint8_t *sr = src + desc->comp[0].offset;
+            const uint8_t *sg = src + desc->comp[1].offset;
+            const uint8_t *sb = src + desc->comp[2].offset;
+            int step = desc->comp[0].step;
 
+            /* v * 257 expands 8 bits to the full 16-bit range */
+            for (i = 0; i < c->srcW; i++) {
+                r[i] = table[sr[step * i] * 257];
+                g[i] = table[sg[step * i] * 257];
+                b[i] = table[sb[step * i] * 257];
+            }
+            if (alpha) {
+                const uint8_t *sa = src + desc->comp[3].offset;
+
+                for (i = 0; i < c->srcW; i++)
+                    a[i] = sa[step * i] * 257;
+            }
+        }
     }
-    return sliceH;
 }
 
-
-int ff_init_gamma_convert(SwsFilterDescriptor *desc, SwsSlice * src, uint16_t *table)
+/* Re-encode lines of the scaled linear light planes in place. */
+static void delinearize(SwsContext *c, int y, int h)
 {
-    GammaContext *li = av_malloc(sizeof(GammaContext));
-    if (!li)
-        return AVERROR(ENOMEM);
-    li->table = table;
+    const uint16_t *table = c->inv_gamma;
+    int i, j, plane;
 
-    desc->instance = li;
-    desc->src = src;
-    desc->dst = NULL;
-    desc->process = &gamma_convert;
+    for (plane = 0; plane < 3; plane++) {
+        for (j = y; j < y + h; j++) {
+            uint16_t *p = (uint16_t *)(c->cascaded1_tmp[plane] + j * c->cascaded1_tmpStride[plane]);
 
-    return 0;
+            for (i = 0; i < c->dstW; i++)
+                p[i] = table[p[i]];
+        }
+    }
 }
 
+int ff_sws_scale_gamma(SwsContext *c, const uint8_t * const srcSlice[],
+                       const int srcStride[], int srcSliceY, int srcSliceH,
+                       uint8_t * const dst[], const int dstStride[])
+{
+    /* the linear light planes are in RGB order, the planar RGB formats
+     * in GBR order */
+    static const int gbr_order[4] = { 1, 2, 0, 3 };
+    const uint8_t *src[4] = { NULL };
+    int stride[4] = { 0 };
+    int i, y, ret;
+
+    if (c->cascaded_context[0]) {
+        if (srcSliceY == 0)
+            c->gamma_srcY = 0;
+
+        ret = sws_scale(c->cascaded_context[0], srcSlice, srcStride, srcSliceY, srcSliceH,
+                        c->cascaded_tmp, c->cascaded_tmpStride);
+        if (ret <= 0)
+            return ret;
+        y = c->gamma_srcY;
+        c->gamma_srcY += ret;
+        linearize(c, c->cascaded_tmp[0] + y * c->cascaded_tmpStride[0],
+                  c->cascaded_tmpStride[0], y, ret);
+    } else {
+        y   = srcSliceY;
+        ret = srcSliceH;
+        linearize(c, srcSlice[0], srcStride[0], y, ret);
+    }
+
+    for (i = 0; i < 4; i++)
+        if (c->gamma_tmp[i])
+            src[i] = c->gamma_tmp[i] + y * c->gamma_tmpStride[i];
+    ret = sws_scale(c->cascaded_context[1], src, c->gamma_tmpStride, y, ret,
+                    c->cascaded1_tmp, c->cascaded1_tmpStride);
+    if (ret <= 0)
+        return ret;
+    y = c->cascaded_context[1]->dstY - ret;
+    delinearize(c, y, ret);
+
+    for (i = 0; i < 4; i++) {
+        int plane = gbr_order[i];
+
+        if (c->cascaded1_tmp[plane]) {
+            src[i]    = c->cascaded1_tmp[plane] + y * c->cascaded1_tmpStride[plane];
+            stride[i] = c->cascaded1_tmpStride[plane];
+        }
+    }
+    return sws_scale(c->cascaded_context[2], src, stride, y, ret, dst, dstStride);
+}
@@ -139,6 +139,20 @@ extern void (*deinterleaveBytes)(const uint8_t *src, uint8_t *dst1, uint8_t *dst
                                  int width, int height, int srcStride,
                                  int dst1Stride, int dst2Stride);
 
+/**
+ * 16-bit versions of interleaveBytes() and deinterleaveBytes(), as used
+ * by the semi-planar high bit depth formats. The samples are shifted left
+ * by shift when interleaving and right when deinterleaving. The strides
+ * are in samples.
+ */
+extern void (*interleaveWords)(const uint16_t *src1, const uint16_t *src2, uint16_t *dst,
+                               int width, int height, int src1Stride,
+                               int src2Stride, int dstStride, int shift);
+
+extern void (*deinterleaveWords)(const uint16_t *src, uint16_t *dst1, uint16_t *dst2,
+                                 int width, int height, int srcStride,
+                                 int dst1Stride, int dst2Stride, int shift);
+
 extern void (*vu9_to_vu12)(const uint8_t *src1, const uint8_t *src2,
                            uint8_t *dst1, uint8_t *dst2,
                            int width, int height,
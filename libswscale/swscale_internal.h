@@ -327,9 +327,11 @@ typedef struct SwsContext {
 
     double gamma_value;
     int gamma_flag;
-    int is_internal_gamma;
-    uint16_t *gamma;
-    uint16_t *inv_gamma;
+    uint16_t *gamma;              ///< 16-bit to linear light table, for gamma_flag
+    uint16_t *inv_gamma;          ///< linear light to 16-bit table, for gamma_flag
+    int gamma_tmpStride[4];
+    uint8_t *gamma_tmp[4];        ///< linear light planes of the source, for gamma_flag
+    int gamma_srcY;               ///< number of source lines converted to linear light
 
     int numDesc;
     int descIndex[2];
@@ -988,6 +990,14 @@ typedef struct SwsFilterDescriptor
     int (*process)(SwsContext *c, struct SwsFilterDescriptor *desc, int sliceY, int sliceH);
 } SwsFilterDescriptor;
 
+/**
+ * Scale a slice in linear light through the cascaded contexts set up for
+ * gamma_flag, with the arguments of sws_scale().
+ */
+int ff_sws_scale_gamma(SwsContext *c, const uint8_t * const srcSlice[],
+                       const int srcStride[], int srcSliceY, int srcSliceH,
+                       uint8_t * const dst[], const int dstStride[]);
+
 // warp input lines in the form (src + width*i + j) to slice format (line[i][j])
 // relative=true means first line src[x][0] otherwise first line is src[x][lum/crh Y]
 int ff_init_slice_from_src(SwsSlice * s, uint8_t *src[4], int stride[4], int srcW, int lumY, int lumH, int chrY, int chrH, int relative);
@@ -1006,8 +1016,6 @@ int ff_free_filters(SwsContext *c);
 */
 int ff_rotate_slice(SwsSlice *s, int lum, int chr);
 
-/// initializes gamma conversion descriptor
-int ff_init_gamma_convert(SwsFilterDescriptor *desc, SwsSlice * src, uint16_t *table);
 
 /// initializes lum pixel format conversion descriptor
 int ff_init_desc_fmt_convert(SwsFilterDescriptor *desc, SwsSlice * src, SwsSlice *dst, uint32_t *pal);
@@ -197,6 +197,108 @@ static int nv12ToPlanarWrapper(SwsContext *c, const uint8_t *src[],
     return srcSliceH;
 }
 
+static void copyPlane16Shift(const uint16_t *src, int srcStride,
+                             uint16_t *dst, int dstStride,
+                             int width, int height, int shift)
+{
+    int x, y;
+
+    for (y = 0; y < height; y++) {
+        if (shift > 0) {
+            for (x = 0; x < width; x++)
+                dst[x] = src[x] << shift;
+        } else {
+            for (x = 0; x < width; x++)
+                dst[x] = src[x] >> -shift;
+        }
+        src += srcStride;
+        dst += dstStride;
+    }
+}
+
+/* P010 stores the same samples as YUV420P10 in the 10 most significant
+ * bits, so the conversions in both directions are lossless. */
+static int planarToP010Wrapper(SwsContext *c, const uint8_t *src[],
+                               int srcStride[], int srcSliceY,
+                               int srcSliceH, uint8_t *dstParam[],
+                               int dstStride[])
+{
+    uint16_t *dstY  = (uint16_t *)(dstParam[0] + dstStride[0] * srcSliceY);
+    uint16_t *dstUV = (uint16_t *)(dstParam[1] + dstStride[1] * srcSliceY / 2);
+
+    copyPlane16Shift((const uint16_t *)src[0], srcStride[0] / 2,
+                     dstY, dstStride[0] / 2, c->srcW, srcSliceH, 6);
+    interleaveWords((const uint16_t *)src[1], (const uint16_t *)src[2], dstUV,
+                    AV_CEIL_RSHIFT(c->srcW, 1), AV_CEIL_RSHIFT(srcSliceH, 1),
+                    srcStride[1] / 2, srcStride[2] / 2, dstStride[1] / 2, 6);
+
+    return srcSliceH;
+}
+
+static int p010ToPlanarWrapper(SwsContext *c, const uint8_t *src[],
+                               int srcStride[], int srcSliceY,
+                               int srcSliceH, uint8_t *dstParam[],
+                               int dstStride[])
+{
+    uint16_t *dstY = (uint16_t *)(dstParam[0] + dstStride[0] * srcSliceY);
+    uint16_t *dstU = (uint16_t *)(dstParam[1] + dstStride[1] * srcSliceY / 2);
+    uint16_t *dstV = (uint16_t *)(dstParam[2] + dstStride[2] * srcSliceY / 2);
+
+    copyPlane16Shift((const uint16_t *)src[0], srcStride[0] / 2,
+                     dstY, dstStride[0] / 2, c->srcW, srcSliceH, -6);
+    deinterleaveWords((const uint16_t *)src[1], dstU, dstV,
+                      AV_CEIL_RSHIFT(c->srcW, 1), AV_CEIL_RSHIFT(srcSliceH, 1),
+                      srcStride[1] / 2, dstStride[1] / 2, dstStride[2] / 2, 6);
+
+    return srcSliceH;
+}
+
+/* NV12/NV21 to native endian 9 to 16 bit planar YUV 4:2:0, expanding the
+ * samples the same way planarCopyWrapper() does for planar input. */
+static int nv12ToPlanar16Wrapper(SwsContext *c, const uint8_t *src[],
+                                 int srcStride[], int srcSliceY,
+                                 int srcSliceH, uint8_t *dstParam[],
+                                 int dstStride[])
+{
+    const int depth = av_pix_fmt_desc_get(c->dstFormat)->comp[0].depth;
+    const int shift = depth - 8;
+    const int chrW  = AV_CEIL_RSHIFT(c->srcW, 1);
+    const int chrH  = AV_CEIL_RSHIFT(srcSliceH, 1);
+    uint16_t *dstY = (uint16_t *)(dstParam[0] + dstStride[0] * srcSliceY);
+    uint16_t *dstU = (uint16_t *)(dstParam[1] + dstStride[1] * srcSliceY / 2);
+    uint16_t *dstV = (uint16_t *)(dstParam[2] + dstStride[2] * srcSliceY / 2);
+    const uint8_t *srcY  = src[0];
+    const uint8_t *srcUV = src[1];
+    int x, y;
+
+    if (c->srcFormat == AV_PIX_FMT_NV21)
+        FFSWAP(uint16_t *, dstU, dstV);
+
+    for (y = 0; y < srcSliceH; y++) {
+        if (c->srcRange) {
+            for (x = 0; x < c->srcW; x++)
+                dstY[x] = (srcY[x] << shift) | (srcY[x] >> (8 - shift));
+        } else {
+            for (x = 0; x < c->srcW; x++)
+                dstY[x] = srcY[x] << shift;
+        }
+        srcY += srcStride[0];
+        dstY += dstStride[0] / 2;
+    }
+
+    for (y = 0; y < chrH; y++) {
+        for (x = 0; x < chrW; x++) {
+            dstU[x] = srcUV[2 * x + 0] << shift;
+            dstV[x] = srcUV[2 * x + 1] << shift;
+        }
+        srcUV += srcStride[1];
+        dstU  += dstStride[1] / 2;
+        dstV  += dstStride[2] / 2;
+    }
+
+    return srcSliceH;
+}
+
 static int planarToYuy2Wrapper(SwsContext *c, const uint8_t *src[],
                                int srcStride[], int srcSliceY, int srcSliceH,
                                uint8_t *dstParam[], int dstStride[])
@@ -1594,6 +1696,21 @@ void ff_get_unscaled_swscale(SwsContext *c)
         (srcFormat == AV_PIX_FMT_NV12 || srcFormat == AV_PIX_FMT_NV21)) {
         c->swscale = nv12ToPlanarWrapper;
     }
+    /* yuv420p10_to_p010 */
+    if (srcFormat == AV_PIX_FMT_YUV420P10 && dstFormat == AV_PIX_FMT_P010) {
+        c->swscale = planarToP010Wrapper;
+    }
+    /* p010_to_yuv420p10 */
+    if (srcFormat == AV_PIX_FMT_P010 && dstFormat == AV_PIX_FMT_YUV420P10) {
+        c->swscale = p010ToPlanarWrapper;
+    }
+    /* nv12_to_yuv420p9..16 */
+    if ((srcFormat == AV_PIX_FMT_NV12 || srcFormat == AV_PIX_FMT_NV21) &&
+        (dstFormat == AV_PIX_FMT_YUV420P9  || dstFormat == AV_PIX_FMT_YUV420P10 ||
+         dstFormat == AV_PIX_FMT_YUV420P12 || dstFormat == AV_PIX_FMT_YUV420P14 ||
+         dstFormat == AV_PIX_FMT_YUV420P16)) {
+        c->swscale = nv12ToPlanar16Wrapper;
+    }
     /* yuv2bgr */
     if ((srcFormat == AV_PIX_FMT_YUV420P || srcFormat == AV_PIX_FMT_YUV422P ||
          srcFormat == AV_PIX_FMT_YUVA420P) && isAnyRGB(dstFormat) &&
@@ -244,8 +244,8 @@ static const FormatEntry format_entries[AV_PIX_FMT_NB] = {
     [AV_PIX_FMT_XYZ12BE]     = { 1, 1, 1 },
     [AV_PIX_FMT_XYZ12LE]     = { 1, 1, 1 },
     [AV_PIX_FMT_AYUV64LE]    = { 1, 1},
-    [AV_PIX_FMT_P010LE]      = { 1, 0 },
-    [AV_PIX_FMT_P010BE]      = { 1, 0 },
+    [AV_PIX_FMT_P010LE]      = { 1, 1 },
+    [AV_PIX_FMT_P010BE]      = { 1, 1 },
 };
 
 int sws_isSupportedInput(enum AVPixelFormat pix_fmt)
@@ -327,7 +327,7 @@ static av_cold int initFilter(int16_t **outFilter, int32_t **filterPos,
     emms_c(); // FIXME should not be required but IS (even for non-MMX versions)
 
     // NOTE: the +3 is for the MMX(+1) / SSE(+3) scaler which reads over the end
-    FF_ALLOC_ARRAY_OR_GOTO(NULL, *filterPos, (dstW + 3), sizeof(**filterPos), fail);
+    FF_ALLOC_ARRAY_OR_GOTO(NULL, *filterPos, (dstW + 7), sizeof(**filterPos), fail);
 
     if (FFABS(xInc - 0x10000) < 10 && srcPos == dstPos) { // unscaled
         int i;
@@ -668,7 +668,7 @@ static av_cold int initFilter(int16_t **outFilter, int32_t **filterPos,
     // Note the +1 is for the MMX scaler which reads over the end
     /* align at 16 for AltiVec (needed by hScale_altivec_real) */
     FF_ALLOCZ_ARRAY_OR_GOTO(NULL, *outFilter,
-                            (dstW + 3), *outFilterSize * sizeof(int16_t), fail);
+                            (dstW + 7), *outFilterSize * sizeof(int16_t), fail);
 
     /* normalize & store in outFilter */
     for (i = 0; i < dstW; i++) {
@@ -692,15 +692,13 @@ static av_cold int initFilter(int16_t **outFilter, int32_t **filterPos,
         }
     }
 
-    (*filterPos)[dstW + 0] =
-    (*filterPos)[dstW + 1] =
-    (*filterPos)[dstW + 2] = (*filterPos)[dstW - 1]; /* the MMX/SSE scaler will
-                                                      * read over the end */
+    /* the MMX/SSE/AVX2 scalers will read over the end */
+    for (i = 0; i < 7; i++)
+        (*filterPos)[dstW + i] = (*filterPos)[dstW - 1];
     for (i = 0; i < *outFilterSize; i++) {
-        int k = (dstW - 1) * (*outFilterSize) + i;
-        (*outFilter)[k + 1 * (*outFilterSize)] =
-        (*outFilter)[k + 2 * (*outFilterSize)] =
-        (*outFilter)[k + 3 * (*outFilterSize)] = (*outFilter)[k];
+        int j, k = (dstW - 1) * (*outFilterSize) + i;
+        for (j = 1; j <= 7; j++)
+            (*outFilter)[k + j * (*outFilterSize)] = (*outFilter)[k];
     }
 
     ret = 0;
@@ -889,6 +887,17 @@ int sws_setColorspaceDetails(struct SwsContext *c, const int inv_table[4],
     c->dstFormatBpp = av_get_bits_per_pixel(desc_dst);
     c->srcFormatBpp = av_get_bits_per_pixel(desc_src);
 
+    if (c->gamma_flag && c->cascaded_context[2]) {
+        if (c->cascaded_context[0]) {
+            int ret = sws_setColorspaceDetails(c->cascaded_context[0], inv_table, srcRange, table, 0,
+                                               brightness, contrast, saturation);
+            if (ret < 0)
+                return ret;
+        }
+        return sws_setColorspaceDetails(c->cascaded_context[2], inv_table, 0, table, dstRange,
+                                        0, 1 << 16, 1 << 16);
+    }
+
     if (c->cascaded_context[c->cascaded_mainindex])
         return sws_setColorspaceDetails(c->cascaded_context[c->cascaded_mainindex],inv_table, srcRange,table, dstRange, brightness,  contrast, saturation);
 
@@ -1079,7 +1088,7 @@ static uint16_t * alloc_gamma_tbl(double e)
         return NULL;
 
     for (i = 0; i < 65536; ++i) {
-        tbl[i] = pow(i / 65535.0, e) * 65535.0;
+        tbl[i] = lrint(pow(i / 65535.0, e) * 65535.0);
     }
     return tbl;
 }
@@ -1157,7 +1166,6 @@ av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
     const AVPixFmtDescriptor *desc_src;
     const AVPixFmtDescriptor *desc_dst;
     int ret = 0;
-    enum AVPixelFormat tmpFmt;
 
     cpu_flags = av_get_cpu_flags();
     flags     = c->flags;
@@ -1438,62 +1446,69 @@ av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
 
     // hardcoded for now
     c->gamma_value = 2.2;
-    tmpFmt = AV_PIX_FMT_RGBA64LE;
 
+    /* Linear light scaling: convert the source to 16-bit RGB, linearize it
+     * into planes, scale the planes as if they were YUV 4:4:4 so that no
+     * colorspace conversion is done on linear values, then re-encode them
+     * in place and convert the planar RGB result to the destination. */
+    if (!unscaled && c->gamma_flag) {
+        int alpha = isALPHA(srcFormat) && isALPHA(dstFormat);
+        enum AVPixelFormat packedFmt = alpha ? AV_PIX_FMT_RGBA64     : AV_PIX_FMT_RGB48;
+        enum AVPixelFormat linearFmt = alpha ? AV_PIX_FMT_YUVA444P16 : AV_PIX_FMT_YUV444P16;
+        enum AVPixelFormat planarFmt = alpha ? AV_PIX_FMT_GBRAP16    : AV_PIX_FMT_GBRP16;
+
+        /* 8-bit packed RGB is linearized directly from the source */
+        int direct = !(desc_src->flags & (AV_PIX_FMT_FLAG_PLANAR | AV_PIX_FMT_FLAG_PAL |
+                                          AV_PIX_FMT_FLAG_BITSTREAM)) &&
+                     (desc_src->flags & AV_PIX_FMT_FLAG_RGB) &&
+                     desc_src->comp[0].depth == 8 && desc_src->comp[0].shift == 0 &&
+                     desc_src->comp[0].step >= 3;
 
-    if (!unscaled && c->gamma_flag && (srcFormat != tmpFmt || dstFormat != tmpFmt)) {
-        SwsContext *c2;
         c->cascaded_context[0] = NULL;
 
-        ret = av_image_alloc(c->cascaded_tmp, c->cascaded_tmpStride,
-                            srcW, srcH, tmpFmt, 64);
+        if (!direct) {
+            ret = av_image_alloc(c->cascaded_tmp, c->cascaded_tmpStride,
+                                srcW, srcH, packedFmt, 64);
+            if (ret < 0)
+                return ret;
+        }
+        ret = av_image_alloc(c->gamma_tmp, c->gamma_tmpStride,
+                            srcW, srcH, linearFmt, 64);
+        if (ret < 0)
+            return ret;
+        ret = av_image_alloc(c->cascaded1_tmp, c->cascaded1_tmpStride,
+                            dstW, dstH, linearFmt, 64);
         if (ret < 0)
             return ret;
 
-        c->cascaded_context[0] = sws_getContext(srcW, srcH, srcFormat,
-                                                srcW, srcH, tmpFmt,
-                                                flags, NULL, NULL, c->param);
-        if (!c->cascaded_context[0]) {
-            return -1;
+        if (!direct) {
+            c->cascaded_context[0] = sws_getContext(srcW, srcH, srcFormat,
+                                                    srcW, srcH, packedFmt,
+                                                    flags, NULL, NULL, c->param);
+            if (!c->cascaded_context[0])
+                return -1;
         }
 
-        c->cascaded_context[1] = sws_getContext(srcW, srcH, tmpFmt,
-                                                dstW, dstH, tmpFmt,
+        c->cascaded_context[1] = sws_getContext(srcW, srcH, linearFmt,
+                                                dstW, dstH, linearFmt,
                                                 flags, srcFilter, dstFilter, c->param);
-
         if (!c->cascaded_context[1])
             return -1;
 
-        c2 = c->cascaded_context[1];
-        c2->is_internal_gamma = 1;
-        c2->gamma     = alloc_gamma_tbl(    c->gamma_value);
-        c2->inv_gamma = alloc_gamma_tbl(1.f/c->gamma_value);
-        if (!c2->gamma || !c2->inv_gamma)
-            return AVERROR(ENOMEM);
-
-        // is_internal_flag is set after creating the context
-        // to properly create the gamma convert FilterDescriptor
-        // we have to re-initialize it
-        ff_free_filters(c2);
-        if (ff_init_filters(c2) < 0) {
-            sws_freeContext(c2);
+        c->cascaded_context[2] = sws_getContext(dstW, dstH, planarFmt,
+                                                dstW, dstH, dstFormat,
+                                                flags, NULL, NULL, c->param);
+        if (!c->cascaded_context[2])
             return -1;
-        }
 
-        c->cascaded_context[2] = NULL;
-        if (dstFormat != tmpFmt) {
-            ret = av_image_alloc(c->cascaded1_tmp, c->cascaded1_tmpStride,
-                                dstW, dstH, tmpFmt, 64);
-            if (ret < 0)
-                return ret;
+        c->gamma     = alloc_gamma_tbl(    c->gamma_value);
+        c->inv_gamma = alloc_gamma_tbl(1.f/c->gamma_value);
+        if (!c->gamma || !c->inv_gamma)
+            return AVERROR(ENOMEM);
 
-            c->cascaded_context[2] = sws_getContext(dstW, dstH, tmpFmt,
-                                                dstW, dstH, dstFormat,
-                                                flags, NULL, NULL, c->param);
-            if (!c->cascaded_context[2])
-                return -1;
-        }
-        return 0;
+        return sws_setColorspaceDetails(c, c->srcColorspaceTable, c->srcRange,
+                                        c->dstColorspaceTable, c->dstRange,
+                                        c->brightness, c->contrast, c->saturation);
     }
 
     if (isBayer(srcFormat)) {
@@ -2316,6 +2331,7 @@ void sws_freeContext(SwsContext *c)
     memset(c->cascaded_context, 0, sizeof(c->cascaded_context));
     av_freep(&c->cascaded_tmp[0]);
     av_freep(&c->cascaded1_tmp[0]);
+    av_freep(&c->gamma_tmp[0]);
 
     av_freep(&c->gamma);
     av_freep(&c->inv_gamma);
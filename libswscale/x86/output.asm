@@ -22,20 +22,28 @@
 
 %include "libavutil/x86/x86util.asm"
 
-SECTION_RODATA
-
-minshort:      times 8 dw 0x8000
-yuv2yuvX_16_start:  times 4 dd 0x4000 - 0x40000000
-yuv2yuvX_10_start:  times 4 dd 0x10000
-yuv2yuvX_9_start:   times 4 dd 0x20000
-yuv2yuvX_10_upper:  times 8 dw 0x3ff
-yuv2yuvX_9_upper:   times 8 dw 0x1ff
-pd_4:          times 4 dd 4
-pd_4min0x40000:times 4 dd 4 - (0x40000)
-pw_16:         times 8 dw 16
-pw_32:         times 8 dw 32
-pw_512:        times 8 dw 512
-pw_1024:       times 8 dw 1024
+SECTION_RODATA 32
+
+minshort:      times 16 dw 0x8000
+yuv2yuvX_16_start:  times 8 dd 0x4000 - 0x40000000
+yuv2yuvX_14_start:  times 8 dd 0x1000
+yuv2yuvX_12_start:  times 8 dd 0x4000
+yuv2yuvX_10_start:  times 8 dd 0x10000
+yuv2yuvX_9_start:   times 8 dd 0x20000
+yuv2yuvX_14_upper:  times 16 dw 0x3fff
+yuv2yuvX_12_upper:  times 16 dw 0xfff
+yuv2yuvX_10_upper:  times 16 dw 0x3ff
+yuv2yuvX_9_upper:   times 16 dw 0x1ff
+pd_4:          times 8 dd 4
+pd_4min0x40000:times 8 dd 4 - (0x40000)
+pw_1:          times 16 dw 1
+pw_4:          times 16 dw 4
+pw_16:         times 16 dw 16
+pw_32:         times 16 dw 32
+pw_512:        times 16 dw 512
+pw_1024:       times 16 dw 1024
+pw_4096:       times 16 dw 4096
+pw_16384:      times 16 dw 16384
 
 SECTION .text
 
@@ -50,7 +58,7 @@ SECTION .text
 ;                                     const uint8_t *dither, int offset)
 ;
 ; Scale one or $filterSize lines of source data to generate one line of output
-; data. The input is 15-bit in int16_t if $output_size is [8,10] and 19-bit in
+; data. The input is 15-bit in int16_t if $output_size is [8,14] and 19-bit in
 ; int32_t if $output_size is 16. $filter is 12-bits. $filterSize is a multiple
 ; of 2. $offset is either 0 or 3. $dither holds 8 values.
 ;-----------------------------------------------------------------------------
@@ -77,35 +85,41 @@ SECTION .text
     mova            m2,  m8
     mova            m1,  m_dith
 %endif ; x86-32/64
-%else ; %1 == 9/10/16
+%else ; %1 == 9-16
     mova            m1, [yuv2yuvX_%1_start]
     mova            m2,  m1
-%endif ; %1 == 8/9/10/16
+%endif ; %1 == 8/9-16
     movsx     cntr_reg,  fltsizem
 .filterloop_%2_ %+ %%i:
     ; input pixels
     mov             r6, [srcq+gprsize*cntr_reg-2*gprsize]
 %if %1 == 16
-    mova            m3, [r6+r5*4]
-    mova            m5, [r6+r5*4+mmsize]
-%else ; %1 == 8/9/10
-    mova            m3, [r6+r5*2]
-%endif ; %1 == 8/9/10/16
+    movsrc          m3, [r6+r5*4]
+    movsrc          m5, [r6+r5*4+mmsize]
+%else ; %1 == 8-14
+    movsrc          m3, [r6+r5*2]
+%endif ; %1 == 8-14/16
     mov             r6, [srcq+gprsize*cntr_reg-gprsize]
 %if %1 == 16
-    mova            m4, [r6+r5*4]
-    mova            m6, [r6+r5*4+mmsize]
-%else ; %1 == 8/9/10
-    mova            m4, [r6+r5*2]
-%endif ; %1 == 8/9/10/16
+    movsrc          m4, [r6+r5*4]
+    movsrc          m6, [r6+r5*4+mmsize]
+%else ; %1 == 8-14
+    movsrc          m4, [r6+r5*2]
+%endif ; %1 == 8-14/16
 
     ; coefficients
-    movd            m0, [filterq+2*cntr_reg-4] ; coeff[0], coeff[1]
+    movd           xm0, [filterq+2*cntr_reg-4] ; coeff[0], coeff[1]
 %if %1 == 16
+%if mmsize == 32
+    vpbroadcastw   xm7, xm0              ; coeff[0]
+    psrld          xm0, 16
+    vpbroadcastw   xm0, xm0              ; coeff[1]
+%else ; mmsize == 16
     pshuflw         m7,  m0,  0          ; coeff[0]
     pshuflw         m0,  m0,  0x55       ; coeff[1]
-    pmovsxwd        m7,  m7              ; word -> dword
-    pmovsxwd        m0,  m0              ; word -> dword
+%endif ; mmsize == 16/32
+    pmovsxwd        m7, xm7              ; word -> dword
+    pmovsxwd        m0, xm0              ; word -> dword
 
     pmulld          m3,  m7
     pmulld          m5,  m7
@@ -116,10 +130,14 @@ SECTION .text
     paddd           m1,  m5
     paddd           m2,  m4
     paddd           m1,  m6
-%else ; %1 == 10/9/8
+%else ; %1 == 8-14
     punpcklwd       m5,  m3,  m4
     punpckhwd       m3,  m4
+%if mmsize == 32
+    vpbroadcastd    m0, xm0
+%else
     SPLATD          m0
+%endif
 
     pmaddwd         m5,  m0
     pmaddwd         m3,  m0
@@ -134,30 +152,34 @@ SECTION .text
 %if %1 == 16
     psrad           m2,  31 - %1
     psrad           m1,  31 - %1
-%else ; %1 == 10/9/8
+%else ; %1 == 8-14
     psrad           m2,  27 - %1
     psrad           m1,  27 - %1
-%endif ; %1 == 8/9/10/16
+%endif ; %1 == 8-14/16
 
 %if %1 == 8
     packssdw        m2,  m1
     packuswb        m2,  m2
     movh   [dstq+r5*1],  m2
-%else ; %1 == 9/10/16
+%else ; %1 == 9-16
 %if %1 == 16
     packssdw        m2,  m1
+%if mmsize == 32
+    vpermq          m2,  m2, q3120
+%endif
     paddw           m2, [minshort]
-%else ; %1 == 9/10
+%else ; %1 == 9-14
 %if cpuflag(sse4)
     packusdw        m2,  m1
+    pminuw          m2, [yuv2yuvX_%1_upper]
 %else ; mmxext/sse2
     packssdw        m2,  m1
     pmaxsw          m2,  m6
-%endif ; mmxext/sse2/sse4/avx
     pminsw          m2, [yuv2yuvX_%1_upper]
-%endif ; %1 == 9/10/16
+%endif ; mmxext/sse2/sse4/avx/avx2
+%endif ; %1 == 9-14/16
     mov%2   [dstq+r5*2],  m2
-%endif ; %1 == 8/9/10/16
+%endif ; %1 == 8/9-16
 
     add             r5,  mmsize/2
     sub             wd,  mmsize/2
@@ -177,10 +199,16 @@ SECTION .text
 %define movsx movsxd
 %endif
 
+%if mmsize == 32
+%define movsrc movu ; the chroma lines are only 16-byte aligned
+%else
+%define movsrc mova
+%endif
+
 cglobal yuv2planeX_%1, %3, 8, %2, filter, fltsize, src, dst, w, dither, offset
-%if %1 == 8 || %1 == 9 || %1 == 10
+%if %1 < 16
     pxor            m6,  m6
-%endif ; %1 == 8/9/10
+%endif ; %1 == 8-14
 
 %if %1 == 8
 %if ARCH_X86_32
@@ -237,14 +265,14 @@ cglobal yuv2planeX_%1, %3, 8, %2, filter, fltsize, src, dst, w, dither, offset
 
 %if mmsize == 8 || %1 == 8
     yuv2planeX_mainloop %1, a
-%else ; mmsize == 16
-    test          dstq, 15
+%else ; mmsize == 16/32
+    test          dstq, mmsize - 1
     jnz .unaligned
     yuv2planeX_mainloop %1, a
     REP_RET
 .unaligned:
     yuv2planeX_mainloop %1, u
-%endif ; mmsize == 8/16
+%endif ; mmsize == 8/16/32
 
 %if %1 == 8
 %if ARCH_X86_32
@@ -253,9 +281,9 @@ cglobal yuv2planeX_%1, %3, 8, %2, filter, fltsize, src, dst, w, dither, offset
 %else ; x86-64
     REP_RET
 %endif ; x86-32/64
-%else ; %1 == 9/10/16
+%else ; %1 == 9-16
     REP_RET
-%endif ; %1 == 8/9/10/16
+%endif ; %1 == 8/9-16
 %endmacro
 
 %if ARCH_X86_32
@@ -263,17 +291,23 @@ INIT_MMX mmxext
 yuv2planeX_fn  8,  0, 7
 yuv2planeX_fn  9,  0, 5
 yuv2planeX_fn 10,  0, 5
+yuv2planeX_fn 12,  0, 5
+yuv2planeX_fn 14,  0, 5
 %endif
 
 INIT_XMM sse2
 yuv2planeX_fn  8, 10, 7
 yuv2planeX_fn  9,  7, 5
 yuv2planeX_fn 10,  7, 5
+yuv2planeX_fn 12,  7, 5
+yuv2planeX_fn 14,  7, 5
 
 INIT_XMM sse4
 yuv2planeX_fn  8, 10, 7
 yuv2planeX_fn  9,  7, 5
 yuv2planeX_fn 10,  7, 5
+yuv2planeX_fn 12,  7, 5
+yuv2planeX_fn 14,  7, 5
 yuv2planeX_fn 16,  8, 5
 
 %if HAVE_AVX_EXTERNAL
@@ -281,6 +315,19 @@ INIT_XMM avx
 yuv2planeX_fn  8, 10, 7
 yuv2planeX_fn  9,  7, 5
 yuv2planeX_fn 10,  7, 5
+yuv2planeX_fn 12,  7, 5
+yuv2planeX_fn 14,  7, 5
+%endif
+
+; the 8-bit version keeps its dither state per 8 pixels, there is no avx2
+; version of it
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+yuv2planeX_fn  9,  7, 5
+yuv2planeX_fn 10,  7, 5
+yuv2planeX_fn 12,  7, 5
+yuv2planeX_fn 14,  7, 5
+yuv2planeX_fn 16,  8, 5
 %endif
 
 ; %1=outout-bpc, %2=alignment (u/a)
@@ -292,6 +339,9 @@ yuv2planeX_fn 10,  7, 5
     psraw           m0, 7
     psraw           m1, 7
     packuswb        m0, m1
+%if mmsize == 32
+    vpermq          m0, m0, q3120
+%endif
     mov%2    [dstq+wq], m0
 %elif %1 == 16
     paddd           m0, m4, [srcq+wq*4+mmsize*0]
@@ -302,9 +352,13 @@ yuv2planeX_fn 10,  7, 5
     psrad           m1, 3
     psrad           m2, 3
     psrad           m3, 3
-%if cpuflag(sse4) ; avx/sse4
+%if cpuflag(sse4) ; avx2/avx/sse4
     packusdw        m0, m1
     packusdw        m2, m3
+%if mmsize == 32
+    vpermq          m0, m0, q3120
+    vpermq          m2, m2, q3120
+%endif
 %else ; mmx/sse2
     packssdw        m0, m1
     packssdw        m2, m3
@@ -313,7 +367,7 @@ yuv2planeX_fn 10,  7, 5
 %endif ; mmx/sse2/sse4/avx
     mov%2    [dstq+wq*2+mmsize*0], m0
     mov%2    [dstq+wq*2+mmsize*1], m2
-%else ; %1 == 9/10
+%else ; %1 == 9-14
     paddsw          m0, m2, [srcq+wq*2+mmsize*0]
     paddsw          m1, m2, [srcq+wq*2+mmsize*1]
     psraw           m0, 15 - %1
@@ -350,7 +404,11 @@ cglobal yuv2plane1_%1, %3, %3, %2, src, dst, w, dither, offset
     pxor            m4, m4               ; zero
 
     ; create registers holding dither
+%if mmsize == 32
+    vpbroadcastq    m3, [ditherq]        ; dither
+%else
     movq            m3, [ditherq]        ; dither
+%endif ; mmsize == 32
     test       offsetd, offsetd
     jz              .no_rot
 %if mmsize == 16
@@ -374,8 +432,16 @@ cglobal yuv2plane1_%1, %3, %3, %2, src, dst, w, dither, offset
     pxor            m4, m4
     mova            m3, [pw_1024]
     mova            m2, [pw_16]
+%elif %1 == 12
+    pxor            m4, m4
+    mova            m3, [pw_4096]
+    mova            m2, [pw_4]
+%elif %1 == 14
+    pxor            m4, m4
+    mova            m3, [pw_16384]
+    mova            m2, [pw_1]
 %else ; %1 == 16
-%if cpuflag(sse4) ; sse4/avx
+%if cpuflag(sse4) ; sse4/avx/avx2
     mova            m4, [pd_4]
 %else ; mmx/sse2
     mova            m4, [pd_4min0x40000]
@@ -386,14 +452,14 @@ cglobal yuv2plane1_%1, %3, %3, %2, src, dst, w, dither, offset
     ; actual pixel scaling
 %if mmsize == 8
     yuv2plane1_mainloop %1, a
-%else ; mmsize == 16
-    test          dstq, 15
+%else ; mmsize == 16/32
+    test          dstq, mmsize - 1
     jnz .unaligned
     yuv2plane1_mainloop %1, a
     REP_RET
 .unaligned:
     yuv2plane1_mainloop %1, u
-%endif ; mmsize == 8/16
+%endif ; mmsize == 8/16/32
     REP_RET
 %endmacro
 
@@ -405,12 +471,16 @@ yuv2plane1_fn 16, 0, 3
 INIT_MMX mmxext
 yuv2plane1_fn  9, 0, 3
 yuv2plane1_fn 10, 0, 3
+yuv2plane1_fn 12, 0, 3
+yuv2plane1_fn 14, 0, 3
 %endif
 
 INIT_XMM sse2
 yuv2plane1_fn  8, 5, 5
 yuv2plane1_fn  9, 5, 3
 yuv2plane1_fn 10, 5, 3
+yuv2plane1_fn 12, 5, 3
+yuv2plane1_fn 14, 5, 3
 yuv2plane1_fn 16, 6, 3
 
 INIT_XMM sse4
@@ -421,5 +491,17 @@ INIT_XMM avx
 yuv2plane1_fn  8, 5, 5
 yuv2plane1_fn  9, 5, 3
 yuv2plane1_fn 10, 5, 3
+yuv2plane1_fn 12, 5, 3
+yuv2plane1_fn 14, 5, 3
+yuv2plane1_fn 16, 5, 3
+%endif
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+yuv2plane1_fn  8, 5, 5
+yuv2plane1_fn  9, 5, 3
+yuv2plane1_fn 10, 5, 3
+yuv2plane1_fn 12, 5, 3
+yuv2plane1_fn 14, 5, 3
 yuv2plane1_fn 16, 5, 3
 %endif
@@ -1991,6 +1991,99 @@ static void RENAME(deinterleaveBytes)(const uint8_t *src, uint8_t *dst1, uint8_t
 #endif /* !COMPILE_TEMPLATE_AMD3DNOW */
 #endif /* !COMPILE_TEMPLATE_AVX || HAVE_AVX_EXTERNAL */
 
+#if COMPILE_TEMPLATE_SSE2 && !COMPILE_TEMPLATE_AVX
+static void RENAME(interleaveWords)(const uint16_t *src1, const uint16_t *src2, uint16_t *dest,
+                                    int width, int height, int src1Stride,
+                                    int src2Stride, int dstStride, int shift)
+{
+    int h;
+
+    for (h = 0; h < height; h++) {
+        int w;
+
+        if (width >= 8)
+        __asm__ volatile(
+            "movd                    %4, %%xmm3     \n\t"
+            "xor              %%"REG_a", %%"REG_a"  \n\t"
+            "1:                                     \n\t"
+            PREFETCH" 64(%1, %%"REG_a")             \n\t"
+            PREFETCH" 64(%2, %%"REG_a")             \n\t"
+            "movdqu     (%1, %%"REG_a"), %%xmm0     \n\t"
+            "movdqu     (%2, %%"REG_a"), %%xmm2     \n\t"
+            "psllw               %%xmm3, %%xmm0     \n\t"
+            "psllw               %%xmm3, %%xmm2     \n\t"
+            "movdqa              %%xmm0, %%xmm1     \n\t"
+            "punpcklwd           %%xmm2, %%xmm0     \n\t"
+            "punpckhwd           %%xmm2, %%xmm1     \n\t"
+            "movdqu              %%xmm0,   (%0, %%"REG_a", 2)   \n\t"
+            "movdqu              %%xmm1, 16(%0, %%"REG_a", 2)   \n\t"
+            "add                    $16, %%"REG_a"  \n\t"
+            "cmp                     %3, %%"REG_a"  \n\t"
+            " jb                     1b             \n\t"
+            :: "r"(dest), "r"(src1), "r"(src2), "r"((x86_reg)(width & ~7) * 2),
+               "r"(shift)
+            : "memory", XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3",) "%"REG_a
+        );
+        for (w = width & ~7; w < width; w++) {
+            dest[2 * w + 0] = src1[w] << shift;
+            dest[2 * w + 1] = src2[w] << shift;
+        }
+        dest += dstStride;
+        src1 += src1Stride;
+        src2 += src2Stride;
+    }
+}
+
+static void RENAME(deinterleaveWords)(const uint16_t *src, uint16_t *dst1, uint16_t *dst2,
+                                      int width, int height, int srcStride,
+                                      int dst1Stride, int dst2Stride, int shift)
+{
+    int h;
+
+    for (h = 0; h < height; h++) {
+        int w;
+
+        /* split the words of each register into even and odd halves,
+         * then gather the halves of two registers */
+        if (width >= 8)
+        __asm__ volatile(
+            "movd                    %4, %%xmm4     \n\t"
+            "xor              %%"REG_a", %%"REG_a"  \n\t"
+            "1:                                     \n\t"
+            PREFETCH" 128(%0, %%"REG_a", 2)         \n\t"
+            "movdqu     (%0, %%"REG_a", 2), %%xmm0  \n\t"
+            "movdqu   16(%0, %%"REG_a", 2), %%xmm1  \n\t"
+            "psrlw               %%xmm4, %%xmm0     \n\t"
+            "psrlw               %%xmm4, %%xmm1     \n\t"
+            "pshuflw       $0xd8, %%xmm0, %%xmm0    \n\t"
+            "pshuflw       $0xd8, %%xmm1, %%xmm1    \n\t"
+            "pshufhw       $0xd8, %%xmm0, %%xmm0    \n\t"
+            "pshufhw       $0xd8, %%xmm1, %%xmm1    \n\t"
+            "pshufd        $0xd8, %%xmm0, %%xmm0    \n\t"
+            "pshufd        $0xd8, %%xmm1, %%xmm1    \n\t"
+            "movdqa              %%xmm0, %%xmm2     \n\t"
+            "punpcklqdq          %%xmm1, %%xmm0     \n\t"
+            "punpckhqdq          %%xmm1, %%xmm2     \n\t"
+            "movdqu              %%xmm0, (%1, %%"REG_a")    \n\t"
+            "movdqu              %%xmm2, (%2, %%"REG_a")    \n\t"
+            "add                    $16, %%"REG_a"  \n\t"
+            "cmp                     %3, %%"REG_a"  \n\t"
+            " jb                     1b             \n\t"
+            :: "r"(src), "r"(dst1), "r"(dst2), "r"((x86_reg)(width & ~7) * 2),
+               "r"(shift)
+            : "memory", XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm4",) "%"REG_a
+        );
+        for (w = width & ~7; w < width; w++) {
+            dst1[w] = src[2 * w + 0] >> shift;
+            dst2[w] = src[2 * w + 1] >> shift;
+        }
+        src  += srcStride;
+        dst1 += dst1Stride;
+        dst2 += dst2Stride;
+    }
+}
+#endif /* COMPILE_TEMPLATE_SSE2 && !COMPILE_TEMPLATE_AVX */
+
 #if !COMPILE_TEMPLATE_SSE2
 #if !COMPILE_TEMPLATE_AMD3DNOW
 static inline void RENAME(vu9_to_vu12)(const uint8_t *src1, const uint8_t *src2,
@@ -2342,8 +2435,8 @@ static void RENAME(extract_even2avg)(const uint8_t *src0, const uint8_t *src1, u
     }
 #endif
     while(count<0) {
-        dst0[count]= (src0[4*count+0]+src1[4*count+0])>>1;
-        dst1[count]= (src0[4*count+2]+src1[4*count+2])>>1;
+        dst0[count]= (src0[4*count+0]+src1[4*count+0]+1)>>1;
+        dst1[count]= (src0[4*count+2]+src1[4*count+2]+1)>>1;
         count++;
     }
 }
@@ -2446,8 +2539,8 @@ static void RENAME(extract_odd2avg)(const uint8_t *src0, const uint8_t *src1, ui
     src0++;
     src1++;
     while(count<0) {
-        dst0[count]= (src0[4*count+0]+src1[4*count+0])>>1;
-        dst1[count]= (src0[4*count+2]+src1[4*count+2])>>1;
+        dst0[count]= (src0[4*count+0]+src1[4*count+0]+1)>>1;
+        dst1[count]= (src0[4*count+2]+src1[4*count+2]+1)>>1;
         count++;
     }
 }
@@ -2600,6 +2693,10 @@ static av_cold void RENAME(rgb2rgb_init)(void)
 #if !COMPILE_TEMPLATE_AMD3DNOW && !COMPILE_TEMPLATE_AVX
     interleaveBytes    = RENAME(interleaveBytes);
 #endif /* !COMPILE_TEMPLATE_AMD3DNOW && !COMPILE_TEMPLATE_AVX */
+#if COMPILE_TEMPLATE_SSE2 && !COMPILE_TEMPLATE_AVX
+    interleaveWords    = RENAME(interleaveWords);
+    deinterleaveWords  = RENAME(deinterleaveWords);
+#endif /* COMPILE_TEMPLATE_SSE2 && !COMPILE_TEMPLATE_AVX */
 #if !COMPILE_TEMPLATE_AVX || HAVE_AVX_EXTERNAL
 #if !COMPILE_TEMPLATE_AMD3DNOW && (ARCH_X86_32 || COMPILE_TEMPLATE_SSE2) && COMPILE_TEMPLATE_MMXEXT == COMPILE_TEMPLATE_SSE2 && HAVE_YASM
     deinterleaveBytes  = RENAME(deinterleaveBytes);
@@ -0,0 +1,246 @@
+;******************************************************************************
+;* x86-optimized horizontal line scaling functions, AVX2 versions
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA 32
+
+max_19bit_int: times 8 dd 0x7ffff
+minshort:      times 16 dw 0x8000
+unicoeff:      times 8 dd 0x20000000
+perm_8tap:     dd 0, 4, 1, 5, 2, 6, 3, 7
+
+SECTION .text
+
+;-----------------------------------------------------------------------------
+; horizontal line scaling
+;
+; void hscale<source_width>to<intermediate_nbits>_<filterSize>_avx2
+;                               (SwsContext *c, int{16,32}_t *dst,
+;                                int dstW, const uint{8,16}_t *src,
+;                                const int16_t *filter,
+;                                const int32_t *filterPos, int filterSize);
+;
+; Same as the versions in scale.asm. The 4- and 8-tap versions generate 8
+; output pixels per iteration, so they write up to 7 pixels past dstW and
+; read as many filterPos and filter entries past the end, which initFilter()
+; pads for. The X8 version generates 2 output pixels per iteration and
+; handles any filterSize which is a multiple of 8.
+;-----------------------------------------------------------------------------
+
+; load the 4 source pixels of 4 output pixels, starting at filterPos[%2],
+; into m%1 as words, using m3 as temporary
+%macro LOAD_4TAP 2
+    mov32      pos0q, dword [fltposq+(%2+0)*4]
+    mov32      pos1q, dword [fltposq+(%2+1)*4]
+%if srcmul == 1
+    movd        xm%1, [srcq+pos0q]
+    pinsrd      xm%1, xm%1, [srcq+pos1q], 1
+    mov32      pos0q, dword [fltposq+(%2+2)*4]
+    mov32      pos1q, dword [fltposq+(%2+3)*4]
+    pinsrd      xm%1, xm%1, [srcq+pos0q], 2
+    pinsrd      xm%1, xm%1, [srcq+pos1q], 3
+    pmovzxbw     m%1, xm%1
+%else ; srcmul == 2
+    movq        xm%1, [srcq+pos0q*2]
+    movhps      xm%1, xm%1, [srcq+pos1q*2]
+    mov32      pos0q, dword [fltposq+(%2+2)*4]
+    mov32      pos1q, dword [fltposq+(%2+3)*4]
+    movq         xm3, [srcq+pos0q*2]
+    movhps       xm3, xm3, [srcq+pos1q*2]
+    vinserti128  m%1, m%1, xm3, 1
+%endif ; srcmul == 1/2
+%endmacro
+
+; load the 8 source pixels of 2 output pixels, starting at filterPos[%2],
+; into m%1 as words
+%macro LOAD_8TAP 2
+    mov32      pos0q, dword [fltposq+(%2+0)*4]
+    mov32      pos1q, dword [fltposq+(%2+1)*4]
+%if srcmul == 1
+    movq        xm%1, [srcq+pos0q]
+    movhps      xm%1, xm%1, [srcq+pos1q]
+    pmovzxbw     m%1, xm%1
+%else ; srcmul == 2
+    movu        xm%1, [srcq+pos0q*2]
+    vinserti128  m%1, m%1, [srcq+pos1q*2], 1
+%endif ; srcmul == 1/2
+%endmacro
+
+; SCALE_FUNC source_width, intermediate_nbits, filtersize
+%macro SCALE_FUNC 3
+%if %1 == 8
+%define srcmul 1
+%else
+%define srcmul 2
+%endif
+%if %2 == 15
+%define dstmul 2
+%else
+%define dstmul 4
+%endif
+
+%ifnidn %3, X8
+cglobal hscale%1to%2_%3, 6, 7, 8, pos0, dst, w, src, filter, fltpos, pos1
+%if ARCH_X86_64
+%define mov32 movsxd
+%else
+%define mov32 mov
+%endif
+%else ; %3 == X8
+cglobal hscale%1to%2_%3, 7, 9, 8, pos0, dst, w, src, filter, fltpos, fltsize, pos1, cnt
+    movsxd  fltsizeq, fltsized
+%endif ; %3 ==/!= X8
+%if %2 == 19
+    mova          m2, [max_19bit_int]
+%endif
+%if %1 == 16
+    mova          m6, [minshort]
+    mova          m7, [unicoeff]
+%endif
+
+%ifidn %3, 4
+.loop:
+    LOAD_4TAP      0, 0
+    LOAD_4TAP      1, 4
+%if %1 == 16 ; pmaddwd needs signed adds, so this moves unsigned -> signed, we'll
+             ; add back 0x8000 * sum(coeffs) after the horizontal add
+    psubw         m0, m6
+    psubw         m1, m6
+%endif ; %1 == 16
+    pmaddwd       m0, [filterq+mmsize*0]        ; dstpix {0,1 | 2,3}
+    pmaddwd       m1, [filterq+mmsize*1]        ; dstpix {4,5 | 6,7}
+    phaddd        m0, m0, m1                    ; dstpix {0,1,4,5 | 2,3,6,7}
+    vpermq        m0, m0, q3120
+%elifidn %3, 8
+    mova          m3, [perm_8tap]
+.loop:
+    LOAD_8TAP      0, 0
+    LOAD_8TAP      1, 2
+    LOAD_8TAP      4, 4
+    LOAD_8TAP      5, 6
+%if %1 == 16
+    psubw         m0, m6
+    psubw         m1, m6
+    psubw         m4, m6
+    psubw         m5, m6
+%endif ; %1 == 16
+    pmaddwd       m0, [filterq+mmsize*0]        ; dstpix {0 | 1}
+    pmaddwd       m1, [filterq+mmsize*1]        ; dstpix {2 | 3}
+    pmaddwd       m4, [filterq+mmsize*2]        ; dstpix {4 | 5}
+    pmaddwd       m5, [filterq+mmsize*3]        ; dstpix {6 | 7}
+    phaddd        m0, m0, m1
+    phaddd        m4, m4, m5
+    phaddd        m0, m0, m4                    ; dstpix {0,2,4,6 | 1,3,5,7}
+    vpermd        m0, m3, m0
+%else ; %3 == X8
+.loop:
+    movsxd     pos0q, dword [fltposq+0]
+    movsxd     pos1q, dword [fltposq+4]
+    lea        pos0q, [srcq+pos0q*srcmul]
+    lea        pos1q, [srcq+pos1q*srcmul]
+    mov         cntq, fltsizeq
+    pxor          m4, m4
+.innerloop:
+%if srcmul == 1
+    movq         xm0, [pos0q]
+    movhps       xm0, xm0, [pos1q]
+    pmovzxbw      m0, xm0
+%else ; srcmul == 2
+    movu         xm0, [pos0q]
+    vinserti128   m0, m0, [pos1q], 1
+%endif ; srcmul == 1/2
+%if %1 == 16
+    psubw         m0, m6
+%endif ; %1 == 16
+    movu         xm1, [filterq]
+    vinserti128   m1, m1, [filterq+fltsizeq*2], 1
+    pmaddwd       m0, m1
+    paddd         m4, m0
+    add        pos0q, 8*srcmul
+    add        pos1q, 8*srcmul
+    add      filterq, 16
+    sub         cntq, 8
+    jg .innerloop
+    lea      filterq, [filterq+fltsizeq*2]      ; skip the taps of dstpix 1
+
+    vextracti128 xm5, m4, 1
+    phaddd       xm4, xm4, xm5
+    phaddd       xm0, xm4, xm4                  ; dstpix {0,1,0,1}
+%endif ; %3 == 4/8/X8
+
+%if %1 == 16 ; add 0x8000 * sum(coeffs), i.e. back from signed -> unsigned
+    paddd         m0, m7
+%endif ; %1 == 16
+
+    ; clip, store
+    psrad         m0, 14 + %1 - %2
+%ifidn %3, X8
+%if %2 == 15
+    packssdw     xm0, xm0, xm0
+    movd      [dstq], xm0
+%else ; %2 == 19
+    pminsd       xm0, xm2
+    movq      [dstq], xm0
+%endif ; %2 == 15/19
+    add      fltposq, 2*4
+    add         dstq, 2*dstmul
+    sub           wd, 2
+%else ; %3 == 4/8
+%if %2 == 15
+    vextracti128 xm1, m0, 1
+    packssdw     xm0, xm0, xm1
+    movu      [dstq], xm0
+%else ; %2 == 19
+    pminsd        m0, m2
+    movu      [dstq], m0
+%endif ; %2 == 15/19
+    add      filterq, 8*%3*2
+    add      fltposq, 8*4
+    add         dstq, 8*dstmul
+    sub           wd, 8
+%endif ; %3 ==/!= X8
+    jg .loop
+    RET
+%endmacro
+
+; SCALE_FUNCS source_width, intermediate_nbits
+%macro SCALE_FUNCS 2
+SCALE_FUNC %1, %2, 4
+SCALE_FUNC %1, %2, 8
+%if ARCH_X86_64
+SCALE_FUNC %1, %2, X8
+%endif
+%endmacro
+
+%macro SCALE_FUNCS2 1
+SCALE_FUNCS  8, %1
+SCALE_FUNCS  9, %1
+SCALE_FUNCS 10, %1
+SCALE_FUNCS 12, %1
+SCALE_FUNCS 14, %1
+SCALE_FUNCS 16, %1
+%endmacro
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+SCALE_FUNCS2 15
+SCALE_FUNCS2 19
+%endif
@@ -316,6 +316,9 @@ SCALE_FUNCS_MMX(mmx);
 SCALE_FUNCS_SSE(sse2);
 SCALE_FUNCS_SSE(ssse3);
 SCALE_FUNCS_SSE(sse4);
+SCALE_FUNCS(4, avx2);
+SCALE_FUNCS(8, avx2);
+SCALE_FUNCS(X8, avx2);
 
 #define VSCALEX_FUNC(size, opt) \
 void ff_yuv2planeX_ ## size ## _ ## opt(const int16_t *filter, int filterSize, \
@@ -324,7 +327,9 @@ void ff_yuv2planeX_ ## size ## _ ## opt(const int16_t *filter, int filterSize, \
 #define VSCALEX_FUNCS(opt) \
     VSCALEX_FUNC(8,  opt); \
     VSCALEX_FUNC(9,  opt); \
-    VSCALEX_FUNC(10, opt)
+    VSCALEX_FUNC(10, opt); \
+    VSCALEX_FUNC(12, opt); \
+    VSCALEX_FUNC(14, opt)
 
 #if ARCH_X86_32
 VSCALEX_FUNCS(mmxext);
@@ -333,6 +338,11 @@ VSCALEX_FUNCS(sse2);
 VSCALEX_FUNCS(sse4);
 VSCALEX_FUNC(16, sse4);
 VSCALEX_FUNCS(avx);
+VSCALEX_FUNC(9,  avx2);
+VSCALEX_FUNC(10, avx2);
+VSCALEX_FUNC(12, avx2);
+VSCALEX_FUNC(14, avx2);
+VSCALEX_FUNC(16, avx2);
 
 #define VSCALE_FUNC(size, opt) \
 void ff_yuv2plane1_ ## size ## _ ## opt(const int16_t *src, uint8_t *dst, int dstW, \
@@ -341,6 +351,8 @@ void ff_yuv2plane1_ ## size ## _ ## opt(const int16_t *src, uint8_t *dst, int ds
     VSCALE_FUNC(8,  opt1); \
     VSCALE_FUNC(9,  opt2); \
     VSCALE_FUNC(10, opt2); \
+    VSCALE_FUNC(12, opt2); \
+    VSCALE_FUNC(14, opt2); \
     VSCALE_FUNC(16, opt1)
 
 #if ARCH_X86_32
@@ -349,6 +361,7 @@ VSCALE_FUNCS(mmx, mmxext);
 VSCALE_FUNCS(sse2, sse2);
 VSCALE_FUNC(16, sse4);
 VSCALE_FUNCS(avx, avx);
+VSCALE_FUNCS(avx2, avx2);
 
 #define INPUT_Y_FUNC(fmt, opt) \
 void ff_ ## fmt ## ToY_  ## opt(uint8_t *dst, const uint8_t *src, \
@@ -430,14 +443,18 @@ av_cold void ff_sws_init_swscale_x86(SwsContext *c)
 #define ASSIGN_VSCALEX_FUNC(vscalefn, opt, do_16_case, condition_8bit) \
 switch(c->dstBpc){ \
     case 16:                          do_16_case;                          break; \
-    case 10: if (!isBE(c->dstFormat)) vscalefn = ff_yuv2planeX_10_ ## opt; break; \
+    case 14: if (!isBE(c->dstFormat)) vscalefn = ff_yuv2planeX_14_ ## opt; break; \
+    case 12: if (!isBE(c->dstFormat)) vscalefn = ff_yuv2planeX_12_ ## opt; break; \
+    case 10: if (!isBE(c->dstFormat) && c->dstFormat != AV_PIX_FMT_P010LE) vscalefn = ff_yuv2planeX_10_ ## opt; break; \
     case 9:  if (!isBE(c->dstFormat)) vscalefn = ff_yuv2planeX_9_  ## opt; break; \
     case 8: if ((condition_8bit) && !c->use_mmx_vfilter) vscalefn = ff_yuv2planeX_8_  ## opt; break; \
     }
 #define ASSIGN_VSCALE_FUNC(vscalefn, opt1, opt2, opt2chk) \
     switch(c->dstBpc){ \
     case 16: if (!isBE(c->dstFormat))            vscalefn = ff_yuv2plane1_16_ ## opt1; break; \
-    case 10: if (!isBE(c->dstFormat) && opt2chk) vscalefn = ff_yuv2plane1_10_ ## opt2; break; \
+    case 14: if (!isBE(c->dstFormat) && opt2chk) vscalefn = ff_yuv2plane1_14_ ## opt2; break; \
+    case 12: if (!isBE(c->dstFormat) && opt2chk) vscalefn = ff_yuv2plane1_12_ ## opt2; break; \
+    case 10: if (!isBE(c->dstFormat) && c->dstFormat != AV_PIX_FMT_P010LE && opt2chk) vscalefn = ff_yuv2plane1_10_ ## opt2; break; \
     case 9:  if (!isBE(c->dstFormat) && opt2chk) vscalefn = ff_yuv2plane1_9_  ## opt2;  break; \
     case 8:                                      vscalefn = ff_yuv2plane1_8_  ## opt1;  break; \
     default: av_assert0(c->dstBpc>8); \
@@ -582,4 +599,30 @@ switch(c->dstBpc){ \
             break;
         }
     }
+
+#define ASSIGN_AVX2_SCALE_FUNC(hscalefn, filtersize) \
+    switch (filtersize) { \
+    case 4:  ASSIGN_SCALE_FUNC2(hscalefn, 4, avx2, avx2); break; \
+    case 8:  ASSIGN_SCALE_FUNC2(hscalefn, 8, avx2, avx2); break; \
+    default: if (ARCH_X86_64 && !(filtersize & 4)) \
+                 ASSIGN_SCALE_FUNC2(hscalefn, X8, avx2, avx2); \
+             break; \
+    }
+    if (EXTERNAL_AVX2_FAST(cpu_flags)) {
+        ASSIGN_AVX2_SCALE_FUNC(c->hyScale, c->hLumFilterSize);
+        ASSIGN_AVX2_SCALE_FUNC(c->hcScale, c->hChrFilterSize);
+        /* the dithered 8-bit yuv2planeX has no avx2 version */
+        if (!isBE(c->dstFormat)) {
+            switch (c->dstBpc) {
+            case 16: c->yuv2planeX = ff_yuv2planeX_16_avx2; break;
+            case 14: c->yuv2planeX = ff_yuv2planeX_14_avx2; break;
+            case 12: c->yuv2planeX = ff_yuv2planeX_12_avx2; break;
+            case 10: if (c->dstFormat != AV_PIX_FMT_P010LE)
+                         c->yuv2planeX = ff_yuv2planeX_10_avx2;
+                     break;
+            case 9:  c->yuv2planeX = ff_yuv2planeX_9_avx2;  break;
+            }
+        }
+        ASSIGN_VSCALE_FUNC(c->yuv2plane1, avx2, avx2, 1);
+    }
 }
@@ -0,0 +1,99 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/avf_showcqt.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+
+#define FFT_LEN  1024
+#define PAD      64
+#define NB_BINS  24
+#define MAX_LEN  256
+#define ALIGN    8   /* a multiple of the cqt_align of all the versions */
+
+#define randomf() ((float)(rnd() & 0xffff) / 0x8000 - 1.0f)
+
+static void check_cqt_calc(void (*func)(FFTComplex *dst, const FFTComplex *src,
+                                        const Coeffs *coeffs, int len, int fft_len))
+{
+    LOCAL_ALIGNED_32(FFTComplex, buf,  [FFT_LEN + 2 * PAD]);
+    LOCAL_ALIGNED_32(FFTComplex, dst0, [NB_BINS]);
+    LOCAL_ALIGNED_32(FFTComplex, dst1, [NB_BINS]);
+    LOCAL_ALIGNED_32(float, vals, [NB_BINS], [MAX_LEN]);
+    FFTComplex *src = buf + PAD;
+    Coeffs coeffs[NB_BINS];
+    declare_func(void, FFTComplex *dst, const FFTComplex *src,
+                 const Coeffs *coeffs, int len, int fft_len);
+
+    if (check_func(func, "cqt_calc")) {
+        int i, k;
+
+        /* the padding is read with zero coefficients, as in the filter */
+        memset(buf, 0, sizeof(buf[0]) * (FFT_LEN + 2 * PAD));
+        for (i = 0; i <= FFT_LEN; i++) {
+            src[i].re = randomf();
+            src[i].im = randomf();
+        }
+        for (k = 0; k < NB_BINS; k++) {
+            int start, len;
+
+            switch (k % 4) {
+            case 0: /* bin above the nyquist frequency */
+                start = len = 0;
+                break;
+            case 1: /* the mirrored reads go below src[0] */
+                start = FFT_LEN;
+                len   = ALIGN;
+                break;
+            default:
+                len   = ALIGN * (1 + rnd() % (MAX_LEN / ALIGN));
+                start = k % 4 == 2 ? 0 : (rnd() % (FFT_LEN - MAX_LEN)) & ~(ALIGN - 1);
+            }
+            coeffs[k].val   = len ? vals[k] : NULL;
+            coeffs[k].start = start;
+            coeffs[k].len   = len;
+            for (i = 0; i < len; i++)
+                vals[k][i] = start + i > FFT_LEN ? 0.0f : randomf() / len;
+        }
+
+        call_ref(dst0, src, coeffs, NB_BINS, FFT_LEN);
+        call_new(dst1, src, coeffs, NB_BINS, FFT_LEN);
+        if (!float_near_abs_eps_array((float *)dst0, (float *)dst1, 1e-5f, 2 * NB_BINS))
+            fail();
+
+        memcpy(dst0, dst1, sizeof(dst0[0]) * NB_BINS);
+        call_new(dst1, src, coeffs, 0, FFT_LEN);
+        if (memcmp(dst0, dst1, sizeof(dst0[0]) * NB_BINS))
+            fail();
+
+        bench_new(dst1, src, coeffs, NB_BINS, FFT_LEN);
+    }
+}
+
+void checkasm_check_showcqt(void)
+{
+    ShowCQTContext s = { 0 };
+
+    ff_showcqt_init_cqt_calc(&s);
+
+    check_cqt_calc(s.cqt_calc);
+    report("cqt_calc");
+}
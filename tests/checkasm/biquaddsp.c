@@ -0,0 +1,178 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <math.h>
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/biquaddsp.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+
+#define MAX_SECTIONS 4
+#define BUF_SIZE     (BIQUAD_BLOCK_SIZE * 32)
+
+#define randomf() ((double)(rnd() & 0xffff) / 0x8000 - 1.0)
+
+/* stable second order denominator 1 + a1 z^-1 + a2 z^-2, poles of radius
+ * up to 0.8 */
+static void random_poles(double *a1, double *a2)
+{
+    const double r = 0.8 * (rnd() & 0xffff) / 0xffff;
+    const double w = M_PI * (rnd() & 0xffff) / 0xffff;
+
+    *a1 = -2 * r * cos(w);
+    *a2 = r * r;
+}
+
+#define CHECK_BIQUAD(type, lanes, eps, check_array)                              \
+    do {                                                                          \
+        LOCAL_ALIGNED_32(type, buf0,    [BUF_SIZE / sizeof(type)]);               \
+        LOCAL_ALIGNED_32(type, buf1,    [BUF_SIZE / sizeof(type)]);               \
+        LOCAL_ALIGNED_32(type, state0,  [MAX_SECTIONS * 4 * lanes]);              \
+        LOCAL_ALIGNED_32(type, state1,  [MAX_SECTIONS * 4 * lanes]);              \
+        LOCAL_ALIGNED_32(type, coeffs,  [MAX_SECTIONS * 5 * lanes]);              \
+        static const int sections[] = { 1, MAX_SECTIONS };                        \
+        static const int lens[]     = { 1, 37, BIQUAD_BLOCK_SIZE };               \
+        int i, j, s, l;                                                           \
+                                                                                  \
+        declare_func(void, type *buf, type *state, const type *coeffs,            \
+                     int nb_sections, int len);                                   \
+                                                                                  \
+        for (s = 0; s < MAX_SECTIONS; s++) {                                      \
+            for (l = 0; l < lanes; l++) {                                         \
+                double a1, a2;                                                    \
+                                                                                  \
+                random_poles(&a1, &a2);                                           \
+                coeffs[(5 * s + 0) * lanes + l] = randomf();                      \
+                coeffs[(5 * s + 1) * lanes + l] = randomf();                      \
+                coeffs[(5 * s + 2) * lanes + l] = randomf();                      \
+                coeffs[(5 * s + 3) * lanes + l] = -a1;                            \
+                coeffs[(5 * s + 4) * lanes + l] = -a2;                            \
+            }                                                                     \
+        }                                                                         \
+                                                                                  \
+        for (i = 0; i < FF_ARRAY_ELEMS(sections); i++) {                          \
+            for (j = 0; j < FF_ARRAY_ELEMS(lens); j++) {                          \
+                const int size = lens[j] * lanes;                                 \
+                                                                                  \
+                for (l = 0; l < size; l++)                                        \
+                    buf0[l] = randomf();                                          \
+                for (l = 0; l < MAX_SECTIONS * 4 * lanes; l++)                    \
+                    state0[l] = randomf();                                        \
+                memcpy(buf1,   buf0,   size * sizeof(*buf0));                     \
+                memcpy(state1, state0, MAX_SECTIONS * 4 * lanes * sizeof(*state0)); \
+                                                                                  \
+                call_ref(buf0, state0, coeffs, sections[i], lens[j]);             \
+                call_new(buf1, state1, coeffs, sections[i], lens[j]);             \
+                if (!check_array(buf0, buf1, eps, size) ||                        \
+                    !check_array(state0, state1, eps, MAX_SECTIONS * 4 * lanes))  \
+                    fail();                                                       \
+            }                                                                     \
+        }                                                                         \
+        bench_new(buf1, state1, coeffs, MAX_SECTIONS, BIQUAD_BLOCK_SIZE);         \
+    } while (0)
+
+static void check_biquad_flt(void (*func)(float *buf, float *state, const float *coeffs,
+                                          int nb_sections, int len))
+{
+    if (check_func(func, "biquad_flt"))
+        CHECK_BIQUAD(float, BIQUAD_LANES_FLT, 1e-4, float_near_abs_eps_array);
+}
+
+static void check_biquad_dbl(void (*func)(double *buf, double *state, const double *coeffs,
+                                          int nb_sections, int len))
+{
+    if (check_func(func, "biquad_dbl"))
+        CHECK_BIQUAD(double, BIQUAD_LANES_DBL, 1e-12, double_near_abs_eps_array);
+}
+
+static void check_fourth_order_dbl(void (*func)(double *buf, double *state,
+                                                const double *coeffs,
+                                                int nb_sections, int len))
+{
+    const int lanes = BIQUAD_LANES_DBL;
+    LOCAL_ALIGNED_32(double, buf0,   [BUF_SIZE / sizeof(double)]);
+    LOCAL_ALIGNED_32(double, buf1,   [BUF_SIZE / sizeof(double)]);
+    LOCAL_ALIGNED_32(double, state0, [MAX_SECTIONS * 8 * BIQUAD_LANES_DBL]);
+    LOCAL_ALIGNED_32(double, state1, [MAX_SECTIONS * 8 * BIQUAD_LANES_DBL]);
+    LOCAL_ALIGNED_32(double, coeffs, [MAX_SECTIONS * 9 * BIQUAD_LANES_DBL]);
+    declare_func(void, double *buf, double *state, const double *coeffs,
+                 int nb_sections, int len);
+
+    if (check_func(func, "fourth_order_dbl")) {
+        static const int sections[] = { 1, MAX_SECTIONS };
+        static const int lens[]     = { 1, 37, BIQUAD_BLOCK_SIZE };
+        int i, j, k, s, l;
+
+        /* the denominators are products of two stable second order ones */
+        for (s = 0; s < MAX_SECTIONS; s++) {
+            for (l = 0; l < lanes; l++) {
+                double *c = coeffs + 9 * lanes * s + l;
+                double p1, p2, q1, q2;
+
+                random_poles(&p1, &p2);
+                random_poles(&q1, &q2);
+                c[0] = randomf();
+                for (k = 1; k < 5; k++)
+                    c[(2 * k - 1) * lanes] = randomf();
+                c[2 * lanes] = p1 + q1;
+                c[4 * lanes] = p2 + q2 + p1 * q1;
+                c[6 * lanes] = p1 * q2 + p2 * q1;
+                c[8 * lanes] = p2 * q2;
+            }
+        }
+
+        for (i = 0; i < FF_ARRAY_ELEMS(sections); i++) {
+            for (j = 0; j < FF_ARRAY_ELEMS(lens); j++) {
+                const int size = lens[j] * lanes;
+
+                for (l = 0; l < size; l++)
+                    buf0[l] = randomf();
+                for (l = 0; l < MAX_SECTIONS * 8 * lanes; l++)
+                    state0[l] = randomf();
+                memcpy(buf1,   buf0,   size * sizeof(*buf0));
+                memcpy(state1, state0, MAX_SECTIONS * 8 * lanes * sizeof(*state0));
+
+                call_ref(buf0, state0, coeffs, sections[i], lens[j]);
+                call_new(buf1, state1, coeffs, sections[i], lens[j]);
+                if (!double_near_abs_eps_array(buf0, buf1, 1e-12, size) ||
+                    !double_near_abs_eps_array(state0, state1, 1e-12,
+                                               MAX_SECTIONS * 8 * lanes))
+                    fail();
+            }
+        }
+        bench_new(buf1, state1, coeffs, MAX_SECTIONS, BIQUAD_BLOCK_SIZE);
+    }
+}
+
+void checkasm_check_biquaddsp(void)
+{
+    BiquadDSPContext dsp;
+
+    ff_biquaddsp_init(&dsp);
+
+    check_biquad_flt(dsp.biquad_flt);
+    report("biquad_flt");
+
+    check_biquad_dbl(dsp.biquad_dbl);
+    report("biquad_dbl");
+
+    check_fourth_order_dbl(dsp.fourth_order_dbl);
+    report("fourth_order_dbl");
+}
@@ -103,12 +103,49 @@ static const struct {
     #endif
 #endif
 #if CONFIG_AVFILTER
+    { "drawutils", checkasm_check_drawutils },
+    #if CONFIG_SHOWCQT_FILTER
+        { "avf_showcqt", checkasm_check_showcqt },
+    #endif
+    #if CONFIG_BIQUADDSP
+        { "biquaddsp", checkasm_check_biquaddsp },
+    #endif
+    #if CONFIG_EBUR128_FILTER
+        { "f_ebur128", checkasm_check_ebur128 },
+    #endif
     #if CONFIG_BLEND_FILTER
         { "vf_blend", checkasm_check_blend },
     #endif
+    #if CONFIG_BOXBLUR_FILTER
+        { "vf_boxblur", checkasm_check_boxblur },
+    #endif
     #if CONFIG_COLORSPACE_FILTER
         { "vf_colorspace", checkasm_check_colorspace },
     #endif
+    #if CONFIG_CONVOLUTION_FILTER
+        { "vf_convolution", checkasm_check_convolution },
+    #endif
+    #if CONFIG_NNEDI_FILTER
+        { "vf_nnedi", checkasm_check_nnedi },
+    #endif
+    #if CONFIG_OVERLAY_FILTER
+        { "vf_overlay", checkasm_check_overlay },
+    #endif
+    #if CONFIG_PALETTEUSE_FILTER
+        { "vf_paletteuse", checkasm_check_paletteuse },
+    #endif
+    #if CONFIG_UNSHARP_FILTER
+        { "vf_unsharp", checkasm_check_unsharp },
+    #endif
+#endif
+#if CONFIG_SWSCALE
+    { "sw_rgb", checkasm_check_sw_rgb },
+    { "sw_scale", checkasm_check_sw_scale },
+#endif
+#if CONFIG_SWRESAMPLE
+    { "sw_audioconvert", checkasm_check_sw_audioconvert },
+    { "sw_rematrix", checkasm_check_sw_rematrix },
+    { "sw_resample", checkasm_check_sw_resample },
 #endif
     { NULL }
 };
@@ -262,6 +299,25 @@ int float_near_abs_eps_array_ulp(const float *a, const float *b, float eps,
     return 1;
 }
 
+int double_near_abs_eps(double a, double b, double eps)
+{
+    double abs_diff = fabs(a - b);
+
+    return abs_diff < eps;
+}
+
+int double_near_abs_eps_array(const double *a, const double *b, double eps,
+                              unsigned len)
+{
+    unsigned i;
+
+    for (i = 0; i < len; i++) {
+        if (!double_near_abs_eps(a[i], b[i], eps))
+            return 0;
+    }
+    return 1;
+}
+
 /* Print colored text to stderr if the terminal supports it */
 static void color_printf(int color, const char *fmt, ...)
 {
@@ -31,16 +31,31 @@
 #include "libavutil/timer.h"
 
 void checkasm_check_alacdsp(void);
+void checkasm_check_biquaddsp(void);
 void checkasm_check_blend(void);
+void checkasm_check_boxblur(void);
 void checkasm_check_bswapdsp(void);
 void checkasm_check_colorspace(void);
+void checkasm_check_convolution(void);
+void checkasm_check_drawutils(void);
+void checkasm_check_ebur128(void);
 void checkasm_check_flacdsp(void);
 void checkasm_check_fmtconvert(void);
 void checkasm_check_h264pred(void);
 void checkasm_check_h264qpel(void);
 void checkasm_check_jpeg2000dsp(void);
+void checkasm_check_nnedi(void);
+void checkasm_check_overlay(void);
+void checkasm_check_paletteuse(void);
 void checkasm_check_pixblockdsp(void);
+void checkasm_check_showcqt(void);
 void checkasm_check_synth_filter(void);
+void checkasm_check_sw_audioconvert(void);
+void checkasm_check_sw_rematrix(void);
+void checkasm_check_sw_resample(void);
+void checkasm_check_sw_rgb(void);
+void checkasm_check_sw_scale(void);
+void checkasm_check_unsharp(void);
 void checkasm_check_v210enc(void);
 void checkasm_check_vp9dsp(void);
 void checkasm_check_videodsp(void);
@@ -61,6 +76,9 @@ int float_near_abs_eps_array(const float *a, const float *b, float eps,
                              unsigned len);
 int float_near_abs_eps_array_ulp(const float *a, const float *b, float eps,
                                  unsigned max_ulp, unsigned len);
+int double_near_abs_eps(double a, double b, double eps);
+int double_near_abs_eps_array(const double *a, const double *b, double eps,
+                              unsigned len);
 
 extern AVLFG checkasm_lfg;
 #define rnd() av_lfg_get(&checkasm_lfg)
@@ -0,0 +1,127 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/drawutils.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+
+#define WIDTH 264
+
+static const int widths[] = { 1, 8, 21, WIDTH };
+
+/* the range of alpha used by ff_blend_mask() for 8 bits formats */
+static unsigned rnd_alpha(void)
+{
+    return (0x10307 * (rnd() & 0xff) + 0x3) >> 8;
+}
+
+static void randomize_buffer(uint8_t *buf, int size)
+{
+    int i;
+
+    for (i = 0; i < size; i++)
+        buf[i] = rnd();
+}
+
+static void check_blend_row8(int (*func)(uint8_t *dst, const uint8_t *mask, int w,
+                                         unsigned src, unsigned alpha))
+{
+    LOCAL_ALIGNED_32(uint8_t, orig, [WIDTH]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [WIDTH]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [WIDTH]);
+    LOCAL_ALIGNED_32(uint8_t, mask, [WIDTH]);
+    unsigned src = 0, alpha = 0;
+    declare_func(int, uint8_t *dst, const uint8_t *mask, int w,
+                 unsigned src, unsigned alpha);
+
+    if (check_func(func, "blend_row8")) {
+        int i;
+
+        for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+            int w = widths[i], ret0, ret1;
+
+            src   = rnd() & 0xff;
+            alpha = rnd_alpha();
+            randomize_buffer(orig, WIDTH);
+            randomize_buffer(mask, WIDTH);
+            memcpy(dst0, orig, WIDTH);
+            memcpy(dst1, orig, WIDTH);
+
+            ret0 = call_ref(dst0, mask, w, src, alpha);
+            ret1 = call_new(dst1, mask, w, src, alpha);
+            if (ret0 != w || ret1 > w || ret1 < w - 16 ||
+                memcmp(dst0, dst1, ret1) ||
+                memcmp(dst1 + ret1, orig + ret1, WIDTH - ret1))
+                fail();
+        }
+        bench_new(dst1, mask, WIDTH, src, alpha);
+    }
+}
+
+static void check_blend_row8_2x2(int (*func)(uint8_t *dst, const uint8_t *mask,
+                                             ptrdiff_t mask_linesize, int w,
+                                             unsigned src, unsigned alpha))
+{
+    LOCAL_ALIGNED_32(uint8_t, orig, [WIDTH]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [WIDTH]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [WIDTH]);
+    LOCAL_ALIGNED_32(uint8_t, mask, [4 * WIDTH]);
+    unsigned src = 0, alpha = 0;
+    declare_func(int, uint8_t *dst, const uint8_t *mask, ptrdiff_t mask_linesize,
+                 int w, unsigned src, unsigned alpha);
+
+    if (check_func(func, "blend_row8_2x2")) {
+        int i;
+
+        for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+            int w = widths[i], ret0, ret1;
+
+            src   = rnd() & 0xff;
+            alpha = rnd_alpha();
+            randomize_buffer(orig, WIDTH);
+            randomize_buffer(mask, 4 * WIDTH);
+            memcpy(dst0, orig, WIDTH);
+            memcpy(dst1, orig, WIDTH);
+
+            ret0 = call_ref(dst0, mask, 2 * WIDTH, w, src, alpha);
+            ret1 = call_new(dst1, mask, 2 * WIDTH, w, src, alpha);
+            if (ret0 != w || ret1 > w || ret1 < w - 16 ||
+                memcmp(dst0, dst1, ret1) ||
+                memcmp(dst1 + ret1, orig + ret1, WIDTH - ret1))
+                fail();
+        }
+        bench_new(dst1, mask, 2 * WIDTH, WIDTH, src, alpha);
+    }
+}
+
+void checkasm_check_drawutils(void)
+{
+    FFDrawContext draw;
+
+    if (ff_draw_init(&draw, AV_PIX_FMT_YUV420P, 0) < 0)
+        return;
+
+    check_blend_row8(draw.blend_row8);
+    report("blend_row8");
+
+    check_blend_row8_2x2(draw.blend_row8_2x2);
+    report("blend_row8_2x2");
+}
@@ -0,0 +1,128 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/ebur128.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+
+#define MAX_CHANNELS 8
+#define NB_SAMPLES   64
+#define TP_HISTORY   (EBUR128_TP_TAPS - 1)
+#define TP_LEN       480
+#define EPS          1e-9
+
+#define randomd() ((double)(rnd() & 0xffff) / 0x8000 - 1.0)
+
+static void randomize_buf(double *buf, int len)
+{
+    int i;
+
+    for (i = 0; i < len; i++)
+        buf[i] = randomd();
+}
+
+static void check_filter_channels(void (*func)(double *state, const double *samples,
+                                               double *cache_400, double *cache_3000,
+                                               double *sum_400, double *sum_3000,
+                                               int nb_channels, int nb_samples))
+{
+    LOCAL_ALIGNED_32(double, state0, [6 * EBUR128_STATE_STRIDE]);
+    LOCAL_ALIGNED_32(double, state1, [6 * EBUR128_STATE_STRIDE]);
+    LOCAL_ALIGNED_32(double, samples, [NB_SAMPLES * MAX_CHANNELS]);
+    LOCAL_ALIGNED_32(double, cache0, [2], [NB_SAMPLES * MAX_CHANNELS]);
+    LOCAL_ALIGNED_32(double, cache1, [2], [NB_SAMPLES * MAX_CHANNELS]);
+    LOCAL_ALIGNED_32(double, sum0, [2], [MAX_CHANNELS]);
+    LOCAL_ALIGNED_32(double, sum1, [2], [MAX_CHANNELS]);
+    declare_func(void, double *state, const double *samples,
+                 double *cache_400, double *cache_3000,
+                 double *sum_400, double *sum_3000,
+                 int nb_channels, int nb_samples);
+
+    if (check_func(func, "filter_channels")) {
+        /* vector only, scalar only, and both */
+        static const int channels[] = { 4, 1, 7, MAX_CHANNELS };
+        int i;
+
+        for (i = 0; i < FF_ARRAY_ELEMS(channels); i++) {
+            const int nb_channels = channels[i];
+            const int len = NB_SAMPLES * nb_channels;
+
+            randomize_buf(state0, 6 * EBUR128_STATE_STRIDE);
+            randomize_buf(samples, len);
+            randomize_buf(cache0[0], len);
+            randomize_buf(cache0[1], len);
+            randomize_buf(sum0[0], nb_channels);
+            randomize_buf(sum0[1], nb_channels);
+            memcpy(state1, state0, sizeof(*state0) * 6 * EBUR128_STATE_STRIDE);
+            memcpy(cache1, cache0, sizeof(cache0[0]) * 2);
+            memcpy(sum1,   sum0,   sizeof(sum0[0])   * 2);
+
+            call_ref(state0, samples, cache0[0], cache0[1], sum0[0], sum0[1],
+                     nb_channels, NB_SAMPLES);
+            call_new(state1, samples, cache1[0], cache1[1], sum1[0], sum1[1],
+                     nb_channels, NB_SAMPLES);
+            if (!double_near_abs_eps_array(state0, state1, EPS, 6 * EBUR128_STATE_STRIDE) ||
+                !double_near_abs_eps_array(cache0[0], cache1[0], EPS, len) ||
+                !double_near_abs_eps_array(cache0[1], cache1[1], EPS, len) ||
+                !double_near_abs_eps_array(sum0[0], sum1[0], EPS, nb_channels) ||
+                !double_near_abs_eps_array(sum0[1], sum1[1], EPS, nb_channels))
+                fail();
+        }
+        bench_new(state1, samples, cache1[0], cache1[1], sum1[0], sum1[1],
+                  2, NB_SAMPLES * MAX_CHANNELS / 2);
+    }
+}
+
+static void check_true_peak(double (*func)(const double *src, const double *coeffs,
+                                           int nb_samples))
+{
+    LOCAL_ALIGNED_32(double, buf, [TP_HISTORY + TP_LEN]);
+    LOCAL_ALIGNED_32(double, coeffs, [EBUR128_TP_TAPS * EBUR128_TP_PHASES]);
+    declare_func(double, const double *src, const double *coeffs, int nb_samples);
+
+    if (check_func(func, "true_peak")) {
+        static const int lens[] = { 0, 1, 37, TP_LEN };
+        int i;
+
+        randomize_buf(buf, TP_HISTORY + TP_LEN);
+        randomize_buf(coeffs, EBUR128_TP_TAPS * EBUR128_TP_PHASES);
+        for (i = 0; i < FF_ARRAY_ELEMS(lens); i++) {
+            if (!double_near_abs_eps(call_ref(buf + TP_HISTORY, coeffs, lens[i]),
+                                     call_new(buf + TP_HISTORY, coeffs, lens[i]),
+                                     EPS))
+                fail();
+        }
+        bench_new(buf + TP_HISTORY, coeffs, TP_LEN);
+    }
+}
+
+void checkasm_check_ebur128(void)
+{
+    EBUR128DSPContext dsp;
+
+    ff_ebur128_init_dsp(&dsp);
+
+    check_filter_channels(dsp.filter_channels);
+    report("filter_channels");
+
+    check_true_peak(dsp.true_peak);
+    report("true_peak");
+}
@@ -0,0 +1,192 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/mem.h"
+#include "libavutil/samplefmt.h"
+
+#include "libswresample/audioconvert.h"
+
+#include "checkasm.h"
+
+#define MAX_SAMPLES  1024
+#define MAX_CHANNELS 8
+#define PLANE_SIZE   (MAX_SAMPLES * 4)
+#define BUF_SIZE     (MAX_CHANNELS * PLANE_SIZE)
+
+typedef struct ConvertCase {
+    enum AVSampleFormat out_fmt, in_fmt;
+    int channels;
+} ConvertCase;
+
+/* The conversions with SIMD versions. Conversions keeping the layout are
+ * done plane by plane, so they are tested as mono. */
+static const ConvertCase cases[] = {
+    { AV_SAMPLE_FMT_S32P, AV_SAMPLE_FMT_S16P, 1 },
+    { AV_SAMPLE_FMT_S16P, AV_SAMPLE_FMT_S32P, 1 },
+    { AV_SAMPLE_FMT_FLTP, AV_SAMPLE_FMT_S32P, 1 },
+    { AV_SAMPLE_FMT_FLTP, AV_SAMPLE_FMT_S16P, 1 },
+    { AV_SAMPLE_FMT_S32P, AV_SAMPLE_FMT_FLTP, 1 },
+    { AV_SAMPLE_FMT_S16P, AV_SAMPLE_FMT_FLTP, 1 },
+
+    { AV_SAMPLE_FMT_FLT,  AV_SAMPLE_FMT_FLTP, 2 },
+    { AV_SAMPLE_FMT_S16,  AV_SAMPLE_FMT_S16P, 2 },
+    { AV_SAMPLE_FMT_S32,  AV_SAMPLE_FMT_S16P, 2 },
+    { AV_SAMPLE_FMT_S16,  AV_SAMPLE_FMT_S32P, 2 },
+    { AV_SAMPLE_FMT_FLT,  AV_SAMPLE_FMT_S32P, 2 },
+    { AV_SAMPLE_FMT_S32,  AV_SAMPLE_FMT_FLTP, 2 },
+    { AV_SAMPLE_FMT_FLT,  AV_SAMPLE_FMT_S16P, 2 },
+    { AV_SAMPLE_FMT_S16,  AV_SAMPLE_FMT_FLTP, 2 },
+    { AV_SAMPLE_FMT_FLTP, AV_SAMPLE_FMT_FLT,  2 },
+    { AV_SAMPLE_FMT_S16P, AV_SAMPLE_FMT_S16,  2 },
+    { AV_SAMPLE_FMT_S32P, AV_SAMPLE_FMT_S16,  2 },
+    { AV_SAMPLE_FMT_S16P, AV_SAMPLE_FMT_S32,  2 },
+    { AV_SAMPLE_FMT_FLTP, AV_SAMPLE_FMT_S32,  2 },
+    { AV_SAMPLE_FMT_S32P, AV_SAMPLE_FMT_FLT,  2 },
+    { AV_SAMPLE_FMT_FLTP, AV_SAMPLE_FMT_S16,  2 },
+    { AV_SAMPLE_FMT_S16P, AV_SAMPLE_FMT_FLT,  2 },
+
+    { AV_SAMPLE_FMT_FLT,  AV_SAMPLE_FMT_FLTP, 6 },
+    { AV_SAMPLE_FMT_FLT,  AV_SAMPLE_FMT_S32P, 6 },
+    { AV_SAMPLE_FMT_S32,  AV_SAMPLE_FMT_FLTP, 6 },
+    { AV_SAMPLE_FMT_FLTP, AV_SAMPLE_FMT_FLT,  6 },
+    { AV_SAMPLE_FMT_FLTP, AV_SAMPLE_FMT_S32,  6 },
+    { AV_SAMPLE_FMT_S32P, AV_SAMPLE_FMT_FLT,  6 },
+
+    { AV_SAMPLE_FMT_FLT,  AV_SAMPLE_FMT_FLTP, 8 },
+    { AV_SAMPLE_FMT_FLT,  AV_SAMPLE_FMT_S32P, 8 },
+    { AV_SAMPLE_FMT_S32,  AV_SAMPLE_FMT_FLTP, 8 },
+};
+
+/* the C converter of the case being tested */
+static const ConvertCase *cur_case;
+static AudioConvert *ref_conv;
+
+static void fill_audio_data(AudioData *a, uint8_t **data,
+                            enum AVSampleFormat fmt, int channels)
+{
+    int i;
+
+    memset(a, 0, sizeof(*a));
+    a->ch_count = channels;
+    a->bps      = av_get_bytes_per_sample(fmt);
+    a->planar   = av_sample_fmt_is_planar(fmt);
+    a->fmt      = fmt;
+    for (i = 0; i < channels; i++)
+        a->ch[i] = a->planar ? data[i] : data[0] + i * a->bps;
+}
+
+/* wraps the C conversion in the prototype of the SIMD functions */
+static void convert_c(uint8_t **dst, const uint8_t **src, int len)
+{
+    AudioData out, in;
+
+    fill_audio_data(&out, dst, cur_case->out_fmt, cur_case->channels);
+    fill_audio_data(&in, (uint8_t **)src, cur_case->in_fmt, cur_case->channels);
+    swri_audio_convert(ref_conv, &out, &in, len);
+}
+
+static void randomize_samples(uint8_t *buf, enum AVSampleFormat fmt)
+{
+    int i;
+
+    switch (av_get_packed_sample_fmt(fmt)) {
+    case AV_SAMPLE_FMT_S16:
+        for (i = 0; i < BUF_SIZE / 2; i++)
+            ((int16_t *)buf)[i] = rnd();
+        break;
+    case AV_SAMPLE_FMT_S32:
+        for (i = 0; i < BUF_SIZE / 4; i++)
+            ((int32_t *)buf)[i] = rnd();
+        break;
+    case AV_SAMPLE_FMT_FLT:
+        /* the float to s32 conversions saturate differently at 1.0 */
+        for (i = 0; i < BUF_SIZE / 4; i++)
+            ((float *)buf)[i] = (int32_t)rnd() / (float)(1U << 31);
+        break;
+    }
+}
+
+static void check_convert(const ConvertCase *cc, uint8_t *src, uint8_t *dst0, uint8_t *dst1)
+{
+    /* the SIMD functions only handle multiples of 16 samples */
+    static const int lens[] = { 16, 32, 496, MAX_SAMPLES };
+    uint8_t *srcp[MAX_CHANNELS], *dst0p[MAX_CHANNELS], *dst1p[MAX_CHANNELS];
+    AudioConvert *conv;
+    int i, l;
+
+    declare_func_emms(AV_CPU_FLAG_MMX, void, uint8_t **dst, const uint8_t **src, int len);
+
+    conv     = swri_audio_convert_alloc(cc->out_fmt, cc->in_fmt, cc->channels, NULL, 0);
+    ref_conv = swri_audio_convert_alloc(cc->out_fmt, cc->in_fmt, cc->channels, NULL, 0);
+    if (!conv || !ref_conv)
+        goto end;
+    ref_conv->simd_f = NULL;
+    cur_case = cc;
+
+    for (i = 0; i < MAX_CHANNELS; i++) {
+        srcp[i]  = src  + i * PLANE_SIZE;
+        dst0p[i] = dst0 + i * PLANE_SIZE;
+        dst1p[i] = dst1 + i * PLANE_SIZE;
+    }
+
+    if (check_func(conv->simd_f ? conv->simd_f : convert_c, "%s_to_%s_%dch",
+                   av_get_sample_fmt_name(cc->in_fmt),
+                   av_get_sample_fmt_name(cc->out_fmt), cc->channels)) {
+        for (l = 0; l < FF_ARRAY_ELEMS(lens); l++) {
+            randomize_samples(src, cc->in_fmt);
+            memset(dst0, 0, BUF_SIZE);
+            memset(dst1, 0, BUF_SIZE);
+            call_ref(dst0p, (const uint8_t **)srcp, lens[l]);
+            call_new(dst1p, (const uint8_t **)srcp, lens[l]);
+            if (memcmp(dst0, dst1, BUF_SIZE))
+                fail();
+        }
+        bench_new(dst1p, (const uint8_t **)srcp, MAX_SAMPLES);
+    }
+
+end:
+    swri_audio_convert_free(&conv);
+    swri_audio_convert_free(&ref_conv);
+}
+
+void checkasm_check_sw_audioconvert(void)
+{
+    uint8_t *src  = av_malloc(BUF_SIZE);
+    uint8_t *dst0 = av_malloc(BUF_SIZE);
+    uint8_t *dst1 = av_malloc(BUF_SIZE);
+    int i, channels = 0;
+
+    if (!src || !dst0 || !dst1)
+        goto end;
+
+    for (i = 0; i < FF_ARRAY_ELEMS(cases); i++) {
+        if (channels && cases[i].channels != channels)
+            report(channels == 1 ? "convert" : "pack_unpack_%dch", channels);
+        channels = cases[i].channels;
+        check_convert(&cases[i], src, dst0, dst1);
+    }
+    report("pack_unpack_%dch", channels);
+
+end:
+    av_free(src);
+    av_free(dst0);
+    av_free(dst1);
+}
@@ -0,0 +1,203 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <float.h>
+#include <string.h>
+
+#include "libavutil/channel_layout.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/opt.h"
+#include "libavutil/samplefmt.h"
+
+#include "libswresample/swresample.h"
+#include "libswresample/swresample_internal.h"
+
+#include "checkasm.h"
+
+#define MAX_SAMPLES 1024
+
+/* the SIMD functions only handle multiples of 16 samples */
+static const int lens[] = { 16, 32, 496, MAX_SAMPLES };
+
+/* A stereo to stereo context with a random matrix. The coefficients are
+ * kept small enough for the sum of two products not to overflow, and for
+ * the 16-bit SIMD coefficients to keep their full precision. */
+static SwrContext *alloc_context(enum AVSampleFormat fmt)
+{
+    SwrContext *s = swr_alloc_set_opts(NULL, AV_CH_LAYOUT_STEREO, fmt, 48000,
+                                       AV_CH_LAYOUT_STEREO, fmt, 48000, 0, NULL);
+    double matrix[4];
+    int i;
+
+    if (!s)
+        return NULL;
+    for (i = 0; i < 4; i++)
+        matrix[i] = ((int)(rnd() % 901) - 450) / 1000.0;
+    if (av_opt_set_sample_fmt(s, "internal_sample_fmt", fmt, 0) < 0 ||
+        swr_set_matrix(s, matrix, 2) < 0 || swr_init(s) < 0)
+        swr_free(&s);
+    return s;
+}
+
+static void randomize_samples(void *buf, enum AVSampleFormat fmt, int count)
+{
+    int i;
+
+    for (i = 0; i < count; i++) {
+        if (fmt == AV_SAMPLE_FMT_S16P)
+            ((int16_t *)buf)[i] = rnd();
+        else
+            ((float *)buf)[i] = (int32_t)rnd() / (float)(1U << 31);
+    }
+}
+
+static int compare_samples(const void *ref, const void *new,
+                           enum AVSampleFormat fmt, int count)
+{
+    if (fmt == AV_SAMPLE_FMT_S16P)
+        return memcmp(ref, new, count * sizeof(int16_t));
+    return !float_near_abs_eps_array(ref, new, 2 * FLT_EPSILON, count);
+}
+
+/* The C functions take the coefficients from native_matrix, the SIMD
+ * ones from native_simd_matrix, which has a different layout for s16. */
+static void *get_coeffs(SwrContext *s, void *func)
+{
+    return func == s->mix_1_1_f || func == s->mix_2_1_f ||
+           func == s->mix_add_f ? s->native_matrix : s->native_simd_matrix;
+}
+
+static void check_mix_1_1(SwrContext *s, enum AVSampleFormat fmt,
+                          uint8_t *src0, uint8_t *dst0, uint8_t *dst1)
+{
+    mix_1_1_func_type *func = s->mix_1_1_simd ? s->mix_1_1_simd : s->mix_1_1_f;
+    int l;
+
+    declare_func_emms(AV_CPU_FLAG_MMX, void, void *out, const void *in, void *coeffp,
+                      integer index, integer len);
+
+    if (check_func(func, "mix_1_1_%s", av_get_sample_fmt_name(fmt))) {
+        void *coeffs = get_coeffs(s, func);
+
+        for (l = 0; l < FF_ARRAY_ELEMS(lens); l++) {
+            int index = rnd() & 3;
+
+            randomize_samples(src0, fmt, MAX_SAMPLES);
+            memset(dst0, 0, MAX_SAMPLES * 4);
+            memset(dst1, 0, MAX_SAMPLES * 4);
+            call_ref(dst0, src0, s->native_matrix, index, lens[l]);
+            call_new(dst1, src0, coeffs, index, lens[l]);
+            if (compare_samples(dst0, dst1, fmt, MAX_SAMPLES))
+                fail();
+        }
+        bench_new(dst1, src0, coeffs, 0, MAX_SAMPLES);
+    }
+}
+
+static void check_mix_2_1(SwrContext *s, enum AVSampleFormat fmt,
+                          uint8_t *src0, uint8_t *src1, uint8_t *dst0, uint8_t *dst1)
+{
+    mix_2_1_func_type *func = s->mix_2_1_simd ? s->mix_2_1_simd : s->mix_2_1_f;
+    int l;
+
+    declare_func_emms(AV_CPU_FLAG_MMX, void, void *out, const void *in1, const void *in2,
+                      void *coeffp, integer index1, integer index2, integer len);
+
+    if (check_func(func, "mix_2_1_%s", av_get_sample_fmt_name(fmt))) {
+        void *coeffs = get_coeffs(s, func);
+
+        for (l = 0; l < FF_ARRAY_ELEMS(lens); l++) {
+            int index = (rnd() & 1) * 2;
+
+            randomize_samples(src0, fmt, MAX_SAMPLES);
+            randomize_samples(src1, fmt, MAX_SAMPLES);
+            memset(dst0, 0, MAX_SAMPLES * 4);
+            memset(dst1, 0, MAX_SAMPLES * 4);
+            call_ref(dst0, src0, src1, s->native_matrix, index, index + 1, lens[l]);
+            call_new(dst1, src0, src1, coeffs, index, index + 1, lens[l]);
+            if (compare_samples(dst0, dst1, fmt, MAX_SAMPLES))
+                fail();
+        }
+        bench_new(dst1, src0, src1, coeffs, 0, 1, MAX_SAMPLES);
+    }
+}
+
+static void check_mix_add(SwrContext *s, enum AVSampleFormat fmt,
+                          uint8_t *src0, uint8_t *dst0, uint8_t *dst1)
+{
+    mix_1_1_func_type *func = s->mix_add_simd ? s->mix_add_simd : s->mix_add_f;
+    int l;
+
+    declare_func(void, void *out, const void *in, void *coeffp,
+                 integer index, integer len);
+
+    if (!func)
+        return;
+
+    if (check_func(func, "mix_add_%s", av_get_sample_fmt_name(fmt))) {
+        void *coeffs = get_coeffs(s, func);
+
+        for (l = 0; l < FF_ARRAY_ELEMS(lens); l++) {
+            int index = rnd() & 3;
+
+            randomize_samples(src0, fmt, MAX_SAMPLES);
+            randomize_samples(dst0, fmt, MAX_SAMPLES);
+            memcpy(dst1, dst0, MAX_SAMPLES * 4);
+            call_ref(dst0, src0, s->native_matrix, index, lens[l]);
+            call_new(dst1, src0, coeffs, index, lens[l]);
+            if (compare_samples(dst0, dst1, fmt, MAX_SAMPLES))
+                fail();
+        }
+        bench_new(dst1, src0, coeffs, 0, MAX_SAMPLES);
+    }
+}
+
+void checkasm_check_sw_rematrix(void)
+{
+    static const enum AVSampleFormat formats[] = {
+        AV_SAMPLE_FMT_S16P, AV_SAMPLE_FMT_FLTP,
+    };
+    LOCAL_ALIGNED_32(uint8_t, src0, [MAX_SAMPLES * 4]);
+    LOCAL_ALIGNED_32(uint8_t, src1, [MAX_SAMPLES * 4]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [MAX_SAMPLES * 4]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [MAX_SAMPLES * 4]);
+    SwrContext *s[FF_ARRAY_ELEMS(formats)];
+    int f;
+
+    for (f = 0; f < FF_ARRAY_ELEMS(formats); f++)
+        s[f] = alloc_context(formats[f]);
+
+    for (f = 0; f < FF_ARRAY_ELEMS(formats); f++)
+        if (s[f])
+            check_mix_1_1(s[f], formats[f], src0, dst0, dst1);
+    report("mix_1_1");
+
+    for (f = 0; f < FF_ARRAY_ELEMS(formats); f++)
+        if (s[f])
+            check_mix_2_1(s[f], formats[f], src0, src1, dst0, dst1);
+    report("mix_2_1");
+
+    for (f = 0; f < FF_ARRAY_ELEMS(formats); f++)
+        if (s[f])
+            check_mix_add(s[f], formats[f], src0, dst0, dst1);
+    report("mix_add");
+
+    for (f = 0; f < FF_ARRAY_ELEMS(formats); f++)
+        swr_free(&s[f]);
+}
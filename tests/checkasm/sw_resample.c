@@ -0,0 +1,163 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/mem.h"
+#include "libavutil/samplefmt.h"
+
+#include "libswresample/resample.h"
+
+#include "checkasm.h"
+
+#define MAX_SAMPLES 1024
+#define FILTER_SIZE 32
+#define PHASE_SHIFT 10
+/* the largest rate ratio tested below is 6, plus the filter length and
+ * some room for the SIMD functions reading past it */
+#define SRC_SAMPLES (6 * MAX_SAMPLES + 6 * FILTER_SIZE * 2 + 64)
+
+static const struct {
+    int out_rate, in_rate;
+} rates[] = {
+    { 48000, 44100 }, { 44100, 48000 }, { 48000,  8000 }, {  8000, 48000 },
+};
+
+static void randomize_samples(void *buf, enum AVSampleFormat fmt, int count)
+{
+    int i;
+
+    for (i = 0; i < count; i++) {
+        switch (fmt) {
+        case AV_SAMPLE_FMT_S16P:
+            ((int16_t *)buf)[i] = rnd();
+            break;
+        case AV_SAMPLE_FMT_FLTP:
+            ((float  *)buf)[i] = (int32_t)rnd() / (float)(1U << 31);
+            break;
+        case AV_SAMPLE_FMT_DBLP:
+            ((double *)buf)[i] = (int32_t)rnd() / (double)(1U << 31);
+            break;
+        }
+    }
+}
+
+/* The float versions sum in a different order, so allow for an error of
+ * one ulp per filter tap. */
+static int compare_samples(const void *ref, const void *new,
+                           enum AVSampleFormat fmt, int count, int taps)
+{
+    int i;
+
+    switch (fmt) {
+    case AV_SAMPLE_FMT_S16P:
+        return memcmp(ref, new, count * sizeof(int16_t));
+    case AV_SAMPLE_FMT_FLTP:
+        return !float_near_abs_eps_array(ref, new, taps * FLT_EPSILON, count);
+    case AV_SAMPLE_FMT_DBLP:
+        for (i = 0; i < count; i++)
+            if (fabs(((const double *)ref)[i] - ((const double *)new)[i]) > taps * DBL_EPSILON)
+                return 1;
+        return 0;
+    }
+    return 1;
+}
+
+static void check_resample(enum AVSampleFormat fmt, int linear)
+{
+    static const int counts[] = { 1, 7, 16, 33, 131, MAX_SAMPLES };
+    ResampleContext *ctx[FF_ARRAY_ELEMS(rates)] = { NULL };
+    int bps = av_get_bytes_per_sample(fmt);
+    uint8_t *src  = av_malloc(SRC_SAMPLES * bps);
+    uint8_t *dst0 = av_malloc(MAX_SAMPLES * bps);
+    uint8_t *dst1 = av_malloc(MAX_SAMPLES * bps);
+    int r, n;
+
+    declare_func(int, ResampleContext *c, void *dst, const void *src,
+                 int n, int update_ctx);
+
+    if (!src || !dst0 || !dst1)
+        goto end;
+
+    for (r = 0; r < FF_ARRAY_ELEMS(rates); r++) {
+        ctx[r] = swri_resampler.init(NULL, rates[r].out_rate, rates[r].in_rate,
+                                     FILTER_SIZE, PHASE_SHIFT, linear, 0, fmt,
+                                     SWR_FILTER_TYPE_KAISER, 9, 0, 0);
+        if (!ctx[r])
+            goto end;
+    }
+
+    if (check_func(ctx[0]->dsp.resample, "resample_%s_%s",
+                   linear ? "linear" : "common", av_get_sample_fmt_name(fmt))) {
+        for (r = 0; r < FF_ARRAY_ELEMS(rates); r++) {
+            ResampleContext *c = ctx[r];
+
+            for (n = 0; n < FF_ARRAY_ELEMS(counts); n++) {
+                int index = rnd() & c->phase_mask;
+                int frac  = rnd() % c->src_incr;
+                int ret0, ret1, index0, frac0;
+
+                randomize_samples(src, fmt, SRC_SAMPLES);
+                memset(dst0, 0, MAX_SAMPLES * bps);
+                memset(dst1, 0, MAX_SAMPLES * bps);
+
+                c->index = index;
+                c->frac  = frac;
+                ret0   = call_ref(c, dst0, src, counts[n], 1);
+                index0 = c->index;
+                frac0  = c->frac;
+
+                c->index = index;
+                c->frac  = frac;
+                ret1 = call_new(c, dst1, src, counts[n], 1);
+
+                if (ret0 != ret1 || index0 != c->index || frac0 != c->frac ||
+                    compare_samples(dst0, dst1, fmt, counts[n], c->filter_length))
+                    fail();
+            }
+        }
+        ctx[0]->index = ctx[0]->frac = 0;
+        bench_new(ctx[0], dst1, src, MAX_SAMPLES, 0);
+    }
+
+end:
+    for (r = 0; r < FF_ARRAY_ELEMS(rates); r++)
+        swri_resampler.free(&ctx[r]);
+    av_free(src);
+    av_free(dst0);
+    av_free(dst1);
+}
+
+void checkasm_check_sw_resample(void)
+{
+    static const enum AVSampleFormat formats[] = {
+        AV_SAMPLE_FMT_S16P, AV_SAMPLE_FMT_FLTP, AV_SAMPLE_FMT_DBLP,
+    };
+    int f;
+
+    for (f = 0; f < FF_ARRAY_ELEMS(formats); f++)
+        check_resample(formats[f], 0);
+    report("resample_common");
+
+    for (f = 0; f < FF_ARRAY_ELEMS(formats); f++)
+        check_resample(formats[f], 1);
+    report("resample_linear");
+}
@@ -0,0 +1,428 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/log.h"
+#include "libavutil/mem.h"
+#include "libavutil/pixdesc.h"
+
+#include "libswscale/rgb2rgb.h"
+#include "libswscale/swscale.h"
+#include "libswscale/swscale_internal.h"
+
+#include "checkasm.h"
+
+#define MAX_WIDTH  1920
+#define MAX_HEIGHT 4
+#define STRIDE     (4 * MAX_WIDTH + 64)
+#define BUF_SIZE   (STRIDE * MAX_HEIGHT)
+
+static void randomize_buffer(uint8_t *buf, int size)
+{
+    int i;
+
+    for (i = 0; i < size; i++)
+        buf[i] = rnd();
+}
+
+typedef void (*rgb2rgb_func)(const uint8_t *src, uint8_t *dst, int src_size);
+
+static const struct {
+    const char *name;
+    rgb2rgb_func *func;
+    int src_bpp;
+} rgb_funcs[] = {
+#define RGB_FUNC(name, src_bpp) { #name, &name, src_bpp }
+    RGB_FUNC(rgb15to16,          2),
+    RGB_FUNC(rgb15tobgr24,       2),
+    RGB_FUNC(rgb15to32,          2),
+    RGB_FUNC(rgb16to15,          2),
+    RGB_FUNC(rgb16tobgr24,       2),
+    RGB_FUNC(rgb16to32,          2),
+    RGB_FUNC(rgb24tobgr15,       3),
+    RGB_FUNC(rgb24tobgr16,       3),
+    RGB_FUNC(rgb24tobgr24,       3),
+    RGB_FUNC(rgb24tobgr32,       3),
+    RGB_FUNC(rgb24to15,          3),
+    RGB_FUNC(rgb24to16,          3),
+    RGB_FUNC(rgb32tobgr15,       4),
+    RGB_FUNC(rgb32tobgr16,       4),
+    RGB_FUNC(rgb32tobgr24,       4),
+    RGB_FUNC(rgb32to15,          4),
+    RGB_FUNC(rgb32to16,          4),
+    RGB_FUNC(shuffle_bytes_0321, 4),
+    RGB_FUNC(shuffle_bytes_2103, 4),
+#undef RGB_FUNC
+};
+
+static void check_rgb_to_rgb(uint8_t *src, uint8_t *dst0, uint8_t *dst1)
+{
+    static const int widths[] = { 1, 7, 16, 33, 131, MAX_WIDTH };
+    int f, w;
+
+    declare_func_emms(AV_CPU_FLAG_MMX, void, const uint8_t *src, uint8_t *dst, int src_size);
+
+    for (f = 0; f < FF_ARRAY_ELEMS(rgb_funcs); f++) {
+        int bpp = rgb_funcs[f].src_bpp;
+
+        if (!check_func(*rgb_funcs[f].func, "%s", rgb_funcs[f].name))
+            continue;
+
+        for (w = 0; w < FF_ARRAY_ELEMS(widths); w++) {
+            randomize_buffer(src, BUF_SIZE);
+            memset(dst0, 0xa5, BUF_SIZE);
+            memset(dst1, 0xa5, BUF_SIZE);
+            call_ref(src, dst0, widths[w] * bpp);
+            call_new(src, dst1, widths[w] * bpp);
+            if (memcmp(dst0, dst1, BUF_SIZE))
+                fail();
+        }
+        bench_new(src, dst1, MAX_WIDTH * bpp);
+    }
+}
+
+/* widths of the packed YUV functions must be a multiple of 16 */
+static const int yuv_widths[] = { 16, 32, 496, MAX_WIDTH };
+
+static void check_planar_to_packed(uint8_t *src, uint8_t *dst0, uint8_t *dst1)
+{
+    static const struct {
+        const char *name;
+        void (**func)(const uint8_t *ysrc, const uint8_t *usrc, const uint8_t *vsrc,
+                      uint8_t *dst, int width, int height,
+                      int lumStride, int chromStride, int dstStride);
+    } funcs[] = {
+        { "yv12toyuy2",    &yv12toyuy2    },
+        { "yv12touyvy",    &yv12touyvy    },
+        { "yuv422ptoyuy2", &yuv422ptoyuy2 },
+        { "yuv422ptouyvy", &yuv422ptouyvy },
+    };
+    const uint8_t *y = src, *u = src + BUF_SIZE / 2, *v = u + BUF_SIZE / 4;
+    int f, w;
+
+    declare_func_emms(AV_CPU_FLAG_MMX, void, const uint8_t *ysrc, const uint8_t *usrc,
+                      const uint8_t *vsrc, uint8_t *dst, int width, int height,
+                      int lumStride, int chromStride, int dstStride);
+
+    for (f = 0; f < FF_ARRAY_ELEMS(funcs); f++) {
+        if (!check_func(*funcs[f].func, "%s", funcs[f].name))
+            continue;
+
+        for (w = 0; w < FF_ARRAY_ELEMS(yuv_widths); w++) {
+            int width = yuv_widths[w];
+
+            randomize_buffer(src, BUF_SIZE);
+            memset(dst0, 0xa5, BUF_SIZE);
+            memset(dst1, 0xa5, BUF_SIZE);
+            call_ref(y, u, v, dst0, width, MAX_HEIGHT, MAX_WIDTH, MAX_WIDTH / 2, STRIDE);
+            call_new(y, u, v, dst1, width, MAX_HEIGHT, MAX_WIDTH, MAX_WIDTH / 2, STRIDE);
+            if (memcmp(dst0, dst1, BUF_SIZE))
+                fail();
+        }
+        bench_new(y, u, v, dst1, MAX_WIDTH, MAX_HEIGHT, MAX_WIDTH, MAX_WIDTH / 2, STRIDE);
+    }
+}
+
+static void check_packed_to_planar(uint8_t *src, uint8_t *dst0, uint8_t *dst1)
+{
+    static const struct {
+        const char *name;
+        void (**func)(uint8_t *ydst, uint8_t *udst, uint8_t *vdst, const uint8_t *src,
+                      int width, int height,
+                      int lumStride, int chromStride, int srcStride);
+    } funcs[] = {
+        { "uyvytoyuv420", &uyvytoyuv420 },
+        { "uyvytoyuv422", &uyvytoyuv422 },
+        { "yuyvtoyuv420", &yuyvtoyuv420 },
+        { "yuyvtoyuv422", &yuyvtoyuv422 },
+    };
+    int f, w;
+
+    declare_func_emms(AV_CPU_FLAG_MMX, void, uint8_t *ydst, uint8_t *udst, uint8_t *vdst,
+                      const uint8_t *src, int width, int height,
+                      int lumStride, int chromStride, int srcStride);
+
+    for (f = 0; f < FF_ARRAY_ELEMS(funcs); f++) {
+        if (!check_func(*funcs[f].func, "%s", funcs[f].name))
+            continue;
+
+        for (w = 0; w < FF_ARRAY_ELEMS(yuv_widths); w++) {
+            int width = yuv_widths[w];
+
+            randomize_buffer(src, BUF_SIZE);
+            memset(dst0, 0xa5, BUF_SIZE);
+            memset(dst1, 0xa5, BUF_SIZE);
+            call_ref(dst0, dst0 + BUF_SIZE / 2, dst0 + 3 * BUF_SIZE / 4, src,
+                     width, MAX_HEIGHT, MAX_WIDTH, MAX_WIDTH / 2, STRIDE);
+            call_new(dst1, dst1 + BUF_SIZE / 2, dst1 + 3 * BUF_SIZE / 4, src,
+                     width, MAX_HEIGHT, MAX_WIDTH, MAX_WIDTH / 2, STRIDE);
+            if (memcmp(dst0, dst1, BUF_SIZE))
+                fail();
+        }
+        bench_new(dst1, dst1 + BUF_SIZE / 2, dst1 + 3 * BUF_SIZE / 4, src,
+                  MAX_WIDTH, MAX_HEIGHT, MAX_WIDTH, MAX_WIDTH / 2, STRIDE);
+    }
+}
+
+static void check_interleave_bytes(uint8_t *src, uint8_t *dst0, uint8_t *dst1)
+{
+    static const int widths[] = { 1, 7, 16, 33, 131, MAX_WIDTH };
+    int w;
+
+    declare_func_emms(AV_CPU_FLAG_MMX, void, const uint8_t *src1, const uint8_t *src2,
+                      uint8_t *dst, int width, int height,
+                      int src1Stride, int src2Stride, int dstStride);
+
+    if (check_func(interleaveBytes, "interleave_bytes")) {
+        for (w = 0; w < FF_ARRAY_ELEMS(widths); w++) {
+            randomize_buffer(src, BUF_SIZE);
+            memset(dst0, 0xa5, BUF_SIZE);
+            memset(dst1, 0xa5, BUF_SIZE);
+            /* the second source is misaligned on purpose */
+            call_ref(src, src + BUF_SIZE / 2 + 1, dst0, widths[w], MAX_HEIGHT,
+                     MAX_WIDTH, MAX_WIDTH, STRIDE);
+            call_new(src, src + BUF_SIZE / 2 + 1, dst1, widths[w], MAX_HEIGHT,
+                     MAX_WIDTH, MAX_WIDTH, STRIDE);
+            if (memcmp(dst0, dst1, BUF_SIZE))
+                fail();
+        }
+        bench_new(src, src + BUF_SIZE / 2, dst1, MAX_WIDTH, MAX_HEIGHT,
+                  MAX_WIDTH, MAX_WIDTH, STRIDE);
+    }
+}
+
+static void check_deinterleave_bytes(uint8_t *src, uint8_t *dst0, uint8_t *dst1)
+{
+    static const int widths[] = { 1, 7, 16, 33, 131, MAX_WIDTH };
+    int w;
+
+    declare_func_emms(AV_CPU_FLAG_MMX, void, const uint8_t *src, uint8_t *dst1,
+                      uint8_t *dst2, int width, int height,
+                      int srcStride, int dst1Stride, int dst2Stride);
+
+    if (check_func(deinterleaveBytes, "deinterleave_bytes")) {
+        for (w = 0; w < FF_ARRAY_ELEMS(widths); w++) {
+            randomize_buffer(src, BUF_SIZE);
+            memset(dst0, 0xa5, BUF_SIZE);
+            memset(dst1, 0xa5, BUF_SIZE);
+            call_ref(src, dst0, dst0 + BUF_SIZE / 2, widths[w], MAX_HEIGHT,
+                     STRIDE, MAX_WIDTH, MAX_WIDTH);
+            call_new(src, dst1, dst1 + BUF_SIZE / 2, widths[w], MAX_HEIGHT,
+                     STRIDE, MAX_WIDTH, MAX_WIDTH);
+            if (memcmp(dst0, dst1, BUF_SIZE))
+                fail();
+        }
+        bench_new(src, dst1, dst1 + BUF_SIZE / 2, MAX_WIDTH, MAX_HEIGHT,
+                  STRIDE, MAX_WIDTH, MAX_WIDTH);
+    }
+}
+
+static void check_interleave_words(uint8_t *src, uint8_t *dst0, uint8_t *dst1)
+{
+    static const int widths[] = { 1, 7, 16, 33, 131, MAX_WIDTH };
+    const uint16_t *src1 = (const uint16_t *)src;
+    /* the second source is misaligned on purpose */
+    const uint16_t *src2 = (const uint16_t *)(src + BUF_SIZE / 2) + 1;
+    int w;
+
+    declare_func(void, const uint16_t *src1, const uint16_t *src2,
+                 uint16_t *dst, int width, int height,
+                 int src1Stride, int src2Stride, int dstStride, int shift);
+
+    if (check_func(interleaveWords, "interleave_words")) {
+        for (w = 0; w < FF_ARRAY_ELEMS(widths); w++) {
+            randomize_buffer(src, BUF_SIZE);
+            memset(dst0, 0xa5, BUF_SIZE);
+            memset(dst1, 0xa5, BUF_SIZE);
+            call_ref(src1, src2, (uint16_t *)dst0, widths[w], MAX_HEIGHT,
+                     MAX_WIDTH, MAX_WIDTH, STRIDE / 2, 6);
+            call_new(src1, src2, (uint16_t *)dst1, widths[w], MAX_HEIGHT,
+                     MAX_WIDTH, MAX_WIDTH, STRIDE / 2, 6);
+            if (memcmp(dst0, dst1, BUF_SIZE))
+                fail();
+        }
+        bench_new(src1, src2, (uint16_t *)dst1, MAX_WIDTH, MAX_HEIGHT,
+                  MAX_WIDTH, MAX_WIDTH, STRIDE / 2, 6);
+    }
+}
+
+static void check_deinterleave_words(uint8_t *src, uint8_t *dst0, uint8_t *dst1)
+{
+    static const int widths[] = { 1, 7, 16, 33, 131, MAX_WIDTH };
+    int w;
+
+    declare_func(void, const uint16_t *src, uint16_t *dst1, uint16_t *dst2,
+                 int width, int height, int srcStride,
+                 int dst1Stride, int dst2Stride, int shift);
+
+    if (check_func(deinterleaveWords, "deinterleave_words")) {
+        for (w = 0; w < FF_ARRAY_ELEMS(widths); w++) {
+            uint16_t *dst0p = (uint16_t *)dst0, *dst1p = (uint16_t *)dst1;
+
+            randomize_buffer(src, BUF_SIZE);
+            memset(dst0, 0xa5, BUF_SIZE);
+            memset(dst1, 0xa5, BUF_SIZE);
+            call_ref((const uint16_t *)src, dst0p, dst0p + BUF_SIZE / 4 + 1,
+                     widths[w], MAX_HEIGHT, STRIDE / 2, MAX_WIDTH, MAX_WIDTH, 6);
+            call_new((const uint16_t *)src, dst1p, dst1p + BUF_SIZE / 4 + 1,
+                     widths[w], MAX_HEIGHT, STRIDE / 2, MAX_WIDTH, MAX_WIDTH, 6);
+            if (memcmp(dst0, dst1, BUF_SIZE))
+                fail();
+        }
+        bench_new((const uint16_t *)src, (uint16_t *)dst1, (uint16_t *)dst1 + BUF_SIZE / 4,
+                  MAX_WIDTH, MAX_HEIGHT, STRIDE / 2, MAX_WIDTH, MAX_WIDTH, 6);
+    }
+}
+
+/* The SIMD yuv2rgb functions use 16-bit intermediates instead of the
+ * lookup tables of the C functions, so they are compared component-wise
+ * with some tolerance. */
+static int compare_rgb(const uint8_t *ref, const uint8_t *new,
+                       enum AVPixelFormat fmt, int width)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(fmt);
+    int x, i;
+
+    for (x = 0; x < width; x++) {
+        for (i = 0; i < desc->nb_components; i++) {
+            const AVComponentDescriptor *comp = &desc->comp[i];
+            int offset   = x * comp->step + comp->offset;
+            int mask     = (1 << comp->depth) - 1;
+            int max_diff = comp->depth < 8 ? 2 : 3;
+            int a, b;
+
+            if (comp->step > 2) {
+                a = ref[offset];
+                b = new[offset];
+            } else {
+                a = (AV_RN16(ref + offset) >> comp->shift) & mask;
+                b = (AV_RN16(new + offset) >> comp->shift) & mask;
+            }
+            if (FFABS(a - b) > max_diff)
+                return 1;
+        }
+    }
+    return 0;
+}
+
+static void check_yuv2rgb(uint8_t *src, uint8_t *dst0, uint8_t *dst1)
+{
+    static const enum AVPixelFormat src_fmts[] = {
+        AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUVA420P,
+    };
+    static const enum AVPixelFormat dst_fmts[] = {
+        AV_PIX_FMT_RGB24,  AV_PIX_FMT_BGR24,  AV_PIX_FMT_RGB32, AV_PIX_FMT_BGR32,
+        AV_PIX_FMT_RGB565, AV_PIX_FMT_RGB555,
+    };
+    /* the SIMD functions process blocks of 8 pixels */
+    static const int widths[] = { 8, 16, 128, MAX_WIDTH };
+    const uint8_t *srcp[4] = {
+        src, src + BUF_SIZE / 4, src + BUF_SIZE / 2, src + 3 * BUF_SIZE / 4,
+    };
+    int src_stride[4] = { MAX_WIDTH, MAX_WIDTH / 2, MAX_WIDTH / 2, MAX_WIDTH };
+    uint8_t *dst0p[4] = { dst0 }, *dst1p[4] = { dst1 };
+    int dst_stride[4] = { STRIDE };
+    int s, d, w, y;
+
+    declare_func_emms(AV_CPU_FLAG_MMX, int, SwsContext *c, const uint8_t *src[],
+                      int srcStride[], int srcSliceY, int srcSliceH,
+                      uint8_t *dst[], int dstStride[]);
+
+    for (s = 0; s < FF_ARRAY_ELEMS(src_fmts); s++) {
+        for (d = 0; d < FF_ARRAY_ELEMS(dst_fmts); d++) {
+            const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(dst_fmts[d]);
+            SwsContext *c;
+            SwsFunc func;
+            int log_level, bpp = av_get_padded_bits_per_pixel(desc) >> 3;
+
+            if (src_fmts[s] == AV_PIX_FMT_YUVA420P && bpp != 4)
+                continue;
+            /* silence the warnings about missing accelerated versions */
+            log_level = av_log_get_level();
+            av_log_set_level(AV_LOG_ERROR);
+            c = sws_getContext(MAX_WIDTH, MAX_HEIGHT, src_fmts[s],
+                               MAX_WIDTH, MAX_HEIGHT, dst_fmts[d],
+                               SWS_BILINEAR, NULL, NULL, NULL);
+            func = c ? ff_yuv2rgb_get_func_ptr(c) : NULL;
+            av_log_set_level(log_level);
+            if (!c)
+                continue;
+
+            if (check_func(func, "yuv2rgb_%s_%s", av_get_pix_fmt_name(src_fmts[s]),
+                           av_get_pix_fmt_name(dst_fmts[d]))) {
+                for (w = 0; w < FF_ARRAY_ELEMS(widths); w++) {
+                    int width = widths[w], ret0, ret1;
+
+                    randomize_buffer(src, BUF_SIZE);
+                    memset(dst0, 0, BUF_SIZE);
+                    memset(dst1, 0, BUF_SIZE);
+                    c->dstW = width;
+                    ret0 = call_ref(c, srcp, src_stride, 0, MAX_HEIGHT, dst0p, dst_stride);
+                    ret1 = call_new(c, srcp, src_stride, 0, MAX_HEIGHT, dst1p, dst_stride);
+                    if (ret0 != ret1)
+                        fail();
+                    for (y = 0; y < MAX_HEIGHT; y++)
+                        if (compare_rgb(dst0 + y * STRIDE, dst1 + y * STRIDE,
+                                        dst_fmts[d], width))
+                            fail();
+                }
+                c->dstW = MAX_WIDTH;
+                bench_new(c, srcp, src_stride, 0, MAX_HEIGHT, dst1p, dst_stride);
+            }
+            sws_freeContext(c);
+        }
+    }
+}
+
+void checkasm_check_sw_rgb(void)
+{
+    uint8_t *src  = av_malloc(BUF_SIZE);
+    uint8_t *dst0 = av_malloc(BUF_SIZE);
+    uint8_t *dst1 = av_malloc(BUF_SIZE);
+
+    if (!src || !dst0 || !dst1)
+        goto end;
+
+    ff_sws_rgb2rgb_init();
+
+    check_rgb_to_rgb(src, dst0, dst1);
+    report("rgb_to_rgb");
+
+    check_planar_to_packed(src, dst0, dst1);
+    report("planar_to_packed");
+
+    check_packed_to_planar(src, dst0, dst1);
+    report("packed_to_planar");
+
+    check_interleave_bytes(src, dst0, dst1);
+    check_deinterleave_bytes(src, dst0, dst1);
+    check_interleave_words(src, dst0, dst1);
+    check_deinterleave_words(src, dst0, dst1);
+    report("interleave");
+
+    check_yuv2rgb(src, dst0, dst1);
+    report("yuv2rgb");
+
+end:
+    av_free(src);
+    av_free(dst0);
+    av_free(dst1);
+}
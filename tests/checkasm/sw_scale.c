@@ -0,0 +1,264 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/mem.h"
+#include "libavutil/pixdesc.h"
+
+#include "libswscale/swscale.h"
+#include "libswscale/swscale_internal.h"
+
+#include "checkasm.h"
+
+/* the SIMD functions may process up to 31 pixels past the given width */
+#define MAX_WIDTH   1920
+#define PAD         32
+#define MAX_FILTER  40
+#define MAX_LINES   16
+
+static const enum AVPixelFormat formats[] = {
+    AV_PIX_FMT_YUV420P,   AV_PIX_FMT_YUV420P9,  AV_PIX_FMT_YUV420P10,
+    AV_PIX_FMT_YUV420P12, AV_PIX_FMT_YUV420P14, AV_PIX_FMT_YUV420P16,
+};
+
+static const int widths[] = { 1, 7, 16, 33, 131, MAX_WIDTH };
+
+static void init_context(SwsContext *c, enum AVPixelFormat src_fmt,
+                         enum AVPixelFormat dst_fmt, int filter_size)
+{
+    c->srcFormat      = src_fmt;
+    c->dstFormat      = dst_fmt;
+    c->srcBpc         = av_pix_fmt_desc_get(src_fmt)->comp[0].depth;
+    c->dstBpc         = av_pix_fmt_desc_get(dst_fmt)->comp[0].depth;
+    c->hLumFilterSize = c->hChrFilterSize = filter_size;
+    c->vLumFilterSize = c->vChrFilterSize = filter_size;
+    ff_getSwsFunc(c);
+}
+
+static void randomize_buffer(uint16_t *buf, int size, int bits)
+{
+    int i;
+
+    for (i = 0; i < size; i++)
+        buf[i] = rnd() & ((1 << bits) - 1);
+}
+
+/* Random coefficients, some negative, summing to 1 << bits as done by
+ * initFilter(); the 16-bit input hscale versions depend on it. */
+static void randomize_filter(int16_t *filter, int size, int bits)
+{
+    int range = (1 << (bits - 1)) / size, sum = 0, i;
+
+    for (i = 1; i < size; i++) {
+        filter[i] = (int)(rnd() % (2 * range + 1)) - range;
+        sum      += filter[i];
+    }
+    filter[0] = (1 << bits) - sum;
+}
+
+static void check_hscale(SwsContext *c)
+{
+    static const int filter_sizes[] = { 4, 8, 12, 16, MAX_FILTER };
+    LOCAL_ALIGNED_32(uint16_t, src,  [MAX_WIDTH + MAX_FILTER + PAD]);
+    LOCAL_ALIGNED_32(int32_t,  dst0, [MAX_WIDTH + PAD]);
+    LOCAL_ALIGNED_32(int32_t,  dst1, [MAX_WIDTH + PAD]);
+    int16_t *filter    = av_malloc((MAX_WIDTH + PAD) * MAX_FILTER * sizeof(*filter));
+    int32_t *filterpos = av_malloc((MAX_WIDTH + PAD) * sizeof(*filterpos));
+    int s, d, f, w, i;
+
+    declare_func_emms(AV_CPU_FLAG_MMX, void, SwsContext *c, int16_t *dst, int dstW,
+                      const uint8_t *src, const int16_t *filter,
+                      const int32_t *filterPos, int filterSize);
+
+    if (!filter || !filterpos)
+        goto end;
+
+    for (s = 0; s < FF_ARRAY_ELEMS(formats); s++) {
+        int src_bpc = av_pix_fmt_desc_get(formats[s])->comp[0].depth;
+
+        /* 8-bit sources are read as bytes */
+        randomize_buffer(src, MAX_WIDTH + MAX_FILTER + PAD, src_bpc == 8 ? 16 : src_bpc);
+        for (d = 0; d < 2; d++) {
+            /* an output depth up to 14 bits uses 15-bit intermediates,
+             * 16 bits uses 19-bit ones */
+            enum AVPixelFormat dst_fmt = d ? AV_PIX_FMT_YUV420P16 : AV_PIX_FMT_YUV420P;
+            int dst_bits = d ? 19 : 15;
+
+            for (f = 0; f < FF_ARRAY_ELEMS(filter_sizes); f++) {
+                int size = filter_sizes[f];
+
+                init_context(c, formats[s], dst_fmt, size);
+                if (!check_func(c->hyScale, "hscale_%dto%d_%d", src_bpc, dst_bits, size))
+                    continue;
+
+                for (w = 0; w < FF_ARRAY_ELEMS(widths); w++) {
+                    int dst_w = widths[w];
+
+                    /* pad the filter past dst_w like initFilter() */
+                    for (i = 0; i < dst_w + PAD; i++) {
+                        filterpos[i] = i < dst_w ? rnd() % (MAX_WIDTH + 1) : filterpos[dst_w - 1];
+                        if (i < dst_w)
+                            randomize_filter(filter + i * size, size, 14);
+                        else
+                            memcpy(filter + i * size, filter + (dst_w - 1) * size,
+                                   size * sizeof(*filter));
+                    }
+
+                    memset(dst0, 0, (MAX_WIDTH + PAD) * sizeof(*dst0));
+                    memset(dst1, 0, (MAX_WIDTH + PAD) * sizeof(*dst1));
+                    call_ref(c, (int16_t *)dst0, dst_w, (const uint8_t *)src,
+                             filter, filterpos, size);
+                    call_new(c, (int16_t *)dst1, dst_w, (const uint8_t *)src,
+                             filter, filterpos, size);
+                    if (memcmp(dst0, dst1, dst_w * (dst_bits == 15 ? 2 : 4)))
+                        fail();
+                }
+                bench_new(c, (int16_t *)dst1, MAX_WIDTH, (const uint8_t *)src,
+                          filter, filterpos, size);
+            }
+        }
+    }
+
+end:
+    av_free(filter);
+    av_free(filterpos);
+}
+
+static void check_yuv2planeX(SwsContext *c)
+{
+    static const int filter_sizes[] = { 2, 4, 8, 16 };
+    LOCAL_ALIGNED_32(int32_t,  src, [MAX_LINES], [MAX_WIDTH + PAD]);
+    LOCAL_ALIGNED_32(uint16_t, dst0, [MAX_WIDTH + PAD]);
+    LOCAL_ALIGNED_32(uint16_t, dst1, [MAX_WIDTH + PAD]);
+    LOCAL_ALIGNED_8(uint8_t, dither, [8]);
+    int16_t filter[MAX_LINES];
+    const int16_t *srcp[MAX_LINES];
+    int flags = c->flags, s, f, w, i;
+
+    declare_func_emms(AV_CPU_FLAG_MMX, void, const int16_t *filter, int filterSize,
+                      const int16_t **src, uint8_t *dest, int dstW,
+                      const uint8_t *dither, int offset);
+
+    for (i = 0; i < MAX_LINES; i++)
+        srcp[i] = (const int16_t *)src[i];
+    randomize_buffer((uint16_t *)dither, 4, 16);
+
+    /* the default flags select an MMX vertical scaler for 8-bit output
+     * which takes its filter in a different layout */
+    c->flags = SWS_BITEXACT;
+
+    for (s = 0; s < FF_ARRAY_ELEMS(formats); s++) {
+        int bits = av_pix_fmt_desc_get(formats[s])->comp[0].depth;
+        int bpp  = bits > 8 ? 2 : 1;
+
+        for (i = 0; i < MAX_LINES; i++)
+            randomize_buffer((uint16_t *)src[i], 2 * (MAX_WIDTH + PAD), bits == 16 ? 16 : 15);
+        if (bits == 16)
+            for (i = 0; i < MAX_LINES; i++)
+                for (w = 0; w < MAX_WIDTH + PAD; w++)
+                    src[i][w] &= (1 << 19) - 1;
+
+        for (f = 0; f < FF_ARRAY_ELEMS(filter_sizes); f++) {
+            int size = filter_sizes[f];
+
+            init_context(c, AV_PIX_FMT_YUV420P, formats[s], size);
+            if (!check_func(c->yuv2planeX, "yuv2planeX_%d_%d", bits, size))
+                continue;
+
+            for (w = 0; w < FF_ARRAY_ELEMS(widths); w++) {
+                /* odd widths go to unaligned destinations */
+                int dst_w = widths[w], offset = dst_w & 1;
+
+                randomize_filter(filter, size, 12);
+                memset(dst0, 0, (MAX_WIDTH + PAD) * sizeof(*dst0));
+                memset(dst1, 0, (MAX_WIDTH + PAD) * sizeof(*dst1));
+                call_ref(filter, size, srcp, (uint8_t *)dst0 + offset * bpp, dst_w,
+                         dither, 3 * offset);
+                call_new(filter, size, srcp, (uint8_t *)dst1 + offset * bpp, dst_w,
+                         dither, 3 * offset);
+                if (memcmp(dst0, dst1, (dst_w + offset) * bpp))
+                    fail();
+            }
+            bench_new(filter, size, srcp, (uint8_t *)dst1, MAX_WIDTH, dither, 0);
+        }
+    }
+    c->flags = flags;
+}
+
+static void check_yuv2plane1(SwsContext *c)
+{
+    LOCAL_ALIGNED_32(int32_t,  src,  [MAX_WIDTH + PAD]);
+    LOCAL_ALIGNED_32(uint16_t, dst0, [MAX_WIDTH + PAD]);
+    LOCAL_ALIGNED_32(uint16_t, dst1, [MAX_WIDTH + PAD]);
+    LOCAL_ALIGNED_8(uint8_t, dither, [8]);
+    int s, w;
+
+    declare_func_emms(AV_CPU_FLAG_MMX, void, const int16_t *src, uint8_t *dest,
+                      int dstW, const uint8_t *dither, int offset);
+
+    randomize_buffer((uint16_t *)dither, 4, 16);
+
+    for (s = 0; s < FF_ARRAY_ELEMS(formats); s++) {
+        int bits = av_pix_fmt_desc_get(formats[s])->comp[0].depth;
+        int bpp  = bits > 8 ? 2 : 1;
+
+        randomize_buffer((uint16_t *)src, 2 * (MAX_WIDTH + PAD), bits == 16 ? 16 : 15);
+        if (bits == 16)
+            for (w = 0; w < MAX_WIDTH + PAD; w++)
+                src[w] &= (1 << 19) - 1;
+
+        init_context(c, AV_PIX_FMT_YUV420P, formats[s], 1);
+        if (!check_func(c->yuv2plane1, "yuv2plane1_%d", bits))
+            continue;
+
+        for (w = 0; w < FF_ARRAY_ELEMS(widths); w++) {
+            int dst_w = widths[w], offset = dst_w & 1;
+
+            memset(dst0, 0, (MAX_WIDTH + PAD) * sizeof(*dst0));
+            memset(dst1, 0, (MAX_WIDTH + PAD) * sizeof(*dst1));
+            call_ref((const int16_t *)src, (uint8_t *)dst0 + offset * bpp, dst_w, dither, 3 * offset);
+            call_new((const int16_t *)src, (uint8_t *)dst1 + offset * bpp, dst_w, dither, 3 * offset);
+            if (memcmp(dst0, dst1, (dst_w + offset) * bpp))
+                fail();
+        }
+        bench_new((const int16_t *)src, (uint8_t *)dst1, MAX_WIDTH, dither, 0);
+    }
+}
+
+void checkasm_check_sw_scale(void)
+{
+    SwsContext *c = sws_alloc_context();
+
+    if (!c)
+        return;
+
+    check_hscale(c);
+    report("hscale");
+
+    check_yuv2planeX(c);
+    report("yuv2planeX");
+
+    check_yuv2plane1(c);
+    report("yuv2plane1");
+
+    sws_freeContext(c);
+}
@@ -0,0 +1,81 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/boxblur.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+
+#define WIDTH 259
+
+static void check_vblur_row(int (*func)(uint8_t *dst, int32_t *sum, const uint8_t *add,
+                                        const uint8_t *sub, int w, int inv))
+{
+    LOCAL_ALIGNED_32(uint8_t, add,  [WIDTH]);
+    LOCAL_ALIGNED_32(uint8_t, sub,  [WIDTH]);
+    LOCAL_ALIGNED_32(uint8_t, orig, [WIDTH]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [WIDTH]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [WIDTH]);
+    LOCAL_ALIGNED_32(int32_t, sum0, [WIDTH]);
+    LOCAL_ALIGNED_32(int32_t, sum1, [WIDTH]);
+    int inv = 0;
+    declare_func(int, uint8_t *dst, int32_t *sum, const uint8_t *add,
+                 const uint8_t *sub, int w, int inv);
+
+    if (check_func(func, "boxblur_vblur_row")) {
+        static const int widths[] = { 1, 8, 17, 64, WIDTH };
+        int i, x;
+
+        for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+            int w = widths[i], length = 3 + 2 * (rnd() % 32), ret0, ret1;
+
+            inv = ((1 << 16) + length / 2) / length;
+            for (x = 0; x < WIDTH; x++) {
+                /* a box of length pixels, from which sub is removed */
+                add[x]  = rnd();
+                sub[x]  = rnd();
+                orig[x] = rnd();
+                sum0[x] = (sub[x] + rnd() % (255 * (length - 1) + 1)) * inv + (1 << 15);
+            }
+            memcpy(sum1, sum0, sizeof(*sum0) * WIDTH);
+            memcpy(dst0, orig, WIDTH);
+            memcpy(dst1, orig, WIDTH);
+
+            ret0 = call_ref(dst0, sum0, add, sub, w, inv);
+            ret1 = call_new(dst1, sum1, add, sub, w, inv);
+            if (ret0 != w || ret1 > w || ret1 < w - 16 ||
+                memcmp(dst0, dst1, ret1) ||
+                memcmp(dst1 + ret1, orig + ret1, w - ret1) ||
+                memcmp(sum0, sum1, sizeof(*sum0) * ret1))
+                fail();
+        }
+        bench_new(dst1, sum1, add, sub, WIDTH, inv);
+    }
+}
+
+void checkasm_check_boxblur(void)
+{
+    BoxBlurDSPContext dsp;
+
+    ff_boxblur_init_dsp(&dsp);
+
+    check_vblur_row(dsp.vblur_row);
+    report("vblur_row");
+}
@@ -0,0 +1,96 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/convolution.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+
+#define WIDTH 259
+#define STRIDE (WIDTH + 4)
+#define BUF_SIZE (WIDTH + 32)
+
+static void randomize(uint8_t *buf, int size)
+{
+    int i;
+
+    for (i = 0; i < size; i++)
+        buf[i] = rnd();
+}
+
+static void check_filter(int (*func)(uint8_t *dst, int w, const int *matrix,
+                                     const uint8_t *const *c, float rdiv, float bias),
+                         int radius, const char *name)
+{
+    const int size = 2 * radius + 1;
+    LOCAL_ALIGNED_32(uint8_t, src,  [5 * STRIDE]);
+    LOCAL_ALIGNED_32(uint8_t, orig, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [BUF_SIZE]);
+    const uint8_t *c[25];
+    int matrix[25];
+    float rdiv = 1.0f, bias = 0.0f;
+    int i, j;
+    declare_func(int, uint8_t *dst, int w, const int *matrix,
+                 const uint8_t *const *c, float rdiv, float bias);
+
+    for (i = 0; i < size; i++)
+        for (j = 0; j < size; j++)
+            c[i * size + j] = src + i * STRIDE + j;
+
+    if (check_func(func, "%s", name)) {
+        static const int widths[] = { 1, 8, 17, 64, WIDTH - 4 };
+
+        for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+            int w = widths[i], ret0, ret1, k;
+
+            for (k = 0; k < size * size; k++)
+                matrix[k] = (int)(rnd() % 33) - 16;
+            rdiv = 1.0f / (1 + rnd() % 256);
+            bias = rnd() % 256;
+
+            randomize(src,  5 * STRIDE);
+            randomize(orig, BUF_SIZE);
+            memcpy(dst0, orig, BUF_SIZE);
+            memcpy(dst1, orig, BUF_SIZE);
+
+            ret0 = call_ref(dst0, w, matrix, c, rdiv, bias);
+            ret1 = call_new(dst1, w, matrix, c, rdiv, bias);
+            if (ret0 != w || ret1 > w || ret1 < w - 16 ||
+                memcmp(dst0, dst1, ret1) ||
+                memcmp(dst1 + ret1, orig + ret1, w - ret1))
+                fail();
+        }
+        bench_new(dst1, WIDTH - 4, matrix, c, rdiv, bias);
+    }
+}
+
+void checkasm_check_convolution(void)
+{
+    ConvolutionDSPContext dsp;
+
+    ff_convolution_init_dsp(&dsp);
+
+    check_filter(dsp.filter_3x3, 1, "filter_3x3");
+    report("filter_3x3");
+
+    check_filter(dsp.filter_5x5, 2, "filter_5x5");
+    report("filter_5x5");
+}
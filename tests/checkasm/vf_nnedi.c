@@ -0,0 +1,136 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <float.h>
+#include <string.h>
+
+#include "checkasm.h"
+#include "libavfilter/nnedi.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+
+#define MAX_N   256
+#define MAX_LEN 288
+
+/* the prescreeners and the predictor with some of the neighborhood sizes */
+static const struct {
+    int n, len;
+} sizes[] = {
+    { 4, 48 }, { 4, 64 }, { 32, 32 }, { 64, 96 }, { 256, 288 },
+};
+
+static void check_dot_prod(void (*func)(const float *data, const float *weights,
+                                        float *vals, int n, int len,
+                                        const float *scale))
+{
+    float *data    = av_malloc(MAX_LEN * sizeof(*data));
+    float *weights = av_malloc((MAX_N * MAX_LEN + MAX_N) * sizeof(*weights));
+    LOCAL_ALIGNED_32(float, vals0, [MAX_N]);
+    LOCAL_ALIGNED_32(float, vals1, [MAX_N]);
+    declare_func(void, const float *data, const float *weights, float *vals,
+                 int n, int len, const float *scale);
+
+    if (!data || !weights)
+        goto end;
+
+    if (check_func(func, "nnedi_dot_prod")) {
+        float scale;
+        int i, s;
+
+        for (s = 0; s < FF_ARRAY_ELEMS(sizes); s++) {
+            int n = sizes[s].n, len = sizes[s].len;
+
+            scale = (int32_t)rnd() / (float)(1U << 31);
+
+            for (i = 0; i < len; i++)
+                data[i] = (int32_t)rnd() / (float)(1U << 31);
+            for (i = 0; i < n * len + n; i++)
+                weights[i] = (int32_t)rnd() / (float)(1U << 31);
+
+            call_ref(data, weights, vals0, n, len, &scale);
+            call_new(data, weights, vals1, n, len, &scale);
+            /* the sums are done in a different order */
+            if (!float_near_abs_eps_array(vals0, vals1, 4 * len * FLT_EPSILON, n))
+                fail();
+        }
+        bench_new(data, weights, vals1, MAX_N, MAX_LEN, &scale);
+    }
+
+end:
+    av_free(data);
+    av_free(weights);
+}
+
+static void check_dot_prod_int16(void (*func)(const int16_t *data, const int16_t *weights,
+                                              float *vals, int n, int len,
+                                              const float *scale))
+{
+    int16_t *data    = av_malloc(MAX_LEN * sizeof(*data));
+    int16_t *weights = av_malloc(MAX_N * MAX_LEN * sizeof(*weights) + 2 * MAX_N * sizeof(float));
+    LOCAL_ALIGNED_32(float, vals0, [MAX_N]);
+    LOCAL_ALIGNED_32(float, vals1, [MAX_N]);
+    declare_func(void, const int16_t *data, const int16_t *weights, float *vals,
+                 int n, int len, const float *scale);
+
+    if (!data || !weights)
+        goto end;
+
+    if (check_func(func, "nnedi_dot_prod_int16")) {
+        float scale;
+        int i, s;
+
+        for (s = 0; s < FF_ARRAY_ELEMS(sizes); s++) {
+            int n = sizes[s].n, len = sizes[s].len;
+            float *wf = (float *)&weights[n * len];
+
+            scale = (int32_t)rnd() / (float)(1U << 31);
+
+            /* pixels, and weights small enough for the sums not to overflow */
+            for (i = 0; i < len; i++)
+                data[i] = rnd() & 0xff;
+            for (i = 0; i < n * len; i++)
+                weights[i] = (int16_t)rnd() / 2;
+            for (i = 0; i < 2 * n; i++)
+                wf[i] = (int32_t)rnd() / (float)(1U << 31);
+
+            call_ref(data, weights, vals0, n, len, &scale);
+            call_new(data, weights, vals1, n, len, &scale);
+            if (memcmp(vals0, vals1, n * sizeof(*vals0)))
+                fail();
+        }
+        bench_new(data, weights, vals1, MAX_N, MAX_LEN, &scale);
+    }
+
+end:
+    av_free(data);
+    av_free(weights);
+}
+
+void checkasm_check_nnedi(void)
+{
+    NNEDIDSPContext dsp;
+
+    ff_nnedi_init_dsp(&dsp);
+
+    check_dot_prod(dsp.dot_prod);
+    report("dot_prod");
+
+    check_dot_prod_int16(dsp.dot_prod_int16);
+    report("dot_prod_int16");
+}
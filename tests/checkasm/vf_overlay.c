@@ -0,0 +1,144 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/overlay.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/mem.h"
+
+#define WIDTH 259
+#define ALINESIZE 1024
+#define BUF_SIZE (4 * WIDTH + 64)
+
+/* Alpha values of 0 and 255 are special cased in the C code, so make
+ * sure they are frequent. */
+static void randomize_alpha(uint8_t *buf, int size)
+{
+    int i;
+
+    for (i = 0; i < size; i++) {
+        uint32_t r = rnd();
+        buf[i] = (r & 3) == 0 ? 0 : (r & 3) == 1 ? 255 : r >> 8;
+    }
+}
+
+static void randomize(uint8_t *buf, int size)
+{
+    int i;
+
+    for (i = 0; i < size; i++)
+        buf[i] = rnd();
+}
+
+/* The optimized function may leave a tail of pixels for the caller:
+ * the pixels it blended must match the reference, the others must be
+ * untouched. */
+static void check_result(const uint8_t *ref, const uint8_t *new, const uint8_t *orig,
+                         int ret_ref, int ret_new, int w, int bpp)
+{
+    if (ret_ref != w || ret_new > w || ret_new < w - 32 ||
+        memcmp(ref, new, ret_new * bpp) ||
+        memcmp(new + ret_new * bpp, orig + ret_new * bpp, (w - ret_new) * bpp))
+        fail();
+}
+
+static void check_blend_row_planar(int (*func)(uint8_t *d, const uint8_t *s, const uint8_t *a,
+                                               int w, ptrdiff_t alinesize),
+                                   const char *name)
+{
+    LOCAL_ALIGNED_32(uint8_t, orig, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, src,  [BUF_SIZE]);
+    uint8_t *alpha = av_malloc(2 * ALINESIZE);
+    declare_func(int, uint8_t *d, const uint8_t *s, const uint8_t *a,
+                 int w, ptrdiff_t alinesize);
+
+    if (!alpha)
+        return;
+
+    if (check_func(func, "%s", name)) {
+        static const int widths[] = { 1, 7, 16, 33, WIDTH };
+        int i;
+
+        for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+            int w = widths[i], ret0, ret1;
+
+            randomize(orig, BUF_SIZE);
+            randomize(src,  BUF_SIZE);
+            randomize_alpha(alpha, 2 * ALINESIZE);
+            memcpy(dst0, orig, BUF_SIZE);
+            memcpy(dst1, orig, BUF_SIZE);
+
+            ret0 = call_ref(dst0, src, alpha, w, ALINESIZE);
+            ret1 = call_new(dst1, src, alpha, w, ALINESIZE);
+            check_result(dst0, dst1, orig, ret0, ret1, w, 1);
+        }
+        bench_new(dst1, src, alpha, WIDTH, ALINESIZE);
+    }
+    av_free(alpha);
+}
+
+static void check_blend_row_packed(int (*func)(uint8_t *d, const uint8_t *s, int w),
+                                   const char *name)
+{
+    LOCAL_ALIGNED_32(uint8_t, orig, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, src,  [BUF_SIZE]);
+    declare_func(int, uint8_t *d, const uint8_t *s, int w);
+
+    if (check_func(func, "%s", name)) {
+        static const int widths[] = { 1, 5, 8, 31, WIDTH };
+        int i;
+
+        for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+            int w = widths[i], ret0, ret1;
+
+            randomize_alpha(orig, BUF_SIZE);
+            randomize_alpha(src,  BUF_SIZE);
+            memcpy(dst0, orig, BUF_SIZE);
+            memcpy(dst1, orig, BUF_SIZE);
+
+            ret0 = call_ref(dst0, src, w);
+            ret1 = call_new(dst1, src, w);
+            check_result(dst0, dst1, orig, ret0, ret1, w, 4);
+        }
+        bench_new(dst1, src, WIDTH);
+    }
+}
+
+void checkasm_check_overlay(void)
+{
+    OverlayDSPContext dsp;
+
+    ff_overlay_init_dsp(&dsp);
+
+    check_blend_row_planar(dsp.blend_row_44, "overlay_row_44");
+    report("yuv444");
+
+    check_blend_row_planar(dsp.blend_row_20, "overlay_row_20");
+    report("yuv420");
+
+    check_blend_row_packed(dsp.blend_row_rgba, "overlay_row_rgba");
+    check_blend_row_packed(dsp.blend_row_argb, "overlay_row_argb");
+    report("rgba");
+}
@@ -0,0 +1,82 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "checkasm.h"
+#include "libavfilter/paletteuse.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+
+/* Fill the candidates with random colors and distinct palette indexes.
+ * A small range of component values makes the distance ties frequent. */
+static void randomize_palette(int32_t (*pal)[AVPALETTE_COUNT], int n, int mask)
+{
+    int i, j;
+
+    for (i = 0; i < AVPALETTE_COUNT; i++)
+        pal[3][i] = i;
+    for (i = AVPALETTE_COUNT - 1; i > 0; i--) {
+        j = rnd() % (i + 1);
+        FFSWAP(int32_t, pal[3][i], pal[3][j]);
+    }
+    for (i = 0; i < n; i++) {
+        pal[0][i] = rnd() & mask;
+        pal[1][i] = rnd() & mask;
+        pal[2][i] = rnd() & mask;
+    }
+}
+
+static void check_nearest_color(uint32_t (*func)(const int32_t (*pal)[AVPALETTE_COUNT],
+                                                 int n, int r, int g, int b))
+{
+    LOCAL_ALIGNED_32(int32_t, pal, [4], [AVPALETTE_COUNT]);
+    declare_func(uint32_t, const int32_t (*pal)[AVPALETTE_COUNT],
+                 int n, int r, int g, int b);
+
+    if (check_func(func, "nearest_color")) {
+        static const int counts[] = { 0, 16, 48, AVPALETTE_COUNT };
+        static const int masks[]  = { 0x03, 0xff };
+        int i, j, k;
+
+        for (i = 0; i < FF_ARRAY_ELEMS(counts); i++) {
+            for (j = 0; j < FF_ARRAY_ELEMS(masks); j++) {
+                randomize_palette(pal, counts[i], masks[j]);
+                for (k = 0; k < 16; k++) {
+                    const int r = rnd() & 0xff;
+                    const int g = rnd() & 0xff;
+                    const int b = rnd() & 0xff;
+
+                    if (call_ref(pal, counts[i], r, g, b) !=
+                        call_new(pal, counts[i], r, g, b))
+                        fail();
+                }
+            }
+        }
+        bench_new(pal, AVPALETTE_COUNT, 0x12, 0x34, 0x56);
+    }
+}
+
+void checkasm_check_paletteuse(void)
+{
+    PaletteUseDSPContext dsp;
+
+    ff_paletteuse_init_dsp(&dsp);
+
+    check_nearest_color(dsp.nearest_color);
+    report("nearest_color");
+}
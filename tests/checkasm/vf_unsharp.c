@@ -0,0 +1,156 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/unsharp.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+
+#define WIDTH 264
+#define MAX_STAGES 12
+
+static void randomize_sums(uint32_t *buf, int size, int bits)
+{
+    int i;
+
+    for (i = 0; i < size; i++)
+        buf[i] = rnd() & ((1 << bits) - 1);
+}
+
+static void check_hsum(void (*func)(uint32_t *h, int nb_stages, int w))
+{
+    LOCAL_ALIGNED_32(uint32_t, h0, [WIDTH + 8]);
+    LOCAL_ALIGNED_32(uint32_t, h1, [WIDTH + 8]);
+    declare_func(void, uint32_t *h, int nb_stages, int w);
+
+    if (check_func(func, "unsharp_hsum")) {
+        static const int widths[] = { 8, 24, WIDTH };
+        int i;
+
+        for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+            int w = widths[i], stages = 2 + 2 * (rnd() % (MAX_STAGES / 2));
+
+            /* h[-1] is 0 */
+            memset(h0, 0, 8 * sizeof(*h0));
+            randomize_sums(h0 + 8, WIDTH, 8);
+            memcpy(h1, h0, sizeof(*h0) * (WIDTH + 8));
+            call_ref(h0 + 8, stages, w);
+            call_new(h1 + 8, stages, w);
+            if (memcmp(h0, h1, sizeof(*h0) * (WIDTH + 8)))
+                fail();
+        }
+        bench_new(h1 + 8, 6, WIDTH);
+    }
+}
+
+static void check_vsum(void (*func)(uint32_t *h, uint32_t *sc, ptrdiff_t stride,
+                                    int nb_stages, int w))
+{
+    LOCAL_ALIGNED_32(uint32_t, h0, [WIDTH]);
+    LOCAL_ALIGNED_32(uint32_t, h1, [WIDTH]);
+    uint32_t *sc0 = av_malloc(MAX_STAGES * WIDTH * sizeof(*sc0));
+    uint32_t *sc1 = av_malloc(MAX_STAGES * WIDTH * sizeof(*sc1));
+    declare_func(void, uint32_t *h, uint32_t *sc, ptrdiff_t stride,
+                 int nb_stages, int w);
+
+    if (!sc0 || !sc1)
+        goto end;
+
+    if (check_func(func, "unsharp_vsum")) {
+        static const int widths[] = { 8, 24, WIDTH };
+        int i;
+
+        for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+            int w = widths[i], stages = 2 + 2 * (rnd() % (MAX_STAGES / 2));
+
+            randomize_sums(h0, WIDTH, 20);
+            randomize_sums(sc0, MAX_STAGES * WIDTH, 20);
+            memcpy(h1, h0, sizeof(*h0) * WIDTH);
+            memcpy(sc1, sc0, sizeof(*sc0) * MAX_STAGES * WIDTH);
+            call_ref(h0, sc0, WIDTH, stages, w);
+            call_new(h1, sc1, WIDTH, stages, w);
+            if (memcmp(h0, h1, sizeof(*h0) * WIDTH) ||
+                memcmp(sc0, sc1, sizeof(*sc0) * MAX_STAGES * WIDTH))
+                fail();
+        }
+        bench_new(h1, sc1, WIDTH, 6, WIDTH);
+    }
+
+end:
+    av_free(sc0);
+    av_free(sc1);
+}
+
+static void check_blend(int (*func)(uint8_t *dst, const uint8_t *src, const uint32_t *blur,
+                                    int w, int amount, int scalebits))
+{
+    LOCAL_ALIGNED_32(uint8_t, src,  [WIDTH]);
+    LOCAL_ALIGNED_32(uint8_t, orig, [WIDTH]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [WIDTH]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [WIDTH]);
+    LOCAL_ALIGNED_32(uint32_t, blur, [WIDTH]);
+    int amount = 0, scalebits = 0;
+    declare_func(int, uint8_t *dst, const uint8_t *src, const uint32_t *blur,
+                 int w, int amount, int scalebits);
+
+    if (check_func(func, "unsharp_blend")) {
+        static const int widths[] = { 1, 8, 21, WIDTH };
+        int i, x;
+
+        for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+            int w = widths[i], ret0, ret1;
+
+            /* the amount and matrix sizes allowed by the filter */
+            amount    = (int)(rnd() % (7 * 65536)) - 2 * 65536;
+            scalebits = 4 + 4 * (rnd() % 5);
+            for (x = 0; x < WIDTH; x++) {
+                src[x]  = rnd();
+                orig[x] = rnd();
+                blur[x] = rnd() % (256U << scalebits);
+            }
+            memcpy(dst0, orig, WIDTH);
+            memcpy(dst1, orig, WIDTH);
+
+            ret0 = call_ref(dst0, src, blur, w, amount, scalebits);
+            ret1 = call_new(dst1, src, blur, w, amount, scalebits);
+            if (ret0 != w || ret1 > w || ret1 < w - 16 ||
+                memcmp(dst0, dst1, ret1) ||
+                memcmp(dst1 + ret1, orig + ret1, w - ret1))
+                fail();
+        }
+        bench_new(dst1, src, blur, WIDTH, amount, scalebits);
+    }
+}
+
+void checkasm_check_unsharp(void)
+{
+    UnsharpDSPContext dsp;
+
+    ff_unsharp_init_dsp(&dsp);
+
+    check_hsum(dsp.hsum);
+    report("hsum");
+
+    check_vsum(dsp.vsum);
+    report("vsum");
+
+    check_blend(dsp.blend);
+    report("blend");
+}
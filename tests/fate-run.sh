@@ -129,6 +129,10 @@ framemd5(){
     ffmpeg "$@" -flags +bitexact -fflags +bitexact -f framemd5 -
 }
 
+ebur128_summary(){
+    ffmpeg "$@" -f null - 2>&1 | sed -n '/Summary:/,$p' | tail -n +2
+}
+
 crc(){
     ffmpeg "$@" -f crc -
 }
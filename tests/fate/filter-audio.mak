@@ -102,6 +102,13 @@ fate-filter-volume: CMD = md5 -i $(SRC) -af aperms=random,volume=precision=fixed
 fate-filter-volume: CMP = oneline
 fate-filter-volume: REF = 4d6ba75ef3e32d305d066b9bc771d6f4
 
+FATE_AFILTER-$(call ALLYES, AEVALSRC_FILTER LAVFI_INDEV EBUR128_FILTER) += fate-filter-ebur128-summary
+fate-filter-ebur128-summary: CMD = ebur128_summary -f lavfi -i "aevalsrc=0.3*sin(2*PI*997*t)*t/5+0.6*floor(n/239999)|0.25*sin(2*PI*3000*t):s=48000:d=5" -af ebur128=peak=sample+true:framelog=quiet
+
+FATE_AFILTER-$(call ALLYES, AEVALSRC_FILTER LAVFI_INDEV EQUALIZER_FILTER AFORMAT_FILTER) += fate-filter-equalizer-f64 fate-filter-equalizer-f32
+fate-filter-equalizer-%: SRC = "aevalsrc=0.5*sin(2*PI*(20+200*t)*t)|0.5*sin(2*PI*(30+300*t)*t)|0.3*sin(2*PI*50*t)|0.4*sin(2*PI*(40+100*t)*t)|0.2*sin(2*PI*3000*t)|0.5*sin(2*PI*70*t):s=44100:d=1"
+fate-filter-equalizer-%: CMD = framecrc -f lavfi -i $(SRC) -af equalizer=f=60:width_type=q:w=2:g=12:precision=$(@:fate-filter-equalizer-%=%),aformat=s16p
+
 FATE_AFILTER-yes += fate-filter-formats
 fate-filter-formats: libavfilter/formats-test$(EXESUF)
 fate-filter-formats: CMD = run libavfilter/formats-test
@@ -334,6 +334,17 @@ fate-filter-concat: CMD = framecrc -filter_complex_script $(TARGET_PATH)/tests/d
 FATE_FILTER-$(call ALLYES, TESTSRC2_FILTER FPS_FILTER MPDECIMATE_FILTER) += fate-filter-mpdecimate
 fate-filter-mpdecimate: CMD = framecrc -lavfi testsrc2=r=2:d=10,fps=3,mpdecimate -r 3 -pix_fmt yuv420p
 
+FATE_FILTER-$(call ALLYES, TESTSRC2_FILTER ZOOMPAN_FILTER) += fate-filter-zoompan-bilinear fate-filter-zoompan-bicubic
+fate-filter-zoompan-bilinear: CMD = framecrc -lavfi testsrc2=s=160x120:r=5:d=1,zoompan=z=1+0.13*on:x=iw/2-iw/zoom/2:y=ih/2-ih/zoom/2:d=4:s=144x112:fps=5:interp=bilinear -pix_fmt yuv420p
+fate-filter-zoompan-bicubic: CMD = framecrc -lavfi testsrc2=s=160x120:r=5:d=1,zoompan=z=1+0.13*on:x=iw/2-iw/zoom/2:y=ih/2-ih/zoom/2:d=4:s=144x112:fps=5:interp=bicubic -pix_fmt yuv420p
+
+FATE_FILTER-$(call ALLYES, TESTSRC2_FILTER FRAMERATE_FILTER) += fate-filter-framerate-mci
+fate-filter-framerate-mci: CMD = framecrc -lavfi testsrc2=s=176x144:r=10:d=1,framerate=fps=25:mode=mci:mb_size=8 -pix_fmt yuv420p
+
+FATE_FILTER-$(call ALLYES, FRAMERATE_FILTER MPEG4_ENCODER MP4_MUXER MOV_DEMUXER MPEG4_DECODER) += fate-filter-framerate-mci-mvs
+fate-filter-framerate-mci-mvs: fate-vsynth1-mpeg4
+fate-filter-framerate-mci-mvs: CMD = framecrc -flags bitexact -idct simple -flags2 +export_mvs -i $(TARGET_PATH)/tests/data/fate/vsynth1-mpeg4.mp4 -vframes 10 -vf framerate=fps=50:mode=mci
+
 FATE_FILTER_SAMPLES-$(call ALLYES, MOV_DEMUXER FPS_FILTER QTRLE_DECODER) += fate-filter-fps-cfr fate-filter-fps fate-filter-fps-r
 fate-filter-fps-cfr: CMD = framecrc -i $(TARGET_SAMPLES)/qtrle/apple-animation-variable-fps-bug.mov -r 30 -vsync cfr -pix_fmt yuv420p
 fate-filter-fps-r:   CMD = framecrc -i $(TARGET_SAMPLES)/qtrle/apple-animation-variable-fps-bug.mov -r 30 -vf fps -pix_fmt yuv420p
@@ -0,0 +1,208 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Benchmark for the muxer packet interleaving with many streams.
+ *
+ * Packets are generated for one video and many audio streams, each stream
+ * arriving with a different delay, and written with
+ * av_interleaved_write_frame() to an in-memory muxer. The time spent in
+ * the muxing calls and a checksum of the muxed output are printed, so
+ * both the speed and the resulting packet order can be compared.
+ */
+
+#include "config.h"
+#if HAVE_UNISTD_H
+#include <unistd.h>             /* getopt */
+#endif
+
+#include "libavformat/avformat.h"
+#include "libavutil/adler32.h"
+#include "libavutil/time.h"
+
+#if !HAVE_GETOPT
+#include "compat/getopt.c"
+#endif
+
+typedef struct BenchPacket {
+    int     stream_index;
+    int64_t dts;
+    int     duration;
+    double  arrival;
+} BenchPacket;
+
+static void usage(int ret)
+{
+    fprintf(ret ? stderr : stdout,
+            "Usage: mux_bench [-s streams] [-n packets] [-l lag_ms] "
+            "[-d max_interleave_delta_us] [-f format]\n"
+            "    -s  number of streams (default 256)\n"
+            "    -n  number of packets per stream (default 1000)\n"
+            "    -l  largest arrival delay between streams in ms (default 500)\n"
+            "    -d  max_interleave_delta of the muxer in microseconds\n"
+            "    -f  output format (default framecrc)\n");
+    exit(ret);
+}
+
+static int compare_arrival(const void *a, const void *b)
+{
+    const BenchPacket *pa = a, *pb = b;
+
+    if (pa->arrival != pb->arrival)
+        return pa->arrival > pb->arrival ? 1 : -1;
+    return pa->stream_index - pb->stream_index;
+}
+
+int main(int argc, char **argv)
+{
+    int nb_streams = 256, nb_packets = 1000, lag_ms = 500;
+    int64_t max_interleave_delta = -1;
+    const char *format = "framecrc";
+    AVFormatContext *avf = NULL;
+    BenchPacket *packets = NULL;
+    uint8_t *out_buf = NULL;
+    int64_t t0, elapsed = 0;
+    int opt, ret, i, j, out_size;
+    size_t nb_total, k;
+
+    while ((opt = getopt(argc, argv, "hs:n:l:d:f:")) != -1) {
+        switch (opt) {
+        case 's': nb_streams = atoi(optarg);            break;
+        case 'n': nb_packets = atoi(optarg);            break;
+        case 'l': lag_ms     = atoi(optarg);            break;
+        case 'd': max_interleave_delta = atoll(optarg); break;
+        case 'f': format     = optarg;                  break;
+        case 'h':
+            usage(0);
+        default:
+            usage(1);
+        }
+    }
+    if (nb_streams < 1 || nb_packets < 1 || lag_ms < 0)
+        usage(1);
+
+    av_register_all();
+
+    ret = avformat_alloc_output_context2(&avf, NULL, format, NULL);
+    if (ret < 0) {
+        fprintf(stderr, "Failed to allocate muxer: %s\n", av_err2str(ret));
+        return 1;
+    }
+    if (max_interleave_delta >= 0)
+        avf->max_interleave_delta = max_interleave_delta;
+
+    for (i = 0; i < nb_streams; i++) {
+        AVStream *st = avformat_new_stream(avf, NULL);
+        if (!st) {
+            ret = AVERROR(ENOMEM);
+            goto end;
+        }
+        if (!i) {
+            st->codecpar->codec_type = AVMEDIA_TYPE_VIDEO;
+            st->codecpar->codec_id   = AV_CODEC_ID_RAWVIDEO;
+            st->codecpar->width      = 16;
+            st->codecpar->height     = 16;
+            st->codecpar->format     = AV_PIX_FMT_GRAY8;
+            st->time_base            = (AVRational){ 1, 25 };
+        } else {
+            st->codecpar->codec_type  = AVMEDIA_TYPE_AUDIO;
+            st->codecpar->codec_id    = AV_CODEC_ID_PCM_S16LE;
+            st->codecpar->channels    = 1;
+            st->codecpar->sample_rate = i & 1 ? 48000 : 44100;
+            st->time_base = (AVRational){ 1, st->codecpar->sample_rate };
+        }
+    }
+
+    if (!(avf->oformat->flags & AVFMT_NOFILE) &&
+        (ret = avio_open_dyn_buf(&avf->pb)) < 0)
+        goto end;
+    if ((ret = avformat_write_header(avf, NULL)) < 0)
+        goto end;
+
+    /* Compute the order in which the packets are handed to the muxer
+     * before timing anything. */
+    nb_total = (size_t)nb_streams * nb_packets;
+    packets  = av_malloc_array(nb_total, sizeof(*packets));
+    if (!packets) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+    for (i = 0; i < nb_streams; i++) {
+        AVStream *st = avf->streams[i];
+        int duration = i ? 1024 + 128 * (i % 3) : 1;
+        double lag   = (double)((i * 7919) % (lag_ms + 1)) / 1000;
+
+        for (j = 0; j < nb_packets; j++) {
+            BenchPacket *p  = &packets[(size_t)i * nb_packets + j];
+            p->stream_index = i;
+            p->dts          = (int64_t)j * duration;
+            p->duration     = duration;
+            p->arrival      = p->dts * av_q2d(st->time_base) + lag;
+        }
+    }
+    qsort(packets, nb_total, sizeof(*packets), compare_arrival);
+
+    for (k = 0; k < nb_total; k++) {
+        AVPacket pkt;
+
+        if ((ret = av_new_packet(&pkt, 16)) < 0)
+            goto end;
+        memset(pkt.data, packets[k].stream_index, pkt.size);
+        pkt.stream_index = packets[k].stream_index;
+        pkt.dts = pkt.pts = packets[k].dts;
+        pkt.duration = packets[k].duration;
+        pkt.flags   |= AV_PKT_FLAG_KEY;
+
+        t0  = av_gettime_relative();
+        ret = av_interleaved_write_frame(avf, &pkt);
+        elapsed += av_gettime_relative() - t0;
+        if (ret < 0) {
+            fprintf(stderr, "Failed to write packet: %s\n", av_err2str(ret));
+            goto end;
+        }
+    }
+
+    t0  = av_gettime_relative();
+    ret = av_write_trailer(avf);
+    elapsed += av_gettime_relative() - t0;
+    if (ret < 0)
+        goto end;
+
+    printf("streams: %d packets: %"PRId64" time: %.3f s (%.1f ns/packet)",
+           nb_streams, (int64_t)nb_total, elapsed / 1000000.0,
+           elapsed * 1000.0 / nb_total);
+    if (avf->pb) {
+        out_size = avio_close_dyn_buf(avf->pb, &out_buf);
+        avf->pb  = NULL;
+        printf(" output adler32: 0x%08"PRIx32,
+               (uint32_t)av_adler32_update(1, out_buf, out_size));
+    }
+    printf("\n");
+
+end:
+    if (avf && avf->pb)
+        avio_close_dyn_buf(avf->pb, &out_buf);
+    av_free(out_buf);
+    av_free(packets);
+    avformat_free_context(avf);
+    if (ret < 0) {
+        fprintf(stderr, "Error: %s\n", av_err2str(ret));
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,178 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Benchmark for scaling whole frames with libswscale.
+ *
+ * A frame of random pixels is scaled a number of times; the time per frame
+ * and a checksum of the scaled frame are printed. Running it again with
+ * some cpu flags disabled (e.g. -c -avx2) compares the SIMD versions while
+ * checking that they produce the same output.
+ */
+
+#include "config.h"
+#if HAVE_UNISTD_H
+#include <unistd.h>             /* getopt */
+#endif
+
+#include "libavutil/adler32.h"
+#include "libavutil/cpu.h"
+#include "libavutil/imgutils.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/lfg.h"
+#include "libavutil/opt.h"
+#include "libavutil/parseutils.h"
+#include "libavutil/pixdesc.h"
+#include "libavutil/time.h"
+#include "libswscale/swscale.h"
+
+#if !HAVE_GETOPT
+#include "compat/getopt.c"
+#endif
+
+static void usage(int ret)
+{
+    fprintf(ret ? stderr : stdout,
+            "Usage: sws_bench [-s src_size] [-d dst_size] [-i src_fmt] [-o dst_fmt] "
+            "[-f flags] [-n frames] [-c cpuflags]\n"
+            "    -s  source size (default 1920x1080)\n"
+            "    -d  destination size (default 3840x2160)\n"
+            "    -i  source pixel format (default yuv420p10)\n"
+            "    -o  destination pixel format (default same as the source)\n"
+            "    -f  scaler flags (default bicubic)\n"
+            "    -n  number of frames (default 100)\n"
+            "    -c  cpu flags, e.g. -avx2 or 0 for C only\n");
+    exit(ret);
+}
+
+int main(int argc, char **argv)
+{
+    int src_w = 1920, src_h = 1080, dst_w = 3840, dst_h = 2160;
+    enum AVPixelFormat src_fmt = AV_PIX_FMT_YUV420P10, dst_fmt = AV_PIX_FMT_NONE;
+    const char *flags = "bicubic";
+    int nb_frames = 100;
+    struct SwsContext *sws = NULL;
+    const AVPixFmtDescriptor *desc;
+    uint8_t *src[4] = { NULL }, *dst[4] = { NULL };
+    int src_stride[4], dst_stride[4];
+    int64_t t0, elapsed;
+    uint32_t crc = 1;
+    AVLFG lfg;
+    int opt, ret, size, i, p;
+
+    while ((opt = getopt(argc, argv, "hs:d:i:o:f:n:c:")) != -1) {
+        switch (opt) {
+        case 's':
+            if (av_parse_video_size(&src_w, &src_h, optarg) < 0)
+                usage(1);
+            break;
+        case 'd':
+            if (av_parse_video_size(&dst_w, &dst_h, optarg) < 0)
+                usage(1);
+            break;
+        case 'i':
+            if ((src_fmt = av_get_pix_fmt(optarg)) == AV_PIX_FMT_NONE)
+                usage(1);
+            break;
+        case 'o':
+            if ((dst_fmt = av_get_pix_fmt(optarg)) == AV_PIX_FMT_NONE)
+                usage(1);
+            break;
+        case 'f': flags     = optarg;       break;
+        case 'n': nb_frames = atoi(optarg); break;
+        case 'c': {
+            unsigned cpu_flags = av_get_cpu_flags();
+            if (av_parse_cpu_caps(&cpu_flags, optarg) < 0)
+                usage(1);
+            av_force_cpu_flags(cpu_flags);
+            break;
+        }
+        case 'h':
+            usage(0);
+        default:
+            usage(1);
+        }
+    }
+    if (nb_frames < 1)
+        usage(1);
+    if (dst_fmt == AV_PIX_FMT_NONE)
+        dst_fmt = src_fmt;
+
+    sws = sws_alloc_context();
+    if (!sws) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+    av_opt_set_int(sws, "srcw",       src_w,   0);
+    av_opt_set_int(sws, "srch",       src_h,   0);
+    av_opt_set_int(sws, "src_format", src_fmt, 0);
+    av_opt_set_int(sws, "dstw",       dst_w,   0);
+    av_opt_set_int(sws, "dsth",       dst_h,   0);
+    av_opt_set_int(sws, "dst_format", dst_fmt, 0);
+    if ((ret = av_opt_set(sws, "sws_flags", flags, 0)) < 0 ||
+        (ret = sws_init_context(sws, NULL, NULL)) < 0)
+        goto end;
+
+    if ((ret = av_image_alloc(src, src_stride, src_w, src_h, src_fmt, 32)) < 0)
+        goto end;
+    size = ret;
+    if ((ret = av_image_alloc(dst, dst_stride, dst_w, dst_h, dst_fmt, 32)) < 0)
+        goto end;
+
+    /* random samples, but within the range of the format */
+    av_lfg_init(&lfg, 0xdeadbeef);
+    for (i = 0; i < size; i++)
+        src[0][i] = av_lfg_get(&lfg);
+    desc = av_pix_fmt_desc_get(src_fmt);
+    if (desc->comp[0].depth > 8 && desc->comp[0].depth < 16 &&
+        !(desc->flags & AV_PIX_FMT_FLAG_BE)) {
+        int mask = (1 << desc->comp[0].depth) - 1;
+        for (i = 0; i + 1 < size; i += 2)
+            AV_WL16(src[0] + i, AV_RL16(src[0] + i) & mask);
+    }
+
+    t0 = av_gettime_relative();
+    for (i = 0; i < nb_frames; i++)
+        sws_scale(sws, (const uint8_t * const *)src, src_stride, 0, src_h,
+                  dst, dst_stride);
+    elapsed = av_gettime_relative() - t0;
+
+    desc = av_pix_fmt_desc_get(dst_fmt);
+    for (p = 0; p < 4 && dst[p]; p++) {
+        int h = p == 1 || p == 2 ? AV_CEIL_RSHIFT(dst_h, desc->log2_chroma_h) : dst_h;
+        int linesize = av_image_get_linesize(dst_fmt, dst_w, p);
+        for (i = 0; i < h; i++)
+            crc = av_adler32_update(crc, dst[p] + i * dst_stride[p], linesize);
+    }
+
+    printf("%dx%d %s -> %dx%d %s %s: %.3f ms/frame output adler32: 0x%08"PRIx32"\n",
+           src_w, src_h, av_get_pix_fmt_name(src_fmt),
+           dst_w, dst_h, av_get_pix_fmt_name(dst_fmt), flags,
+           elapsed / 1000.0 / nb_frames, crc);
+    ret = 0;
+
+end:
+    sws_freeContext(sws);
+    av_freep(&src[0]);
+    av_freep(&dst[0]);
+    if (ret < 0) {
+        fprintf(stderr, "Error: %s\n", av_err2str(ret));
+        return 1;
+    }
+    return 0;
+}